@@ -67,11 +67,11 @@ bool AudioAnalyzer::isRMVPEAvailable() const {
 
 void AudioAnalyzer::analyze(Project& project, ProgressCallback onProgress, CompleteCallback onComplete) {
     auto& audioData = project.getAudioData();
-    if (audioData.waveform.getNumSamples() == 0)
+    if (audioData.waveform->getNumSamples() == 0)
         return;
 
-    const float* samples = audioData.waveform.getReadPointer(0);
-    int numSamples = audioData.waveform.getNumSamples();
+    const float* samples = audioData.waveform->getReadPointer(0);
+    int numSamples = audioData.waveform->getNumSamples();
 
     // Compute mel spectrogram
     if (onProgress) onProgress(0.35, "Computing mel spectrogram...");
@@ -151,8 +151,8 @@ void AudioAnalyzer::analyzeAsync(Project& project, ProgressCallback onProgress,
 }
 
 void AudioAnalyzer::extractF0WithRMVPE(AudioData& audioData, int targetFrames) {
-    const float* samples = audioData.waveform.getReadPointer(0);
-    int numSamples = audioData.waveform.getNumSamples();
+    const float* samples = audioData.waveform->getReadPointer(0);
+    int numSamples = audioData.waveform->getNumSamples();
 
     auto* detector = rmvpeDetector ? rmvpeDetector.get() : externalRMVPEDetector;
     std::vector<float> rmvpeF0 = detector->extractF0(samples, numSamples, SAMPLE_RATE);
@@ -205,8 +205,8 @@ void AudioAnalyzer::extractF0WithRMVPE(AudioData& audioData, int targetFrames) {
 }
 
 void AudioAnalyzer::extractF0WithFCPE(AudioData& audioData, int targetFrames) {
-    const float* samples = audioData.waveform.getReadPointer(0);
-    int numSamples = audioData.waveform.getNumSamples();
+    const float* samples = audioData.waveform->getReadPointer(0);
+    int numSamples = audioData.waveform->getNumSamples();
 
     auto* detector = fcpeDetector ? fcpeDetector.get() : externalFCPEDetector;
     std::vector<float> fcpeF0 = detector->extractF0(samples, numSamples, SAMPLE_RATE);
@@ -259,8 +259,8 @@ void AudioAnalyzer::extractF0WithFCPE(AudioData& audioData, int targetFrames) {
 }
 
 void AudioAnalyzer::extractF0WithYIN(AudioData& audioData) {
-    const float* samples = audioData.waveform.getReadPointer(0);
-    int numSamples = audioData.waveform.getNumSamples();
+    const float* samples = audioData.waveform->getReadPointer(0);
+    int numSamples = audioData.waveform->getNumSamples();
 
     auto* detector = pitchDetector ? pitchDetector.get() : externalPitchDetector;
     auto [f0Values, voicedValues] = detector->extractF0(samples, numSamples);
@@ -270,15 +270,14 @@ void AudioAnalyzer::extractF0WithYIN(AudioData& audioData) {
 
 void AudioAnalyzer::segmentIntoNotes(Project& project) {
     auto& audioData = project.getAudioData();
-    auto& notes = project.getNotes();
-    notes.clear();
+    project.clearNotes();
 
     if (audioData.f0.empty())
         return;
 
     // Try SOME model first
     auto* detector = someDetector ? someDetector.get() : externalSOMEDetector;
-    if (detector && detector->isLoaded() && audioData.waveform.getNumSamples() > 0) {
+    if (detector && detector->isLoaded() && audioData.waveform->getNumSamples() > 0) {
         segmentWithSOME(project);
         return;
     }
@@ -289,10 +288,10 @@ void AudioAnalyzer::segmentIntoNotes(Project& project) {
 
 void AudioAnalyzer::segmentWithSOME(Project& project) {
     auto& audioData = project.getAudioData();
-    auto& notes = project.getNotes();
+    std::vector<Note> notes;
 
-    const float* samples = audioData.waveform.getReadPointer(0);
-    int numSamples = audioData.waveform.getNumSamples();
+    const float* samples = audioData.waveform->getReadPointer(0);
+    int numSamples = audioData.waveform->getNumSamples();
     const int f0Size = static_cast<int>(audioData.f0.size());
 
     auto* detector = someDetector ? someDetector.get() : externalSOMEDetector;
@@ -325,11 +324,7 @@ void AudioAnalyzer::segmentWithSOME(Project& project) {
                     midi = midiSum / midiCount;
                 }
 
-                Note note(f0Start, f0End, midi);
-                std::vector<float> f0Values(audioData.f0.begin() + f0Start,
-                                            audioData.f0.begin() + f0End);
-                note.setF0Values(std::move(f0Values));
-                notes.push_back(note);
+                notes.emplace_back(f0Start, f0End, midi);
             }
         },
         nullptr
@@ -337,13 +332,14 @@ void AudioAnalyzer::segmentWithSOME(Project& project) {
 
     juce::Thread::sleep(100);
 
+    project.setNotes(std::move(notes));
     if (!audioData.f0.empty())
         PitchCurveProcessor::rebuildCurvesFromSource(project, audioData.f0);
 }
 
 void AudioAnalyzer::segmentFallback(Project& project) {
     auto& audioData = project.getAudioData();
-    auto& notes = project.getNotes();
+    std::vector<Note> notes;
 
     auto finalizeNote = [&](int start, int end) {
         if (end - start < 5)
@@ -362,11 +358,7 @@ void AudioAnalyzer::segmentFallback(Project& project) {
             return;
 
         float midi = midiSum / midiCount;
-        Note note(start, end, midi);
-        std::vector<float> f0Values(audioData.f0.begin() + start,
-                                    audioData.f0.begin() + end);
-        note.setF0Values(std::move(f0Values));
-        notes.push_back(note);
+        notes.emplace_back(start, end, midi);
     };
 
     constexpr float pitchSplitThreshold = 0.5f;
@@ -424,6 +416,7 @@ void AudioAnalyzer::segmentFallback(Project& project) {
         finalizeNote(noteStart, static_cast<int>(audioData.f0.size()));
     }
 
+    project.setNotes(std::move(notes));
     if (!audioData.f0.empty())
         PitchCurveProcessor::rebuildCurvesFromSource(project, audioData.f0);
 }
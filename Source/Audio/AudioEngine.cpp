@@ -1,4 +1,8 @@
 #include "AudioEngine.h"
+#include "../Models/ScratchStorage.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
 
 AudioEngine::AudioEngine()
 {
@@ -47,6 +51,14 @@ void AudioEngine::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
     playbackRatio = static_cast<double>(waveformSampleRate) / sampleRate;
     interpolator.reset();
     fractionalPosition = 0.0;
+
+    // Enough input for a block (and then some) at this ratio
+    std::vector<float> scratch(static_cast<size_t>(std::max(samplesPerBlockExpected, 8192)
+                                                   * std::max(1.0, std::ceil(playbackRatio))) + 16);
+    {
+        const juce::SpinLock::ScopedLockType lock(waveformLock);
+        std::swap(mixScratch, scratch);
+    }
     
     DBG("AudioEngine::prepareToPlay - Device sample rate: " + juce::String(sampleRate) + 
         " Hz, Waveform sample rate: " + juce::String(waveformSampleRate) + 
@@ -59,14 +71,14 @@ void AudioEngine::releaseResources()
 
 void AudioEngine::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill)
 {
-    if (!playing || currentWaveform.getNumSamples() == 0)
+    if (!playing)
     {
         bufferToFill.clearActiveBufferRegion();
         return;
     }
 
     const juce::SpinLock::ScopedTryLockType lock(waveformLock);
-    if (!lock.isLocked())
+    if (!lock.isLocked() || getWaveformLength() == 0)
     {
         // Waveform is being updated, output silence to avoid glitches
         bufferToFill.clearActiveBufferRegion();
@@ -78,7 +90,7 @@ void AudioEngine::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferTo
     auto startSample = bufferToFill.startSample;
 
     int64_t pos = currentPosition.load();
-    int64_t waveformLength = currentWaveform.getNumSamples();
+    int64_t waveformLength = getWaveformLength();
     
     if (pos >= waveformLength)
     {
@@ -97,16 +109,55 @@ void AudioEngine::getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferTo
     }
     
     // Use interpolator for sample rate conversion
-    const float* inputData = currentWaveform.getReadPointer(0);
+    const float* inputData = currentWaveform->getReadPointer(0);
+    const float* input = inputData + pos;
     float* outputData = outputBuffer->getWritePointer(0, startSample);
     
     // Calculate how many input samples we need
     int inputSamplesAvailable = static_cast<int>(waveformLength - pos);
+
+    // A fade that is over (or was seeked out of) no longer needs the old samples
+    if (fadeTail != nullptr && (pos >= fadeStart + fadeLength || pos < fadeStart)
+        && retiredRegion == nullptr)
+    {
+        retiredRegion = std::move(fadeTail);
+        juce::MessageManager::callAsync([this]() { releaseRetiredRegion(); });
+    }
+
+    // Where the overlay or a fade covers this block, the interpolator reads
+    // its input assembled in the scratch buffer; the waveform itself may be
+    // being written there
+    const int needed = std::min(inputSamplesAvailable,
+                                static_cast<int>(std::ceil(numOutputSamples * playbackRatio)) + 8);
+    const bool fading = fadeTail != nullptr && pos >= fadeStart && pos < fadeStart + fadeLength;
+    const bool overlaid = overlay != nullptr && pos < overlay->getEnd() && pos + needed > overlay->start;
+    if ((fading || overlaid) && !mixScratch.empty())
+    {
+        // A block too large for the scratch buffer is cut short
+        const int count = std::min(needed, static_cast<int>(mixScratch.size()));
+        for (int i = 0; i < count; ++i)
+        {
+            const int64_t sample = pos + i;
+            const bool inOverlay = overlaid && sample >= overlay->start && sample < overlay->getEnd();
+            float value = inOverlay ? overlay->samples[static_cast<size_t>(sample - overlay->start)]
+                                    : inputData[sample];
+
+            if (fading && sample < fadeStart + fadeLength)
+            {
+                const float mix = static_cast<float>(sample - fadeStart) / static_cast<float>(fadeLength);
+                const float oldSample = fadeTail->samples[static_cast<size_t>(sample - fadeTail->start)];
+                value = oldSample + (value - oldSample) * mix;
+            }
+            mixScratch[static_cast<size_t>(i)] = value;
+        }
+        input = mixScratch.data();
+        inputSamplesAvailable = count;
+    }
     
     // Process with interpolation
     int samplesUsed = interpolator.process(
         playbackRatio,
-        inputData + pos,
+        input,
         outputData,
         numOutputSamples,
         inputSamplesAvailable,
@@ -170,6 +221,12 @@ void AudioEngine::loadWaveform(const juce::AudioBuffer<float>& buffer, int sampl
 
     DBG("AudioEngine::loadWaveform called - this=" << juce::String::toHexString(reinterpret_cast<uintptr_t>(this)));
 
+    // Only the first channel is played; copied before playback stops
+    const int numSamples = buffer.getNumChannels() > 0 ? buffer.getNumSamples() : 0;
+    auto copy = ScratchStorage::makeAudioBuffer(1, numSamples);
+    if (numSamples > 0)
+        copy->copyFrom(0, 0, buffer, 0, 0, numSamples);
+
     // Save playing state if we need to preserve it
     bool wasPlaying = playing.load();
 
@@ -179,9 +236,16 @@ void AudioEngine::loadWaveform(const juce::AudioBuffer<float>& buffer, int sampl
     // Wait a bit for audio thread to notice
     juce::Thread::sleep(10);
 
+    // Released after the lock, so a large buffer is never freed while holding it
+    std::shared_ptr<juce::AudioBuffer<float>> previousWaveform;
+    std::shared_ptr<const PlaybackRegion> previousOverlay;
+    std::shared_ptr<const PlaybackRegion> previousFade;
+
     {
         const juce::SpinLock::ScopedLockType lock(waveformLock);
-        currentWaveform = buffer;
+        previousWaveform = std::exchange(currentWaveform, std::move(copy));
+        previousOverlay = std::exchange(overlay, nullptr);
+        previousFade = std::exchange(fadeTail, nullptr);
         waveformSampleRate = sampleRate;
 
         if (!preservePosition) {
@@ -204,13 +268,116 @@ void AudioEngine::loadWaveform(const juce::AudioBuffer<float>& buffer, int sampl
         DBG("Restored playback state after waveform update");
     }
 
-    DBG("Loaded waveform: " + juce::String(buffer.getNumSamples()) + " samples at " +
+    DBG("Loaded waveform: " + juce::String(numSamples) + " samples at " +
         juce::String(sampleRate) + " Hz, playback ratio: " + juce::String(playbackRatio));
 }
 
+std::shared_ptr<const AudioEngine::PlaybackRegion> AudioEngine::captureOutput(int64_t start, int64_t count) const
+{
+    auto region = std::make_shared<PlaybackRegion>();
+    region->start = start;
+
+    const int64_t end = std::min(start + count, getWaveformLength());
+    if (start < 0 || start >= end)
+        return region;
+
+    // Only this thread writes the waveform and replaces the overlay
+    region->samples.resize(static_cast<size_t>(end - start));
+    const float* waveform = currentWaveform->getReadPointer(0);
+    for (int64_t sample = start; sample < end; ++sample)
+    {
+        const bool inOverlay = overlay != nullptr && sample >= overlay->start && sample < overlay->getEnd();
+        region->samples[static_cast<size_t>(sample - start)] =
+            inOverlay ? overlay->samples[static_cast<size_t>(sample - overlay->start)] : waveform[sample];
+    }
+    return region;
+}
+
+void AudioEngine::switchOverlay(std::shared_ptr<const PlaybackRegion> region, double fadeSeconds)
+{
+    const int64_t fadeSamples = static_cast<int64_t>(fadeSeconds * waveformSampleRate);
+
+    // What is about to be heard, with room for the blocks played before the
+    // switch below takes effect
+    std::shared_ptr<const PlaybackRegion> tail;
+    if (playing && fadeSamples > 0)
+        tail = captureOutput(currentPosition.load(), fadeSamples + waveformSampleRate / 10);
+
+    // Released after the lock, like in loadWaveform()
+    std::shared_ptr<const PlaybackRegion> previousOverlay;
+    std::shared_ptr<const PlaybackRegion> previousFade;
+
+    {
+        const juce::SpinLock::ScopedLockType lock(waveformLock);
+        previousOverlay = std::exchange(overlay, std::move(region));
+        previousFade = std::exchange(fadeTail, nullptr);
+
+        const int64_t position = currentPosition.load();
+        if (tail != nullptr && position >= tail->start && position + fadeSamples <= tail->getEnd())
+        {
+            fadeTail = std::move(tail);
+            fadeStart = position;
+            fadeLength = fadeSamples;
+        }
+    }
+}
+
+void AudioEngine::replaceRegion(int64_t startSample, const float* samples, int numSamples, double fadeSeconds)
+{
+    const int64_t start = std::max<int64_t>(0, startSample);
+    const int64_t end = std::min(startSample + numSamples, getWaveformLength());
+    if (start >= end || samples == nullptr)
+        return;
+
+    // Heard from the new samples while the waveform is written underneath
+    auto region = std::make_shared<PlaybackRegion>();
+    region->start = start;
+    region->samples.assign(samples + (start - startSample), samples + (end - startSample));
+    switchOverlay(region, fadeSeconds);
+
+    std::copy(region->samples.begin(), region->samples.end(), currentWaveform->getWritePointer(0) + start);
+
+    // The waveform now holds the same samples; released after the lock
+    std::shared_ptr<const PlaybackRegion> previousOverlay;
+    const juce::SpinLock::ScopedLockType lock(waveformLock);
+    previousOverlay = std::exchange(overlay, nullptr);
+}
+
+void AudioEngine::setPreview(int64_t startSample, std::vector<float> samples, double fadeSeconds)
+{
+    // Kept within the waveform, which the audio thread relies on
+    const int64_t start = std::max<int64_t>(0, startSample);
+    const int64_t end = std::min(startSample + static_cast<int64_t>(samples.size()), getWaveformLength());
+    if (start >= end)
+        return;
+
+    samples.erase(samples.begin() + (end - startSample), samples.end());
+    samples.erase(samples.begin(), samples.begin() + (start - startSample));
+
+    auto region = std::make_shared<PlaybackRegion>();
+    region->start = start;
+    region->samples = std::move(samples);
+    switchOverlay(std::move(region), fadeSeconds);
+}
+
+void AudioEngine::clearPreview(double fadeSeconds)
+{
+    if (overlay != nullptr)
+        switchOverlay(nullptr, fadeSeconds);
+}
+
+void AudioEngine::releaseRetiredRegion()
+{
+    std::shared_ptr<const PlaybackRegion> retired;
+    {
+        const juce::SpinLock::ScopedLockType lock(waveformLock);
+        retired = std::move(retiredRegion);
+    }
+}
+
 void AudioEngine::play()
 {
-    if (currentWaveform.getNumSamples() == 0)
+    if (getWaveformLength() == 0)
     {
         DBG("Cannot play: no waveform loaded");
         return;
@@ -223,6 +390,11 @@ void AudioEngine::play()
 void AudioEngine::pause()
 {
     playing = false;
+
+    // Nothing is faded while stopped; released after the lock
+    std::shared_ptr<const PlaybackRegion> previousFade;
+    const juce::SpinLock::ScopedLockType lock(waveformLock);
+    previousFade = std::exchange(fadeTail, nullptr);
 }
 
 void AudioEngine::stop()
@@ -239,7 +411,9 @@ void AudioEngine::stop()
 
     playing = false;
 
+    std::shared_ptr<const PlaybackRegion> previousFade;
     const juce::SpinLock::ScopedLockType lock(waveformLock);
+    previousFade = std::exchange(fadeTail, nullptr);
     currentPosition.store(0);
     interpolator.reset();
     fractionalPosition = 0.0;
@@ -249,7 +423,7 @@ void AudioEngine::seek(double timeSeconds)
 {
     const juce::SpinLock::ScopedLockType lock(waveformLock);
     int64_t newPos = static_cast<int64_t>(timeSeconds * waveformSampleRate);
-    newPos = juce::jlimit<int64_t>(0, currentWaveform.getNumSamples(), newPos);
+    newPos = juce::jlimit<int64_t>(0, getWaveformLength(), newPos);
     currentPosition.store(newPos);
     interpolator.reset();
     fractionalPosition = 0.0;
@@ -262,9 +436,10 @@ double AudioEngine::getPosition() const
 
 double AudioEngine::getDuration() const
 {
-    if (currentWaveform.getNumSamples() == 0)
+    const int64_t length = getWaveformLength();
+    if (length == 0)
         return 0.0;
-    return static_cast<double>(currentWaveform.getNumSamples()) / waveformSampleRate;
+    return static_cast<double>(length) / waveformSampleRate;
 }
 
 void AudioEngine::setVolumeDb(float dB)
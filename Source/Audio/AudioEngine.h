@@ -3,6 +3,8 @@
 #include "../JuceHeader.h"
 #include "../Models/Project.h"
 #include <functional>
+#include <memory>
+#include <vector>
 
 /**
  * Audio engine for playback and synthesis.
@@ -24,7 +26,29 @@ public:
     
     // Playback control
     void setProject(Project* proj) { project = proj; }
+    /**
+     * Plays a copy of the first channel of buffer. The engine keeps its own
+     * copy (spilled to a scratch file when large, like the project's), so
+     * edits to the project's waveform never have to detach from it; they
+     * reach playback through replaceRegion().
+     */
     void loadWaveform(const juce::AudioBuffer<float>& buffer, int sampleRate, bool preservePosition = false);
+
+    /**
+     * Overwrites numSamples samples of the loaded waveform from startSample
+     * without stopping: playback fades from the old samples to the new ones
+     * over fadeSeconds, so replacing a region that is being heard does not
+     * click. Only the region is copied.
+     */
+    void replaceRegion(int64_t startSample, const float* samples, int numSamples, double fadeSeconds);
+
+    /**
+     * Plays samples from startSample in place of the loaded waveform's,
+     * without changing it, until the next replaceRegion(), clearPreview()
+     * or loadWaveform(). Fades in and out like replaceRegion().
+     */
+    void setPreview(int64_t startSample, std::vector<float> samples, double fadeSeconds);
+    void clearPreview(double fadeSeconds);
     
     void play();
     void pause();
@@ -56,9 +80,41 @@ private:
     juce::AudioDeviceManager deviceManager;
     juce::AudioSourcePlayer audioSourcePlayer;
     
+    /** Samples heard from start instead of the waveform's: a preview, or new samples while they are written. */
+    struct PlaybackRegion
+    {
+        int64_t start = 0;
+        std::vector<float> samples;
+
+        int64_t getEnd() const { return start + static_cast<int64_t>(samples.size()); }
+    };
+
     Project* project = nullptr;
-    juce::AudioBuffer<float> currentWaveform;
+    int64_t getWaveformLength() const { return currentWaveform != nullptr ? currentWaveform->getNumSamples() : 0; }
+
+    /** What is heard for count samples from start, read on the message thread. */
+    std::shared_ptr<const PlaybackRegion> captureOutput(int64_t start, int64_t count) const;
+
+    /** Makes region (or nothing) the overlay, fading from what was heard over fadeSeconds. */
+    void switchOverlay(std::shared_ptr<const PlaybackRegion> region, double fadeSeconds);
+
+    void releaseRetiredRegion();
+
+    // The engine's own mono copy. The message thread writes into it only
+    // where the overlay covers, which the audio thread reads instead.
+    std::shared_ptr<juce::AudioBuffer<float>> currentWaveform;
+    std::shared_ptr<const PlaybackRegion> overlay;
     int waveformSampleRate = 44100;
+
+    // Crossfade from what was heard before the last switch, in waveform samples
+    std::shared_ptr<const PlaybackRegion> fadeTail;
+    int64_t fadeStart = 0;
+    int64_t fadeLength = 0;
+    std::vector<float> mixScratch;  // Input for one block when it is not read straight from the waveform
+
+    // A finished fade's tail, handed from the audio thread to the message
+    // thread so that the audio thread never frees it
+    std::shared_ptr<const PlaybackRegion> retiredRegion;
     
     std::atomic<int64_t> currentPosition { 0 };  // Position in waveform samples
     std::atomic<bool> playing { false };
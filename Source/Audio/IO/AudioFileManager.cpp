@@ -1,5 +1,8 @@
 #include "AudioFileManager.h"
 #include "../../Utils/Localization.h"
+#include "../../Models/ScratchStorage.h"
+#include <algorithm>
+#include <vector>
 
 AudioFileManager::AudioFileManager() = default;
 
@@ -77,60 +80,112 @@ void AudioFileManager::loadAudioFileAsync(const juce::File& file,
         if (onProgress)
             onProgress(0.05, TR("progress.loading_audio"));
 
-        juce::AudioFormatManager formatManager;
-        formatManager.registerBasicFormats();
+        std::shared_ptr<juce::AudioBuffer<float>> buffer;
+        const bool ok = decodeStreaming(file, SAMPLE_RATE, buffer,
+            [&onProgress](int, double fraction) {
+                if (onProgress)
+                    onProgress(0.05 + 0.17 * fraction, TR("progress.reading_audio"));
+            },
+            cancelFlag);
 
-        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
-        if (reader == nullptr || cancelFlag.load()) {
+        if (!ok) {
             isLoadingAudio = false;
             return;
         }
 
-        const int numSamples = static_cast<int>(reader->lengthInSamples);
-        const int srcSampleRate = static_cast<int>(reader->sampleRate);
-
         if (onProgress)
-            onProgress(0.10, TR("progress.reading_audio"));
+            onProgress(0.22, TR("progress.audio_loaded"));
 
-        // Read audio data
-        juce::AudioBuffer<float> buffer;
-        if (reader->numChannels == 1) {
-            buffer.setSize(1, numSamples);
-            reader->read(&buffer, 0, numSamples, 0, true, false);
-        } else {
-            juce::AudioBuffer<float> stereoBuffer(2, numSamples);
-            reader->read(&stereoBuffer, 0, numSamples, 0, true, true);
-            buffer = convertToMono(stereoBuffer);
-        }
+        isLoadingAudio = false;
 
-        if (cancelFlag.load()) {
-            isLoadingAudio = false;
-            return;
-        }
+        // Call completion on message thread
+        juce::MessageManager::callAsync([onComplete, buffer = std::move(buffer), file]() {
+            if (onComplete)
+                onComplete(buffer, SAMPLE_RATE, file);
+        });
+    });
+}
+
+bool AudioFileManager::decodeStreaming(const juce::File& file, int targetSampleRate,
+                                       std::shared_ptr<juce::AudioBuffer<float>>& output,
+                                       const ChunkCallback& onChunk,
+                                       const std::atomic<bool>& cancel) {
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    if (reader == nullptr || cancel.load())
+        return false;
+
+    const int numSamples = static_cast<int>(reader->lengthInSamples);
+    const int srcSampleRate = static_cast<int>(reader->sampleRate);
+    const bool isStereo = reader->numChannels > 1;
+
+    // Output position i reads source position i * ratio (linear interpolation)
+    const double ratio = static_cast<double>(srcSampleRate) / targetSampleRate;
+    const int outSamples = srcSampleRate == targetSampleRate
+        ? numSamples
+        : static_cast<int>(numSamples / ratio);
+
+    output = ScratchStorage::makeAudioBuffer(1, outSamples);
+    float* dst = output->getWritePointer(0);
+
+    constexpr int chunkSize = 1 << 16;
+    juce::AudioBuffer<float> chunk(isStereo ? 2 : 1, chunkSize);
+    std::vector<float> mono(static_cast<size_t>(chunkSize));
+
+    int outIndex = 0;
+    float previousSample = 0.0f;  // last source sample of the previous chunk
+
+    for (int chunkStart = 0; chunkStart < numSamples; chunkStart += chunkSize) {
+        if (cancel.load())
+            return false;
+
+        const int count = std::min(chunkSize, numSamples - chunkStart);
+        reader->read(&chunk, 0, count, chunkStart, true, isStereo);
 
-        // Resample if needed
-        if (srcSampleRate != SAMPLE_RATE) {
-            if (onProgress)
-                onProgress(0.18, TR("progress.resampling"));
-            buffer = resampleIfNeeded(buffer, srcSampleRate, SAMPLE_RATE);
+        const float* left = chunk.getReadPointer(0);
+        if (isStereo) {
+            const float* right = chunk.getReadPointer(1);
+            for (int i = 0; i < count; ++i)
+                mono[static_cast<size_t>(i)] = (left[i] + right[i]) * 0.5f;
+        } else {
+            std::copy(left, left + count, mono.begin());
         }
 
-        if (cancelFlag.load()) {
-            isLoadingAudio = false;
-            return;
+        const int chunkEnd = chunkStart + count;
+        if (srcSampleRate == targetSampleRate) {
+            std::copy(mono.begin(), mono.begin() + count, dst + chunkStart);
+            outIndex = chunkEnd;
+        } else {
+            // Source sample k, where k is in this chunk or the one just before it
+            auto sourceAt = [&](int k) {
+                return k >= chunkStart ? mono[static_cast<size_t>(k - chunkStart)] : previousSample;
+            };
+
+            for (; outIndex < outSamples; ++outIndex) {
+                const double srcPos = outIndex * ratio;
+                const int srcIndex = static_cast<int>(srcPos);
+                const double frac = srcPos - srcIndex;
+
+                if (srcIndex + 1 < numSamples) {
+                    if (srcIndex + 1 >= chunkEnd)
+                        break;  // needs the next chunk
+                    dst[outIndex] = static_cast<float>(sourceAt(srcIndex) * (1.0 - frac)
+                                                       + sourceAt(srcIndex + 1) * frac);
+                } else {
+                    dst[outIndex] = sourceAt(srcIndex);
+                }
+            }
         }
 
-        if (onProgress)
-            onProgress(0.22, TR("progress.audio_loaded"));
+        previousSample = mono[static_cast<size_t>(count - 1)];
 
-        isLoadingAudio = false;
+        if (onChunk)
+            onChunk(outIndex, static_cast<double>(chunkEnd) / numSamples);
+    }
 
-        // Call completion on message thread
-        juce::MessageManager::callAsync([onComplete, buffer = std::move(buffer), file]() mutable {
-            if (onComplete)
-                onComplete(std::move(buffer), SAMPLE_RATE, file);
-        });
-    });
+    return !cancel.load();
 }
 
 void AudioFileManager::exportAudioFileAsync(const juce::File& file,
@@ -180,45 +235,3 @@ juce::File AudioFileManager::getFirstAudioFile(const juce::StringArray& files) {
     }
     return {};
 }
-
-juce::AudioBuffer<float> AudioFileManager::resampleIfNeeded(const juce::AudioBuffer<float>& buffer,
-                                                            int srcSampleRate,
-                                                            int targetSampleRate) {
-    if (srcSampleRate == targetSampleRate)
-        return buffer;
-
-    const double ratio = static_cast<double>(srcSampleRate) / targetSampleRate;
-    const int numSamples = buffer.getNumSamples();
-    const int newNumSamples = static_cast<int>(numSamples / ratio);
-
-    juce::AudioBuffer<float> resampledBuffer(1, newNumSamples);
-    const float* src = buffer.getReadPointer(0);
-    float* dst = resampledBuffer.getWritePointer(0);
-
-    for (int i = 0; i < newNumSamples; ++i) {
-        const double srcPos = i * ratio;
-        const int srcIndex = static_cast<int>(srcPos);
-        const double frac = srcPos - srcIndex;
-
-        if (srcIndex + 1 < numSamples)
-            dst[i] = static_cast<float>(src[srcIndex] * (1.0 - frac) + src[srcIndex + 1] * frac);
-        else
-            dst[i] = src[srcIndex];
-    }
-
-    return resampledBuffer;
-}
-
-juce::AudioBuffer<float> AudioFileManager::convertToMono(const juce::AudioBuffer<float>& stereoBuffer) {
-    const int numSamples = stereoBuffer.getNumSamples();
-    juce::AudioBuffer<float> monoBuffer(1, numSamples);
-
-    const float* left = stereoBuffer.getReadPointer(0);
-    const float* right = stereoBuffer.getReadPointer(1);
-    float* mono = monoBuffer.getWritePointer(0);
-
-    for (int i = 0; i < numSamples; ++i)
-        mono[i] = (left[i] + right[i]) * 0.5f;
-
-    return monoBuffer;
-}
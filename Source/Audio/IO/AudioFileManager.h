@@ -4,6 +4,7 @@
 #include "../../Utils/Constants.h"
 #include <atomic>
 #include <functional>
+#include <memory>
 #include <thread>
 
 /**
@@ -13,7 +14,7 @@
 class AudioFileManager {
 public:
     using ProgressCallback = std::function<void(double progress, const juce::String& message)>;
-    using LoadCompleteCallback = std::function<void(juce::AudioBuffer<float>&& buffer, int sampleRate, const juce::File& file)>;
+    using LoadCompleteCallback = std::function<void(std::shared_ptr<juce::AudioBuffer<float>> buffer, int sampleRate, const juce::File& file)>;
     using ExportCompleteCallback = std::function<void(bool success)>;
 
     AudioFileManager();
@@ -43,15 +44,30 @@ public:
     static bool isInterestedInFileDrag(const juce::StringArray& files);
     static juce::File getFirstAudioFile(const juce::StringArray& files);
 
-private:
-    // Resample audio to target sample rate
-    static juce::AudioBuffer<float> resampleIfNeeded(const juce::AudioBuffer<float>& buffer,
-                                                     int srcSampleRate,
-                                                     int targetSampleRate);
+    /**
+     * Called after each decoded chunk with the number of output samples that
+     * are final and the fraction of the file read so far.
+     */
+    using ChunkCallback = std::function<void(int samplesReady, double fraction)>;
 
-    // Convert stereo to mono
-    static juce::AudioBuffer<float> convertToMono(const juce::AudioBuffer<float>& stereoBuffer);
+    /**
+     * Decode a file to mono at targetSampleRate, one chunk at a time.
+     *
+     * Each chunk is read, downmixed and linearly resampled in a single pass
+     * straight into `output`, which is allocated at its final length (through
+     * ScratchStorage, so long files go to a mapped scratch file) before the
+     * first chunk is decoded; only a chunk-sized buffer is needed on top.
+     * Consumers can read output[0, samplesReady) from another thread while
+     * decoding continues. Stops between chunks once `cancel` is set.
+     *
+     * @return false if the file could not be opened or decoding was cancelled
+     */
+    static bool decodeStreaming(const juce::File& file, int targetSampleRate,
+                                std::shared_ptr<juce::AudioBuffer<float>>& output,
+                                const ChunkCallback& onChunk,
+                                const std::atomic<bool>& cancel);
 
+private:
     std::unique_ptr<juce::FileChooser> fileChooser;
     std::thread loaderThread;
     std::atomic<bool> isLoadingAudio{false};
@@ -1,6 +1,7 @@
 #include "PitchDetector.h"
 #include <cmath>
 #include <algorithm>
+#include <thread>
 
 PitchDetector::PitchDetector(int sampleRate, int hopSize)
     : sampleRate(sampleRate), hopSize(hopSize)
@@ -8,7 +9,23 @@ PitchDetector::PitchDetector(int sampleRate, int hopSize)
     windowSize = std::max(2048, static_cast<int>(sampleRate / f0Min) * 2);
 }
 
-std::pair<std::vector<float>, std::vector<bool>> 
+PitchDetector::YinWorkspace::YinWorkspace(int maxBufferSize)
+{
+    // Correlation lags stay below bufferSize, so a transform of at least
+    // bufferSize points avoids circular wrap-around.
+    int order = 1;
+    while ((1 << order) < maxBufferSize)
+        ++order;
+
+    fftSize = 1 << order;
+    fft = std::make_unique<juce::dsp::FFT>(order);
+    headSpectrum.resize(static_cast<size_t>(fftSize) * 2);
+    frameSpectrum.resize(static_cast<size_t>(fftSize) * 2);
+    d.resize(static_cast<size_t>(maxBufferSize / 2));
+    dPrime.resize(static_cast<size_t>(maxBufferSize / 2));
+}
+
+std::pair<std::vector<float>, std::vector<uint8_t>> 
 PitchDetector::extractF0(const float* audio, int numSamples)
 {
     int numFrames = (numSamples - windowSize) / hopSize + 1;
@@ -19,65 +36,126 @@ PitchDetector::extractF0(const float* audio, int numSamples)
     }
     
     std::vector<float> f0Values(numFrames, 0.0f);
-    std::vector<bool> voicedMask(numFrames, false);
+    std::vector<uint8_t> voiced(numFrames, 0);
     
-    for (int i = 0; i < numFrames; ++i)
+    auto processFrames = [&](int firstFrame, int lastFrame)
     {
-        int startSample = i * hopSize;
-        int availableSamples = numSamples - startSample;
-        int frameSamples = std::min(windowSize, availableSamples);
-        
-        if (frameSamples < 512)  // Too short for pitch detection
+        YinWorkspace ws(windowSize);
+
+        for (int i = firstFrame; i < lastFrame; ++i)
         {
-            f0Values[i] = 0.0f;
-            voicedMask[i] = false;
-            continue;
+            int startSample = i * hopSize;
+            int availableSamples = numSamples - startSample;
+            int frameSamples = std::min(windowSize, availableSamples);
+
+            if (frameSamples < 512)  // Too short for pitch detection
+                continue;
+
+            float pitch = yinPitchDetect(audio + startSample, frameSamples, ws);
+
+            if (pitch > 0.0f && pitch >= f0Min && pitch <= f0Max)
+            {
+                f0Values[i] = pitch;
+                voiced[i] = 1;
+            }
         }
-        
-        float pitch = yinPitchDetect(audio + startSample, frameSamples);
-        
-        if (pitch > 0.0f && pitch >= f0Min && pitch <= f0Max)
+    };
+
+    int numThreads = static_cast<int>(std::thread::hardware_concurrency());
+    numThreads = std::clamp(numFrames / MIN_FRAMES_PER_THREAD, 1, std::max(1, numThreads));
+
+    if (numThreads == 1)
+    {
+        processFrames(0, numFrames);
+    }
+    else
+    {
+        // Frames are independent; each thread writes a disjoint slice
+        std::vector<std::thread> workers;
+        workers.reserve(static_cast<size_t>(numThreads));
+        int framesPerThread = (numFrames + numThreads - 1) / numThreads;
+        for (int t = 0; t < numThreads; ++t)
         {
-            f0Values[i] = pitch;
-            voicedMask[i] = true;
+            int first = t * framesPerThread;
+            int last = std::min(numFrames, first + framesPerThread);
+            if (first < last)
+                workers.emplace_back(processFrames, first, last);
         }
-        else
+        for (auto& w : workers)
+            w.join();
+    }
+
+    return { std::move(f0Values), std::move(voiced) };
+}
+
+void PitchDetector::differenceFunction(const float* buffer, int bufferSize, YinWorkspace& ws)
+{
+    // d(tau) = sum_{j<W} (x[j] - x[j+tau])^2
+    //        = sum_{j<W} x[j]^2 + sum_{j<W} x[j+tau]^2 - 2 r(tau)
+    // with r(tau) the cross-correlation of the first W samples with the frame.
+    const int halfSize = bufferSize / 2;
+    const size_t n = static_cast<size_t>(ws.fftSize);
+
+    std::fill(ws.headSpectrum.begin(), ws.headSpectrum.end(), 0.0f);
+    std::fill(ws.frameSpectrum.begin(), ws.frameSpectrum.end(), 0.0f);
+    std::copy(buffer, buffer + halfSize, ws.headSpectrum.begin());
+    std::copy(buffer, buffer + bufferSize, ws.frameSpectrum.begin());
+
+    ws.fft->performRealOnlyForwardTransform(ws.headSpectrum.data(), true);
+    ws.fft->performRealOnlyForwardTransform(ws.frameSpectrum.data(), true);
+
+    // conj(Head) * Frame gives the correlation spectrum
+    for (size_t k = 0; k <= n / 2; ++k)
+    {
+        float ar = ws.headSpectrum[k * 2];
+        float ai = ws.headSpectrum[k * 2 + 1];
+        float br = ws.frameSpectrum[k * 2];
+        float bi = ws.frameSpectrum[k * 2 + 1];
+        ws.frameSpectrum[k * 2] = ar * br + ai * bi;
+        ws.frameSpectrum[k * 2 + 1] = ar * bi - ai * br;
+    }
+
+    ws.fft->performRealOnlyInverseTransform(ws.frameSpectrum.data());
+    const float* r = ws.frameSpectrum.data();
+
+    // Energies accumulated in double; the sliding window is updated per lag
+    double headEnergy = 0.0;
+    for (int j = 0; j < halfSize; ++j)
+        headEnergy += static_cast<double>(buffer[j]) * buffer[j];
+
+    double lagEnergy = headEnergy;
+    for (int tau = 0; tau < halfSize; ++tau)
+    {
+        if (tau > 0)
         {
-            f0Values[i] = 0.0f;
-            voicedMask[i] = false;
+            double in = buffer[tau + halfSize - 1];
+            double out = buffer[tau - 1];
+            lagEnergy += in * in - out * out;
         }
+        double value = headEnergy + lagEnergy - 2.0 * r[tau];
+        ws.d[static_cast<size_t>(tau)] = static_cast<float>(std::max(0.0, value));
     }
-    
-    return { f0Values, voicedMask };
+    ws.d[0] = 0.0f;
 }
 
-float PitchDetector::yinPitchDetect(const float* buffer, int bufferSize)
+float PitchDetector::yinPitchDetect(const float* buffer, int bufferSize, YinWorkspace& ws) const
 {
     int halfSize = bufferSize / 2;
     if (halfSize < 2) return -1.0f;
     
-    std::vector<float> d(halfSize);
-    
     // Step 2: Difference function
-    for (int tau = 0; tau < halfSize; ++tau)
-    {
-        d[tau] = 0.0f;
-        for (int j = 0; j < halfSize; ++j)
-        {
-            float diff = buffer[j] - buffer[j + tau];
-            d[tau] += diff * diff;
-        }
-    }
+    differenceFunction(buffer, bufferSize, ws);
+    const auto& d = ws.d;
     
     // Step 3: Cumulative mean normalized difference function
-    std::vector<float> dPrime(halfSize);
+    auto& dPrime = ws.dPrime;
     dPrime[0] = 1.0f;
     float runningSum = 0.0f;
     
     for (int tau = 1; tau < halfSize; ++tau)
     {
         runningSum += d[tau];
-        dPrime[tau] = d[tau] * tau / runningSum;
+        dPrime[tau] = runningSum > 0.0f ? d[tau] * tau / runningSum : 1.0f;
     }
     
     // Step 4: Absolute threshold
@@ -100,7 +178,7 @@ float PitchDetector::yinPitchDetect(const float* buffer, int bufferSize)
         return -1.0f;  // No pitch found
     
     // Step 5: Parabolic interpolation
-    float betterTau = parabolicInterpolation(dPrime, tau);
+    float betterTau = parabolicInterpolation(dPrime, tau, halfSize);
     
     if (betterTau > 0.0f)
         return static_cast<float>(sampleRate) / betterTau;
@@ -108,9 +186,9 @@ float PitchDetector::yinPitchDetect(const float* buffer, int bufferSize)
     return -1.0f;
 }
 
-float PitchDetector::parabolicInterpolation(const std::vector<float>& d, int tau)
+float PitchDetector::parabolicInterpolation(const std::vector<float>& d, int tau, int size)
 {
-    if (tau < 1 || tau >= static_cast<int>(d.size()) - 1)
+    if (tau < 1 || tau >= size - 1)
         return static_cast<float>(tau);
     
     float s0 = d[tau - 1];
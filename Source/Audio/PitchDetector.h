@@ -2,10 +2,15 @@
 
 #include "../JuceHeader.h"
 #include <vector>
+#include <memory>
 
 /**
  * Pitch detector using YIN algorithm.
  * (For production, you'd want to integrate a proper pitch detection library)
+ *
+ * The difference function is computed through FFT autocorrelation, and
+ * frames are split across worker threads that each own an FFT plan and
+ * scratch buffers.
  */
 class PitchDetector
 {
@@ -19,7 +24,7 @@ public:
      * @param numSamples Number of samples
      * @return Pair of (f0 values, voiced mask)
      */
-    std::pair<std::vector<float>, std::vector<bool>> 
+    std::pair<std::vector<float>, std::vector<uint8_t>> 
     extractF0(const float* audio, int numSamples);
     
     void setSampleRate(int sr) { sampleRate = sr; }
@@ -27,8 +32,25 @@ public:
     void setF0Range(float min, float max) { f0Min = min; f0Max = max; }
     
 private:
-    float yinPitchDetect(const float* buffer, int bufferSize);
-    float parabolicInterpolation(const std::vector<float>& d, int tau);
+    // Per-thread FFT plan and scratch buffers, reused across frames
+    struct YinWorkspace
+    {
+        explicit YinWorkspace(int maxBufferSize);
+
+        int fftSize = 0;
+        std::unique_ptr<juce::dsp::FFT> fft;
+        std::vector<float> headSpectrum;   // FFT of the first half of the frame
+        std::vector<float> frameSpectrum;  // FFT of the whole frame, then correlation
+        std::vector<float> d;
+        std::vector<float> dPrime;
+    };
+
+    // Frames below this count are not worth spreading across threads
+    static constexpr int MIN_FRAMES_PER_THREAD = 64;
+
+    float yinPitchDetect(const float* buffer, int bufferSize, YinWorkspace& ws) const;
+    static void differenceFunction(const float* buffer, int bufferSize, YinWorkspace& ws);
+    static float parabolicInterpolation(const std::vector<float>& d, int tau, int size);
     
     int sampleRate;
     int hopSize;
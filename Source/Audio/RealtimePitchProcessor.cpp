@@ -96,7 +96,7 @@ void RealtimePitchProcessor::invalidate() {
     }
 
     auto& audioData = project->getAudioData();
-    if (audioData.waveform.getNumSamples() == 0) {
+    if (audioData.waveform->getNumSamples() == 0) {
         DBG("  -> Skipped: waveform is empty");
         return;
     }
@@ -111,20 +111,20 @@ void RealtimePitchProcessor::invalidate() {
     if (srcSampleRate == dstSampleRate || srcSampleRate <= 0) {
         // No resampling needed
         const juce::ScopedLock sl(bufferLock);
-        processedBuffer.makeCopyOf(audioData.waveform);
+        processedBuffer.makeCopyOf(*audioData.waveform);
         ready = true;
         DBG("  -> Using project waveform directly, samples=" << processedBuffer.getNumSamples());
     } else {
         // Resample to host sample rate
         const double ratio = static_cast<double>(srcSampleRate) / dstSampleRate;
-        const int srcSamples = audioData.waveform.getNumSamples();
+        const int srcSamples = audioData.waveform->getNumSamples();
         const int dstSamples = static_cast<int>(srcSamples / ratio);
-        const int numChannels = audioData.waveform.getNumChannels();
+        const int numChannels = audioData.waveform->getNumChannels();
 
         juce::AudioBuffer<float> resampled(numChannels, dstSamples);
 
         for (int ch = 0; ch < numChannels; ++ch) {
-            const float* src = audioData.waveform.getReadPointer(ch);
+            const float* src = audioData.waveform->getReadPointer(ch);
             float* dst = resampled.getWritePointer(ch);
 
             for (int i = 0; i < dstSamples; ++i) {
@@ -221,7 +221,7 @@ void RealtimePitchProcessor::computeInBackground() {
     }
 
     // Create output buffer
-    int numChannels = audioData.waveform.getNumChannels();
+    int numChannels = audioData.waveform->getNumChannels();
     int numSamples = static_cast<int>(synthesized.size());
 
     juce::AudioBuffer<float> output(numChannels, numSamples);
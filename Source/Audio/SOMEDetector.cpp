@@ -4,6 +4,10 @@
 #include <algorithm>
 #include <numeric>
 #include <iostream>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <juce_core/juce_core.h>
 
 SOMEDetector::SOMEDetector() = default;
@@ -120,10 +124,10 @@ std::vector<float> SOMEDetector::resampleTo44k(const float* audio, int numSample
 }
 
 // RMS calculation for slicer
-std::vector<double> SOMEDetector::getRms(const std::vector<float>& samples, int frameLength, int hopLength)
+std::vector<double> SOMEDetector::getRms(const float* samples, size_t numSamples, int frameLength, int hopLength)
 {
     std::vector<double> output;
-    size_t outputSize = samples.size() / hopLength;
+    size_t outputSize = numSamples / hopLength;
     output.reserve(outputSize);
 
     for (size_t i = 0; i < outputSize; ++i)
@@ -131,7 +135,7 @@ std::vector<double> SOMEDetector::getRms(const std::vector<float>& samples, int
         size_t halfFrame = static_cast<size_t>(frameLength / 2);
         size_t center = i * hopLength;
         size_t start = (center < halfFrame) ? 0 : (center - halfFrame);
-        size_t end = std::min(samples.size(), center + halfFrame);
+        size_t end = std::min(numSamples, center + halfFrame);
 
         double sum = 0.0;
         for (size_t j = start; j < end; ++j)
@@ -142,7 +146,7 @@ std::vector<double> SOMEDetector::getRms(const std::vector<float>& samples, int
 }
 
 // Audio slicer based on silence detection
-SOMEDetector::MarkerList SOMEDetector::sliceAudio(const std::vector<float>& samples) const
+SOMEDetector::MarkerList SOMEDetector::sliceAudio(const float* samples, size_t numSamples) const
 {
     constexpr float threshold = 0.02f;
     constexpr int hopSize = 441;
@@ -152,10 +156,10 @@ SOMEDetector::MarkerList SOMEDetector::sliceAudio(const std::vector<float>& samp
     constexpr int maxSilKept = 50;
 
     size_t minFrames = static_cast<size_t>(minLength);
-    if ((samples.size() + hopSize - 1) / hopSize <= minFrames)
-        return {{0, static_cast<int64_t>(samples.size())}};
+    if ((numSamples + hopSize - 1) / hopSize <= minFrames)
+        return {{0, static_cast<int64_t>(numSamples)}};
 
-    auto rmsList = getRms(samples, winSize, hopSize);
+    auto rmsList = getRms(samples, numSamples, winSize, hopSize);
     MarkerList silTags;
     int64_t silenceStart = -1;
     int64_t clipStart = 0;
@@ -212,7 +216,7 @@ SOMEDetector::MarkerList SOMEDetector::sliceAudio(const std::vector<float>& samp
     }
 
     if (silTags.empty())
-        return {{0, static_cast<int64_t>(samples.size())}};
+        return {{0, static_cast<int64_t>(numSamples)}};
 
     MarkerList chunks;
     if (silTags[0].first > 0)
@@ -227,7 +231,7 @@ SOMEDetector::MarkerList SOMEDetector::sliceAudio(const std::vector<float>& samp
     return chunks;
 }
 
-bool SOMEDetector::inferChunk(const std::vector<float>& chunk, std::vector<float>& midi,
+bool SOMEDetector::inferChunk(const float* chunk, size_t chunkSize, std::vector<float>& midi,
                                std::vector<bool>& rest, std::vector<float>& dur)
 {
 #ifdef HAVE_ONNXRUNTIME
@@ -236,12 +240,12 @@ bool SOMEDetector::inferChunk(const std::vector<float>& chunk, std::vector<float
 
     try
     {
-        std::vector<int64_t> shape = {1, static_cast<int64_t>(chunk.size())};
+        std::vector<int64_t> shape = {1, static_cast<int64_t>(chunkSize)};
         Ort::MemoryInfo memInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
 
-        std::vector<float> chunkCopy = chunk;
+        // ONNX Runtime never writes to input tensors, so wrap the waveform directly
         Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
-            memInfo, chunkCopy.data(), chunkCopy.size(), shape.data(), shape.size());
+            memInfo, const_cast<float*>(chunk), chunkSize, shape.data(), shape.size());
 
         std::vector<Ort::Value> inputTensors;
         inputTensors.push_back(std::move(inputTensor));
@@ -271,6 +275,164 @@ bool SOMEDetector::inferChunk(const std::vector<float>& chunk, std::vector<float
 #endif
 }
 
+void SOMEDetector::inferChunksParallel(const float* waveform, int64_t totalSize, const MarkerList& chunks,
+                                       const std::function<bool(size_t, ChunkResult&)>& onChunk)
+{
+    const size_t numChunks = chunks.size();
+    if (numChunks == 0)
+        return;
+
+    // Session::Run is safe to call concurrently; each call already uses
+    // several intra-op threads, so only a few chunks run side by side.
+#ifdef USE_DIRECTML
+    int numWorkers = 1;  // DirectML does not support concurrent Run on one session
+#else
+    int hwThreads = static_cast<int>(std::thread::hardware_concurrency());
+    int numWorkers = juce::jlimit(1, MAX_PARALLEL_CHUNKS, hwThreads / 4);
+#endif
+    numWorkers = std::min(numWorkers, static_cast<int>(numChunks));
+
+    std::vector<ChunkResult> results(numChunks);
+    std::vector<char> ready(numChunks, 0);
+    std::mutex readyMutex;
+    std::condition_variable readyCondition;
+    std::atomic<size_t> nextChunk{0};
+    std::atomic<bool> stopRequested{false};
+
+    auto worker = [&]() {
+        while (!stopRequested.load())
+        {
+            size_t index = nextChunk.fetch_add(1);
+            if (index >= numChunks)
+                break;
+
+            ChunkResult result;
+            const auto [beginSample, endSample] = chunks[index];
+            if (endSample > beginSample && beginSample < totalSize)
+            {
+                int64_t actualEnd = std::min(endSample, totalSize);
+                result.valid = true;
+                result.ok = inferChunk(waveform + beginSample, static_cast<size_t>(actualEnd - beginSample),
+                                       result.midi, result.rest, result.dur);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(readyMutex);
+                results[index] = std::move(result);
+                ready[index] = 1;
+            }
+            readyCondition.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(static_cast<size_t>(numWorkers));
+    for (int i = 0; i < numWorkers; ++i)
+        workers.emplace_back(worker);
+
+    // Deliver results strictly in order so notes are reassembled correctly
+    for (size_t i = 0; i < numChunks; ++i)
+    {
+        {
+            std::unique_lock<std::mutex> lock(readyMutex);
+            readyCondition.wait(lock, [&]() { return ready[i] != 0; });
+        }
+
+        if (!onChunk(i, results[i]))
+        {
+            stopRequested = true;
+            break;
+        }
+        results[i] = {};
+    }
+
+    for (auto& t : workers)
+        t.join();
+}
+
+int SOMEDetector::buildChunkNotes(const ChunkResult& result, int startFrame,
+                                  std::vector<NoteEvent>& notes)
+{
+    const auto& noteMidi = result.midi;
+    const auto& noteRest = result.rest;
+    const auto& noteDur = result.dur;
+
+    // DIRECT COPY from ds-editor-lite Some.cpp, adapted for frames instead of ticks
+    // Step 1: Calculate cumulative sum (exactly like cumulativeSum in ds-editor-lite)
+    std::vector<double> cumsum(noteDur.size());
+    if (!noteDur.empty())
+    {
+        cumsum[0] = static_cast<double>(noteDur[0]);
+        for (size_t i = 1; i < noteDur.size(); ++i)
+        {
+            cumsum[i] = noteDur[i] + cumsum[i - 1];
+        }
+    }
+
+    // Step 2: Convert cumulative durations to frames (like calculateNoteTicks in ds-editor-lite)
+    // noteDur is in seconds, convert to frames: seconds * SAMPLE_RATE / HOP_SIZE
+    std::vector<int> scaled_frames(cumsum.size());
+    for (size_t i = 0; i < cumsum.size(); ++i)
+    {
+        scaled_frames[i] = static_cast<int>(std::round(cumsum[i] * SAMPLE_RATE / HOP_SIZE));
+    }
+
+    // Step 3: Calculate each note's duration as difference (like note_ticks in ds-editor-lite)
+    std::vector<int> note_frames(scaled_frames.size());
+    if (!scaled_frames.empty())
+    {
+        note_frames[0] = scaled_frames[0];
+        for (size_t i = 1; i < scaled_frames.size(); ++i)
+        {
+            note_frames[i] = scaled_frames[i] - scaled_frames[i - 1];
+        }
+    }
+
+    // Step 4: Build notes (exactly like build_midi_note in ds-editor-lite)
+    int start_frame_temp = startFrame;
+    int notesCreated = 0;
+    int restSkipped = 0;
+    for (size_t i = 0; i < noteMidi.size(); ++i)
+    {
+        // CRITICAL: Check bounds for note_frames array
+        if (i >= note_frames.size())
+        {
+            DBG("SOME: note_frames index " << i << " out of bounds (size=" << note_frames.size() << ")");
+            std::cout << "[SOME] ERROR: note_frames index " << i << " out of bounds" << std::endl;
+            break;
+        }
+
+        int noteDurationFrames = note_frames[i];
+        if (noteDurationFrames < 1) noteDurationFrames = 1;
+
+        if (noteRest[i])
+        {
+            // Rest note: skip but advance position (creates gap between notes)
+            restSkipped++;
+            start_frame_temp += noteDurationFrames;
+            continue;
+        }
+
+        // Regular note: create event
+        NoteEvent event;
+        event.startFrame = start_frame_temp;
+        event.endFrame = start_frame_temp + noteDurationFrames;
+        event.midiNote = noteMidi[i];
+        event.isRest = false;
+        notes.push_back(event);
+        notesCreated++;
+
+        // Advance position for next note (or rest)
+        start_frame_temp += noteDurationFrames;
+    }
+
+    DBG("SOME chunk built: " << notesCreated << " notes created, " << restSkipped << " rest skipped");
+    std::cout << "[SOME] Chunk built: " << notesCreated << " notes, " << restSkipped << " rest, start="
+              << startFrame << ", end=" << start_frame_temp << std::endl;
+
+    return start_frame_temp;
+}
+
 std::vector<SOMEDetector::NoteEvent> SOMEDetector::detectNotes(
     const float* audio, int numSamples, int sampleRate)
 {
@@ -290,12 +452,20 @@ std::vector<SOMEDetector::NoteEvent> SOMEDetector::detectNotesWithProgress(
 
     if (progressCallback) progressCallback(0.05);
 
-    std::vector<float> waveform = resampleTo44k(audio, numSamples, sampleRate);
-    int64_t totalSize = static_cast<int64_t>(waveform.size());
+    // Only resample when needed; otherwise chunks are views into the caller's audio
+    std::vector<float> resampled;
+    const float* waveform = audio;
+    int64_t totalSize = numSamples;
+    if (sampleRate != SAMPLE_RATE)
+    {
+        resampled = resampleTo44k(audio, numSamples, sampleRate);
+        waveform = resampled.data();
+        totalSize = static_cast<int64_t>(resampled.size());
+    }
 
     if (progressCallback) progressCallback(0.1);
 
-    MarkerList chunks = sliceAudio(waveform);
+    MarkerList chunks = sliceAudio(waveform, static_cast<size_t>(totalSize));
     DBG("SOME: sliced into " << chunks.size() << " chunks");
 
     if (chunks.empty())
@@ -308,121 +478,43 @@ std::vector<SOMEDetector::NoteEvent> SOMEDetector::detectNotesWithProgress(
 
     std::vector<NoteEvent> allNotes;
     int64_t processedFrames = 0;
+    bool failed = false;
 
-    // Process chunks sequentially (like dataset-tools)
-    for (const auto& [beginFrame, endFrame] : chunks)
-    {
-        if (endFrame <= beginFrame || beginFrame >= totalSize)
-            continue;
+    inferChunksParallel(waveform, totalSize, chunks, [&](size_t index, ChunkResult& result) {
+        if (!result.valid)
+            return true;
 
-        int64_t actualEnd = std::min(endFrame, totalSize);
-        std::vector<float> chunkData(waveform.begin() + beginFrame, waveform.begin() + actualEnd);
-
-        std::vector<float> noteMidi;
-        std::vector<bool> noteRest;
-        std::vector<float> noteDur;
-
-        if (!inferChunk(chunkData, noteMidi, noteRest, noteDur))
+        if (!result.ok)
         {
-            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
-                TR("error.some_error"), TR("error.inference_failed"));
-            return {};
+            failed = true;
+            return false;
         }
 
-        if (noteMidi.empty())
-            continue;
-        
-        // Debug: log SOME output for diagnosis
-        int restCount = static_cast<int>(std::count(noteRest.begin(), noteRest.end(), true));
-        DBG("SOME chunk: " << noteMidi.size() << " notes, rest count: " << restCount);
-        std::cout << "[SOME] Chunk: " << noteMidi.size() << " notes, " << restCount << " rest notes" << std::endl;
-
-        // Calculate start frame for this chunk
-        // DIRECT COPY from ds-editor-lite: use max of chunk start position and last note end position
-        const auto start_frame = (std::max)(static_cast<int>(beginFrame / HOP_SIZE),
-                                             !allNotes.empty() ? allNotes.back().endFrame : 0);
-        int chunkStartFrame = start_frame;
-
-        // Build notes from this chunk
-        // DIRECT COPY from ds-editor-lite Some.cpp, adapted for frames instead of ticks
-        // Step 1: Calculate cumulative sum (exactly like cumulativeSum in ds-editor-lite)
-        std::vector<double> cumsum(noteDur.size());
-        if (!noteDur.empty())
-        {
-            cumsum[0] = static_cast<double>(noteDur[0]);
-            for (size_t i = 1; i < noteDur.size(); ++i)
-            {
-                cumsum[i] = noteDur[i] + cumsum[i - 1];
-            }
-        }
+        const auto [beginFrame, endFrame] = chunks[index];
+        int64_t actualEnd = std::min(endFrame, totalSize);
 
-        // Step 2: Convert cumulative durations to frames (like calculateNoteTicks in ds-editor-lite)
-        // noteDur is in seconds, convert to frames: seconds * SAMPLE_RATE / HOP_SIZE
-        std::vector<int> scaled_frames(cumsum.size());
-        for (size_t i = 0; i < cumsum.size(); ++i)
+        if (!result.midi.empty())
         {
-            scaled_frames[i] = static_cast<int>(std::round(cumsum[i] * SAMPLE_RATE / HOP_SIZE));
-        }
+            int restCount = static_cast<int>(std::count(result.rest.begin(), result.rest.end(), true));
+            DBG("SOME chunk: " << result.midi.size() << " notes, rest count: " << restCount);
 
-        // Step 3: Calculate each note's duration as difference (like note_ticks in ds-editor-lite)
-        std::vector<int> note_frames(scaled_frames.size());
-        if (!scaled_frames.empty())
-        {
-            note_frames[0] = scaled_frames[0];
-            for (size_t i = 1; i < scaled_frames.size(); ++i)
-            {
-                note_frames[i] = scaled_frames[i] - scaled_frames[i - 1];
-            }
+            // DIRECT COPY from ds-editor-lite: use max of chunk start position and last note end position
+            const auto start_frame = (std::max)(static_cast<int>(beginFrame / HOP_SIZE),
+                                                 !allNotes.empty() ? allNotes.back().endFrame : 0);
+            buildChunkNotes(result, start_frame, allNotes);
         }
 
-        // Step 4: Build notes (exactly like build_midi_note in ds-editor-lite)
-        int start_frame_temp = chunkStartFrame;
-        int notesCreated = 0;
-        int restSkipped = 0;
-        for (size_t i = 0; i < noteMidi.size(); ++i)
-        {
-            // CRITICAL: Check bounds for note_frames array
-            if (i >= note_frames.size())
-            {
-                DBG("SOME: note_frames index " << i << " out of bounds (size=" << note_frames.size() << ")");
-                std::cout << "[SOME] ERROR: note_frames index " << i << " out of bounds" << std::endl;
-                break;
-            }
-            
-            int noteDurationFrames = note_frames[i];
-            if (noteDurationFrames < 1) noteDurationFrames = 1;
-            
-            if (noteRest[i])
-            {
-                // Rest note: skip but advance position (creates gap between notes)
-                restSkipped++;
-                start_frame_temp += noteDurationFrames;
-                continue;
-            }
-            
-            // Regular note: create event
-            NoteEvent event;
-            event.startFrame = start_frame_temp;
-            event.endFrame = start_frame_temp + noteDurationFrames;
-            event.midiNote = noteMidi[i];
-            event.isRest = false;
-            allNotes.push_back(event);
-            notesCreated++;
-
-            // Log SOME output for debugging
-            DBG("SOME note: midi=" << noteMidi[i] << " (raw float from model)");
-            
-            // Advance position for next note (or rest)
-            start_frame_temp += noteDurationFrames;
-        }
-        
-        DBG("SOME chunk built: " << notesCreated << " notes created, " << restSkipped << " rest skipped");
-        std::cout << "[SOME] Chunk built: " << notesCreated << " notes, " << restSkipped << " rest, start=" 
-                  << chunkStartFrame << ", end=" << start_frame_temp << std::endl;
-
         processedFrames += (actualEnd - beginFrame);
         if (progressCallback)
             progressCallback(0.1 + 0.85 * static_cast<double>(processedFrames) / totalFrames);
+        return true;
+    });
+
+    if (failed)
+    {
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+            TR("error.some_error"), TR("error.inference_failed"));
+        return {};
     }
 
     if (progressCallback) progressCallback(1.0);
@@ -451,12 +543,19 @@ void SOMEDetector::detectNotesStreaming(
 
     if (progressCallback) progressCallback(0.05);
 
-    std::vector<float> waveform = resampleTo44k(audio, numSamples, sampleRate);
-    int64_t totalSize = static_cast<int64_t>(waveform.size());
+    std::vector<float> resampled;
+    const float* waveform = audio;
+    int64_t totalSize = numSamples;
+    if (sampleRate != SAMPLE_RATE)
+    {
+        resampled = resampleTo44k(audio, numSamples, sampleRate);
+        waveform = resampled.data();
+        totalSize = static_cast<int64_t>(resampled.size());
+    }
 
     if (progressCallback) progressCallback(0.1);
 
-    MarkerList chunks = sliceAudio(waveform);
+    MarkerList chunks = sliceAudio(waveform, static_cast<size_t>(totalSize));
     DBG("SOME streaming: sliced into " << chunks.size() << " chunks");
 
     if (chunks.empty())
@@ -469,111 +568,33 @@ void SOMEDetector::detectNotesStreaming(
     int lastEndFrame = 0;
     int64_t processedFrames = 0;
 
-    for (const auto& [beginFrame, endFrame] : chunks)
-    {
-        if (endFrame <= beginFrame || beginFrame >= totalSize)
-            continue;
-
-        int64_t actualEnd = std::min(endFrame, totalSize);
-        std::vector<float> chunkData(waveform.begin() + beginFrame, waveform.begin() + actualEnd);
-
-        std::vector<float> noteMidi;
-        std::vector<bool> noteRest;
-        std::vector<float> noteDur;
+    // Chunks are inferred in parallel but reported in order, so the callback
+    // sees the same sequence as a sequential run.
+    inferChunksParallel(waveform, totalSize, chunks, [&](size_t index, ChunkResult& result) {
+        if (!result.valid)
+            return true;
 
-        if (!inferChunk(chunkData, noteMidi, noteRest, noteDur))
+        if (!result.ok)
         {
             DBG("SOME chunk inference failed");
             std::cout << "[SOME] Chunk inference failed" << std::endl;
-            continue;
+            return true;
         }
 
-        if (noteMidi.empty())
-            continue;
-        
-        // Debug: log SOME output for diagnosis
-        int restCount = static_cast<int>(std::count(noteRest.begin(), noteRest.end(), true));
-        DBG("SOME streaming chunk: " << noteMidi.size() << " notes, rest count: " << restCount);
+        if (result.midi.empty())
+            return true;
+
+        const auto [beginFrame, endFrame] = chunks[index];
+        int64_t actualEnd = std::min(endFrame, totalSize);
+
+        int restCount = static_cast<int>(std::count(result.rest.begin(), result.rest.end(), true));
+        DBG("SOME streaming chunk: " << result.midi.size() << " notes, rest count: " << restCount);
 
         int chunkStartFrame = static_cast<int>(beginFrame / HOP_SIZE);
         chunkStartFrame = std::max(chunkStartFrame, lastEndFrame);
 
         std::vector<NoteEvent> chunkNotes;
-        // DIRECT COPY from ds-editor-lite Some.cpp, adapted for frames instead of ticks
-        // Step 1: Calculate cumulative sum (exactly like cumulativeSum in ds-editor-lite)
-        std::vector<double> cumsum(noteDur.size());
-        if (!noteDur.empty())
-        {
-            cumsum[0] = static_cast<double>(noteDur[0]);
-            for (size_t i = 1; i < noteDur.size(); ++i)
-            {
-                cumsum[i] = noteDur[i] + cumsum[i - 1];
-            }
-        }
-
-        // Step 2: Convert cumulative durations to frames (like calculateNoteTicks in ds-editor-lite)
-        // noteDur is in seconds, convert to frames: seconds * SAMPLE_RATE / HOP_SIZE
-        std::vector<int> scaled_frames(cumsum.size());
-        for (size_t i = 0; i < cumsum.size(); ++i)
-        {
-            scaled_frames[i] = static_cast<int>(std::round(cumsum[i] * SAMPLE_RATE / HOP_SIZE));
-        }
-
-        // Step 3: Calculate each note's duration as difference (like note_ticks in ds-editor-lite)
-        std::vector<int> note_frames(scaled_frames.size());
-        if (!scaled_frames.empty())
-        {
-            note_frames[0] = scaled_frames[0];
-            for (size_t i = 1; i < scaled_frames.size(); ++i)
-            {
-                note_frames[i] = scaled_frames[i] - scaled_frames[i - 1];
-            }
-        }
-
-        // Step 4: Build notes (exactly like build_midi_note in ds-editor-lite)
-        int start_frame_temp = chunkStartFrame;
-        int notesCreated = 0;
-        int restSkipped = 0;
-        for (size_t i = 0; i < noteMidi.size(); ++i)
-        {
-            // CRITICAL: Check bounds for note_frames array
-            if (i >= note_frames.size())
-            {
-                DBG("SOME streaming: note_frames index " << i << " out of bounds (size=" << note_frames.size() << ")");
-                std::cout << "[SOME] ERROR: note_frames index " << i << " out of bounds" << std::endl;
-                break;
-            }
-            
-            int noteDurationFrames = note_frames[i];
-            if (noteDurationFrames < 1) noteDurationFrames = 1;
-            
-            if (noteRest[i])
-            {
-                // Rest note: skip but advance position (creates gap between notes)
-                restSkipped++;
-                start_frame_temp += noteDurationFrames;
-                continue;
-            }
-            
-            // Regular note: create event
-            NoteEvent event;
-            event.startFrame = start_frame_temp;
-            event.endFrame = start_frame_temp + noteDurationFrames;
-            event.midiNote = noteMidi[i];
-            event.isRest = false;
-            chunkNotes.push_back(event);
-            notesCreated++;
-
-            // Log SOME output for debugging
-            DBG("SOME streaming note: midi=" << noteMidi[i] << " (raw float from model)");
-            
-            // Advance position for next note (or rest)
-            start_frame_temp += noteDurationFrames;
-        }
-        
-        DBG("SOME streaming chunk built: " << notesCreated << " notes created, " << restSkipped << " rest skipped");
-
-        lastEndFrame = start_frame_temp;
+        lastEndFrame = buildChunkNotes(result, chunkStartFrame, chunkNotes);
 
         // Immediately callback with this chunk's notes
         if (noteCallback && !chunkNotes.empty())
@@ -582,7 +603,8 @@ void SOMEDetector::detectNotesStreaming(
         processedFrames += (actualEnd - beginFrame);
         if (progressCallback)
             progressCallback(0.1 + 0.85 * static_cast<double>(processedFrames) / totalFrames);
-    }
+        return true;
+    });
 
     if (progressCallback) progressCallback(1.0);
 #endif
@@ -44,17 +44,38 @@ public:
 private:
     bool loaded = false;
 
+    // Upper bound on concurrent Run() calls sharing the session
+    static constexpr int MAX_PARALLEL_CHUNKS = 4;
+
     std::vector<float> resampleTo44k(const float* audio, int numSamples, int srcRate);
 
     // Slicer
     using MarkerList = std::vector<std::pair<int64_t, int64_t>>;
-    MarkerList sliceAudio(const std::vector<float>& samples) const;
-    static std::vector<double> getRms(const std::vector<float>& samples, int frameLength, int hopLength);
+    MarkerList sliceAudio(const float* samples, size_t numSamples) const;
+    static std::vector<double> getRms(const float* samples, size_t numSamples, int frameLength, int hopLength);
 
-    // Single chunk inference
-    bool inferChunk(const std::vector<float>& chunk, std::vector<float>& midi,
+    // Single chunk inference (input tensor is a view into the caller's buffer)
+    bool inferChunk(const float* chunk, size_t chunkSize, std::vector<float>& midi,
                     std::vector<bool>& rest, std::vector<float>& dur);
 
+    struct ChunkResult {
+        std::vector<float> midi;
+        std::vector<bool> rest;
+        std::vector<float> dur;
+        bool valid = false;     // chunk lies inside the waveform
+        bool ok = false;        // inference succeeded
+    };
+
+    // Runs inferChunk for all chunks on a worker pool and hands each result to
+    // onChunk in chunk order. Returning false from onChunk stops early.
+    void inferChunksParallel(const float* waveform, int64_t totalSize, const MarkerList& chunks,
+                             const std::function<bool(size_t, ChunkResult&)>& onChunk);
+
+    // Converts one chunk's SOME output into note events starting at startFrame.
+    // Returns the frame after the last note or rest.
+    static int buildChunkNotes(const ChunkResult& result, int startFrame,
+                               std::vector<NoteEvent>& notes);
+
 #ifdef HAVE_ONNXRUNTIME
     std::unique_ptr<Ort::Env> onnxEnv;
     std::unique_ptr<Ort::Session> onnxSession;
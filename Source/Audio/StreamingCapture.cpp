@@ -0,0 +1,193 @@
+#include "StreamingCapture.h"
+#include "../Models/ScratchStorage.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+StreamingCapture::~StreamingCapture() {
+    release(false);
+}
+
+void StreamingCapture::prepare(int channels, double sr) {
+    release(true);
+
+    numChannels = std::max(1, channels);
+    sampleRate = sr > 0.0 ? sr : 44100.0;
+
+    const int ringSize = static_cast<int>(sampleRate * RING_SECONDS);
+    fifo = std::make_unique<juce::AbstractFifo>(ringSize);
+    ring.setSize(numChannels, ringSize);
+    ring.clear();
+    droppedSamples = 0;
+    takeState = TakeState::Idle;
+    resetStore();
+    reserveStorage();
+
+    running = true;
+    drainThread = std::thread([this]() { run(); });
+}
+
+void StreamingCapture::release(bool publishTake) {
+    if (!drainThread.joinable())
+        return;
+
+    running = false;
+    drainThread.join();
+
+    // The thread has gone; finish the take here
+    drainRing();
+    const auto state = takeState.load();
+    if (publishTake && (state == TakeState::Recording || state == TakeState::Finishing))
+        publish(true);
+    else if (publishTake && state == TakeState::Discarding)
+        publishDiscarded();
+    resetStore();
+    takeState = TakeState::Idle;
+}
+
+bool StreamingCapture::beginTake() {
+    auto expected = TakeState::Idle;
+    return fifo != nullptr && takeState.compare_exchange_strong(expected, TakeState::Recording);
+}
+
+void StreamingCapture::push(const juce::AudioBuffer<float>& buffer, int numSamples) {
+    if (takeState.load() != TakeState::Recording || numSamples <= 0)
+        return;
+
+    int start1, size1, start2, size2;
+    fifo->prepareToWrite(numSamples, start1, size1, start2, size2);
+
+    const int channels = std::min(numChannels, buffer.getNumChannels());
+    for (int ch = 0; ch < channels; ++ch) {
+        if (size1 > 0)
+            ring.copyFrom(ch, start1, buffer, ch, 0, size1);
+        if (size2 > 0)
+            ring.copyFrom(ch, start2, buffer, ch, size1, size2);
+    }
+    // Mono input into a stereo capture: duplicate rather than record silence
+    for (int ch = channels; ch < numChannels && channels > 0; ++ch) {
+        if (size1 > 0)
+            ring.copyFrom(ch, start1, buffer, 0, 0, size1);
+        if (size2 > 0)
+            ring.copyFrom(ch, start2, buffer, 0, size1, size2);
+    }
+
+    fifo->finishedWrite(size1 + size2);
+
+    if (size1 + size2 < numSamples)
+        droppedSamples += numSamples - (size1 + size2);
+}
+
+void StreamingCapture::endTake(bool keep) {
+    auto expected = TakeState::Recording;
+    takeState.compare_exchange_strong(expected, keep ? TakeState::Finishing : TakeState::Discarding);
+}
+
+void StreamingCapture::run() {
+    while (running.load()) {
+        drainRing();
+
+        const auto state = takeState.load();
+        if (state == TakeState::Finishing || state == TakeState::Discarding) {
+            // The audio thread pushed its last block before switching state
+            drainRing();
+            if (state == TakeState::Finishing)
+                publish(true);
+            else
+                publishDiscarded();
+            resetStore();
+            reserveStorage();  // For the next take, before it can begin
+            takeState = TakeState::Idle;
+        } else if (state == TakeState::Recording) {
+            if (!takeAnnounced) {
+                takeAnnounced = true;
+                if (onSnapshot)
+                    onSnapshot(nullptr, sampleRate, false);
+            }
+            if (written >= nextSnapshotAt)
+                publish(false);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+    }
+}
+
+void StreamingCapture::drainRing() {
+    if (fifo == nullptr)
+        return;
+
+    const int ready = fifo->getNumReady();
+    if (ready <= 0)
+        return;
+
+    int start1, size1, start2, size2;
+    fifo->prepareToRead(ready, start1, size1, start2, size2);
+
+    // A failed reservation is retried while there is nothing to move yet;
+    // past the reservation the take is cut off
+    if (storage == nullptr && written == 0)
+        reserveStorage();
+    const int fits = static_cast<int>(std::min(static_cast<juce::int64>(size1 + size2), capacity - written));
+    const int count1 = std::min(size1, fits);
+    const int count2 = fits - count1;
+
+    for (int ch = 0; ch < numChannels && fits > 0; ++ch) {
+        float* dest = storage.get() + static_cast<size_t>(ch) * static_cast<size_t>(capacity)
+                    + static_cast<size_t>(written);
+        if (count1 > 0)
+            std::memcpy(dest, ring.getReadPointer(ch, start1), sizeof(float) * static_cast<size_t>(count1));
+        if (count2 > 0)
+            std::memcpy(dest + count1, ring.getReadPointer(ch, start2), sizeof(float) * static_cast<size_t>(count2));
+    }
+    written += fits;
+    droppedSamples += size1 + size2 - fits;
+
+    fifo->finishedRead(size1 + size2);
+}
+
+void StreamingCapture::reserveStorage() {
+    const auto minimumFrames = static_cast<juce::int64>(sampleRate * MIN_RESERVED_SECONDS);
+    // AudioBuffer addresses samples with int
+    juce::int64 frames = std::min(static_cast<juce::int64>(sampleRate * RESERVED_TAKE_SECONDS),
+                                  static_cast<juce::int64>(std::numeric_limits<int>::max()));
+
+    // Less address space or disk may still be there
+    for (; frames >= minimumFrames; frames /= 2) {
+        storage = ScratchStorage::allocateMappedFloats(static_cast<size_t>(numChannels) * static_cast<size_t>(frames));
+        if (storage != nullptr) {
+            capacity = frames;
+            return;
+        }
+    }
+
+    storage = ScratchStorage::allocateFloats(static_cast<size_t>(numChannels) * static_cast<size_t>(minimumFrames));
+    capacity = storage != nullptr ? minimumFrames : 0;
+}
+
+void StreamingCapture::publish(bool isFinal) {
+    nextSnapshotAt = std::max(written + static_cast<juce::int64>(sampleRate * FIRST_SNAPSHOT_SECONDS),
+                              static_cast<juce::int64>(static_cast<double>(written) * SNAPSHOT_GROWTH));
+
+    if (storage == nullptr || written <= 0 || !onSnapshot)
+        return;
+
+    onSnapshot(ScratchStorage::referToFloats(storage, numChannels, static_cast<int>(written),
+                                             static_cast<size_t>(capacity)),
+               sampleRate, isFinal);
+}
+
+void StreamingCapture::publishDiscarded() {
+    // Snapshots of the take may already have gone out; tell the receiver no
+    // finished take follows them
+    if (onSnapshot)
+        onSnapshot(nullptr, sampleRate, true);
+}
+
+void StreamingCapture::resetStore() {
+    storage.reset();
+    capacity = 0;
+    written = 0;
+    nextSnapshotAt = static_cast<juce::int64>(sampleRate * FIRST_SNAPSHOT_SECONDS);
+    takeAnnounced = false;
+}
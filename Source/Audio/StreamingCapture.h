@@ -0,0 +1,110 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+
+/**
+ * Records audio of unbounded length from the audio thread.
+ *
+ * The audio thread only writes into a small lock-free ring (juce::AbstractFifo).
+ * A background thread drains the ring into planar storage from
+ * ScratchStorage::allocateMappedFloats, so a long take lives in a
+ * memory-mapped scratch file and resident memory stays flat. The storage for
+ * a take is reserved before it starts, RESERVED_TAKE_SECONDS long, and is
+ * sparse where the file system allows, so only the pages the take reaches
+ * are written. The drain thread therefore only ever appends and never moves
+ * what it has written; a take longer than its reservation is cut off there,
+ * the rest counting as dropped.
+ *
+ * While a take is recording, the drain thread hands out snapshots of the
+ * recording so far at geometrically growing lengths, so analysing every
+ * snapshot costs a constant factor of analysing the finished take once.
+ * Snapshots refer to the capture storage without copying; samples written
+ * later only ever go past a snapshot's end.
+ *
+ * Threading: prepare()/release() from the message thread (or the host's
+ * prepare/release calls), beginTake()/push()/endTake() from the audio
+ * thread. The snapshot callback runs on the drain thread.
+ */
+class StreamingCapture {
+public:
+    /**
+     * Receives the recording so far; isFinal is set once, for the finished
+     * take. The audio is null in two calls: one with isFinal unset as soon as
+     * a take starts, before the first snapshot, and the final call of a
+     * discarded take.
+     */
+    using SnapshotCallback = std::function<void(std::shared_ptr<juce::AudioBuffer<float>> audio,
+                                                double sampleRate, bool isFinal)>;
+
+    StreamingCapture() = default;
+    ~StreamingCapture();
+
+    /** Set before prepare(); the drain thread reads it without locking. */
+    void setSnapshotCallback(SnapshotCallback callback) { onSnapshot = std::move(callback); }
+
+    /**
+     * Allocate the ring and start the drain thread. A take still in progress
+     * is finished (and published) first.
+     */
+    void prepare(int numChannels, double sampleRate);
+
+    /** Stop the drain thread; with publishTake, a take in progress is published as final. */
+    void release(bool publishTake = true);
+
+    /** Start a new take. Returns false while the previous take is still being drained. */
+    bool beginTake();
+
+    /** Append a block to the current take. Never blocks or allocates. */
+    void push(const juce::AudioBuffer<float>& buffer, int numSamples);
+
+    /** End the current take; keep == false discards it. */
+    void endTake(bool keep);
+
+    bool isRecording() const { return takeState.load() == TakeState::Recording; }
+
+    /** Frames lost because the drain thread fell behind the ring. */
+    juce::int64 getNumDroppedSamples() const { return droppedSamples.load(); }
+
+private:
+    enum class TakeState { Idle, Recording, Finishing, Discarding };
+
+    void run();
+    void drainRing();
+    void reserveStorage();
+    void publish(bool isFinal);
+    void publishDiscarded();
+    void resetStore();
+
+    int numChannels = 0;
+    double sampleRate = 44100.0;
+    SnapshotCallback onSnapshot;
+
+    // Ring between the audio thread and the drain thread
+    std::unique_ptr<juce::AbstractFifo> fifo;
+    juce::AudioBuffer<float> ring;
+    std::atomic<TakeState> takeState{TakeState::Idle};
+    std::atomic<juce::int64> droppedSamples{0};
+
+    // Drain thread only: planar storage, channel c at c * capacity
+    std::shared_ptr<float> storage;
+    juce::int64 capacity = 0;
+    juce::int64 written = 0;
+    juce::int64 nextSnapshotAt = 0;
+    bool takeAnnounced = false;
+
+    std::thread drainThread;
+    std::atomic<bool> running{false};
+
+    static constexpr double RING_SECONDS = 8.0;
+    static constexpr double RESERVED_TAKE_SECONDS = 4.0 * 60.0 * 60.0;
+    static constexpr double MIN_RESERVED_SECONDS = 60.0;  // Asked for when the full reservation fails
+    static constexpr double FIRST_SNAPSHOT_SECONDS = 8.0;
+    static constexpr double SNAPSHOT_GROWTH = 1.5;
+    static constexpr int DRAIN_INTERVAL_MS = 20;
+
+    JUCE_DECLARE_NON_COPYABLE(StreamingCapture)
+};
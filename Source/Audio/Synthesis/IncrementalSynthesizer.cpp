@@ -1,5 +1,7 @@
 #include "IncrementalSynthesizer.h"
+#include "PsolaPreview.h"
 #include "../../Utils/Localization.h"
+#include <algorithm>
 
 IncrementalSynthesizer::IncrementalSynthesizer() = default;
 
@@ -12,10 +14,8 @@ void IncrementalSynthesizer::cancel() {
         cancelFlag->store(true);
 }
 
-std::pair<int, int> IncrementalSynthesizer::expandToSilenceBoundaries(int dirtyStart, int dirtyEnd) {
-    if (!project) return {dirtyStart, dirtyEnd};
-
-    auto& voicedMask = project->getAudioData().voicedMask;
+std::pair<int, int> IncrementalSynthesizer::expandToSilenceBoundaries(const Project& p, int dirtyStart, int dirtyEnd) {
+    auto& voicedMask = p.getAudioData().voicedMask;
     const int totalFrames = static_cast<int>(voicedMask.size());
 
     if (totalFrames == 0) return {dirtyStart, dirtyEnd};
@@ -77,63 +77,159 @@ std::pair<int, int> IncrementalSynthesizer::expandToSilenceBoundaries(int dirtyS
     return {expandedStart, expandedEnd};
 }
 
-void IncrementalSynthesizer::synthesizeRegion(ProgressCallback onProgress,
-                                               CompleteCallback onComplete) {
-    if (!project || !vocoder) {
-        if (onComplete) onComplete(false);
-        return;
-    }
+bool IncrementalSynthesizer::findDirtyRegion(const Project& p, Region& region) {
+    auto& audioData = p.getAudioData();
+    if (audioData.melSpectrogram.empty() || audioData.f0.empty())
+        return false;
+
+    // Check for dirty regions
+    if (!p.hasDirtyNotes() && !p.hasF0DirtyRange())
+        return false;
+
+    auto [dirtyStart, dirtyEnd] = p.getDirtyFrameRange();
+    if (dirtyStart < 0 || dirtyEnd < 0)
+        return false;
+
+    // Expand to silence boundaries (no padding, no crossfade)
+    auto [startFrame, endFrame] = expandToSilenceBoundaries(p, dirtyStart, dirtyEnd);
+
+    // Clamp to valid range
+    startFrame = std::max(0, startFrame);
+    endFrame = std::min(static_cast<int>(audioData.melSpectrogram.size()), endFrame);
+
+    if (startFrame >= endFrame)
+        return false;
+
+    region.startFrame = startFrame;
+    region.endFrame = endFrame;
+
+    // Mel spectrogram range (shares the project's frames)
+    region.mel = audioData.melSpectrogram.slice(static_cast<size_t>(startFrame),
+                                                static_cast<size_t>(endFrame));
+
+    // Get adjusted F0 for range
+    region.f0 = p.getAdjustedF0ForRange(startFrame, endFrame);
+
+    return !region.mel.empty() && !region.f0.empty();
+}
+
+void IncrementalSynthesizer::captureRenderedPitch() {
+    segmentCache.clear();
+    if (project)
+        renderedF0 = project->getAdjustedF0ForRange(0, project->getAudioData().getNumFrames());
+    else
+        renderedF0.clear();
+}
 
+bool IncrementalSynthesizer::renderPreview(int startFrame, const std::vector<float>& targetF0,
+                                           const PreviewCallback& onPreview) {
     auto& audioData = project->getAudioData();
-    if (audioData.melSpectrogram.empty() || audioData.f0.empty()) {
-        if (onComplete) onComplete(false);
-        return;
-    }
+    const int numFrames = static_cast<int>(targetF0.size());
+    if (numFrames > MAX_PREVIEW_FRAMES)
+        return false;
+
+    // Without the pitch the waveform was rendered at there is nothing to shift from
+    if (static_cast<int>(renderedF0.size()) != audioData.getNumFrames() ||
+        startFrame + numFrames > static_cast<int>(renderedF0.size()))
+        return false;
+
+    const auto sourceBegin = renderedF0.begin() + startFrame;
+    const std::vector<float> sourceF0(sourceBegin, sourceBegin + numFrames);
+    if (sourceF0 == targetF0)
+        return false;
+
+    const int hopSize = vocoder->getHopSize();
+    const int startSample = startFrame * hopSize;
+    const int numSamples = std::min(numFrames * hopSize, audioData.waveform->getNumSamples() - startSample);
+    if (numSamples <= 0)
+        return false;
+
+    const auto shifted = PsolaPreview::render(audioData.waveform->getReadPointer(0, startSample), numSamples,
+                                              sourceF0, targetF0, hopSize, audioData.sampleRate);
+    onPreview(startSample, shifted);
+    return true;
+}
 
-    if (!vocoder->isLoaded()) {
-        if (onComplete) onComplete(false);
-        return;
+bool IncrementalSynthesizer::replaceSamples(Project& p, int startFrame, const std::vector<float>& audio,
+                                            const std::vector<float>& f0) {
+    auto& audioData = p.getAudioData();
+    int totalSamples = audioData.waveform->getNumSamples();
+    int numChannels = audioData.waveform->getNumChannels();
+
+    int startSample = startFrame * vocoder->getHopSize();
+    int samplesToReplace = static_cast<int>(audio.size());
+    samplesToReplace = std::min(samplesToReplace, totalSamples - startSample);
+
+    if (samplesToReplace <= 0)
+        return false;
+
+    // Direct replacement - no crossfade. Playback keeps its own copy, so
+    // this writes in place; edit() detaches the buffer first only while a
+    // background worker still holds a snapshot of it.
+    auto& waveform = audioData.waveform.edit();
+    for (int ch = 0; ch < numChannels; ++ch) {
+        float* dstCh = waveform.getWritePointer(ch, startSample);
+        std::copy(audio.begin(), audio.begin() + samplesToReplace, dstCh);
     }
 
-    // Check for dirty regions
-    if (!project->hasDirtyNotes() && !project->hasF0DirtyRange()) {
+    audioData.peaks.edit().update(waveform, startSample, samplesToReplace);
+
+    DBG("synthesizeRegion: replaced " << samplesToReplace << " samples at " << startSample);
+
+    lastReplacedRange = {startSample, startSample + samplesToReplace};
+
+    // The region now sounds at this pitch
+    if (&p == project && startFrame + f0.size() <= renderedF0.size())
+        std::copy(f0.begin(), f0.end(), renderedF0.begin() + startFrame);
+
+    return true;
+}
+
+void IncrementalSynthesizer::synthesizeRegion(ProgressCallback onProgress,
+                                               CompleteCallback onComplete,
+                                               PreviewCallback onPreview) {
+    if (!project || !vocoder) {
         if (onComplete) onComplete(false);
         return;
     }
 
-    auto [dirtyStart, dirtyEnd] = project->getDirtyFrameRange();
-    if (dirtyStart < 0 || dirtyEnd < 0) {
+    if (!vocoder->isLoaded()) {
         if (onComplete) onComplete(false);
         return;
     }
 
-    // Expand to silence boundaries (no padding, no crossfade)
-    auto [startFrame, endFrame] = expandToSilenceBoundaries(dirtyStart, dirtyEnd);
-
-    // Clamp to valid range
-    startFrame = std::max(0, startFrame);
-    endFrame = std::min(static_cast<int>(audioData.melSpectrogram.size()), endFrame);
-
-    if (startFrame >= endFrame) {
+    Region region;
+    if (!findDirtyRegion(*project, region)) {
         if (onComplete) onComplete(false);
         return;
     }
 
-    // Extract mel spectrogram range
-    std::vector<std::vector<float>> melRange(
-        audioData.melSpectrogram.begin() + startFrame,
-        audioData.melSpectrogram.begin() + endFrame);
+    const int startFrame = region.startFrame;
+    const int endFrame = region.endFrame;
+    MelFrames melRange = std::move(region.mel);
+    std::vector<float> adjustedF0Range = std::move(region.f0);
 
-    // Get adjusted F0 for range
-    std::vector<float> adjustedF0Range = project->getAdjustedF0ForRange(startFrame, endFrame);
+    // Rendered before, or ahead of this edit: no need to wait
+    if (const auto* cached = segmentCache.find(startFrame, adjustedF0Range)) {
+        cancel();
+        ++jobId;
+        isBusy = false;
 
-    if (melRange.empty() || adjustedF0Range.empty()) {
-        if (onComplete) onComplete(false);
+        const bool replaced = replaceSamples(*project, startFrame, *cached, adjustedF0Range);
+        if (replaced)
+            project->clearAllDirty();
+
+        DBG("synthesizeRegion: frames [" << startFrame << ", " << endFrame << "] from segment cache");
+        if (onComplete) onComplete(replaced);
         return;
     }
 
     if (onProgress) onProgress(TR("progress.synthesizing"));
 
+    // Something to listen to right away
+    if (onPreview)
+        renderPreview(startFrame, adjustedF0Range, onPreview);
+
     // Cancel previous job
     if (cancelFlag)
         cancelFlag->store(true);
@@ -142,24 +238,25 @@ void IncrementalSynthesizer::synthesizeRegion(ProgressCallback onProgress,
 
     isBusy = true;
 
-    int hopSize = vocoder->getHopSize();
     int capturedStartFrame = startFrame;
 
     // Capture for lambda
     auto capturedCancelFlag = cancelFlag;
     auto capturedProject = project;
+    const auto cacheGeneration = segmentCache.getGeneration();
 
     DBG("synthesizeRegion: frames [" << startFrame << ", " << endFrame << "]");
 
     // Run vocoder inference asynchronously
     vocoder->inferAsync(
         melRange, adjustedF0Range,
-        [this, capturedCancelFlag, capturedProject, capturedStartFrame, hopSize,
-         currentJobId, onComplete](std::vector<float> synthesizedAudio) {
+        [this, capturedCancelFlag, capturedProject, capturedStartFrame,
+         currentJobId, cacheGeneration, onComplete, adjustedF0Range](std::vector<float> synthesizedAudio) {
 
-            // Check if cancelled or superseded
+            // Check if cancelled or superseded; a newer job is still busy
             if (capturedCancelFlag->load() || currentJobId != jobId.load()) {
-                isBusy = false;
+                if (currentJobId == jobId.load())
+                    isBusy = false;
                 if (onComplete) onComplete(false);
                 return;
             }
@@ -170,32 +267,15 @@ void IncrementalSynthesizer::synthesizeRegion(ProgressCallback onProgress,
                 return;
             }
 
-            auto& audioData = capturedProject->getAudioData();
-            int totalSamples = audioData.waveform.getNumSamples();
-            int numChannels = audioData.waveform.getNumChannels();
-
-            int startSample = capturedStartFrame * hopSize;
-            int samplesToReplace = static_cast<int>(synthesizedAudio.size());
-            samplesToReplace = std::min(samplesToReplace, totalSamples - startSample);
+            if (capturedProject == project && cacheGeneration == segmentCache.getGeneration())
+                segmentCache.store(capturedStartFrame, adjustedF0Range, synthesizedAudio);
 
-            if (samplesToReplace <= 0) {
+            if (!replaceSamples(*capturedProject, capturedStartFrame, synthesizedAudio, adjustedF0Range)) {
                 isBusy = false;
                 if (onComplete) onComplete(false);
                 return;
             }
 
-            // Direct replacement - no crossfade
-            for (int i = 0; i < samplesToReplace; ++i) {
-                int dstIdx = startSample + i;
-                float srcVal = synthesizedAudio[i];
-                for (int ch = 0; ch < numChannels; ++ch) {
-                    float* dstCh = audioData.waveform.getWritePointer(ch);
-                    dstCh[dstIdx] = srcVal;
-                }
-            }
-
-            DBG("synthesizeRegion: replaced " << samplesToReplace << " samples at " << startSample);
-
             // Clear dirty flags
             capturedProject->clearAllDirty();
 
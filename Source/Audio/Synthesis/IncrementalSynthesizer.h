@@ -3,6 +3,7 @@
 #include "../../JuceHeader.h"
 #include "../../Models/Project.h"
 #include "../Vocoder.h"
+#include "SegmentCache.h"
 #include <atomic>
 #include <functional>
 #include <memory>
@@ -12,26 +13,75 @@
  * Handles audio synthesis for edited regions.
  * Uses vocoder to resynthesize dirty (modified) portions of audio.
  * Expands dirty region to nearest silence boundaries for clean cuts.
+ *
+ * Vocoder inference can take seconds, so a quick preview of the region is
+ * handed out first: the waveform already there, pitch-shifted by
+ * PsolaPreview from the pitch it was rendered at to the edited one. It is
+ * for playback only and never written into the project, so a failed or
+ * cancelled render leaves the waveform as it was and the next preview
+ * shifts the real audio, not an earlier preview. The rendered pitch per
+ * frame is tracked for this; captureRenderedPitch() sets it whenever the
+ * waveform and the project's pitch are known to match, e.g. after loading.
+ * The preview runs on the message thread, so regions longer than
+ * MAX_PREVIEW_FRAMES (e.g. after a global pitch change) get none and wait
+ * for the vocoder.
+ *
+ * Every render is kept in a SegmentCache, which SpeculativeRenderer also
+ * fills ahead of edits; a region found there is written at once instead.
  */
 class IncrementalSynthesizer {
 public:
     using ProgressCallback = std::function<void(const juce::String& message)>;
     using CompleteCallback = std::function<void(bool success)>;
+    using PreviewCallback = std::function<void(int startSample, const std::vector<float>& samples)>;
+
+    /** Frames a synthesis would render, with their mel frames and adjusted F0. */
+    struct Region {
+        int startFrame = 0;
+        int endFrame = 0;
+        MelFrames mel;  // Shares the project's frames
+        std::vector<float> f0;
+    };
 
     IncrementalSynthesizer();
     ~IncrementalSynthesizer();
 
     void setVocoder(Vocoder* v) { vocoder = v; }
-    void setProject(Project* p) { project = p; }
+    void setProject(Project* p) {
+        if (p != project) {
+            renderedF0.clear();
+            segmentCache.clear();
+        }
+        project = p;
+    }
 
     /**
      * Synthesize the dirty region.
      * - Finds dirty frame range from project
      * - Expands to nearest silence boundaries
+     * - Writes a cached render of the region and completes, if there is one
+     * - Otherwise passes the preview of the region to onPreview, before returning
      * - Synthesizes entire region (no padding, no crossfade)
      * - Direct replacement of samples
      */
-    void synthesizeRegion(ProgressCallback onProgress, CompleteCallback onComplete);
+    void synthesizeRegion(ProgressCallback onProgress, CompleteCallback onComplete,
+                          PreviewCallback onPreview = nullptr);
+
+    /**
+     * The region synthesizeRegion() would render for p's dirty notes and
+     * frames; false if there is nothing to render. p may be a copy of the
+     * project with an edit applied, sharing its mel frames.
+     */
+    static bool findDirtyRegion(const Project& p, Region& region);
+
+    /**
+     * The waveform sounds at the project's current adjusted F0 everywhere.
+     * Also call when the mel frames were replaced, e.g. after re-analysis;
+     * renders of the old ones are dropped.
+     */
+    void captureRenderedPitch();
+
+    SegmentCache& getSegmentCache() { return segmentCache; }
 
     // Cancel ongoing synthesis
     void cancel();
@@ -39,12 +89,23 @@ public:
     // Check if synthesis is in progress
     bool isSynthesizing() const { return isBusy.load(); }
 
+    // Samples [first, second) rewritten by the last successful synthesis
+    std::pair<int, int> getLastReplacedRange() const { return lastReplacedRange; }
+
 private:
     /**
      * Expand dirty range to nearest silence boundaries.
      * Searches backwards and forwards to find silence gaps (>= 5 frames).
      */
-    std::pair<int, int> expandToSilenceBoundaries(int dirtyStart, int dirtyEnd);
+    static std::pair<int, int> expandToSilenceBoundaries(const Project& p, int dirtyStart, int dirtyEnd);
+
+    /** Pass the preview of frames from startFrame at targetF0 to onPreview; false if there is none. */
+    bool renderPreview(int startFrame, const std::vector<float>& targetF0, const PreviewCallback& onPreview);
+
+    static constexpr int MAX_PREVIEW_FRAMES = 1000;  // About 11.6 s at 44.1 kHz, hop 512
+
+    /** Write rendered audio for frames from startFrame at f0; false if it falls outside the waveform. */
+    bool replaceSamples(Project& p, int startFrame, const std::vector<float>& audio, const std::vector<float>& f0);
 
     Vocoder* vocoder = nullptr;
     Project* project = nullptr;
@@ -52,6 +113,9 @@ private:
     std::shared_ptr<std::atomic<bool>> cancelFlag;
     std::atomic<uint64_t> jobId{0};
     std::atomic<bool> isBusy{false};
+    std::pair<int, int> lastReplacedRange{0, 0};  // Message thread only
+    std::vector<float> renderedF0;                 // Hz per frame the waveform sounds at; message thread only
+    SegmentCache segmentCache;                     // Message thread only
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(IncrementalSynthesizer)
 };
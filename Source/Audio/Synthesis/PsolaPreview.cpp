@@ -0,0 +1,81 @@
+#include "PsolaPreview.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    float pitchAt(const std::vector<float>& f0, int sample, int hopSize) {
+        if (f0.empty())
+            return 0.0f;
+        const int frame = std::clamp(sample / hopSize, 0, static_cast<int>(f0.size()) - 1);
+        return f0[static_cast<size_t>(frame)];
+    }
+}
+
+std::vector<float> PsolaPreview::render(const float* input, int numSamples,
+                                        const std::vector<float>& sourceF0,
+                                        const std::vector<float>& targetF0,
+                                        int hopSize, int sampleRate) {
+    std::vector<float> output(static_cast<size_t>(std::max(0, numSamples)), 0.0f);
+    if (numSamples <= 0 || hopSize <= 0 || sampleRate <= 0)
+        return output;
+
+    // Periods in samples, kept to 50 Hz .. 1 kHz so a stray value cannot
+    // stall the mark walk or blow up a grain
+    const float minPeriod = sampleRate / 1000.0f;
+    const float maxPeriod = sampleRate / 50.0f;
+    const float unvoicedPeriod = sampleRate * UNVOICED_PERIOD_SECONDS;
+    auto periodOf = [&](float hz) {
+        return hz > 0.0f ? std::clamp(sampleRate / hz, minPeriod, maxPeriod) : unvoicedPeriod;
+    };
+
+    // Analysis marks, one source period apart. Positions are doubles: a float
+    // stops resolving a period's fraction past 2^24 samples.
+    std::vector<int> marks;
+    for (double t = 0.0; t < numSamples; t += periodOf(pitchAt(sourceF0, static_cast<int>(t), hopSize)))
+        marks.push_back(static_cast<int>(t));
+
+    std::vector<float> weight(output.size(), 0.0f);
+    size_t mark = 0;
+
+    for (double t = 0.0; t < numSamples;) {
+        const int at = static_cast<int>(t);
+
+        // Grain from the analysis mark nearest this synthesis mark
+        while (mark + 1 < marks.size() && std::abs(marks[mark + 1] - at) <= std::abs(marks[mark] - at))
+            ++mark;
+        const int centre = marks[mark];
+
+        const float sourceHz = pitchAt(sourceF0, centre, hopSize);
+        const float targetHz = pitchAt(targetF0, at, hopSize);
+        const float sourcePeriod = periodOf(sourceHz);
+
+        // Next synthesis mark: the target period where both sides are voiced
+        float step = sourcePeriod;
+        if (sourceHz > 0.0f && targetHz > 0.0f) {
+            const float ratio = std::clamp(targetHz / sourceHz, 1.0f / MAX_RATIO, MAX_RATIO);
+            step = sourcePeriod / ratio;
+        }
+
+        // Hann window over two source periods
+        const int half = std::max(1, static_cast<int>(sourcePeriod));
+        const int first = std::max({-half, -centre, -at});
+        const int last = std::min({half, numSamples - centre, numSamples - at});
+        for (int i = first; i < last; ++i) {
+            const float w = 0.5f + 0.5f * std::cos(3.14159265f * static_cast<float>(i) / static_cast<float>(half));
+            output[static_cast<size_t>(at + i)] += input[centre + i] * w;
+            weight[static_cast<size_t>(at + i)] += w;
+        }
+
+        t += std::max(1.0f, step);
+    }
+
+    // Normalise the overlap; grains bunch up where the pitch was raised
+    for (size_t i = 0; i < output.size(); ++i) {
+        if (weight[i] > 1.0e-3f)
+            output[i] /= weight[i];
+        else
+            output[i] = input[i];
+    }
+
+    return output;
+}
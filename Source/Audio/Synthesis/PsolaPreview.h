@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * Quick pitch shift of existing audio for auditioning edits (TD-PSOLA).
+ *
+ * Grains two source periods long are cut around marks spaced one source
+ * period apart and overlap-added at the target period, so the pitch follows
+ * the target curve while timing and formants stay put. Where either curve
+ * is unvoiced the audio is passed through unchanged. The cost is a couple
+ * of multiply-adds per sample, so a region of several seconds shifts in a
+ * few milliseconds; the result is rougher than the vocoder's and is meant
+ * to be heard only until that arrives.
+ */
+class PsolaPreview {
+public:
+    /**
+     * input shifted from sourceF0 to targetF0 (Hz per frame of hopSize
+     * samples, 0 where unvoiced), numSamples long. Frame 0 of both curves
+     * starts at input[0].
+     */
+    static std::vector<float> render(const float* input, int numSamples,
+                                     const std::vector<float>& sourceF0,
+                                     const std::vector<float>& targetF0,
+                                     int hopSize, int sampleRate);
+
+private:
+    // Shifts beyond two octaves either way are clamped
+    static constexpr float MAX_RATIO = 4.0f;
+
+    // Grain spacing where there is no pitch to follow
+    static constexpr float UNVOICED_PERIOD_SECONDS = 0.005f;
+};
@@ -0,0 +1,72 @@
+#include "SegmentCache.h"
+#include <algorithm>
+#include <cstring>
+
+size_t SegmentCache::hashOf(int startFrame, const std::vector<float>& f0) {
+    // FNV-1a over the start frame and the F0 bit patterns
+    juce::uint64 hash = 14695981039346656037ull;
+    auto mix = [&hash](juce::uint32 value) {
+        hash = (hash ^ value) * 1099511628211ull;
+    };
+
+    mix(static_cast<juce::uint32>(startFrame));
+    mix(static_cast<juce::uint32>(f0.size()));
+    for (float hz : f0) {
+        juce::uint32 bits;
+        std::memcpy(&bits, &hz, sizeof(bits));
+        mix(bits);
+    }
+    return static_cast<size_t>(hash);
+}
+
+SegmentCache::Map::const_iterator SegmentCache::findEntry(int startFrame, const std::vector<float>& f0) const {
+    const auto [first, last] = entries.equal_range(hashOf(startFrame, f0));
+    for (auto it = first; it != last; ++it) {
+        if (it->second.startFrame == startFrame && it->second.f0 == f0)
+            return it;
+    }
+    return entries.end();
+}
+
+const std::vector<float>* SegmentCache::find(int startFrame, const std::vector<float>& f0) {
+    const auto found = findEntry(startFrame, f0);
+    if (found == entries.end())
+        return nullptr;
+
+    found->second.lastUsed = ++useCounter;
+    return &found->second.audio;
+}
+
+bool SegmentCache::contains(int startFrame, const std::vector<float>& f0) const {
+    return findEntry(startFrame, f0) != entries.end();
+}
+
+void SegmentCache::store(int startFrame, std::vector<float> f0, std::vector<float> audio) {
+    if (f0.empty() || audio.empty() || contains(startFrame, f0))
+        return;
+
+    const size_t bytes = (f0.size() + audio.size()) * sizeof(float);
+    if (bytes > MAX_CACHE_BYTES / 4)
+        return;
+
+    const size_t hash = hashOf(startFrame, f0);
+    entries.emplace(hash, Entry{startFrame, std::move(f0), std::move(audio), ++useCounter});
+    cachedBytes += bytes;
+    evictOverBudget();
+}
+
+void SegmentCache::clear() {
+    entries.clear();
+    cachedBytes = 0;
+    ++generation;
+}
+
+void SegmentCache::evictOverBudget() {
+    while (cachedBytes > MAX_CACHE_BYTES && !entries.empty()) {
+        auto oldest = std::min_element(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+            return a.second.lastUsed < b.second.lastUsed;
+        });
+        cachedBytes -= (oldest->second.f0.size() + oldest->second.audio.size()) * sizeof(float);
+        entries.erase(oldest);
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Vocoder output for regions already rendered, keyed by the first frame and
+ * the exact F0 the region was rendered at.
+ *
+ * The mel frames are the project's and do not change with edits, so the
+ * same frames at the same F0 always render the same audio: an edit that
+ * comes back to a state seen before (undo, redo, a pre-rendered nudge) can
+ * be written straight in. clear() must be called whenever the mel frames
+ * are replaced. Entries are dropped least recently used first over
+ * MAX_CACHE_BYTES. Message thread only.
+ */
+class SegmentCache {
+public:
+    /** The audio for frames from startFrame at f0, or nullptr. */
+    const std::vector<float>* find(int startFrame, const std::vector<float>& f0);
+
+    bool contains(int startFrame, const std::vector<float>& f0) const;
+
+    void store(int startFrame, std::vector<float> f0, std::vector<float> audio);
+
+    void clear();
+
+    /** Bumped by clear(); a render started at an older generation is stale. */
+    juce::uint32 getGeneration() const { return generation; }
+
+private:
+    struct Entry {
+        int startFrame = 0;
+        std::vector<float> f0;
+        std::vector<float> audio;
+        mutable juce::uint32 lastUsed = 0;
+    };
+
+    using Map = std::unordered_multimap<size_t, Entry>;
+
+    static size_t hashOf(int startFrame, const std::vector<float>& f0);
+    Map::const_iterator findEntry(int startFrame, const std::vector<float>& f0) const;
+    void evictOverBudget();
+
+    Map entries;
+    size_t cachedBytes = 0;
+    juce::uint32 useCounter = 0;
+    juce::uint32 generation = 0;
+
+    static constexpr size_t MAX_CACHE_BYTES = 64 * 1024 * 1024;
+};
@@ -0,0 +1,121 @@
+#include "SpeculativeRenderer.h"
+#include <algorithm>
+
+SpeculativeRenderer::SpeculativeRenderer(IncrementalSynthesizer& s) : synthesizer(s) {}
+
+SpeculativeRenderer::~SpeculativeRenderer() {
+    cancel();
+}
+
+void SpeculativeRenderer::setBudgetPercent(int percent) {
+    budgetPercent = std::clamp(percent, 0, 100);
+    if (budgetPercent == 0)
+        cancel();
+}
+
+void SpeculativeRenderer::schedule() {
+    cancel();
+    if (budgetPercent > 0)
+        startTimer(IDLE_DELAY_MS);
+}
+
+void SpeculativeRenderer::cancel() {
+    stopTimer();
+    // The render under way is stopped, not waited for
+    if (cancelFlag && vocoder)
+        vocoder->cancelInference(cancelFlag);
+    else if (cancelFlag)
+        cancelFlag->store(true);
+    cancelFlag.reset();
+    rendering = false;
+    pending.clear();
+    collected = false;
+}
+
+void SpeculativeRenderer::timerCallback() {
+    stopTimer();
+    if (rendering || budgetPercent == 0 || !vocoder || !vocoder->isLoaded())
+        return;
+
+    // Real synthesis first; it schedules again when done
+    if (synthesizer.isSynthesizing())
+        return;
+
+    if (!collected)
+        collectRegions();
+    startNext();
+}
+
+void SpeculativeRenderer::collectRegions() {
+    auto& cache = synthesizer.getSegmentCache();
+    collected = true;
+    generation = cache.getGeneration();
+    pending.clear();
+    if (!variants)
+        return;
+
+    for (const auto& variant : variants(MAX_REGION_FRAMES)) {
+        IncrementalSynthesizer::Region region;
+        if (!variant.project || !IncrementalSynthesizer::findDirtyRegion(*variant.project, region))
+            continue;
+
+        // A region reaching an edge where the copy was cut may go on past it
+        const int copyFrames = variant.project->getAudioData().getNumFrames();
+        if ((region.startFrame == 0 && variant.startFrame > 0) ||
+            (region.endFrame == copyFrames && variant.startFrame + copyFrames < variant.projectFrames))
+            continue;
+        region.startFrame += variant.startFrame;
+        region.endFrame += variant.startFrame;
+
+        if (region.endFrame - region.startFrame > MAX_REGION_FRAMES ||
+            cache.contains(region.startFrame, region.f0))
+            continue;
+        pending.push_back(std::move(region));
+    }
+}
+
+void SpeculativeRenderer::startNext() {
+    // Regions collected before the mel frames were replaced are stale
+    auto& cache = synthesizer.getSegmentCache();
+    if (generation != cache.getGeneration())
+        pending.clear();
+
+    while (!pending.empty() && cache.contains(pending.front().startFrame, pending.front().f0))
+        pending.pop_front();
+    if (pending.empty())
+        return;
+
+    current = std::move(pending.front());
+    pending.pop_front();
+    rendering = true;
+
+    cancelFlag = std::make_shared<std::atomic<bool>>(false);
+    auto capturedCancelFlag = cancelFlag;
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+
+    vocoder->inferAsync(current.mel, current.f0,
+                        [this, capturedCancelFlag, startMs](std::vector<float> audio) {
+                            // cancel() resets the flag before the renderer goes away
+                            if (capturedCancelFlag->load())
+                                return;
+                            finishRender(std::move(audio), juce::Time::getMillisecondCounterHiRes() - startMs);
+                        },
+                        cancelFlag);
+}
+
+void SpeculativeRenderer::finishRender(std::vector<float> audio, double elapsedMs) {
+    rendering = false;
+    cancelFlag.reset();
+
+    auto& cache = synthesizer.getSegmentCache();
+    if (!audio.empty() && generation == cache.getGeneration())
+        cache.store(current.startFrame, std::move(current.f0), std::move(audio));
+    current = {};
+
+    if (pending.empty())
+        return;
+
+    // Idle for as long as the budget leaves over
+    const double idleMs = elapsedMs * (100 - budgetPercent) / budgetPercent;
+    startTimer(std::max(1, static_cast<int>(idleMs)));
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Models/Project.h"
+#include "../Vocoder.h"
+#include "IncrementalSynthesizer.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * Renders likely next edits into the synthesizer's SegmentCache while the
+ * user is idle, so that when one of them is made it is heard at once.
+ *
+ * schedule() is called when the selection changes or real work finishes.
+ * After IDLE_DELAY_MS without further calls, the variants function is
+ * asked for copies of the frames around each likely edit with the edit
+ * applied, and the region each would resynthesize is rendered, one at a
+ * time. Between renders the renderer waits long enough to use no more than
+ * the budget's share of the time; a budget of 0 turns it off. Regions
+ * longer than MAX_REGION_FRAMES are skipped; they cost the most and are the
+ * least likely to be reused, and the copies need only reach that far.
+ *
+ * cancel() must be called before real work starts, e.g. synthesis of an
+ * edit; nothing further is started and the render under way is stopped.
+ * Message thread only.
+ */
+class SpeculativeRenderer : private juce::Timer {
+public:
+    /**
+     * A copy of the project's frames [startFrame, startFrame + its frame
+     * count) with one likely next edit applied; the copy's frames start at 0.
+     */
+    struct Variant {
+        std::unique_ptr<Project> project;
+        int startFrame = 0;
+        int projectFrames = 0;  // Of the whole project
+    };
+
+    /** Variants for each likely next edit, each copying at least marginFrames either side of it. */
+    using VariantsFunction = std::function<std::vector<Variant>(int marginFrames)>;
+
+    explicit SpeculativeRenderer(IncrementalSynthesizer& synthesizer);
+    ~SpeculativeRenderer() override;
+
+    void setVocoder(Vocoder* v) { vocoder = v; }
+    void setVariantsFunction(VariantsFunction function) { variants = std::move(function); }
+
+    /** Percentage of the time spent rendering, 0 to 100; 0 is off. */
+    void setBudgetPercent(int percent);
+    int getBudgetPercent() const { return budgetPercent; }
+
+    /** Start over with fresh variants once the user has been idle for a moment. */
+    void schedule();
+
+    /** Stop at once; nothing more is rendered until the next schedule(). */
+    void cancel();
+
+private:
+    void timerCallback() override;
+    void collectRegions();
+    void startNext();
+    void finishRender(std::vector<float> audio, double elapsedMs);
+
+    IncrementalSynthesizer& synthesizer;
+    Vocoder* vocoder = nullptr;
+    VariantsFunction variants;
+    int budgetPercent = 0;
+
+    std::deque<IncrementalSynthesizer::Region> pending;
+    bool collected = false;  // pending holds the variants since the last schedule()
+    bool rendering = false;
+    IncrementalSynthesizer::Region current;
+    juce::uint32 generation = 0;  // Of the segment cache when pending was collected
+    std::shared_ptr<std::atomic<bool>> cancelFlag;
+
+    static constexpr int IDLE_DELAY_MS = 500;
+    static constexpr int MAX_REGION_FRAMES = 1000;  // About 11.6 s at 44.1 kHz, hop 512
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpeculativeRenderer)
+};
@@ -228,8 +228,15 @@ bool Vocoder::loadModel(const juce::File& modelPath)
 #endif
 }
 
-std::vector<float> Vocoder::infer(const std::vector<std::vector<float>>& mel,
+std::vector<float> Vocoder::infer(const MelFrames& mel,
                                    const std::vector<float>& f0)
+{
+    return infer(mel, f0, nullptr);
+}
+
+std::vector<float> Vocoder::infer(const MelFrames& mel,
+                                   const std::vector<float>& f0,
+                                   const std::atomic<bool>* cancelFlag)
 {
     if (!loaded || mel.empty() || f0.empty())
         return {};
@@ -255,11 +262,13 @@ std::vector<float> Vocoder::infer(const std::vector<std::vector<float>>& mel,
         std::vector<float> melData(numMels * numFrames);
         
         // Transpose mel from [T, num_mels] to [num_mels, T]
+        const int melsPerFrame = std::min(numMels, mel.getNumMels());
         for (size_t frame = 0; frame < numFrames; ++frame)
         {
-            for (int m = 0; m < numMels && m < static_cast<int>(mel[frame].size()); ++m)
+            const float* melFrame = mel[frame];
+            for (int m = 0; m < melsPerFrame; ++m)
             {
-                melData[m * numFrames + frame] = mel[frame][m];
+                melData[m * numFrames + frame] = melFrame[m];
             }
         }
         
@@ -331,8 +340,35 @@ std::vector<float> Vocoder::infer(const std::vector<std::vector<float>>& mel,
         // Run inference
         auto startInfer = std::chrono::high_resolution_clock::now();
         
+        // A cancellable run is registered until it returns or throws
+        Ort::RunOptions runOptions;
+        struct ActiveRun
+        {
+            Vocoder& vocoder;
+            const std::atomic<bool>* cancelFlag;
+
+            ~ActiveRun()
+            {
+                if (cancelFlag == nullptr)
+                    return;
+                std::lock_guard<std::mutex> lock(vocoder.runsMutex);
+                auto& runs = vocoder.activeRuns;
+                runs.erase(std::find_if(runs.begin(), runs.end(),
+                                        [this](const auto& run) { return run.first == cancelFlag; }));
+            }
+        };
+
+        if (cancelFlag != nullptr)
+        {
+            std::lock_guard<std::mutex> lock(runsMutex);
+            if (cancelFlag->load())
+                return {};
+            activeRuns.emplace_back(cancelFlag, &runOptions);
+        }
+        ActiveRun activeRun{*this, cancelFlag};
+
         auto outputTensors = onnxSession->Run(
-            Ort::RunOptions{nullptr},
+            runOptions,
             inputNames.data(), inputTensors.data(), inputTensors.size(),
             outputNames.data(), outputNames.size());
         
@@ -403,6 +439,11 @@ std::vector<float> Vocoder::infer(const std::vector<std::vector<float>>& mel,
         return waveform;
         
     } catch (const Ort::Exception& e) {
+        if (cancelFlag != nullptr && cancelFlag->load())
+        {
+            log("ONNX inference cancelled");
+            return {};
+        }
         log("ONNX inference failed: " + std::string(e.what()));
         return generateSineFallback(f0);
     }
@@ -411,7 +452,7 @@ std::vector<float> Vocoder::infer(const std::vector<std::vector<float>>& mel,
 #endif
 }
 
-std::vector<float> Vocoder::inferWithPitchShift(const std::vector<std::vector<float>>& mel,
+std::vector<float> Vocoder::inferWithPitchShift(const MelFrames& mel,
                                                  const std::vector<float>& f0,
                                                  float pitchShiftSemitones)
 {
@@ -431,7 +472,7 @@ std::vector<float> Vocoder::inferWithPitchShift(const std::vector<std::vector<fl
     return infer(mel, shiftedF0);
 }
 
-void Vocoder::inferAsync(const std::vector<std::vector<float>>& mel,
+void Vocoder::inferAsync(const MelFrames& mel,
                          const std::vector<float>& f0,
                          std::function<void(std::vector<float>)> callback,
                          std::shared_ptr<std::atomic<bool>> cancelFlag)
@@ -457,7 +498,7 @@ void Vocoder::inferAsync(const std::vector<std::vector<float>>& mel,
             return;
         }
 
-        auto result = this->infer(mel, f0);
+        auto result = this->infer(mel, f0, cancelFlag.get());
 
         // Decrement active task count and notify if this was the last task
         if (activeAsyncTasks.fetch_sub(1) == 1) {
@@ -480,6 +521,24 @@ void Vocoder::inferAsync(const std::vector<std::vector<float>>& mel,
     }).detach();
 }
 
+void Vocoder::cancelInference(const std::shared_ptr<std::atomic<bool>>& cancelFlag)
+{
+    if (!cancelFlag)
+        return;
+
+#ifdef HAVE_ONNXRUNTIME
+    std::lock_guard<std::mutex> lock(runsMutex);
+    cancelFlag->store(true);
+    for (auto& run : activeRuns)
+    {
+        if (run.first == cancelFlag.get())
+            run.second->SetTerminate();
+    }
+#else
+    cancelFlag->store(true);
+#endif
+}
+
 std::vector<float> Vocoder::generateSineFallback(const std::vector<float>& f0)
 {
     // Fallback: Generate simple sine wave based on F0
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "../Models/MelFrames.h"
 #include <vector>
 #include <functional>
 #include <memory>
@@ -46,7 +47,7 @@ public:
      * @param f0 F0 values [T] (fundamental frequency per frame)
      * @return Synthesized waveform, or empty vector on failure
      */
-    std::vector<float> infer(const std::vector<std::vector<float>>& mel,
+    std::vector<float> infer(const MelFrames& mel,
                               const std::vector<float>& f0);
 
     /**
@@ -56,21 +57,27 @@ public:
      * @param pitchShiftSemitones Pitch shift in semitones (+12 = one octave up)
      * @return Synthesized waveform
      */
-    std::vector<float> inferWithPitchShift(const std::vector<std::vector<float>>& mel,
+    std::vector<float> inferWithPitchShift(const MelFrames& mel,
                                             const std::vector<float>& f0,
                                             float pitchShiftSemitones);
 
     /**
      * Asynchronous inference with callback.
-     * @param mel Mel spectrogram
+     * @param mel Mel spectrogram (shared with the worker, not copied)
      * @param f0 F0 values
      * @param callback Called with result on completion
      */
-    void inferAsync(const std::vector<std::vector<float>>& mel,
+    void inferAsync(const MelFrames& mel,
                     const std::vector<float>& f0,
                     std::function<void(std::vector<float>)> callback,
                     std::shared_ptr<std::atomic<bool>> cancelFlag = nullptr);
 
+    /**
+     * Set cancelFlag and stop the inference started with it, if one is
+     * running, instead of letting it finish. Safe from any thread.
+     */
+    void cancelInference(const std::shared_ptr<std::atomic<bool>>& cancelFlag);
+
     // Model parameters
     int getSampleRate() const { return sampleRate; }
     int getHopSize() const { return hopSize; }
@@ -110,6 +117,11 @@ private:
 
     void log(const std::string& message);
 
+    // infer() that gives up, returning nothing, once cancelFlag is set
+    std::vector<float> infer(const MelFrames& mel,
+                              const std::vector<float>& f0,
+                              const std::atomic<bool>* cancelFlag);
+
 #ifdef HAVE_ONNXRUNTIME
     std::unique_ptr<Ort::Env> onnxEnv;
     std::unique_ptr<Ort::Session> onnxSession;
@@ -123,6 +135,11 @@ private:
 
     // Create session options based on current settings
     Ort::SessionOptions createSessionOptions();
+
+    // Runs under way with the cancel flag they were started with, so that
+    // cancelInference() can terminate them
+    std::mutex runsMutex;
+    std::vector<std::pair<const std::atomic<bool>*, Ort::RunOptions*>> activeRuns;
 #endif
 
     /**
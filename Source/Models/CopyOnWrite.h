@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+
+/**
+ * Value holder with structural sharing.
+ *
+ * Copying a CopyOnWrite only shares the underlying object; the first edit()
+ * through a holder whose object is shared clones it first. Anything that
+ * captured the previous object (via a copy or share()) keeps seeing it
+ * unchanged, so a background worker can take an O(1) snapshot and read it
+ * while the owner keeps editing.
+ *
+ * Holders themselves are not thread-safe: copy, share() and edit() a given
+ * holder from its owning thread (the message thread for Project data) and
+ * hand the result to the worker.
+ */
+template <typename T>
+struct CopyOnWriteTraits
+{
+    /** Makes the private copy edit() switches to. Specialise to control where it lives. */
+    static std::shared_ptr<T> clone(const T& value) { return std::make_shared<T>(value); }
+};
+
+template <typename T>
+class CopyOnWrite
+{
+public:
+    CopyOnWrite() : data(std::make_shared<T>()) {}
+    CopyOnWrite(T value) : data(std::make_shared<T>(std::move(value))) {}
+
+    /** Adopts an existing object, e.g. one whose storage is owned elsewhere. */
+    explicit CopyOnWrite(std::shared_ptr<T> shared) : data(std::move(shared)) {}
+
+    CopyOnWrite& operator=(T value)
+    {
+        data = std::make_shared<T>(std::move(value));
+        return *this;
+    }
+
+    const T& get() const { return *data; }
+    const T& operator*() const { return *data; }
+    const T* operator->() const { return data.get(); }
+
+    /** Writable access; detaches from any other holders or snapshots first. */
+    T& edit()
+    {
+        if (data.use_count() > 1)
+            data = CopyOnWriteTraits<T>::clone(*data);
+        return *data;
+    }
+
+    /** Immutable handle to the current object. */
+    std::shared_ptr<const T> share() const { return data; }
+
+private:
+    std::shared_ptr<T> data;
+};
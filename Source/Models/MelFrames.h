@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ScratchStorage.h"
+#include <cstddef>
+#include <memory>
+
+/**
+ * Mel spectrogram frames [T, numMels], stored row-major in one block.
+ *
+ * Frames are written once, right after allocation, and treated as read-only
+ * from then on. Copies and slices share the block, so handing the mel to a
+ * worker or to the vocoder is O(1). Large spectrograms are allocated through
+ * ScratchStorage and are paged in only where they are read.
+ */
+class MelFrames
+{
+public:
+    MelFrames() = default;
+
+    /** Zero-filled frames, to be written through getWritePointer(). */
+    MelFrames(size_t frameCount, int melCount)
+        : storage(ScratchStorage::allocateFloats(frameCount * static_cast<size_t>(melCount))),
+          values(storage.get()),
+          numFrames(frameCount),
+          numMels(melCount)
+    {
+    }
+
+    size_t size() const { return numFrames; }
+    bool empty() const { return numFrames == 0; }
+    int getNumMels() const { return numMels; }
+
+    /** The numMels values of one frame. */
+    const float* operator[](size_t frame) const { return values + frame * static_cast<size_t>(numMels); }
+    float* getWritePointer(size_t frame) { return values + frame * static_cast<size_t>(numMels); }
+
+    /** Frames [startFrame, endFrame), sharing this object's storage. */
+    MelFrames slice(size_t startFrame, size_t endFrame) const
+    {
+        MelFrames result;
+        if (startFrame >= endFrame || endFrame > numFrames)
+            return result;
+
+        result.storage = storage;
+        result.values = values + startFrame * static_cast<size_t>(numMels);
+        result.numFrames = endFrame - startFrame;
+        result.numMels = numMels;
+        return result;
+    }
+
+private:
+    std::shared_ptr<float> storage;
+    float* values = nullptr;
+    size_t numFrames = 0;
+    int numMels = 0;
+};
@@ -1,49 +1,30 @@
 #include "Note.h"
 #include "../Utils/Constants.h"
+#include "../Utils/PitchMath.h"
+#include <algorithm>
 
 Note::Note(int startFrame, int endFrame, float midiNote)
     : startFrame(startFrame), endFrame(endFrame), midiNote(midiNote)
 {
 }
 
-std::vector<float> Note::getAdjustedF0() const
-{
-    if (f0Values.empty() || pitchOffset == 0.0f)
-        return f0Values;
-
-    // Convert semitone offset to frequency ratio
-    float ratio = std::pow(2.0f, pitchOffset / 12.0f);
-
-    std::vector<float> adjusted;
-    adjusted.reserve(f0Values.size());
-
-    for (float f0 : f0Values)
-    {
-        if (f0 > 0.0f)
-            adjusted.push_back(f0 * ratio);
-        else
-            adjusted.push_back(0.0f);
-    }
-
-    return adjusted;
-}
-
-std::vector<float> Note::computeF0FromDelta() const
+std::vector<float> Note::computeF0FromDelta(const std::vector<float>& deltaPitch) const
 {
     int numFrames = endFrame - startFrame;
-    std::vector<float> result(numFrames, 0.0f);
+    std::vector<float> result(static_cast<size_t>(std::max(0, numFrames)), 0.0f);
 
-    for (int i = 0; i < numFrames; ++i)
-    {
-        // Get delta pitch for this frame (or 0 if not available)
-        float delta = (i < static_cast<int>(deltaPitch.size())) ? deltaPitch[i] : 0.0f;
+    if (numFrames <= 0)
+        return result;
 
-        // Actual MIDI = base + offset + delta
-        float actualMidi = midiNote + pitchOffset + delta;
+    // Actual MIDI = base + offset + delta, converted to Hz in one batch
+    const auto delta = startFrame >= 0 ? viewOf(deltaPitch) : FrameSpan<const float>{};
+    const int withDelta = std::min(numFrames, delta.size);
+    if (withDelta > 0)
+        PitchMath::midiToFreq(delta.data, result.data(), static_cast<size_t>(withDelta),
+                              midiNote + pitchOffset);
 
-        // Convert to Hz
-        result[i] = midiToFreq(actualMidi);
-    }
+    // Frames without delta sit exactly on the note pitch
+    std::fill(result.begin() + withDelta, result.end(), midiToFreq(midiNote + pitchOffset));
 
     return result;
 }
@@ -1,15 +1,35 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include <algorithm>
 #include <vector>
 
+/**
+ * Non-owning view of a run of frames in one of the project's dense
+ * per-frame curves.
+ */
+template <typename T>
+struct FrameSpan
+{
+    T* data = nullptr;
+    int size = 0;
+
+    bool empty() const { return size == 0; }
+    T* begin() const { return data; }
+    T* end() const { return data + size; }
+    T& operator[](int i) const { return data[i]; }
+};
+
 /**
  * Represents a single note/pitch segment.
  *
  * Pitch model:
  * - midiNote: The base pitch of the note (can be changed by dragging)
  * - deltaPitch: Per-frame deviation from base pitch (preserved during drag)
- * - f0Values: Original F0 values from detection (for reference)
+ *
+ * Per-frame data (f0, delta pitch, voicing) lives only in the project's
+ * dense curves; a note refers to it through views over its frame range
+ * instead of keeping copies.
  *
  * When dragging a note up/down:
  * - midiNote changes
@@ -36,10 +56,22 @@ public:
     void setPitchOffset(float offset) { pitchOffset = offset; }
     float getAdjustedMidiNote() const { return midiNote + pitchOffset; }
 
-    // Delta pitch (per-frame deviation from base pitch in semitones)
-    const std::vector<float>& getDeltaPitch() const { return deltaPitch; }
-    void setDeltaPitch(std::vector<float> delta) { deltaPitch = std::move(delta); }
-    bool hasDeltaPitch() const { return !deltaPitch.empty(); }
+    /** This note's frames of a dense per-frame curve, clipped to its size. */
+    template <typename T>
+    FrameSpan<const T> viewOf(const std::vector<T>& curve) const
+    {
+        const int begin = std::clamp(startFrame, 0, static_cast<int>(curve.size()));
+        const int end = std::clamp(endFrame, begin, static_cast<int>(curve.size()));
+        return {curve.data() + begin, end - begin};
+    }
+
+    template <typename T>
+    FrameSpan<T> viewOf(std::vector<T>& curve) const
+    {
+        const int begin = std::clamp(startFrame, 0, static_cast<int>(curve.size()));
+        const int end = std::clamp(endFrame, begin, static_cast<int>(curve.size()));
+        return {curve.data() + begin, end - begin};
+    }
 
     // Vibrato
     bool isVibratoEnabled() const { return vibratoEnabled; }
@@ -51,13 +83,8 @@ public:
     float getVibratoPhaseRadians() const { return vibratoPhaseRadians; }
     void setVibratoPhaseRadians(float radians) { vibratoPhaseRadians = radians; }
 
-    // F0 values (original detected values)
-    const std::vector<float>& getF0Values() const { return f0Values; }
-    void setF0Values(std::vector<float> values) { f0Values = std::move(values); }
-    std::vector<float> getAdjustedF0() const;
-
-    // Get F0 values based on current midiNote + deltaPitch
-    std::vector<float> computeF0FromDelta() const;
+    // Get F0 values based on current midiNote + the dense delta pitch curve
+    std::vector<float> computeF0FromDelta(const std::vector<float>& deltaPitch) const;
 
     // Selection
     bool isSelected() const { return selected; }
@@ -92,14 +119,11 @@ private:
     float midiNote = 60.0f;
     float pitchOffset = 0.0f;
 
-    std::vector<float> deltaPitch;  // Per-frame deviation from midiNote in semitones
-
     bool vibratoEnabled = false;
     float vibratoRateHz = 5.0f;
     float vibratoDepthSemitones = 0.0f;
     float vibratoPhaseRadians = 0.0f;
 
-    std::vector<float> f0Values;
     bool selected = false;
     bool dirty = false;  // For incremental synthesis
     bool rest = false;   // Rest note (silence placeholder)
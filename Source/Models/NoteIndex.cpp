@@ -0,0 +1,406 @@
+#include "NoteIndex.h"
+#include <algorithm>
+#include <cmath>
+
+NoteIndex::Placement NoteIndex::placementOf(const Note& note)
+{
+    return {note.getStartFrame(), note.getEndFrame(), note.getAdjustedMidiNote()};
+}
+
+int NoteIndex::rowOf(float midi)
+{
+    const float limit = static_cast<float>(ROW_BIAS);
+    return static_cast<int>(std::clamp(std::floor(midi), -limit, limit - 1.0f));
+}
+
+std::int64_t NoteIndex::cellKey(int row, int column)
+{
+    // Row-major, so one row's cells are contiguous in time order
+    return (static_cast<std::int64_t>(row + ROW_BIAS) << 32) | static_cast<std::uint32_t>(column);
+}
+
+int NoteIndex::rowOfKey(std::int64_t key)
+{
+    return static_cast<int>(key >> 32) - ROW_BIAS;
+}
+
+std::uint32_t NoteIndex::priorityOf(size_t index)
+{
+    // Fixed per position, so a copied index keeps the same shape
+    std::uint64_t x = static_cast<std::uint64_t>(index) + 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return static_cast<std::uint32_t>(x ^ (x >> 31));
+}
+
+void NoteIndex::rebuild(const std::vector<Note>& notes)
+{
+    nodes.assign(notes.size(), {});
+    root = npos;
+    placements.clear();
+    cells.clear();
+    selected.clear();
+    dirty.clear();
+    placements.reserve(notes.size());
+
+    for (size_t i = 0; i < notes.size(); ++i)
+    {
+        const auto& note = notes[i];
+        placements.push_back(placementOf(note));
+        insertNode(i);
+        fileInCells(placements.back(), i);
+        if (note.isSelected())
+            selected.push_back(i);
+        if (note.isDirty())
+            dirty.push_back(i);
+    }
+
+    indexedCount = notes.size();
+    valid = true;
+}
+
+void NoteIndex::append(const std::vector<Note>& notes, size_t index)
+{
+    if (!valid || index != indexedCount || index >= notes.size())
+    {
+        valid = false;
+        return;
+    }
+
+    const auto& note = notes[index];
+
+    // A note split off another lands in the middle of the start order
+    placements.push_back(placementOf(note));
+    nodes.emplace_back();
+    insertNode(index);
+    fileInCells(placements.back(), index);
+    if (note.isSelected())
+        selected.push_back(index);
+    if (note.isDirty())
+        dirty.push_back(index);
+    ++indexedCount;
+}
+
+void NoteIndex::update(const std::vector<Note>& notes, size_t index)
+{
+    if (!valid || index >= indexedCount || indexedCount != notes.size())
+    {
+        valid = false;
+        return;
+    }
+
+    const Placement before = placements[index];
+    const Placement after = placementOf(notes[index]);
+    if (after == before)
+        return;
+
+    // The tree is searched by the placement the note was filed with
+    if (after.startFrame != before.startFrame || after.endFrame != before.endFrame)
+    {
+        eraseNode(index);
+        placements[index] = after;
+        insertNode(index);
+    }
+
+    removeFromCells(before, index);
+    fileInCells(after, index);
+    placements[index] = after;
+}
+
+bool NoteIndex::startsBefore(size_t a, int startFrame, size_t b) const
+{
+    const int start = placements[a].startFrame;
+    return start < startFrame || (start == startFrame && a < b);
+}
+
+void NoteIndex::pull(size_t node)
+{
+    auto& n = nodes[node];
+    n.maxEndFrame = placements[node].endFrame;
+    if (n.left != npos)
+        n.maxEndFrame = std::max(n.maxEndFrame, nodes[n.left].maxEndFrame);
+    if (n.right != npos)
+        n.maxEndFrame = std::max(n.maxEndFrame, nodes[n.right].maxEndFrame);
+}
+
+void NoteIndex::split(size_t node, int startFrame, size_t index, size_t& below, size_t& rest)
+{
+    // below gets the notes ordered before (startFrame, index), rest the others
+    if (node == npos)
+    {
+        below = rest = npos;
+        return;
+    }
+
+    if (startsBefore(node, startFrame, index))
+    {
+        split(nodes[node].right, startFrame, index, nodes[node].right, rest);
+        below = node;
+    }
+    else
+    {
+        split(nodes[node].left, startFrame, index, below, nodes[node].left);
+        rest = node;
+    }
+    pull(node);
+}
+
+size_t NoteIndex::merge(size_t below, size_t above)
+{
+    // Every note in below is ordered before every note in above
+    if (below == npos)
+        return above;
+    if (above == npos)
+        return below;
+
+    if (priorityOf(below) > priorityOf(above))
+    {
+        nodes[below].right = merge(nodes[below].right, above);
+        pull(below);
+        return below;
+    }
+
+    nodes[above].left = merge(below, nodes[above].left);
+    pull(above);
+    return above;
+}
+
+void NoteIndex::insertNode(size_t index)
+{
+    nodes[index] = {};
+    pull(index);
+
+    size_t below, rest;
+    split(root, placements[index].startFrame, index, below, rest);
+    root = merge(merge(below, index), rest);
+}
+
+void NoteIndex::eraseNode(size_t index)
+{
+    // Equal starts are ordered by position, so (start, index + 1) follows only this note
+    const int startFrame = placements[index].startFrame;
+    size_t below, rest, node, above;
+    split(root, startFrame, index, below, rest);
+    split(rest, startFrame, index + 1, node, above);
+    root = merge(below, above);
+}
+
+void NoteIndex::fileInCells(const Placement& placement, size_t index)
+{
+    const int row = rowOf(placement.midi);
+    const int first = std::max(0, placement.startFrame) / FRAMES_PER_CELL;
+    const int last = std::max(0, placement.endFrame - 1) / FRAMES_PER_CELL;
+    for (int column = first; column <= last; ++column)
+        cells[cellKey(row, column)].push_back(index);
+}
+
+void NoteIndex::removeFromCells(const Placement& placement, size_t index)
+{
+    const int row = rowOf(placement.midi);
+    const int first = std::max(0, placement.startFrame) / FRAMES_PER_CELL;
+    const int last = std::max(0, placement.endFrame - 1) / FRAMES_PER_CELL;
+    for (int column = first; column <= last; ++column)
+    {
+        auto cell = cells.find(cellKey(row, column));
+        if (cell == cells.end())
+            continue;
+
+        auto& members = cell->second;
+        members.erase(std::remove(members.begin(), members.end(), index), members.end());
+        if (members.empty())
+            cells.erase(cell);
+    }
+}
+
+void NoteIndex::findOverlapping(int startFrame, int endFrame, std::vector<size_t>& result) const
+{
+    result.clear();
+    collectOverlapping(root, startFrame, endFrame, result);
+    std::sort(result.begin(), result.end());
+}
+
+void NoteIndex::collectOverlapping(size_t node, int startFrame, int endFrame,
+                                   std::vector<size_t>& result) const
+{
+    // Nothing below ends after startFrame
+    if (node == npos || nodes[node].maxEndFrame <= startFrame)
+        return;
+
+    collectOverlapping(nodes[node].left, startFrame, endFrame, result);
+
+    // This note and everything right of it start too late
+    const auto& placement = placements[node];
+    if (placement.startFrame >= endFrame)
+        return;
+    if (placement.endFrame > startFrame)
+        result.push_back(node);
+
+    collectOverlapping(nodes[node].right, startFrame, endFrame, result);
+}
+
+void NoteIndex::findInArea(int startFrame, int endFrame, float lowMidi, float highMidi,
+                           std::vector<size_t>& result) const
+{
+    result.clear();
+    if (startFrame >= endFrame || lowMidi > highMidi)
+        return;
+
+    const int firstColumn = std::max(0, startFrame) / FRAMES_PER_CELL;
+    const int lastColumn = std::max(0, endFrame - 1) / FRAMES_PER_CELL;
+    const int lastRow = rowOf(highMidi);
+
+    // Walk the occupied cells of each occupied row in the area
+    for (int row = rowOf(lowMidi); row <= lastRow; ++row)
+    {
+        auto cell = cells.lower_bound(cellKey(row, firstColumn));
+        if (cell == cells.end())
+            break;
+
+        for (; cell != cells.end() && cell->first <= cellKey(row, lastColumn); ++cell)
+        {
+            for (size_t index : cell->second)
+            {
+                const auto& placement = placements[index];
+                if (placement.startFrame < endFrame && placement.endFrame > startFrame &&
+                    placement.midi >= lowMidi && placement.midi <= highMidi)
+                    result.push_back(index);
+            }
+        }
+
+        // Skip rows without cells
+        if (cell != cells.end())
+            row = std::max(row, rowOfKey(cell->first) - 1);
+    }
+
+    // A note spanning several cells is found in each
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+size_t NoteIndex::findAtFrame(int frame) const
+{
+    std::vector<size_t> hits;
+    findOverlapping(frame, frame + 1, hits);
+    return hits.empty() ? npos : hits.front();
+}
+
+size_t NoteIndex::findByStartFrame(int startFrame) const
+{
+    const size_t index = firstStartingFrom(startFrame);
+    return (index != npos && placements[index].startFrame == startFrame) ? index : npos;
+}
+
+size_t NoteIndex::firstStartingFrom(int frame) const
+{
+    size_t found = npos;
+    for (size_t node = root; node != npos;)
+    {
+        if (placements[node].startFrame >= frame)
+        {
+            found = node;
+            node = nodes[node].left;
+        }
+        else
+        {
+            node = nodes[node].right;
+        }
+    }
+    return found;
+}
+
+size_t NoteIndex::lastStartingBefore(int frame) const
+{
+    size_t found = npos;
+    for (size_t node = root; node != npos;)
+    {
+        if (placements[node].startFrame < frame)
+        {
+            found = node;
+            node = nodes[node].right;
+        }
+        else
+        {
+            node = nodes[node].left;
+        }
+    }
+    return found;
+}
+
+size_t NoteIndex::nextByStart(size_t index) const
+{
+    if (index >= indexedCount)
+        return npos;
+
+    // First note not ordered before (start, index + 1)
+    const int startFrame = placements[index].startFrame;
+    size_t found = npos;
+    for (size_t node = root; node != npos;)
+    {
+        if (!startsBefore(node, startFrame, index + 1))
+        {
+            found = node;
+            node = nodes[node].left;
+        }
+        else
+        {
+            node = nodes[node].right;
+        }
+    }
+    return found;
+}
+
+size_t NoteIndex::previousByStart(size_t index) const
+{
+    if (index >= indexedCount)
+        return npos;
+
+    // Last note ordered before (start, index)
+    const int startFrame = placements[index].startFrame;
+    size_t found = npos;
+    for (size_t node = root; node != npos;)
+    {
+        if (startsBefore(node, startFrame, index))
+        {
+            found = node;
+            node = nodes[node].right;
+        }
+        else
+        {
+            node = nodes[node].left;
+        }
+    }
+    return found;
+}
+
+void NoteIndex::findStartingIn(int startFrame, int endFrame, std::vector<size_t>& result) const
+{
+    result.clear();
+    collectStartingIn(root, startFrame, endFrame, result);
+}
+
+void NoteIndex::collectStartingIn(size_t node, int startFrame, int endFrame,
+                                  std::vector<size_t>& result) const
+{
+    // In order, visiting only subtrees that can start inside the range
+    if (node == npos)
+        return;
+
+    const int start = placements[node].startFrame;
+    if (start >= startFrame)
+        collectStartingIn(nodes[node].left, startFrame, endFrame, result);
+    if (start >= startFrame && start < endFrame)
+        result.push_back(node);
+    if (start < endFrame)
+        collectStartingIn(nodes[node].right, startFrame, endFrame, result);
+}
+
+void NoteIndex::setMember(std::vector<size_t>& list, size_t index, bool member)
+{
+    auto it = std::lower_bound(list.begin(), list.end(), index);
+    const bool present = it != list.end() && *it == index;
+
+    if (member && !present)
+        list.insert(it, index);
+    else if (!member && present)
+        list.erase(it);
+}
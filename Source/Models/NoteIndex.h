@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Note.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/**
+ * Interval index over a note vector.
+ *
+ * Notes are kept in a treap (a search tree balanced by pseudo-random
+ * priorities) ordered by start frame and then vector position, each node
+ * carrying the largest end frame in its subtree. Filing or moving a note is
+ * O(log n) expected, and a frame or range query descends only into subtrees
+ * that can still reach the query range, O(log n) plus the hits however long
+ * any one note is. Selected and dirty notes are tracked in side lists that
+ * are updated one note at a time instead of rescanning the whole vector.
+ *
+ * For queries over pitch as well, notes are also filed in a grid of cells
+ * FRAMES_PER_CELL frames wide and one semitone (of the adjusted MIDI note)
+ * high, ordered by semitone and then time. An area query visits only the
+ * occupied cells inside it, so a dense stack of voices costs what falls in
+ * the area rather than everything over its frames.
+ *
+ * Notes are referenced by their position in the vector (never by pointer),
+ * so a copied index stays valid for a copied note vector. The index does not
+ * observe the vector: the owner calls update() when a note is moved or
+ * resized, append() when one is pushed onto the end, and invalidate() when
+ * notes are removed or reordered, then rebuild() before the next query.
+ */
+class NoteIndex
+{
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    void invalidate() { valid = false; }
+    bool isValidFor(const std::vector<Note>& notes) const
+    {
+        return valid && indexedCount == notes.size();
+    }
+
+    void rebuild(const std::vector<Note>& notes);
+
+    /** Record notes[index] pushed onto the end of the vector. O(log n), no sort. */
+    void append(const std::vector<Note>& notes, size_t index);
+
+    /** Re-file notes[index] after its frames or pitch changed. Same cost as append(). */
+    void update(const std::vector<Note>& notes, size_t index);
+
+    /** Positions of notes with start < endFrame and end > startFrame, in vector order. */
+    void findOverlapping(int startFrame, int endFrame, std::vector<size_t>& result) const;
+
+    /**
+     * Positions of notes with start < endFrame, end > startFrame and an
+     * adjusted MIDI note in [lowMidi, highMidi], in vector order.
+     */
+    void findInArea(int startFrame, int endFrame, float lowMidi, float highMidi,
+                    std::vector<size_t>& result) const;
+
+    /** First note (in vector order) containing frame, or npos. */
+    size_t findAtFrame(int frame) const;
+
+    /** First note (in vector order) starting exactly at startFrame, or npos. */
+    size_t findByStartFrame(int startFrame) const;
+
+    // Start order: by start frame, equal starts in vector order. Each step
+    // is a tree descent, O(log n); npos past either end.
+    size_t firstStartingFrom(int frame) const;  // First with start >= frame
+    size_t lastStartingBefore(int frame) const; // Last with start < frame
+    size_t nextByStart(size_t index) const;
+    size_t previousByStart(size_t index) const;
+
+    /** Positions of notes with start in [startFrame, endFrame), in start order. */
+    void findStartingIn(int startFrame, int endFrame, std::vector<size_t>& result) const;
+
+    // Side lists, sorted by vector position
+    const std::vector<size_t>& getSelected() const { return selected; }
+    const std::vector<size_t>& getDirty() const { return dirty; }
+    void setSelected(size_t index, bool isSelected) { setMember(selected, index, isSelected); }
+    void setDirty(size_t index, bool isDirty) { setMember(dirty, index, isDirty); }
+    void clearSelected() { selected.clear(); }
+    void clearDirty() { dirty.clear(); }
+
+private:
+    // Tree links of the note at the same vector position
+    struct Node
+    {
+        size_t left = npos;
+        size_t right = npos;
+        int maxEndFrame = 0;  // Largest end frame in this subtree
+    };
+
+    // Where a note is filed: the frames and pitch it had when last indexed
+    struct Placement
+    {
+        int startFrame;
+        int endFrame;
+        float midi;
+
+        bool operator==(const Placement& other) const
+        {
+            return startFrame == other.startFrame && endFrame == other.endFrame && midi == other.midi;
+        }
+    };
+
+    static Placement placementOf(const Note& note);
+    static int rowOf(float midi);  // Semitone row of a pitch
+    static std::int64_t cellKey(int row, int column);
+    static int rowOfKey(std::int64_t key);
+
+    static void setMember(std::vector<size_t>& list, size_t index, bool member);
+
+    static std::uint32_t priorityOf(size_t index);
+    bool startsBefore(size_t a, int startFrame, size_t b) const;  // a's (start, position) before (startFrame, b)
+    void pull(size_t node);
+    void split(size_t node, int startFrame, size_t index, size_t& below, size_t& rest);
+    size_t merge(size_t below, size_t above);
+    void insertNode(size_t index);
+    void eraseNode(size_t index);
+    void collectOverlapping(size_t node, int startFrame, int endFrame, std::vector<size_t>& result) const;
+    void collectStartingIn(size_t node, int startFrame, int endFrame, std::vector<size_t>& result) const;
+    void fileInCells(const Placement& placement, size_t index);
+    void removeFromCells(const Placement& placement, size_t index);
+
+    std::vector<Node> nodes;                            // By vector position
+    size_t root = npos;
+    std::vector<Placement> placements;                  // By vector position
+    std::map<std::int64_t, std::vector<size_t>> cells;  // By cellKey(semitone, frame / FRAMES_PER_CELL)
+    std::vector<size_t> selected;
+    std::vector<size_t> dirty;
+    size_t indexedCount = 0;
+    bool valid = false;
+
+    static constexpr int FRAMES_PER_CELL = 64;
+    static constexpr int ROW_BIAS = 1 << 20;  // Keeps cell keys of negative rows ordered
+};
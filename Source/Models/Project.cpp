@@ -1,8 +1,11 @@
 #include "Project.h"
 #include "../Utils/Constants.h"
 #include "../Utils/PitchCurveProcessor.h"
+#include "../Utils/PitchMath.h"
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <utility>
 
 namespace
 {
@@ -13,82 +16,387 @@ Project::Project()
 {
 }
 
-Note* Project::getNoteAtFrame(int frame)
+const NoteIndex& Project::getNoteIndex() const
 {
-    for (auto& note : notes)
+    if (!noteIndex.isValidFor(notes))
+        noteIndex.rebuild(notes);
+    return noteIndex;
+}
+
+size_t Project::indexOf(const Note* note) const
+{
+    if (note == nullptr || notes.empty() || note < notes.data() || note >= notes.data() + notes.size())
+        return NoteIndex::npos;
+    return static_cast<size_t>(note - notes.data());
+}
+
+void Project::addNote(Note note)
+{
+    if (!note.isRest())
+        ++pitchedNoteCount;
+    notes.push_back(std::move(note));
+    noteIndex.append(notes, notes.size() - 1);
+    notifyNoteChanged(notes.back());
+}
+
+void Project::clearNotes()
+{
+    notes.clear();
+    pitchedNoteCount = 0;
+    noteIndex.invalidate();
+    notifyFramesChanged(0, std::numeric_limits<int>::max());
+}
+
+void Project::setNotes(std::vector<Note> newNotes)
+{
+    notes = std::move(newNotes);
+    pitchedNoteCount = static_cast<size_t>(std::count_if(notes.begin(), notes.end(),
+                                                         [](const Note& n) { return !n.isRest(); }));
+    noteIndex.invalidate();
+    notifyFramesChanged(0, std::numeric_limits<int>::max());
+}
+
+void Project::replaceNote(Note* note, const Note& replacement)
+{
+    const size_t index = indexOf(note);
+    if (index == NoteIndex::npos)
+        return;
+
+    // Old and new extent
+    notifyNoteChanged(*note);
+    if (!note->isRest())
+        --pitchedNoteCount;
+    if (!replacement.isRest())
+        ++pitchedNoteCount;
+    *note = replacement;
+    if (noteIndex.isValidFor(notes))
     {
-        if (note.containsFrame(frame))
-            return &note;
+        noteIndex.update(notes, index);
+        noteIndex.setSelected(index, note->isSelected());
+        noteIndex.setDirty(index, note->isDirty());
     }
-    return nullptr;
+    notifyNoteChanged(*note);
 }
 
-std::vector<Note*> Project::getNotesInRange(int startFrame, int endFrame)
+void Project::removeNotesInRange(int startFrame, int endFrame)
 {
-    std::vector<Note*> result;
-    for (auto& note : notes)
+    std::vector<size_t> hits;
+    getNoteIndex().findOverlapping(startFrame, endFrame, hits);
+    if (hits.empty())
+        return;
+
+    for (size_t index : hits)
     {
-        if (note.getStartFrame() < endFrame && note.getEndFrame() > startFrame)
-            result.push_back(&note);
+        notifyNoteChanged(notes[index]);
+        if (!notes[index].isRest())
+            --pitchedNoteCount;
+    }
+
+    // Hits are in vector order; later notes shift down, so positions in the
+    // index are stale afterwards
+    size_t kept = 0;
+    size_t next = 0;
+    for (size_t i = 0; i < notes.size(); ++i)
+    {
+        if (next < hits.size() && hits[next] == i)
+        {
+            ++next;
+            continue;
+        }
+        if (kept != i)
+            notes[kept] = std::move(notes[i]);
+        ++kept;
     }
+    notes.erase(notes.begin() + static_cast<std::ptrdiff_t>(kept), notes.end());
+    noteIndex.invalidate();
+}
+
+Note* Project::getNoteAtFrame(int frame)
+{
+    const size_t index = getNoteIndex().findAtFrame(frame);
+    return index != NoteIndex::npos ? &notes[index] : nullptr;
+}
+
+std::vector<Note*> Project::getNotesInRange(int startFrame, int endFrame)
+{
+    std::vector<size_t> hits;
+    getNoteIndex().findOverlapping(startFrame, endFrame, hits);
+
+    std::vector<Note*> result;
+    result.reserve(hits.size());
+    for (size_t index : hits)
+        result.push_back(&notes[index]);
+    return result;
+}
+
+std::vector<const Note*> Project::getNotesInRange(int startFrame, int endFrame) const
+{
+    std::vector<size_t> hits;
+    getNoteIndex().findOverlapping(startFrame, endFrame, hits);
+
+    std::vector<const Note*> result;
+    result.reserve(hits.size());
+    for (size_t index : hits)
+        result.push_back(&notes[index]);
+    return result;
+}
+
+std::vector<Note*> Project::getNotesInArea(int startFrame, int endFrame, float lowMidi, float highMidi)
+{
+    std::vector<size_t> hits;
+    getNoteIndex().findInArea(startFrame, endFrame, lowMidi, highMidi, hits);
+
+    std::vector<Note*> result;
+    result.reserve(hits.size());
+    for (size_t index : hits)
+        result.push_back(&notes[index]);
+    return result;
+}
+
+const Note* Project::getFirstNoteStartingFrom(int frame) const
+{
+    const size_t index = getNoteIndex().firstStartingFrom(frame);
+    return index != NoteIndex::npos ? &notes[index] : nullptr;
+}
+
+const Note* Project::getLastNoteStartingBefore(int frame) const
+{
+    const size_t index = getNoteIndex().lastStartingBefore(frame);
+    return index != NoteIndex::npos ? &notes[index] : nullptr;
+}
+
+const Note* Project::getNextNoteByStart(const Note* note) const
+{
+    const size_t position = indexOf(note);
+    if (position == NoteIndex::npos)
+        return nullptr;
+
+    const size_t index = getNoteIndex().nextByStart(position);
+    return index != NoteIndex::npos ? &notes[index] : nullptr;
+}
+
+const Note* Project::getPreviousNoteByStart(const Note* note) const
+{
+    const size_t position = indexOf(note);
+    if (position == NoteIndex::npos)
+        return nullptr;
+
+    const size_t index = getNoteIndex().previousByStart(position);
+    return index != NoteIndex::npos ? &notes[index] : nullptr;
+}
+
+std::vector<const Note*> Project::getNotesStartingIn(int startFrame, int endFrame) const
+{
+    std::vector<size_t> hits;
+    getNoteIndex().findStartingIn(startFrame, endFrame, hits);
+
+    std::vector<const Note*> result;
+    result.reserve(hits.size());
+    for (size_t index : hits)
+        result.push_back(&notes[index]);
     return result;
 }
 
 std::vector<Note*> Project::getSelectedNotes()
 {
     std::vector<Note*> result;
-    for (auto& note : notes)
+    for (size_t index : getNoteIndex().getSelected())
     {
-        if (note.isSelected())
-            result.push_back(&note);
+        if (notes[index].isSelected())
+            result.push_back(&notes[index]);
     }
     return result;
 }
 
-bool Project::removeNoteByStartFrame(int startFrame)
+bool Project::hasSelectedNotes() const
 {
-    for (auto it = notes.begin(); it != notes.end(); ++it)
+    for (size_t index : getNoteIndex().getSelected())
     {
-        if (it->getStartFrame() == startFrame)
-        {
-            notes.erase(it);
+        if (notes[index].isSelected())
             return true;
-        }
     }
     return false;
 }
 
+Note* Project::getNoteStartingAt(int startFrame)
+{
+    const size_t index = getNoteIndex().findByStartFrame(startFrame);
+    return index != NoteIndex::npos ? &notes[index] : nullptr;
+}
+
+bool Project::removeNoteByStartFrame(int startFrame)
+{
+    const size_t index = getNoteIndex().findByStartFrame(startFrame);
+    if (index == NoteIndex::npos)
+        return false;
+
+    notifyNoteChanged(notes[index]);
+    if (!notes[index].isRest())
+        --pitchedNoteCount;
+
+    // Later notes shift down, so positions in the index are stale
+    notes.erase(notes.begin() + static_cast<std::ptrdiff_t>(index));
+    noteIndex.invalidate();
+    return true;
+}
+
 void Project::deselectAllNotes()
 {
-    for (auto& note : notes)
-        note.setSelected(false);
+    const auto& index = getNoteIndex();
+    for (size_t i : index.getSelected())
+    {
+        if (notes[i].isSelected())
+            notifyNoteChanged(notes[i]);
+        notes[i].setSelected(false);
+    }
+    noteIndex.clearSelected();
 }
 
 std::vector<Note*> Project::getDirtyNotes()
 {
     std::vector<Note*> result;
-    for (auto& note : notes)
+    for (size_t index : getNoteIndex().getDirty())
     {
-        if (note.isDirty())
-            result.push_back(&note);
+        if (notes[index].isDirty())
+            result.push_back(&notes[index]);
     }
     return result;
 }
 
 void Project::clearAllDirty()
 {
-    for (auto& note : notes)
-        note.clearDirty();
+    const auto& index = getNoteIndex();
+    for (size_t i : index.getDirty())
+        notes[i].clearDirty();
+    noteIndex.clearDirty();
     // Also clear F0 dirty range
     f0DirtyStart = -1;
     f0DirtyEnd = -1;
 }
 
+void Project::setNoteSelected(Note* note, bool selected)
+{
+    if (note == nullptr)
+        return;
+
+    const bool changed = note->isSelected() != selected;
+    note->setSelected(selected);
+    const size_t index = indexOf(note);
+    if (index != NoteIndex::npos && noteIndex.isValidFor(notes))
+        noteIndex.setSelected(index, selected);
+
+    if (changed)
+        notifyNoteChanged(*note);
+}
+
+void Project::setNotePitch(Note* note, float midiNote, float pitchOffset)
+{
+    if (note == nullptr)
+        return;
+
+    note->setMidiNote(midiNote);
+    note->setPitchOffset(pitchOffset);
+    const size_t index = indexOf(note);
+    if (index != NoteIndex::npos)
+        noteIndex.update(notes, index);
+}
+
+void Project::markNoteDirty(Note* note)
+{
+    if (note == nullptr)
+        return;
+
+    note->markDirty();
+    const size_t index = indexOf(note);
+    if (index != NoteIndex::npos && noteIndex.isValidFor(notes))
+        noteIndex.setDirty(index, true);
+}
+
+void Project::clearNoteDirty(Note* note)
+{
+    if (note == nullptr)
+        return;
+
+    note->clearDirty();
+    const size_t index = indexOf(note);
+    if (index != NoteIndex::npos && noteIndex.isValidFor(notes))
+        noteIndex.setDirty(index, false);
+}
+
+void Project::markAllNotesDirty()
+{
+    for (auto& note : notes)
+        note.markDirty();
+    // Cheaper to rescan once than to insert every position
+    noteIndex.invalidate();
+}
+
+void Project::setNoteRange(Note* note, int startFrame, int endFrame)
+{
+    if (note == nullptr)
+        return;
+
+    // Old and new extent
+    notifyNoteChanged(*note);
+    note->setStartFrame(startFrame);
+    note->setEndFrame(endFrame);
+    const size_t index = indexOf(note);
+    if (index != NoteIndex::npos)
+        noteIndex.update(notes, index);
+    notifyNoteChanged(*note);
+}
+
+void Project::notifyChanged(const ProjectChange& change) const
+{
+    if (changeCallback.function)
+        changeCallback.function(change);
+}
+
+void Project::notifyFramesChanged(int startFrame, int endFrame) const
+{
+    notifyChanged({startFrame, endFrame, 1.0f, 0.0f});
+}
+
+void Project::notifyNoteChanged(const Note& note) const
+{
+    // Bounds cost a pass over the note's frames; skip them when nobody listens
+    if (changeCallback.function)
+        changeCallback.function(getNoteBounds(note));
+}
+
+ProjectChange Project::getNoteBounds(const Note& note) const
+{
+    const float offset = note.getPitchOffset();
+    ProjectChange bounds{note.getStartFrame(), note.getEndFrame(),
+                         note.getAdjustedMidiNote(), note.getAdjustedMidiNote()};
+
+    // The curve is drawn from base + delta (F0 where there is no base yet),
+    // moved by the note's offset and the global one
+    const auto& base = audioData.basePitch;
+    const auto& delta = audioData.deltaPitch;
+    const auto& f0 = audioData.f0;
+    const int end = std::min(note.getEndFrame(), static_cast<int>(f0.size()));
+    for (int i = std::max(0, note.getStartFrame()); i < end; ++i)
+    {
+        const auto frame = static_cast<size_t>(i);
+        float midi = frame < base.size() ? base[frame] : (f0[frame] > 0.0f ? freqToMidi(f0[frame]) : 0.0f);
+        if (frame < delta.size())
+            midi += delta[frame];
+        if (midi <= 0.0f)
+            continue;
+
+        midi += offset + globalPitchOffset;
+        bounds.lowMidi = std::min(bounds.lowMidi, midi);
+        bounds.highMidi = std::max(bounds.highMidi, midi);
+    }
+    return bounds;
+}
+
 bool Project::hasDirtyNotes() const
 {
-    for (const auto& note : notes)
+    for (size_t index : getNoteIndex().getDirty())
     {
-        if (note.isDirty())
+        if (notes[index].isDirty())
             return true;
     }
     return false;
@@ -118,14 +426,44 @@ std::pair<int, int> Project::getF0DirtyRange() const
     return {f0DirtyStart, f0DirtyEnd};
 }
 
+void Project::setTrackingRewrittenFrames(bool shouldTrack)
+{
+    trackingRewrittenFrames = shouldTrack;
+    rewrittenFrames.clear();
+}
+
+void Project::addRewrittenFrames(int startFrame, int endFrame)
+{
+    if (!trackingRewrittenFrames || startFrame >= endFrame)
+        return;
+
+    // Absorb the ranges this one overlaps or touches
+    auto first = std::lower_bound(rewrittenFrames.begin(), rewrittenFrames.end(), startFrame,
+                                  [](const std::pair<int, int>& range, int frame) { return range.second < frame; });
+    auto last = first;
+    for (; last != rewrittenFrames.end() && last->first <= endFrame; ++last)
+    {
+        startFrame = std::min(startFrame, last->first);
+        endFrame = std::max(endFrame, last->second);
+    }
+    first = rewrittenFrames.erase(first, last);
+    rewrittenFrames.insert(first, {startFrame, endFrame});
+}
+
+std::vector<std::pair<int, int>> Project::takeRewrittenFrames()
+{
+    return std::exchange(rewrittenFrames, {});
+}
+
 std::pair<int, int> Project::getDirtyFrameRange() const
 {
     int minStart = -1;
     int maxEnd = -1;
     
     // Check dirty notes
-    for (const auto& note : notes)
+    for (size_t index : getNoteIndex().getDirty())
     {
+        const auto& note = notes[index];
         if (note.isDirty())
         {
             if (minStart < 0 || note.getStartFrame() < minStart)
@@ -202,23 +540,35 @@ std::vector<float> Project::getAdjustedF0ForRange(int startFrame, int endFrame)
     const int rangeSize = endFrame - startFrame;
     std::vector<float> adjustedF0(static_cast<size_t>(rangeSize), 0.0f);
 
-    for (int i = 0; i < rangeSize; ++i)
+    // base + delta + global offset converted in one batch pass, with the UV
+    // mask applied by the kernel when it covers the range
+    const bool maskCovers = static_cast<int>(audioData.voicedMask.size()) >= endFrame;
+    const uint8_t* voiced = maskCovers ? audioData.voicedMask.data() : nullptr;
+    const int deltaEnd = std::clamp(static_cast<int>(audioData.deltaPitch.size()), startFrame, endFrame);
+    PitchMath::composeToFreq(audioData.basePitch.data() + startFrame,
+                             audioData.deltaPitch.data() + startFrame, globalPitchOffset,
+                             maskCovers ? voiced + startFrame : nullptr,
+                             adjustedF0.data(), static_cast<size_t>(deltaEnd - startFrame));
+    PitchMath::composeToFreq(audioData.basePitch.data() + deltaEnd, nullptr, globalPitchOffset,
+                             maskCovers ? voiced + deltaEnd : nullptr,
+                             adjustedF0.data() + (deltaEnd - startFrame), static_cast<size_t>(endFrame - deltaEnd));
+
+    if (!maskCovers)
     {
-        const int globalIdx = startFrame + i;
-        const float base = audioData.basePitch[static_cast<size_t>(globalIdx)];
-        const float delta = (globalIdx < static_cast<int>(audioData.deltaPitch.size()))
-                                ? audioData.deltaPitch[static_cast<size_t>(globalIdx)]
-                                : 0.0f;
-        float midi = base + delta + globalPitchOffset;
-        float freq = midiToFreq(midi);
-        if (globalIdx < static_cast<int>(audioData.voicedMask.size()) && !audioData.voicedMask[globalIdx])
-            freq = 0.0f;
-        adjustedF0[static_cast<size_t>(i)] = freq;
+        const int maskEnd = std::min(endFrame, static_cast<int>(audioData.voicedMask.size()));
+        for (int globalIdx = startFrame; globalIdx < maskEnd; ++globalIdx)
+        {
+            if (!audioData.voicedMask[static_cast<size_t>(globalIdx)])
+                adjustedF0[static_cast<size_t>(globalIdx - startFrame)] = 0.0f;
+        }
     }
 
     // Apply vibrato for overlapping notes
-    for (const auto& note : notes)
+    std::vector<size_t> overlapping;
+    getNoteIndex().findOverlapping(startFrame, endFrame, overlapping);
+    for (size_t index : overlapping)
     {
+        const auto& note = notes[index];
         const bool hasVibrato = note.isVibratoEnabled() &&
                                 note.getVibratoDepthSemitones() > 0.0001f &&
                                 note.getVibratoRateHz() > 0.0001f;
@@ -1,36 +1,86 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "CopyOnWrite.h"
+#include "MelFrames.h"
 #include "Note.h"
+#include "NoteIndex.h"
+#include "WaveformPeaks.h"
+#include <functional>
 #include <vector>
 #include <memory>
 
 /**
  * Container for audio data and extracted features.
+ *
+ * The waveform is copy-on-write and the mel frames are immutable: copying an
+ * AudioData (or a Project) shares them, and waveform.edit() detaches.
+ * Background work copies the project on the message thread and reads its
+ * copy while the UI keeps editing; writers such as incremental synthesis
+ * never touch a buffer a worker is reading.
+ *
+ * Both may be backed by memory-mapped scratch files for long recordings
+ * (see ScratchStorage); the dense curves are small and stay in memory.
+ *
+ * peaks summarises the waveform for drawing. Writers that replace samples in
+ * place update it over the same range; getPeaks() rebuilds it when the
+ * waveform itself was swapped.
  */
 struct AudioData
 {
-    juce::AudioBuffer<float> waveform;
+    CopyOnWrite<juce::AudioBuffer<float>> waveform;
+    CopyOnWrite<WaveformPeaks> peaks;                 // Drawing summary of waveform, see getPeaks()
     int sampleRate = 44100;
     
     // Extracted features
-    std::vector<std::vector<float>> melSpectrogram;  // [T, NUM_MELS]
+    MelFrames melSpectrogram;                         // [T, NUM_MELS]
     std::vector<float> f0;                            // [T] (composed: base + delta, dense)
     std::vector<float> baseF0;                        // [T] (cached base pitch in Hz)
     std::vector<float> basePitch;                     // [T] base pitch in MIDI (dense)
     std::vector<float> deltaPitch;                    // [T] delta pitch in MIDI (dense)
-    std::vector<bool> voicedMask;                     // [T] uv mask (true = voiced)
+    std::vector<uint8_t> voicedMask;                  // [T] uv mask (1 = voiced), one byte per frame for SIMD
     
     float getDuration() const
     {
-        if (waveform.getNumSamples() == 0) return 0.0f;
-        return static_cast<float>(waveform.getNumSamples()) / sampleRate;
+        if (waveform->getNumSamples() == 0) return 0.0f;
+        return static_cast<float>(waveform->getNumSamples()) / sampleRate;
     }
     
     int getNumFrames() const
     {
         return static_cast<int>(melSpectrogram.size());
     }
+
+    /** Peak pyramid of the current waveform; rebuilt here if the waveform was replaced. */
+    const WaveformPeaks& getPeaks()
+    {
+        if (!peaks->isBuiltFor(*waveform))
+            peaks.edit().build(*waveform);
+        return *peaks;
+    }
+};
+
+/**
+ * The part of a project an edit touched: a frame range and, where known, the
+ * pitches drawn over it (MIDI, offsets included). Views map it to the area
+ * they need to redraw.
+ */
+struct ProjectChange
+{
+    int startFrame = 0;
+    int endFrame = 0;
+    float lowMidi = 1.0f;   // lowMidi > highMidi: every pitch
+    float highMidi = 0.0f;
+
+    bool coversAllPitches() const { return lowMidi > highMidi; }
+
+    // The same change moved by semitones, e.g. a note being dragged
+    ProjectChange transposed(float semitones) const
+    {
+        if (coversAllPitches())
+            return *this;
+        return {startFrame, endFrame, lowMidi + semitones, highMidi + semitones};
+    }
 };
 
 /**
@@ -55,18 +105,69 @@ public:
     const AudioData& getAudioData() const { return audioData; }
     
     // Notes
-    std::vector<Note>& getNotes() { return notes; }
+    // Changes go through the members below, which keep the note index
+    // current; there is no mutable access to the vector itself.
     const std::vector<Note>& getNotes() const { return notes; }
-    void addNote(Note note) { notes.push_back(std::move(note)); }
-    void clearNotes() { notes.clear(); }
+    void addNote(Note note);
+    void clearNotes();
+    // Replace every note at once; the index is rebuilt by the next query
+    void setNotes(std::vector<Note> newNotes);
+    // Overwrite a note owned by this project, re-filing it in place
+    void replaceNote(Note* note, const Note& replacement);
+    // Remove the notes overlapping [startFrame, endFrame)
+    void removeNotesInRange(int startFrame, int endFrame);
+    // Notes that are not rests, kept current by the members above, O(1)
+    size_t getPitchedNoteCount() const { return pitchedNoteCount; }
 
+    // Indexed lookups (O(log n) plus the number of hits)
     Note* getNoteAtFrame(int frame);
     std::vector<Note*> getNotesInRange(int startFrame, int endFrame);
+    std::vector<const Note*> getNotesInRange(int startFrame, int endFrame) const;
+    // Notes over the frames whose adjusted MIDI note is in [lowMidi, highMidi]
+    std::vector<Note*> getNotesInArea(int startFrame, int endFrame, float lowMidi, float highMidi);
+    // Start order (equal starts in vector order), O(log n) per step; nullptr past either end
+    const Note* getFirstNoteStartingFrom(int frame) const;
+    const Note* getLastNoteStartingBefore(int frame) const;
+    const Note* getNextNoteByStart(const Note* note) const;
+    const Note* getPreviousNoteByStart(const Note* note) const;
+    // Notes starting in [startFrame, endFrame), in start order
+    std::vector<const Note*> getNotesStartingIn(int startFrame, int endFrame) const;
     std::vector<Note*> getSelectedNotes();
+    bool hasSelectedNotes() const;
+    Note* getNoteStartingAt(int startFrame);  // First in vector order, or nullptr
     bool removeNoteByStartFrame(int startFrame);
     std::vector<Note*> getDirtyNotes();
     void deselectAllNotes();
     void clearAllDirty();
+
+    // Selection / dirty changes on notes owned by this project go through
+    // these so the selected and dirty side indexes stay current
+    void setNoteSelected(Note* note, bool selected);
+    void markNoteDirty(Note* note);
+    void clearNoteDirty(Note* note);
+    void markAllNotesDirty();
+
+    // Pitch and extent changes on notes owned by this project go through
+    // these so the note index stays current without a rebuild.
+    // setNotePitch() sends no notification, since callers report the
+    // pitch they moved from and to themselves.
+    void setNotePitch(Note* note, float midiNote, float pitchOffset);
+    void setNoteRange(Note* note, int startFrame, int endFrame);
+
+    // Change notifications, so views redraw only what an edit touched. The
+    // note mutators above send them; code that writes notes or curves
+    // directly (pitch offsets, F0) calls notifyChanged() itself. Message
+    // thread only. A copied project starts without a callback.
+    using ChangeCallback = std::function<void(const ProjectChange&)>;
+    void setChangeCallback(ChangeCallback callback) { changeCallback.function = std::move(callback); }
+    bool hasChangeCallback() const { return changeCallback.function != nullptr; }
+    void notifyChanged(const ProjectChange& change) const;
+    void notifyFramesChanged(int startFrame, int endFrame) const;  // Every pitch over the frames
+    void notifyNoteChanged(const Note& note) const;                // getNoteBounds(note)
+
+    // Frames and pitches a note is drawn over: its body at the current
+    // offset and its composed pitch curve. O(note length).
+    ProjectChange getNoteBounds(const Note& note) const;
     
     // Global settings
     float getGlobalPitchOffset() const { return globalPitchOffset; }
@@ -96,6 +197,14 @@ public:
     void clearF0DirtyRange();
     bool hasF0DirtyRange() const;
     std::pair<int, int> getF0DirtyRange() const;
+
+    // Curve frames rewritten by PitchCurveProcessor, which reports every
+    // range it rebuilds; base pitch smoothing reaches past the edited notes,
+    // so this is wider than the edit. Collected (sorted and merged) only
+    // while tracking is on, until taken, e.g. by the edit journal.
+    void setTrackingRewrittenFrames(bool shouldTrack);
+    void addRewrittenFrames(int startFrame, int endFrame);
+    std::vector<std::pair<int, int>> takeRewrittenFrames();
     
     // Modified state
     bool isModified() const { return modified; }
@@ -108,6 +217,12 @@ private:
     
     AudioData audioData;
     std::vector<Note> notes;
+    size_t pitchedNoteCount = 0;
+
+    // Lazily rebuilt after structural edits; queries are message-thread only
+    mutable NoteIndex noteIndex;
+    const NoteIndex& getNoteIndex() const;
+    size_t indexOf(const Note* note) const;
     
     float globalPitchOffset = 0.0f;
     float formantShift = 0.0f;
@@ -116,6 +231,20 @@ private:
     // F0 direct edit dirty range
     int f0DirtyStart = -1;
     int f0DirtyEnd = -1;
+
+    bool trackingRewrittenFrames = false;
+    std::vector<std::pair<int, int>> rewrittenFrames;
+
+    // Belongs to whoever shows this project, so copies do not take it along
+    struct ChangeCallbackHolder
+    {
+        ChangeCallback function;
+
+        ChangeCallbackHolder() = default;
+        ChangeCallbackHolder(const ChangeCallbackHolder&) {}
+        ChangeCallbackHolder& operator=(const ChangeCallbackHolder&) { return *this; }
+    };
+    ChangeCallbackHolder changeCallback;
     
     bool modified = false;
 };
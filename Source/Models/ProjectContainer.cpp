@@ -0,0 +1,317 @@
+#include "ProjectContainer.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// Typed arrays are stored in host byte order, which is little-endian on every
+// platform we build for; header and directory fields go through ByteOrder.
+
+namespace {
+    constexpr char MAGIC[4] = {'H', 'T', 'P', 'X'};
+    constexpr size_t HEADER_SIZE = 32;
+    constexpr size_t DIRECTORY_ENTRY_SIZE = 48;
+    constexpr int64_t PAYLOAD_ALIGNMENT = 64;
+    constexpr int COMPRESSION_LEVEL = 6;
+
+    // Deflate cannot shrink data by more than about 1032:1, so a section
+    // claiming more is corrupt rather than merely well compressed
+    constexpr uint64_t MAX_ZLIB_RATIO = 1032;
+
+    size_t elementSize(ProjectContainer::SectionType type) {
+        switch (type) {
+            case ProjectContainer::SectionType::Float32: return sizeof(float);
+            case ProjectContainer::SectionType::UInt8:   return 1;
+            case ProjectContainer::SectionType::Blob:    return 1;
+        }
+        return 1;
+    }
+
+    juce::MemoryBlock compressBlock(const void* data, size_t numBytes) {
+        juce::MemoryOutputStream compressed;
+        {
+            juce::GZIPCompressorOutputStream zlib(compressed, COMPRESSION_LEVEL);
+            zlib.write(data, numBytes);
+            zlib.flush();
+        }
+        return compressed.getMemoryBlock();
+    }
+}
+
+bool ProjectContainer::isContainerFile(const juce::File& file) {
+    juce::FileInputStream input(file);
+    if (!input.openedOk())
+        return false;
+
+    char magic[4] = {};
+    return input.read(magic, 4) == 4 && std::memcmp(magic, MAGIC, 4) == 0;
+}
+
+//==============================================================================
+ProjectContainer::Writer::Writer(const juce::File& file)
+    : tempFile(file) {
+    stream = tempFile.getFile().createOutputStream();
+    if (stream == nullptr || stream->failedToOpen()) {
+        stream.reset();
+        ok = false;
+        return;
+    }
+
+    // Header is patched in finish() once the directory offset is known
+    char header[HEADER_SIZE] = {};
+    ok = stream->write(header, HEADER_SIZE);
+}
+
+ProjectContainer::Writer::~Writer() = default;
+
+void ProjectContainer::Writer::padToAlignment() {
+    const auto pos = stream->getPosition();
+    const auto padding = (PAYLOAD_ALIGNMENT - pos % PAYLOAD_ALIGNMENT) % PAYLOAD_ALIGNMENT;
+    if (padding > 0)
+        ok = ok && stream->writeRepeatedByte(0, static_cast<size_t>(padding));
+}
+
+void ProjectContainer::Writer::writeSection(Section section, const void* data, size_t numBytes) {
+    if (!isOpen() || !ok)
+        return;
+
+    section.rawSize = numBytes;
+
+    juce::MemoryBlock compressed;
+    if ((section.flags & FLAG_ZLIB) != 0 && numBytes > 0) {
+        compressed = compressBlock(data, numBytes);
+        data = compressed.getData();
+        numBytes = compressed.getSize();
+    }
+
+    padToAlignment();
+    section.offset = static_cast<uint64_t>(stream->getPosition());
+    section.storedSize = numBytes;
+    if (numBytes > 0)
+        ok = ok && stream->write(data, numBytes);
+
+    sections.push_back(section);
+}
+
+void ProjectContainer::Writer::addBlob(uint32_t tag, const void* data, size_t numBytes, bool compress) {
+    Section section;
+    section.tag = tag;
+    section.type = SectionType::Blob;
+    section.flags = compress ? FLAG_ZLIB : 0;
+    section.count = numBytes;
+    writeSection(section, data, numBytes);
+}
+
+void ProjectContainer::Writer::addFloats(uint32_t tag, const float* data, size_t count, bool compress) {
+    Section section;
+    section.tag = tag;
+    section.type = SectionType::Float32;
+    section.flags = compress ? FLAG_ZLIB : 0;
+    section.count = count;
+    writeSection(section, data, count * sizeof(float));
+}
+
+void ProjectContainer::Writer::addBytes(uint32_t tag, const uint8_t* data, size_t count, bool compress) {
+    Section section;
+    section.tag = tag;
+    section.type = SectionType::UInt8;
+    section.flags = compress ? FLAG_ZLIB : 0;
+    section.count = count;
+    writeSection(section, data, count);
+}
+
+void ProjectContainer::Writer::addFloatMatrix(uint32_t tag, const float* data, size_t rows,
+                                              uint32_t columns, bool compress) {
+    if (columns == 0)
+        return;
+
+    Section section;
+    section.tag = tag;
+    section.type = SectionType::Float32;
+    section.flags = compress ? FLAG_ZLIB : 0;
+    section.columns = columns;
+    section.count = rows;
+    writeSection(section, data, rows * columns * sizeof(float));
+}
+
+bool ProjectContainer::Writer::finish() {
+    if (!isOpen() || !ok)
+        return false;
+
+    padToAlignment();
+    const auto directoryOffset = static_cast<uint64_t>(stream->getPosition());
+
+    for (const auto& section : sections) {
+        ok = ok && stream->writeInt(static_cast<int>(section.tag))
+                && stream->writeInt(static_cast<int>(section.type))
+                && stream->writeInt(static_cast<int>(section.flags))
+                && stream->writeInt(static_cast<int>(section.columns))
+                && stream->writeInt64(static_cast<juce::int64>(section.offset))
+                && stream->writeInt64(static_cast<juce::int64>(section.storedSize))
+                && stream->writeInt64(static_cast<juce::int64>(section.rawSize))
+                && stream->writeInt64(static_cast<juce::int64>(section.count));
+    }
+
+    ok = ok && stream->setPosition(0)
+            && stream->write(MAGIC, 4)
+            && stream->writeInt(static_cast<int>(CONTAINER_VERSION))
+            && stream->writeInt(static_cast<int>(sections.size()))
+            && stream->writeInt(0)
+            && stream->writeInt64(static_cast<juce::int64>(directoryOffset))
+            && stream->writeInt64(0);
+
+    stream->flush();
+    ok = ok && stream->getStatus().wasOk();
+    stream.reset();
+
+    return ok && tempFile.overwriteTargetFileWithTemporary();
+}
+
+//==============================================================================
+ProjectContainer::Reader::Reader(const juce::File& file) {
+    mapped = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+
+    const auto* base = static_cast<const uint8_t*>(mapped->getData());
+    const auto fileSize = static_cast<uint64_t>(mapped->getSize());
+    if (base == nullptr || fileSize < HEADER_SIZE || std::memcmp(base, MAGIC, 4) != 0)
+        return;
+
+    version = juce::ByteOrder::littleEndianInt(base + 4);
+    const auto sectionCount = juce::ByteOrder::littleEndianInt(base + 8);
+    const auto directoryOffset = juce::ByteOrder::littleEndianInt64(base + 16);
+
+    if (version == 0 || version > CONTAINER_VERSION)
+        return;
+    if (directoryOffset > fileSize
+        || (fileSize - directoryOffset) / DIRECTORY_ENTRY_SIZE < sectionCount)
+        return;
+
+    sections.reserve(sectionCount);
+    for (uint32_t i = 0; i < sectionCount; ++i) {
+        const auto* entry = base + directoryOffset + i * DIRECTORY_ENTRY_SIZE;
+
+        Section section;
+        section.tag = juce::ByteOrder::littleEndianInt(entry);
+        section.type = static_cast<SectionType>(juce::ByteOrder::littleEndianInt(entry + 4));
+        section.flags = juce::ByteOrder::littleEndianInt(entry + 8);
+        section.columns = juce::ByteOrder::littleEndianInt(entry + 12);
+        section.offset = juce::ByteOrder::littleEndianInt64(entry + 16);
+        section.storedSize = juce::ByteOrder::littleEndianInt64(entry + 24);
+        section.rawSize = juce::ByteOrder::littleEndianInt64(entry + 32);
+        section.count = juce::ByteOrder::littleEndianInt64(entry + 40);
+
+        if (section.offset > fileSize || section.storedSize > fileSize - section.offset)
+            return;
+
+        sections.push_back(section);
+    }
+
+    valid = true;
+}
+
+const ProjectContainer::Section* ProjectContainer::Reader::findSection(uint32_t tag) const {
+    for (const auto& section : sections) {
+        if (section.tag == tag)
+            return &section;
+    }
+    return nullptr;
+}
+
+const uint8_t* ProjectContainer::Reader::getPayload(const Section& section, SectionType expectedType,
+                                                    juce::MemoryBlock& scratch) const {
+    if (section.type != expectedType || section.columns == 0)
+        return nullptr;
+
+    // Checked in 64 bits without wrapping, so a corrupt count cannot pass for
+    // a small size
+    const uint64_t rowBytes = static_cast<uint64_t>(section.columns) * elementSize(section.type);
+    if (section.count > std::numeric_limits<uint64_t>::max() / rowBytes
+        || section.rawSize != section.count * rowBytes)
+        return nullptr;
+
+    const auto* stored = static_cast<const uint8_t*>(mapped->getData()) + section.offset;
+
+    if ((section.flags & FLAG_ZLIB) == 0)
+        return section.storedSize == section.rawSize ? stored : nullptr;
+
+    if (section.rawSize / MAX_ZLIB_RATIO > section.storedSize
+        || section.rawSize > std::numeric_limits<size_t>::max())
+        return nullptr;
+
+    juce::MemoryInputStream source(stored, static_cast<size_t>(section.storedSize), false);
+    juce::GZIPDecompressorInputStream zlib(source);
+
+    scratch.setSize(static_cast<size_t>(section.rawSize));
+    auto* dest = static_cast<char*>(scratch.getData());
+    uint64_t remaining = section.rawSize;
+
+    // InputStream::read takes an int, so large sections are read in pieces
+    while (remaining > 0) {
+        const int chunk = static_cast<int>(std::min<uint64_t>(remaining, 1u << 30));
+        const int got = zlib.read(dest, chunk);
+        if (got <= 0)
+            return nullptr;
+        dest += got;
+        remaining -= static_cast<uint64_t>(got);
+    }
+
+    return static_cast<const uint8_t*>(scratch.getData());
+}
+
+bool ProjectContainer::Reader::readBlob(uint32_t tag, juce::MemoryBlock& out) const {
+    const auto* section = findSection(tag);
+    if (section == nullptr)
+        return false;
+
+    juce::MemoryBlock scratch;
+    const auto* payload = getPayload(*section, SectionType::Blob, scratch);
+    if (payload == nullptr)
+        return false;
+
+    out.replaceAll(payload, static_cast<size_t>(section->rawSize));
+    return true;
+}
+
+bool ProjectContainer::Reader::readFloats(uint32_t tag, std::vector<float>& out) const {
+    const auto* section = findSection(tag);
+    if (section == nullptr || section->columns != 1)
+        return false;
+
+    juce::MemoryBlock scratch;
+    const auto* payload = getPayload(*section, SectionType::Float32, scratch);
+    if (payload == nullptr)
+        return false;
+
+    out.resize(static_cast<size_t>(section->count));
+    if (!out.empty())
+        std::memcpy(out.data(), payload, out.size() * sizeof(float));
+    return true;
+}
+
+bool ProjectContainer::Reader::readFloats(uint32_t tag, float* out, size_t count) const {
+    const auto* section = findSection(tag);
+    if (section == nullptr || section->count * section->columns != count)
+        return false;
+
+    juce::MemoryBlock scratch;
+    const auto* payload = getPayload(*section, SectionType::Float32, scratch);
+    if (payload == nullptr)
+        return false;
+
+    if (count > 0)
+        std::memcpy(out, payload, count * sizeof(float));
+    return true;
+}
+
+bool ProjectContainer::Reader::readBytes(uint32_t tag, std::vector<uint8_t>& out) const {
+    const auto* section = findSection(tag);
+    if (section == nullptr || section->columns != 1)
+        return false;
+
+    juce::MemoryBlock scratch;
+    const auto* payload = getPayload(*section, SectionType::UInt8, scratch);
+    if (payload == nullptr)
+        return false;
+
+    out.assign(payload, payload + section->count);
+    return true;
+}
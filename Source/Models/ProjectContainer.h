@@ -0,0 +1,125 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Versioned binary container for project files.
+ *
+ * Layout (little-endian):
+ * - 32-byte header: magic "HTPX", container version, section count,
+ *   directory offset
+ * - Section payloads, each starting on a 64-byte boundary
+ * - Section directory: one fixed-size entry per section with its tag,
+ *   element type, flags, offset and sizes
+ *
+ * Sections are identified by a four-character tag and are either raw typed
+ * arrays (float32 / uint8, optionally with a row width) or opaque blobs.
+ * Any section may be zlib-compressed. Uncompressed sections are read
+ * straight out of a memory-mapped view of the file, so only the sections
+ * that are asked for are ever paged in.
+ */
+class ProjectContainer {
+public:
+    static constexpr uint32_t CONTAINER_VERSION = 1;
+
+    enum class SectionType : uint32_t {
+        Blob = 0,
+        Float32 = 1,
+        UInt8 = 2
+    };
+
+    static constexpr uint32_t makeTag(char a, char b, char c, char d) {
+        return static_cast<uint32_t>(static_cast<uint8_t>(a))
+             | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8)
+             | (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16)
+             | (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+    }
+
+    struct Section {
+        uint32_t tag = 0;
+        SectionType type = SectionType::Blob;
+        uint32_t flags = 0;       // FLAG_* bits
+        uint32_t columns = 1;     // Row width for 2D arrays
+        uint64_t offset = 0;      // Payload offset from start of file
+        uint64_t storedSize = 0;  // Bytes on disk
+        uint64_t rawSize = 0;     // Bytes after decompression
+        uint64_t count = 0;       // Elements (or rows when columns > 1)
+    };
+
+    static constexpr uint32_t FLAG_ZLIB = 1u << 0;
+
+    /** True if the file starts with the container magic. */
+    static bool isContainerFile(const juce::File& file);
+
+    /**
+     * Streams sections to a file. Payloads are written as they are added;
+     * the directory and header are written by finish().
+     */
+    class Writer {
+    public:
+        explicit Writer(const juce::File& file);
+        ~Writer();
+
+        bool isOpen() const { return stream != nullptr; }
+
+        void addBlob(uint32_t tag, const void* data, size_t numBytes, bool compress);
+        void addFloats(uint32_t tag, const float* data, size_t count, bool compress);
+        void addFloatMatrix(uint32_t tag, const float* data, size_t rows,
+                            uint32_t columns, bool compress);
+        void addBytes(uint32_t tag, const uint8_t* data, size_t count, bool compress);
+
+        /** Writes directory + header and replaces the target file. */
+        bool finish();
+
+    private:
+        void writeSection(Section section, const void* data, size_t numBytes);
+        void padToAlignment();
+
+        juce::TemporaryFile tempFile;
+        std::unique_ptr<juce::FileOutputStream> stream;
+        std::vector<Section> sections;
+        bool ok = true;
+
+        JUCE_DECLARE_NON_COPYABLE(Writer)
+    };
+
+    /**
+     * Maps a container file read-only and decodes sections on request.
+     */
+    class Reader {
+    public:
+        explicit Reader(const juce::File& file);
+
+        bool isValid() const { return valid; }
+        uint32_t getVersion() const { return version; }
+
+        const Section* findSection(uint32_t tag) const;
+
+        bool readBlob(uint32_t tag, juce::MemoryBlock& out) const;
+        bool readFloats(uint32_t tag, std::vector<float>& out) const;
+        /** Copies all values of a float section (rows * columns) into out. */
+        bool readFloats(uint32_t tag, float* out, size_t count) const;
+        bool readBytes(uint32_t tag, std::vector<uint8_t>& out) const;
+
+    private:
+        /**
+         * Returns a pointer to the section's raw bytes: straight into the
+         * mapping when uncompressed, otherwise into `scratch`.
+         */
+        const uint8_t* getPayload(const Section& section, SectionType expectedType,
+                                  juce::MemoryBlock& scratch) const;
+
+        std::unique_ptr<juce::MemoryMappedFile> mapped;
+        std::vector<Section> sections;
+        uint32_t version = 0;
+        bool valid = false;
+
+        JUCE_DECLARE_NON_COPYABLE(Reader)
+    };
+
+private:
+    ProjectContainer() = delete;
+};
@@ -1,14 +1,46 @@
 #include "ProjectSerializer.h"
+#include "ProjectContainer.h"
+#include "../Utils/Constants.h"
 #include "../Utils/PitchCurveProcessor.h"
 
-bool ProjectSerializer::saveToFile(const Project& project, const juce::File& file) {
+namespace {
+    // Section tags of the binary project file
+    constexpr uint32_t TAG_METADATA    = ProjectContainer::makeTag('M', 'E', 'T', 'A');
+    constexpr uint32_t TAG_NOTES       = ProjectContainer::makeTag('N', 'O', 'T', 'E');
+    constexpr uint32_t TAG_F0          = ProjectContainer::makeTag('F', '0', ' ', ' ');
+    constexpr uint32_t TAG_BASE_PITCH  = ProjectContainer::makeTag('B', 'P', 'I', 'T');
+    constexpr uint32_t TAG_DELTA_PITCH = ProjectContainer::makeTag('D', 'P', 'I', 'T');
+    constexpr uint32_t TAG_VOICED      = ProjectContainer::makeTag('V', 'O', 'I', 'C');
+    constexpr uint32_t TAG_MEL         = ProjectContainer::makeTag('M', 'E', 'L', ' ');
+
+    // Bytes per note record before its two strings
+    constexpr int NOTE_RECORD_MIN_SIZE = 4 * 2 + 4 * 2 + 1 + 1 + 4 * 3 + 2;
+}
+
+bool ProjectSerializer::saveToFile(const Project& project, const juce::File& file,
+                                   const ProjectSaveOptions& options) {
+    if (file.hasFileExtension("json"))
+        return exportToJson(project, file);
+
+    return saveToContainer(project, file, options);
+}
+
+bool ProjectSerializer::loadFromFile(Project& project, const juce::File& file, bool loadMelCache) {
+    if (ProjectContainer::isContainerFile(file))
+        return loadFromContainer(project, file, loadMelCache);
+
+    // Older project files are plain JSON
+    return importFromJson(project, file);
+}
+
+bool ProjectSerializer::exportToJson(const Project& project, const juce::File& file) {
     auto json = toJson(project);
     auto jsonString = juce::JSON::toString(json, true); // Pretty print
 
     return file.replaceWithText(jsonString);
 }
 
-bool ProjectSerializer::loadFromFile(Project& project, const juce::File& file) {
+bool ProjectSerializer::importFromJson(Project& project, const juce::File& file) {
     auto jsonString = file.loadFileAsString();
     if (jsonString.isEmpty())
         return false;
@@ -20,21 +52,191 @@ bool ProjectSerializer::loadFromFile(Project& project, const juce::File& file) {
     return fromJson(project, json);
 }
 
-juce::var ProjectSerializer::toJson(const Project& project) {
-    auto* obj = new juce::DynamicObject();
+bool ProjectSerializer::saveToContainer(const Project& project, const juce::File& file,
+                                        const ProjectSaveOptions& options) {
+    ProjectContainer::Writer writer(file);
+    if (!writer.isOpen())
+        return false;
+
+    // Metadata stays JSON: it is tiny and easy to extend
+    auto* metadata = new juce::DynamicObject();
+    metadataToJson(project, *metadata);
+    const auto metadataText = juce::JSON::toString(juce::var(metadata), true);
+    writer.addBlob(TAG_METADATA, metadataText.toRawUTF8(), metadataText.getNumBytesAsUTF8(), false);
+
+    const auto notesData = notesToBinary(project.getNotes());
+    writer.addBlob(TAG_NOTES, notesData.getData(), notesData.getSize(), true);
+
+    const auto& audioData = project.getAudioData();
+    const bool compress = options.compressCurves;
+    writer.addFloats(TAG_F0, audioData.f0.data(), audioData.f0.size(), compress);
+    writer.addFloats(TAG_BASE_PITCH, audioData.basePitch.data(), audioData.basePitch.size(), compress);
+    writer.addFloats(TAG_DELTA_PITCH, audioData.deltaPitch.data(), audioData.deltaPitch.size(), compress);
+
+    writer.addBytes(TAG_VOICED, audioData.voicedMask.data(), audioData.voicedMask.size(), true);
+
+    const auto& mel = audioData.melSpectrogram;
+    if (options.includeMelCache && !mel.empty() && mel.getNumMels() == NUM_MELS)
+        writer.addFloatMatrix(TAG_MEL, mel[0], mel.size(), NUM_MELS, compress);
+
+    return writer.finish();
+}
+
+bool ProjectSerializer::loadFromContainer(Project& project, const juce::File& file, bool loadMelCache) {
+    ProjectContainer::Reader reader(file);
+    if (!reader.isValid())
+        return false;
+
+    juce::MemoryBlock metadataBlock;
+    if (!reader.readBlob(TAG_METADATA, metadataBlock))
+        return false;
+
+    auto metadata = juce::JSON::parse(metadataBlock.toString());
+    if (!metadata.isObject())
+        return false;
+
+    // Everything is decoded before the project is touched. A section that is
+    // there but does not decode means a corrupt or truncated file; only the
+    // mel cache below may be dropped, since it is rebuilt from the audio.
+    const auto present = [&reader](uint32_t tag) { return reader.findSection(tag) != nullptr; };
+
+    juce::MemoryBlock notesBlock;
+    std::vector<Note> notes;
+    if (present(TAG_NOTES) && !(reader.readBlob(TAG_NOTES, notesBlock) && notesFromBinary(notesBlock, notes)))
+        return false;
+
+    // Dense curves are copied straight out of the mapped file
+    std::vector<float> f0, basePitch, deltaPitch;
+    std::vector<uint8_t> voicedMask;
+    if ((present(TAG_F0) && !reader.readFloats(TAG_F0, f0))
+        || (present(TAG_BASE_PITCH) && !reader.readFloats(TAG_BASE_PITCH, basePitch))
+        || (present(TAG_DELTA_PITCH) && !reader.readFloats(TAG_DELTA_PITCH, deltaPitch))
+        || (present(TAG_VOICED) && !reader.readBytes(TAG_VOICED, voicedMask)))
+        return false;
+
+    metadataFromJson(project, metadata);
+    project.setNotes(std::move(notes));
+
+    auto& audioData = project.getAudioData();
+    audioData.f0 = std::move(f0);
+    audioData.baseF0 = audioData.f0;
+    audioData.basePitch = std::move(basePitch);
+    audioData.deltaPitch = std::move(deltaPitch);
+    audioData.voicedMask = std::move(voicedMask);
+
+    // The mel cache is by far the largest section; it is only paged in when
+    // asked for and when it still matches the curves
+    if (loadMelCache) {
+        const auto* mel = reader.findSection(TAG_MEL);
+        if (mel != nullptr && mel->columns == static_cast<uint32_t>(NUM_MELS)
+            && mel->count == audioData.f0.size() && mel->count > 0) {
+            MelFrames frames(static_cast<size_t>(mel->count), NUM_MELS);
+            if (reader.readFloats(TAG_MEL, frames.getWritePointer(0), frames.size() * NUM_MELS))
+                audioData.melSpectrogram = std::move(frames);
+        }
+    }
+
+    finishLoad(project);
+    return true;
+}
+
+juce::MemoryBlock ProjectSerializer::notesToBinary(const std::vector<Note>& notes) {
+    juce::MemoryOutputStream out;
+    out.writeInt(static_cast<int>(notes.size()));
+
+    for (const auto& note : notes) {
+        out.writeInt(note.getStartFrame());
+        out.writeInt(note.getEndFrame());
+        out.writeFloat(note.getMidiNote());
+        out.writeFloat(note.getPitchOffset());
+        out.writeBool(note.isRest());
+        out.writeBool(note.isVibratoEnabled());
+        out.writeFloat(note.getVibratoRateHz());
+        out.writeFloat(note.getVibratoDepthSemitones());
+        out.writeFloat(note.getVibratoPhaseRadians());
+        out.writeString(note.getLyric());
+        out.writeString(note.getPhoneme());
+    }
+
+    return out.getMemoryBlock();
+}
+
+bool ProjectSerializer::notesFromBinary(const juce::MemoryBlock& data, std::vector<Note>& notes) {
+    juce::MemoryInputStream in(data, false);
+
+    notes.clear();
+    const int count = in.readInt();
+    if (count < 0 || static_cast<juce::int64>(count) * NOTE_RECORD_MIN_SIZE > in.getNumBytesRemaining())
+        return false;
+
+    notes.reserve(static_cast<size_t>(count));
+
+    for (int i = 0; i < count; ++i) {
+        if (in.getNumBytesRemaining() < NOTE_RECORD_MIN_SIZE)
+            return false;
+
+        Note note;
+        note.setStartFrame(in.readInt());
+        note.setEndFrame(in.readInt());
+        note.setMidiNote(in.readFloat());
+        note.setPitchOffset(in.readFloat());
+        note.setRest(in.readBool());
+        note.setVibratoEnabled(in.readBool());
+        note.setVibratoRateHz(in.readFloat());
+        note.setVibratoDepthSemitones(in.readFloat());
+        note.setVibratoPhaseRadians(in.readFloat());
+        note.setLyric(in.readString());
+        note.setPhoneme(in.readString());
+        notes.push_back(std::move(note));
+    }
 
+    return true;
+}
+
+void ProjectSerializer::metadataToJson(const Project& project, juce::DynamicObject& obj) {
+    // Metadata
+    obj.setProperty("formatVersion", FORMAT_VERSION);
+    obj.setProperty("name", project.getName());
+    obj.setProperty("audioPath", project.getFilePath().getFullPathName());
+
+    // Audio settings
+    obj.setProperty("sampleRate", project.getAudioData().sampleRate);
+
+    // Global parameters
+    obj.setProperty("globalPitchOffset", project.getGlobalPitchOffset());
+    obj.setProperty("formantShift", project.getFormantShift());
+    obj.setProperty("volume", project.getVolume());
+}
+
+void ProjectSerializer::metadataFromJson(Project& project, const juce::var& json) {
     // Metadata
-    obj->setProperty("formatVersion", FORMAT_VERSION);
-    obj->setProperty("name", project.getName());
-    obj->setProperty("audioPath", project.getFilePath().getFullPathName());
+    project.setName(json.getProperty("name", "Untitled").toString());
+    project.setFilePath(juce::File(json.getProperty("audioPath", "").toString()));
 
     // Audio settings
-    obj->setProperty("sampleRate", project.getAudioData().sampleRate);
+    project.getAudioData().sampleRate = json.getProperty("sampleRate", 44100);
 
     // Global parameters
-    obj->setProperty("globalPitchOffset", project.getGlobalPitchOffset());
-    obj->setProperty("formantShift", project.getFormantShift());
-    obj->setProperty("volume", project.getVolume());
+    project.setGlobalPitchOffset(static_cast<float>(json.getProperty("globalPitchOffset", 0.0)));
+    project.setFormantShift(static_cast<float>(json.getProperty("formantShift", 0.0)));
+    project.setVolume(static_cast<float>(json.getProperty("volume", 0.0)));
+}
+
+void ProjectSerializer::finishLoad(Project& project) {
+    auto& audioData = project.getAudioData();
+
+    // Rebuild curves if needed
+    if (!audioData.f0.empty() && (audioData.basePitch.empty() || audioData.deltaPitch.empty())) {
+        PitchCurveProcessor::rebuildCurvesFromSource(project, audioData.f0);
+    }
+
+    project.setModified(false);
+}
+
+juce::var ProjectSerializer::toJson(const Project& project) {
+    auto* obj = new juce::DynamicObject();
+
+    metadataToJson(project, *obj);
 
     // Notes array
     juce::Array<juce::var> notesArray;
@@ -53,18 +255,8 @@ bool ProjectSerializer::fromJson(Project& project, const juce::var& json) {
     if (!json.isObject())
         return false;
 
-    // Metadata
-    project.setName(json.getProperty("name", "Untitled").toString());
-    project.setFilePath(juce::File(json.getProperty("audioPath", "").toString()));
-
-    // Audio settings
+    metadataFromJson(project, json);
     auto& audioData = project.getAudioData();
-    audioData.sampleRate = json.getProperty("sampleRate", 44100);
-
-    // Global parameters
-    project.setGlobalPitchOffset(static_cast<float>(json.getProperty("globalPitchOffset", 0.0)));
-    project.setFormantShift(static_cast<float>(json.getProperty("formantShift", 0.0)));
-    project.setVolume(static_cast<float>(json.getProperty("volume", 0.0)));
 
     // Notes
     project.clearNotes();
@@ -84,12 +276,7 @@ bool ProjectSerializer::fromJson(Project& project, const juce::var& json) {
         pitchDataFromJson(audioData, pitchDataVar);
     }
 
-    // Rebuild curves if needed
-    if (!audioData.f0.empty() && (audioData.basePitch.empty() || audioData.deltaPitch.empty())) {
-        PitchCurveProcessor::rebuildCurvesFromSource(project, audioData.f0);
-    }
-
-    project.setModified(false);
+    finishLoad(project);
     return true;
 }
 
@@ -207,29 +394,29 @@ std::vector<float> ProjectSerializer::stringToFloatArray(const juce::String& str
     return result;
 }
 
-juce::String ProjectSerializer::boolArrayToString(const std::vector<bool>& arr) {
+juce::String ProjectSerializer::boolArrayToString(const std::vector<uint8_t>& arr) {
     if (arr.empty())
         return {};
 
     juce::String result;
     result.preallocateBytes(arr.size());
 
-    for (bool b : arr) {
-        result << (b ? '1' : '0');
+    for (uint8_t b : arr) {
+        result << (b != 0 ? '1' : '0');
     }
 
     return result;
 }
 
-std::vector<bool> ProjectSerializer::stringToBoolArray(const juce::String& str) {
+std::vector<uint8_t> ProjectSerializer::stringToBoolArray(const juce::String& str) {
     if (str.isEmpty())
         return {};
 
-    std::vector<bool> result;
+    std::vector<uint8_t> result;
     result.reserve(static_cast<size_t>(str.length()));
 
     for (int i = 0; i < str.length(); ++i) {
-        result.push_back(str[i] == '1');
+        result.push_back(str[i] == '1' ? 1 : 0);
     }
 
     return result;
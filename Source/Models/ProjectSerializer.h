@@ -4,11 +4,24 @@
 #include "Project.h"
 
 /**
- * Handles Project serialization to/from JSON format.
+ * Options for binary project files.
+ */
+struct ProjectSaveOptions {
+    bool includeMelCache = true;   // Store the mel spectrogram so it need not be recomputed
+    bool compressCurves = false;   // zlib the dense curves (smaller, but no direct mapping)
+};
+
+/**
+ * Handles Project serialization.
+ *
+ * Project files are binary ProjectContainer files with one section each for
+ * metadata, notes, every dense pitch curve and the mel cache. The earlier
+ * JSON format is still read, and can be written explicitly for export and
+ * for plugin state.
  *
  * Design principles:
  * - Decoupled from Project class (Project doesn't know about serialization details)
- * - Uses JUCE's built-in JSON support (no external dependencies)
+ * - Uses JUCE's built-in JSON and zlib support (no external dependencies)
  * - Stateless utility class
  */
 class ProjectSerializer {
@@ -16,14 +29,29 @@ public:
     static constexpr int FORMAT_VERSION = 1;
 
     /**
-     * Save project to JSON file.
+     * Save project to file: binary container, or JSON when the file has a
+     * .json extension.
+     */
+    static bool saveToFile(const Project& project, const juce::File& file,
+                           const ProjectSaveOptions& options = ProjectSaveOptions());
+
+    /**
+     * Load project from file, detecting binary container or JSON content.
+     */
+    static bool loadFromFile(Project& project, const juce::File& file, bool loadMelCache = true);
+
+    /**
+     * Export / import the JSON format.
      */
-    static bool saveToFile(const Project& project, const juce::File& file);
+    static bool exportToJson(const Project& project, const juce::File& file);
+    static bool importFromJson(Project& project, const juce::File& file);
 
     /**
-     * Load project from JSON file.
+     * Compact binary note records, as stored in the container and the edit
+     * journal.
      */
-    static bool loadFromFile(Project& project, const juce::File& file);
+    static juce::MemoryBlock notesToBinary(const std::vector<Note>& notes);
+    static bool notesFromBinary(const juce::MemoryBlock& data, std::vector<Note>& notes);
 
     /**
      * Convert project to JSON object.
@@ -36,6 +64,18 @@ public:
     static bool fromJson(Project& project, const juce::var& json);
 
 private:
+    // Binary container
+    static bool saveToContainer(const Project& project, const juce::File& file,
+                                const ProjectSaveOptions& options);
+    static bool loadFromContainer(Project& project, const juce::File& file, bool loadMelCache);
+
+    // Metadata and global parameters (shared by both formats)
+    static void metadataToJson(const Project& project, juce::DynamicObject& obj);
+    static void metadataFromJson(Project& project, const juce::var& json);
+
+    // Shared tail of both load paths
+    static void finishLoad(Project& project);
+
     // Note serialization
     static juce::var noteToJson(const Note& note);
     static bool noteFromJson(Note& note, const juce::var& json);
@@ -47,8 +87,8 @@ private:
     // Array helpers (compact string format)
     static juce::String floatArrayToString(const std::vector<float>& arr, int precision = 4);
     static std::vector<float> stringToFloatArray(const juce::String& str);
-    static juce::String boolArrayToString(const std::vector<bool>& arr);
-    static std::vector<bool> stringToBoolArray(const juce::String& str);
+    static juce::String boolArrayToString(const std::vector<uint8_t>& arr);
+    static std::vector<uint8_t> stringToBoolArray(const juce::String& str);
 
     ProjectSerializer() = delete;
 };
@@ -0,0 +1,140 @@
+#include "ScratchStorage.h"
+#include <atomic>
+#include <vector>
+
+namespace
+{
+    std::atomic<size_t> spillThreshold { size_t(128) << 20 };
+
+    /** A read-write mapping of a temporary file, deleted on destruction. */
+    class ScratchBlock
+    {
+    public:
+        static std::shared_ptr<ScratchBlock> create(size_t bytes)
+        {
+            auto directory = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                                 .getChildFile("HachiTune")
+                                 .getChildFile("scratch");
+            if (!directory.createDirectory())
+                return nullptr;
+
+            auto block = std::shared_ptr<ScratchBlock>(new ScratchBlock());
+            block->file = directory.getNonexistentChildFile("buffer", ".scratch", false);
+
+            {
+                // Extending the file zero-fills it (sparsely where supported)
+                juce::FileOutputStream out(block->file);
+                if (out.failedToOpen()
+                    || !out.setPosition(static_cast<juce::int64>(bytes) - 1)
+                    || !out.writeByte(0))
+                    return nullptr;
+                out.flush();
+                if (out.getStatus().failed())
+                    return nullptr;
+            }
+
+            block->map = std::make_unique<juce::MemoryMappedFile>(
+                block->file, juce::MemoryMappedFile::readWrite, false);
+            if (block->map->getData() == nullptr
+                || block->map->getSize() < bytes)
+                return nullptr;
+
+            return block;
+        }
+
+        ~ScratchBlock()
+        {
+            map.reset();  // Unmap first; Windows cannot delete a mapped file
+            file.deleteFile();
+        }
+
+        float* getData() const { return static_cast<float*>(map->getData()); }
+
+    private:
+        ScratchBlock() = default;
+
+        juce::File file;
+        std::unique_ptr<juce::MemoryMappedFile> map;
+    };
+
+    /** Keeps the storage alive for as long as the buffer referring to it. */
+    struct MappedAudioBuffer
+    {
+        std::shared_ptr<float> storage;
+        juce::AudioBuffer<float> buffer;
+    };
+}
+
+void ScratchStorage::setThreshold(size_t bytes)
+{
+    spillThreshold = bytes;
+}
+
+size_t ScratchStorage::getThreshold()
+{
+    return spillThreshold;
+}
+
+std::shared_ptr<float> ScratchStorage::allocateFloats(size_t count)
+{
+    const size_t bytes = count * sizeof(float);
+    const size_t threshold = spillThreshold;
+
+    if (threshold > 0 && bytes >= threshold)
+    {
+        if (auto block = ScratchBlock::create(bytes))
+        {
+            auto* data = block->getData();
+            return std::shared_ptr<float>(std::move(block), data);
+        }
+    }
+
+    return std::shared_ptr<float>(new float[count](), std::default_delete<float[]>());
+}
+
+std::shared_ptr<float> ScratchStorage::allocateMappedFloats(size_t count)
+{
+    if (auto block = ScratchBlock::create(juce::jmax(size_t(1), count) * sizeof(float)))
+    {
+        auto* data = block->getData();
+        return std::shared_ptr<float>(std::move(block), data);
+    }
+    return nullptr;
+}
+
+std::shared_ptr<juce::AudioBuffer<float>> ScratchStorage::referToFloats(std::shared_ptr<float> storage, int numChannels,
+                                                                        int numSamples, size_t channelStride)
+{
+    auto owner = std::make_shared<MappedAudioBuffer>();
+    owner->storage = std::move(storage);
+
+    std::vector<float*> channels(static_cast<size_t>(numChannels));
+    for (int ch = 0; ch < numChannels; ++ch)
+        channels[static_cast<size_t>(ch)] = owner->storage.get() + static_cast<size_t>(ch) * channelStride;
+
+    owner->buffer = juce::AudioBuffer<float>(channels.data(), numChannels, numSamples);
+    return std::shared_ptr<juce::AudioBuffer<float>>(owner, &owner->buffer);
+}
+
+std::shared_ptr<juce::AudioBuffer<float>> ScratchStorage::makeAudioBuffer(int numChannels, int numSamples)
+{
+    const size_t count = static_cast<size_t>(juce::jmax(0, numChannels)) * static_cast<size_t>(juce::jmax(0, numSamples));
+    const size_t threshold = spillThreshold;
+
+    if (threshold == 0 || count * sizeof(float) < threshold)
+    {
+        auto buffer = std::make_shared<juce::AudioBuffer<float>>(numChannels, numSamples);
+        buffer->clear();
+        return buffer;
+    }
+
+    return referToFloats(allocateFloats(count), numChannels, numSamples, static_cast<size_t>(numSamples));
+}
+
+std::shared_ptr<juce::AudioBuffer<float>> ScratchStorage::copyAudioBuffer(const juce::AudioBuffer<float>& source)
+{
+    auto copy = makeAudioBuffer(source.getNumChannels(), source.getNumSamples());
+    for (int ch = 0; ch < source.getNumChannels(); ++ch)
+        copy->copyFrom(ch, 0, source, ch, 0, source.getNumSamples());
+    return copy;
+}
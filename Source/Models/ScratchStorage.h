@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "CopyOnWrite.h"
+#include <cstddef>
+#include <memory>
+
+/**
+ * Out-of-core storage for large sample and feature buffers.
+ *
+ * Allocations at or above a size threshold are backed by memory-mapped
+ * scratch files instead of the heap. The OS then pages data in as it is
+ * touched (the visible range while drawing, the frames being resynthesized)
+ * and can write it back and drop it under memory pressure, so a multi-hour
+ * recording does not have to stay resident. Smaller allocations, and any
+ * allocation when the scratch file cannot be created, fall back to the heap.
+ *
+ * Scratch files live in the temp directory and are deleted when the last
+ * reference to their storage is released.
+ */
+namespace ScratchStorage
+{
+    /** Allocations of at least this many bytes go to scratch files; 0 disables spilling. */
+    void setThreshold(size_t bytes);
+    size_t getThreshold();
+
+    /** Zero-filled storage for count floats. */
+    std::shared_ptr<float> allocateFloats(size_t count);
+
+    /**
+     * Zero-filled storage for count floats that is always file-backed,
+     * regardless of the threshold. Returns nullptr if no scratch file could
+     * be created; callers that must not fail fall back to allocateFloats().
+     */
+    std::shared_ptr<float> allocateMappedFloats(size_t count);
+
+    /**
+     * A buffer of numChannels x numSamples referring to storage, channel c
+     * starting at c * channelStride floats. The buffer keeps storage alive.
+     */
+    std::shared_ptr<juce::AudioBuffer<float>> referToFloats(std::shared_ptr<float> storage, int numChannels,
+                                                            int numSamples, size_t channelStride);
+
+    /**
+     * A cleared buffer of the given shape. When spilled, the returned buffer
+     * refers to the mapping (resizing it moves it to the heap) and the
+     * mapping lives as long as the shared_ptr.
+     */
+    std::shared_ptr<juce::AudioBuffer<float>> makeAudioBuffer(int numChannels, int numSamples);
+
+    /** makeAudioBuffer() filled with a copy of source. */
+    std::shared_ptr<juce::AudioBuffer<float>> copyAudioBuffer(const juce::AudioBuffer<float>& source);
+}
+
+/** Copies of a shared waveform made by CopyOnWrite::edit() follow the same policy. */
+template <>
+struct CopyOnWriteTraits<juce::AudioBuffer<float>>
+{
+    static std::shared_ptr<juce::AudioBuffer<float>> clone(const juce::AudioBuffer<float>& value)
+    {
+        return ScratchStorage::copyAudioBuffer(value);
+    }
+};
@@ -0,0 +1,146 @@
+#include "WaveformPeaks.h"
+#include <cmath>
+
+WaveformPeaks::Bin WaveformPeaks::summarise(const float* samples, int count)
+{
+    Bin bin;
+    if (count <= 0)
+        return bin;
+
+    bin.min = samples[0];
+    bin.max = samples[0];
+    double sumSquares = 0.0;
+    for (int i = 0; i < count; ++i)
+    {
+        const float s = samples[i];
+        bin.min = std::min(bin.min, s);
+        bin.max = std::max(bin.max, s);
+        sumSquares += static_cast<double>(s) * s;
+    }
+    bin.meanSquare = static_cast<float>(sumSquares / count);
+    return bin;
+}
+
+void WaveformPeaks::build(const juce::AudioBuffer<float>& waveform)
+{
+    levels.clear();
+    source = &waveform;
+    numSamples = waveform.getNumSamples();
+
+    if (numSamples <= 0 || waveform.getNumChannels() == 0)
+        return;
+
+    const int baseBins = (numSamples + BASE_BIN_SAMPLES - 1) / BASE_BIN_SAMPLES;
+    levels.emplace_back(static_cast<size_t>(baseBins));
+    computeBase(waveform.getReadPointer(0), 0, baseBins - 1);
+
+    while (levels.back().size() > 1)
+    {
+        const int bins = static_cast<int>((levels.back().size() + 1) / 2);
+        levels.emplace_back(static_cast<size_t>(bins));
+        computeLevel(levels.size() - 1, 0, bins - 1);
+    }
+}
+
+void WaveformPeaks::update(const juce::AudioBuffer<float>& waveform, int startSample, int count)
+{
+    if (levels.empty() || waveform.getNumSamples() != numSamples || waveform.getNumChannels() == 0)
+        return;
+
+    source = &waveform;
+
+    const int start = juce::jlimit(0, numSamples, startSample);
+    const int end = juce::jlimit(start, numSamples, startSample + count);
+    if (end <= start)
+        return;
+
+    int firstBin = start / BASE_BIN_SAMPLES;
+    int lastBin = (end - 1) / BASE_BIN_SAMPLES;
+    computeBase(waveform.getReadPointer(0), firstBin, lastBin);
+
+    for (size_t level = 1; level < levels.size(); ++level)
+    {
+        firstBin /= 2;
+        lastBin /= 2;
+        computeLevel(level, firstBin, lastBin);
+    }
+}
+
+void WaveformPeaks::computeBase(const float* samples, int firstBin, int lastBin)
+{
+    auto& base = levels[0];
+    for (int bin = firstBin; bin <= lastBin; ++bin)
+    {
+        const int start = bin * BASE_BIN_SAMPLES;
+        const int count = std::min(BASE_BIN_SAMPLES, numSamples - start);
+        base[static_cast<size_t>(bin)] = summarise(samples + start, count);
+    }
+}
+
+void WaveformPeaks::computeLevel(size_t level, int firstBin, int lastBin)
+{
+    const auto& below = levels[level - 1];
+    auto& bins = levels[level];
+
+    for (int bin = firstBin; bin <= lastBin; ++bin)
+    {
+        const size_t left = static_cast<size_t>(bin) * 2;
+        const size_t right = left + 1;
+
+        Bin merged = below[left];
+        if (right < below.size())
+        {
+            merged.min = std::min(merged.min, below[right].min);
+            merged.max = std::max(merged.max, below[right].max);
+            merged.meanSquare = 0.5f * (merged.meanSquare + below[right].meanSquare);
+        }
+        bins[static_cast<size_t>(bin)] = merged;
+    }
+}
+
+WaveformPeaks::Peak WaveformPeaks::getPeak(const juce::AudioBuffer<float>& waveform,
+                                           int startSample, int endSample) const
+{
+    Peak peak;
+    const int start = juce::jlimit(0, numSamples, startSample);
+    const int end = juce::jlimit(start, numSamples, endSample);
+    if (end <= start || levels.empty())
+        return peak;
+
+    const int span = end - start;
+
+    // Zoomed in: the samples themselves are cheap enough
+    if (span < BASE_BIN_SAMPLES * BINS_PER_QUERY / 2)
+    {
+        const Bin bin = summarise(waveform.getReadPointer(0) + start, span);
+        peak.min = bin.min;
+        peak.max = bin.max;
+        peak.rms = std::sqrt(bin.meanSquare);
+        return peak;
+    }
+
+    // Coarsest level with at least BINS_PER_QUERY bins across the span; the
+    // partial bins at either end widen the span by at most one bin each
+    size_t level = 0;
+    while (level + 1 < levels.size()
+           && (static_cast<juce::int64>(BASE_BIN_SAMPLES) << (level + 1)) * BINS_PER_QUERY <= span)
+        ++level;
+
+    const int binSamples = BASE_BIN_SAMPLES << level;
+    const auto& bins = levels[level];
+    const int firstBin = start / binSamples;
+    const int lastBin = std::min((end - 1) / binSamples, static_cast<int>(bins.size()) - 1);
+
+    peak.min = bins[static_cast<size_t>(firstBin)].min;
+    peak.max = bins[static_cast<size_t>(firstBin)].max;
+    double sumMeanSquares = 0.0;
+    for (int bin = firstBin; bin <= lastBin; ++bin)
+    {
+        const auto& b = bins[static_cast<size_t>(bin)];
+        peak.min = std::min(peak.min, b.min);
+        peak.max = std::max(peak.max, b.max);
+        sumMeanSquares += b.meanSquare;
+    }
+    peak.rms = static_cast<float>(std::sqrt(sumMeanSquares / (lastBin - firstBin + 1)));
+    return peak;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include <algorithm>
+#include <vector>
+
+/**
+ * Multi-resolution min/max/RMS summary of a waveform, for drawing.
+ *
+ * Level 0 summarises BASE_BIN_SAMPLES samples per bin and every further
+ * level merges pairs of bins from the one below. A query picks the coarsest
+ * level that still gives about BINS_PER_QUERY bins over the span, so one
+ * pixel column costs a handful of bins whatever the zoom and file length.
+ * Spans shorter than a few base bins are read from the samples directly.
+ *
+ * Peaks describe channel 0, which is what the views draw. After samples are
+ * replaced in place, update() recomputes just the bins over that range.
+ */
+class WaveformPeaks
+{
+public:
+    struct Peak
+    {
+        float min = 0.0f;
+        float max = 0.0f;
+        float rms = 0.0f;
+
+        float getMagnitude() const { return std::max(max, -min); }
+    };
+
+    static constexpr int BASE_BIN_SAMPLES = 256;
+
+    /** Rebuild every level from waveform. */
+    void build(const juce::AudioBuffer<float>& waveform);
+
+    /**
+     * Recompute the bins over [startSample, startSample + count) of waveform,
+     * which may be a detached copy of the buffer this was built for. Does
+     * nothing if the length differs; the next isBuiltFor() check rebuilds.
+     */
+    void update(const juce::AudioBuffer<float>& waveform, int startSample, int count);
+
+    /** True if the levels describe this buffer as it is now. */
+    bool isBuiltFor(const juce::AudioBuffer<float>& waveform) const
+    {
+        return source == &waveform && numSamples == waveform.getNumSamples();
+    }
+
+    /** Summary of [startSample, endSample), clamped; waveform must pass isBuiltFor(). */
+    Peak getPeak(const juce::AudioBuffer<float>& waveform, int startSample, int endSample) const;
+
+private:
+    struct Bin
+    {
+        float min = 0.0f;
+        float max = 0.0f;
+        float meanSquare = 0.0f;
+    };
+
+    // Bins are only merged once a column spans this many of them
+    static constexpr int BINS_PER_QUERY = 8;
+
+    static Bin summarise(const float* samples, int count);
+    void computeBase(const float* samples, int firstBin, int lastBin);
+    void computeLevel(size_t level, int firstBin, int lastBin);
+
+    std::vector<std::vector<Bin>> levels;
+    const juce::AudioBuffer<float>* source = nullptr;  // Identity only, never read
+    int numSamples = 0;
+};
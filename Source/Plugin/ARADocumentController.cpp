@@ -3,7 +3,34 @@
 #if JucePlugin_Enable_ARA
 
 #include "../Models/ProjectSerializer.h"
+#include "../Models/ScratchStorage.h"
+#include "../UI/Main/SettingsManager.h"
 #include "../UI/MainComponent.h"
+#include "../Utils/Constants.h"
+#include "../Utils/MelSpectrogram.h"
+#include <algorithm>
+#include <climits>
+#include <tuple>
+
+namespace {
+// Marks the per-source analysis section that follows the displayed project
+constexpr int ANALYSIS_CACHE_MAGIC = 0x48544143; // 'HTAC'
+
+// A length-prefixed ProjectSerializer JSON block
+juce::var readJsonBlock(juce::InputStream& input, juce::int64 size) {
+    if (size <= 0 || size > INT_MAX)
+        return {};
+
+    juce::MemoryBlock data;
+    data.setSize(static_cast<size_t>(size));
+    if (input.read(data.getData(), static_cast<int>(size)) != static_cast<int>(size))
+        return {};
+
+    juce::String jsonString(juce::CharPointer_UTF8(static_cast<const char*>(data.getData())),
+                            data.getSize());
+    return juce::JSON::parse(jsonString);
+}
+}
 
 //==============================================================================
 // PitchEditorPlaybackRenderer
@@ -146,36 +173,280 @@ bool PitchEditorPlaybackRenderer::processBlock(juce::AudioBuffer<float>& buffer,
 // PitchEditorDocumentController
 //==============================================================================
 
-void PitchEditorDocumentController::processAudioSource(juce::ARAAudioSource* source) {
-    if (!mainComponent || !source)
-        return;
+PitchEditorDocumentController::~PitchEditorDocumentController() {
+    stopWorkers();
+}
+
+void PitchEditorDocumentController::didAddAudioSourceToDocument(juce::ARADocument*,
+                                                                 juce::ARAAudioSource* audioSource) {
+    {
+        const std::lock_guard<std::mutex> lock(analysisLock);
+        currentAudioSource = audioSource;
+    }
+    enqueue(audioSource, false);
+}
+
+void PitchEditorDocumentController::willRemoveAudioSourceFromDocument(juce::ARADocument*,
+                                                                       juce::ARAAudioSource* audioSource) {
+    // A worker still reading this source notices the removal when it finishes
+    const std::lock_guard<std::mutex> lock(analysisLock);
+    analyses.erase(audioSource);
+    if (currentAudioSource == audioSource)
+        currentAudioSource = nullptr;
+    if (displayedAudioSource == audioSource)
+        displayedAudioSource = nullptr;
+}
 
-    auto numSamples = static_cast<int>(source->getSampleCount());
-    auto numChannels = source->getChannelCount();
-    auto sourceSampleRate = source->getSampleRate();
+void PitchEditorDocumentController::reanalyze() {
+    if (currentAudioSource)
+        enqueue(currentAudioSource, true);
+}
 
-    if (numSamples <= 0 || numChannels <= 0 || sourceSampleRate <= 0)
+void PitchEditorDocumentController::setMainComponent(MainComponent* mc) {
+    {
+        const std::lock_guard<std::mutex> lock(analysisLock);
+        if (mc == nullptr) {
+            // Analyses run on the controller's own analyzer, so nothing
+            // running needs the editor
+            keepDisplayedEdits();
+            displayedAudioSource = nullptr;
+            mainComponent = nullptr;
+            return;
+        }
+        mainComponent = mc;
+    }
+
+    // Show the current source once the editor has finished setting up
+    juce::MessageManager::callAsync(
+        [weak = std::weak_ptr<PitchEditorDocumentController*>(aliveToken)]() {
+            if (auto token = weak.lock())
+                (*token)->showCurrentSource();
+        });
+}
+
+void PitchEditorDocumentController::enqueue(juce::ARAAudioSource* source, bool forceAnalysis) {
+    if (!source)
         return;
 
-    juce::ARAAudioSourceReader reader(source);
-    juce::AudioBuffer<float> buffer(numChannels, numSamples);
+    {
+        const std::lock_guard<std::mutex> lock(analysisLock);
+        auto& entry = analyses[source];
+        entry.persistentID = juce::String(source->getPersistentID());
+        entry.reader = std::make_shared<juce::ARAAudioSourceReader>(source);
+        entry.numChannels = source->getChannelCount();
+        entry.numSamples = source->getSampleCount();
+        entry.sampleRate = source->getSampleRate();
+        entry.order = nextOrder++;
+        entry.forceAnalysis = forceAnalysis;
+
+        auto archived = archivedStates.find(entry.persistentID);
+        if (archived != archivedStates.end()) {
+            entry.archivedState = archived->second;
+            archivedStates.erase(archived);
+        }
+
+        if (entry.status == SourceAnalysis::Status::Running)
+            entry.requeue = true;
+        else
+            entry.status = SourceAnalysis::Status::Queued;
+    }
+
+    if (mainComponent && source == currentAudioSource)
+        mainComponent->getToolbar().setStatusMessage("ARA Mode - Analyzing...");
+
+    startWorkers();
+    analysisWake.notify_all();
+}
 
-    if (!reader.read(&buffer, 0, numSamples, 0, true, true))
+void PitchEditorDocumentController::startWorkers() {
+    if (!workers.empty())
         return;
 
-    mainComponent->getToolbar().setStatusMessage("ARA Mode - Analyzing...");
-    mainComponent->setHostAudio(buffer, sourceSampleRate);
+    // Each analysis already runs multi-threaded inference, so half the cores
+    // are enough to keep them busy
+    const int count = juce::jlimit(1, MAX_WORKERS, juce::SystemStats::getNumCpus() / 2);
+    for (int i = 0; i < count; ++i)
+        workers.emplace_back([this]() { runWorker(); });
 }
 
-void PitchEditorDocumentController::didAddAudioSourceToDocument(juce::ARADocument*,
-                                                                 juce::ARAAudioSource* audioSource) {
-    currentAudioSource = audioSource;
-    processAudioSource(audioSource);
+void PitchEditorDocumentController::stopWorkers() {
+    {
+        const std::lock_guard<std::mutex> lock(analysisLock);
+        stopping = true;
+    }
+    analyzer.cancel();
+    analysisWake.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable())
+            worker.join();
+    }
+    workers.clear();
 }
 
-void PitchEditorDocumentController::reanalyze() {
-    if (currentAudioSource)
-        processAudioSource(currentAudioSource);
+juce::ARAAudioSource* PitchEditorDocumentController::takeNextJob() {
+    juce::ARAAudioSource* best = nullptr;
+    SourceAnalysis* bestEntry = nullptr;
+
+    for (auto& [source, entry] : analyses) {
+        if (entry.status != SourceAnalysis::Status::Queued)
+            continue;
+
+        if (source == currentAudioSource) {
+            best = source;
+            bestEntry = &entry;
+            break;
+        }
+        if (bestEntry == nullptr || entry.order < bestEntry->order) {
+            best = source;
+            bestEntry = &entry;
+        }
+    }
+
+    if (bestEntry != nullptr)
+        bestEntry->status = SourceAnalysis::Status::Running;
+    return best;
+}
+
+void PitchEditorDocumentController::runWorker() {
+    std::unique_lock<std::mutex> lock(analysisLock);
+
+    for (;;) {
+        juce::ARAAudioSource* source = nullptr;
+        analysisWake.wait(lock, [&]() { return stopping || (source = takeNextJob()) != nullptr; });
+        if (stopping)
+            return;
+
+        // Copies only: the entry may be replaced or removed while this runs.
+        // The reader itself copes with the source going away.
+        const auto& entry = analyses[source];
+        const auto persistentID = entry.persistentID;
+        auto reader = entry.reader;
+        const int numChannels = entry.numChannels;
+        const auto numSamples = entry.numSamples;
+        const double sampleRate = entry.sampleRate;
+        const auto archivedState = entry.forceAnalysis ? juce::var() : entry.archivedState;
+
+        lock.unlock();
+        auto project = processAudioSource(*reader, numChannels, numSamples, sampleRate, archivedState);
+        lock.lock();
+
+        // A cancelled analysis is incomplete
+        if (stopping)
+            project.reset();
+
+        bool show = false;
+        auto it = analyses.find(source);
+        if (it != analyses.end() && it->second.persistentID == persistentID) {
+            auto& finished = it->second;
+            if (finished.requeue) {
+                finished.requeue = false;
+                finished.status = SourceAnalysis::Status::Queued;
+                analysisWake.notify_all();
+            } else {
+                finished.status = project ? SourceAnalysis::Status::Done : SourceAnalysis::Status::Failed;
+                finished.project = project;
+                if (project) {
+                    finished.forceAnalysis = false;
+                    finished.archivedState = juce::var();
+                }
+                show = project != nullptr && source == currentAudioSource;
+            }
+        }
+
+        // Readers are released on the message thread, where the rest of the
+        // ARA model lives
+        juce::MessageManager::callAsync(
+            [weak = std::weak_ptr<PitchEditorDocumentController*>(aliveToken), reader, show]() mutable {
+                reader.reset();
+                if (show) {
+                    if (auto token = weak.lock())
+                        (*token)->showCurrentSource();
+                }
+            });
+    }
+}
+
+std::shared_ptr<Project> PitchEditorDocumentController::processAudioSource(
+    juce::ARAAudioSourceReader& reader, int numChannels, juce::int64 numSamples, double sampleRate,
+    const juce::var& archivedState) {
+    if (numSamples <= 0 || numSamples > INT_MAX || numChannels <= 0 || sampleRate <= 0)
+        return nullptr;
+
+    // Read in chunks so a long source goes straight into scratch storage
+    auto buffer = ScratchStorage::makeAudioBuffer(numChannels, static_cast<int>(numSamples));
+    for (juce::int64 position = 0; position < numSamples; position += READ_CHUNK_SAMPLES) {
+        const int chunk = static_cast<int>(std::min<juce::int64>(READ_CHUNK_SAMPLES, numSamples - position));
+        if (!reader.read(buffer.get(), static_cast<int>(position), chunk, position, true, true))
+            return nullptr;
+
+        const std::lock_guard<std::mutex> lock(analysisLock);
+        if (stopping)
+            return nullptr;
+    }
+
+    auto project = std::make_shared<Project>();
+    auto& audioData = project->getAudioData();
+    audioData.waveform = CopyOnWrite<juce::AudioBuffer<float>>(std::move(buffer));
+    audioData.sampleRate = static_cast<int>(sampleRate);
+
+    if (archivedState.isVoid()) {
+        getAnalyzer().analyze(*project, nullptr);
+
+        // Waveform drawing summary, so the first paint does not build it
+        audioData.getPeaks();
+        return project;
+    }
+
+    // Archived analysis: only the mel spectrogram is not part of the archive
+    MelSpectrogram melComputer(SAMPLE_RATE, N_FFT, HOP_SIZE, NUM_MELS, FMIN, FMAX);
+    audioData.melSpectrogram = melComputer.compute(audioData.waveform->getReadPointer(0),
+                                                   static_cast<int>(numSamples));
+    if (!ProjectSerializer::fromJson(*project, archivedState))
+        return nullptr;
+    return project;
+}
+
+AudioAnalyzer& PitchEditorDocumentController::getAnalyzer() {
+    const std::lock_guard<std::mutex> lock(analyzerLoadLock);
+    if (!analyzerLoaded) {
+        // Same detector choice as the standalone editor
+        const SettingsManager settings;
+        analyzer.setPitchDetectorType(settings.getPitchDetectorType());
+        analyzer.initialize();
+        analyzerLoaded = true;
+    }
+    return analyzer;
+}
+
+void PitchEditorDocumentController::showCurrentSource() {
+    std::shared_ptr<const Project> project;
+    {
+        const std::lock_guard<std::mutex> lock(analysisLock);
+        if (mainComponent == nullptr || currentAudioSource == nullptr)
+            return;
+
+        auto it = analyses.find(currentAudioSource);
+        if (it == analyses.end() || it->second.status != SourceAnalysis::Status::Done)
+            return;
+
+        if (displayedAudioSource != currentAudioSource)
+            keepDisplayedEdits();
+        displayedAudioSource = currentAudioSource;
+        project = it->second.project;
+    }
+
+    if (project)
+        mainComponent->setHostProject(*project);
+}
+
+void PitchEditorDocumentController::keepDisplayedEdits() {
+    if (mainComponent == nullptr || displayedAudioSource == nullptr || mainComponent->getProject() == nullptr)
+        return;
+
+    auto it = analyses.find(displayedAudioSource);
+    if (it != analyses.end() && it->second.status == SourceAnalysis::Status::Done)
+        it->second.project = std::make_shared<const Project>(*mainComponent->getProject());
 }
 
 juce::ARAPlaybackRenderer* PitchEditorDocumentController::doCreatePlaybackRenderer() noexcept {
@@ -184,39 +455,90 @@ juce::ARAPlaybackRenderer* PitchEditorDocumentController::doCreatePlaybackRender
 }
 
 bool PitchEditorDocumentController::doRestoreObjectsFromStream(juce::ARAInputStream& input,
-                                                                const juce::ARARestoreObjectsFilter*) noexcept {
-    auto dataSize = input.readInt64();
-    if (dataSize <= 0)
-        return true;
+                                                                const juce::ARARestoreObjectsFilter* filter) noexcept {
+    // Displayed project, as written by every version
+    auto displayed = readJsonBlock(input, input.readInt64());
+
+    // Per-source analyses, when written by a version with the analysis queue
+    if (input.failed() || input.isExhausted() || input.readInt() != ANALYSIS_CACHE_MAGIC) {
+        if (displayed.isObject() && mainComponent && mainComponent->getProject())
+            ProjectSerializer::fromJson(*mainComponent->getProject(), displayed);
+        return !input.failed();
+    }
 
-    juce::MemoryBlock data;
-    data.setSize(static_cast<size_t>(dataSize));
-    input.read(data.getData(), static_cast<int>(dataSize));
-
-    if (mainComponent && mainComponent->getProject()) {
-        juce::String jsonString(juce::CharPointer_UTF8(static_cast<const char*>(data.getData())),
-                                data.getSize());
-        auto json = juce::JSON::parse(jsonString);
-        if (json.isObject()) {
-            ProjectSerializer::fromJson(*mainComponent->getProject(), json);
+    const int count = input.readInt();
+    {
+        const std::lock_guard<std::mutex> lock(analysisLock);
+        for (int i = 0; i < count && !input.failed(); ++i) {
+            auto archivedID = input.readString();
+            auto state = readJsonBlock(input, input.readInt64());
+            if (!state.isObject())
+                continue;
+
+            // The host may map archived sources onto differently named ones
+            auto* source = filter ? filter->getAudioSourceToRestoreStateWithID<juce::ARAAudioSource>(
+                                        archivedID.toRawUTF8())
+                                  : nullptr;
+            auto it = source ? analyses.find(source) : analyses.end();
+            if (it == analyses.end()) {
+                archivedStates[source ? juce::String(source->getPersistentID()) : archivedID] = state;
+                continue;
+            }
+
+            // Reread the audio and restore instead of analysing
+            auto& entry = it->second;
+            entry.archivedState = state;
+            entry.forceAnalysis = false;
+            if (entry.status == SourceAnalysis::Status::Running) {
+                entry.requeue = true;
+            } else if (entry.status != SourceAnalysis::Status::Queued) {
+                entry.status = SourceAnalysis::Status::Queued;
+                entry.order = nextOrder++;
+            }
         }
     }
 
+    startWorkers();
+    analysisWake.notify_all();
     return !input.failed();
 }
 
 bool PitchEditorDocumentController::doStoreObjectsToStream(juce::ARAOutputStream& output,
-                                                            const juce::ARAStoreObjectsFilter*) noexcept {
+                                                            const juce::ARAStoreObjectsFilter* filter) noexcept {
+    // Displayed project first, so older versions can still read the archive
     if (!mainComponent || !mainComponent->getProject()) {
         output.writeInt64(0);
-        return true;
+    } else {
+        auto json = ProjectSerializer::toJson(*mainComponent->getProject());
+        auto jsonString = juce::JSON::toString(json, false);
+
+        output.writeInt64(static_cast<juce::int64>(jsonString.getNumBytesAsUTF8()));
+        if (!output.write(jsonString.toRawUTF8(), jsonString.getNumBytesAsUTF8()))
+            return false;
     }
 
-    auto json = ProjectSerializer::toJson(*mainComponent->getProject());
-    auto jsonString = juce::JSON::toString(json, false);
+    // Per-source analyses; serialised outside the lock
+    std::vector<std::tuple<juce::String, std::shared_ptr<const Project>, juce::var>> stored;
+    {
+        const std::lock_guard<std::mutex> lock(analysisLock);
+        keepDisplayedEdits();
+        for (auto& [source, entry] : analyses) {
+            if (filter && !filter->shouldStoreAudioSource(source))
+                continue;
+            if (entry.project || entry.archivedState.isObject())
+                stored.emplace_back(entry.persistentID, entry.project, entry.archivedState);
+        }
+    }
 
-    output.writeInt64(static_cast<juce::int64>(jsonString.getNumBytesAsUTF8()));
-    return output.write(jsonString.toRawUTF8(), static_cast<int>(jsonString.getNumBytesAsUTF8()));
+    bool ok = output.writeInt(ANALYSIS_CACHE_MAGIC) && output.writeInt(static_cast<int>(stored.size()));
+    for (const auto& [persistentID, project, archivedState] : stored) {
+        auto json = project ? ProjectSerializer::toJson(*project) : archivedState;
+        auto jsonString = juce::JSON::toString(json, false);
+        ok = ok && output.writeString(persistentID)
+                && output.writeInt64(static_cast<juce::int64>(jsonString.getNumBytesAsUTF8()))
+                && output.write(jsonString.toRawUTF8(), jsonString.getNumBytesAsUTF8());
+    }
+    return ok;
 }
 
 #endif // JucePlugin_Enable_ARA
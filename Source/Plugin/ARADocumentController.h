@@ -1,7 +1,15 @@
 #pragma once
 
+#include "../Audio/Analysis/AudioAnalyzer.h"
 #include "../Audio/RealtimePitchProcessor.h"
 #include "../JuceHeader.h"
+#include "../Models/Project.h"
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #if JucePlugin_Enable_ARA
 
@@ -38,15 +46,30 @@ private:
 /**
  * ARA Document Controller
  * Manages ARA document lifecycle and audio source analysis
+ *
+ * Every audio source in the document gets an entry in an analysis queue.
+ * A small pool of workers reads sources in chunks (into scratch storage for
+ * long ones) and analyses them in parallel, the source shown in the editor
+ * first and the rest in the order they were added. Results are cached per
+ * source and archived with the document, keyed by the source's persistent
+ * ID, so reopening a document only rereads audio and skips analysis.
+ *
+ * The controller owns the analyzer (its models are loaded by the first job
+ * that needs them), so sources are analysed whether or not an editor is
+ * open, and closing the editor never waits for an analysis. Shutting down
+ * cancels running analyses at their next stage.
  */
 class PitchEditorDocumentController : public juce::ARADocumentControllerSpecialisation {
 public:
     using ARADocumentControllerSpecialisation::ARADocumentControllerSpecialisation;
+    ~PitchEditorDocumentController() override;
 
     void didAddAudioSourceToDocument(juce::ARADocument* doc, juce::ARAAudioSource* audioSource) override;
+    void willRemoveAudioSourceFromDocument(juce::ARADocument* doc, juce::ARAAudioSource* audioSource) override;
     void reanalyze();
 
-    void setMainComponent(MainComponent* mc) { mainComponent = mc; }
+    /** Attach or detach the editor. Never waits for analyses. */
+    void setMainComponent(MainComponent* mc);
     MainComponent* getMainComponent() const { return mainComponent; }
 
     void setRealtimeProcessor(RealtimePitchProcessor* processor) { realtimeProcessor = processor; }
@@ -60,11 +83,59 @@ protected:
                                 const juce::ARAStoreObjectsFilter* filter) noexcept override;
 
 private:
-    void processAudioSource(juce::ARAAudioSource* source);
+    /** Analysis state of one audio source. */
+    struct SourceAnalysis {
+        enum class Status { Queued, Running, Done, Failed };
+
+        juce::String persistentID;
+        std::shared_ptr<juce::ARAAudioSourceReader> reader;  // Created on the message thread
+        int numChannels = 0;
+        juce::int64 numSamples = 0;
+        double sampleRate = 0.0;
+        Status status = Status::Queued;
+        juce::int64 order = 0;              // Queue position; lower runs first
+        bool forceAnalysis = false;         // Ignore archived state (reanalyze)
+        bool requeue = false;               // Changed while running
+        juce::var archivedState;            // ProjectSerializer JSON to restore
+        std::shared_ptr<const Project> project;  // Waveform and analysis once done
+    };
+
+    void enqueue(juce::ARAAudioSource* source, bool forceAnalysis);
+    void startWorkers();
+    void stopWorkers();
+    void runWorker();
+    juce::ARAAudioSource* takeNextJob();  // analysisLock held
+    std::shared_ptr<Project> processAudioSource(juce::ARAAudioSourceReader& reader,
+                                                int numChannels, juce::int64 numSamples,
+                                                double sampleRate, const juce::var& archivedState);
+    AudioAnalyzer& getAnalyzer();  // Worker threads; loads the models on first use
+    void showCurrentSource();  // Message thread
+    void keepDisplayedEdits(); // Message thread, analysisLock held
 
     MainComponent* mainComponent = nullptr;
-    juce::ARAAudioSource* currentAudioSource = nullptr;
+    juce::ARAAudioSource* currentAudioSource = nullptr;   // Shown in the editor once analysed
+    juce::ARAAudioSource* displayedAudioSource = nullptr; // Currently in mainComponent
     RealtimePitchProcessor* realtimeProcessor = nullptr;
+
+    // Queue and cache, guarded by analysisLock
+    std::mutex analysisLock;
+    std::condition_variable analysisWake;
+    std::map<juce::ARAAudioSource*, SourceAnalysis> analyses;
+    std::map<juce::String, juce::var> archivedStates;  // Restored before their source was added
+    juce::int64 nextOrder = 0;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    // Shared by the workers; detectors run concurrent inference
+    AudioAnalyzer analyzer;
+    std::mutex analyzerLoadLock;
+    bool analyzerLoaded = false;
+
+    std::shared_ptr<PitchEditorDocumentController*> aliveToken =
+        std::make_shared<PitchEditorDocumentController*>(this);
+
+    static constexpr int READ_CHUNK_SAMPLES = 1 << 16;
+    static constexpr int MAX_WORKERS = 4;
 };
 
 #endif // JucePlugin_Enable_ARA
@@ -32,6 +32,10 @@ PitchEditorAudioProcessorEditor::PitchEditorAudioProcessorEditor(PitchEditorAudi
 }
 
 PitchEditorAudioProcessorEditor::~PitchEditorAudioProcessorEditor() {
+#if JucePlugin_Enable_ARA
+    if (araDocController)
+        araDocController->setMainComponent(nullptr);
+#endif
     audioProcessor.setMainComponent(nullptr);
     AppFont::shutdown();  // Release font resources (reference counted)
 }
@@ -69,28 +73,9 @@ void PitchEditorAudioProcessorEditor::setupARAMode() {
         pitchDocController->reanalyze();
     };
 
-    // Check for existing audio sources
-    auto* juceDocument = docController->getDocument();
-    if (juceDocument) {
-        auto& audioSources = juceDocument->getAudioSources<juce::ARAAudioSource>();
-
-        if (!audioSources.empty()) {
-            // Process first audio source
-            auto* source = audioSources.front();
-            if (source && source->getSampleCount() > 0) {
-                juce::ARAAudioSourceReader reader(source);
-                int numSamples = static_cast<int>(source->getSampleCount());
-                int numChannels = source->getChannelCount();
-                double sampleRate = source->getSampleRate();
-
-                juce::AudioBuffer<float> buffer(numChannels, numSamples);
-                if (reader.read(&buffer, 0, numSamples, 0, true, true)) {
-                    mainComponent.setHostAudio(buffer, sampleRate);
-                    return;
-                }
-            }
-        }
-    }
+    // Sources already in the document are queued for analysis; the
+    // controller shows the current one once it is ready
+    araDocController = pitchDocController;
 #endif
 }
 
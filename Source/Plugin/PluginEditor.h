@@ -4,6 +4,10 @@
 #include "../UI/MainComponent.h"
 #include "PluginProcessor.h"
 
+#if JucePlugin_Enable_ARA
+class PitchEditorDocumentController;
+#endif
+
 class PitchEditorAudioProcessorEditor : public juce::AudioProcessorEditor
 #if JucePlugin_Enable_ARA
     , public juce::AudioProcessorEditorARAExtension
@@ -23,6 +27,9 @@ private:
 
     PitchEditorAudioProcessor& audioProcessor;
     MainComponent mainComponent{false};
+#if JucePlugin_Enable_ARA
+    PitchEditorDocumentController* araDocController = nullptr;
+#endif
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PitchEditorAudioProcessorEditor)
 };
@@ -11,9 +11,28 @@ PitchEditorAudioProcessor::PitchEditorAudioProcessor()
           .withOutput("Output", juce::AudioChannelSet::stereo(), true))
 #endif
 {
+    // Every snapshot of a take in progress is analysed, so notes show up
+    // while recording; the final one replaces them with the full take.
+    // Editing stays locked for the whole take, since each pass replaces the
+    // project.
+    capture.setSnapshotCallback([this](std::shared_ptr<juce::AudioBuffer<float>> audio,
+                                       double sampleRate, bool isFinal) {
+        juce::MessageManager::callAsync([this, audio, sampleRate, isFinal]() {
+            if (!mainComponent)
+                return;
+
+            // Without audio: a take has started, or was discarded
+            if (audio == nullptr)
+                mainComponent->setHostTakeInProgress(!isFinal);
+            else
+                mainComponent->setHostAudio(audio, sampleRate, !isFinal);
+        });
+    });
 }
 
-PitchEditorAudioProcessor::~PitchEditorAudioProcessor() = default;
+PitchEditorAudioProcessor::~PitchEditorAudioProcessor() {
+    capture.release(false);
+}
 
 const juce::String PitchEditorAudioProcessor::getName() const {
     return JucePlugin_Name;
@@ -52,11 +71,10 @@ void PitchEditorAudioProcessor::prepareToPlay(double sampleRate, int samplesPerB
                         getMainBusNumOutputChannels(), getProcessingPrecision());
 #endif
 
-    // Pre-allocate capture buffer for non-ARA mode
-    int maxSamples = static_cast<int>(sampleRate * MAX_CAPTURE_SECONDS);
-    captureBuffer.setSize(getMainBusNumOutputChannels(), maxSamples);
-    captureBuffer.clear();
-    capturePosition = 0;
+    // Capture ring and drain thread for non-ARA mode
+    capture.prepare(getMainBusNumOutputChannels(), sampleRate);
+    capturedSamples = 0;
+    stopRequested = false;
     captureState = CaptureState::WaitingForAudio;
 }
 
@@ -64,6 +82,11 @@ void PitchEditorAudioProcessor::releaseResources() {
 #if JucePlugin_Enable_ARA
     releaseResourcesForARA();
 #endif
+
+    // Publishes a take that was still recording
+    capture.release(true);
+    if (captureState == CaptureState::Capturing)
+        captureState = CaptureState::Complete;
 }
 
 #if !JucePlugin_PreferredChannelConfigurations
@@ -134,10 +157,14 @@ void PitchEditorAudioProcessor::processNonARAMode(juce::AudioBuffer<float>& buff
 
     // Check if we have analyzed project ready for real-time processing
     bool hasProject = mainComponent && mainComponent->getProject() &&
-                      mainComponent->getProject()->getAudioData().waveform.getNumSamples() > 0 &&
+                      mainComponent->getProject()->getAudioData().waveform->getNumSamples() > 0 &&
                       !mainComponent->getProject()->getAudioData().f0.empty();
 
-    if (hasProject && realtimeProcessor.isReady()) {
+    // Keep recording while a take is in progress, even once the first
+    // snapshot has produced a project
+    CaptureState state = captureState.load();
+
+    if (state != CaptureState::Capturing && hasProject && realtimeProcessor.isReady()) {
         // Real-time pitch correction mode
         juce::AudioBuffer<float> outputBuffer(numChannels, numSamples);
         if (realtimeProcessor.processBlock(buffer, outputBuffer, &posInfo)) {
@@ -148,74 +175,67 @@ void PitchEditorAudioProcessor::processNonARAMode(juce::AudioBuffer<float>& buff
     }
 
     // Capture mode
-    CaptureState state = captureState.load();
+    const float maxLevel = buffer.getMagnitude(0, numSamples);
 
     if (state == CaptureState::WaitingForAudio) {
         // Detect audio input
-        float maxLevel = 0.0f;
-        for (int ch = 0; ch < numChannels; ++ch) {
-            auto* data = buffer.getReadPointer(ch);
-            for (int i = 0; i < numSamples; ++i)
-                maxLevel = std::max(maxLevel, std::abs(data[i]));
-        }
-
-        if (maxLevel > AUDIO_THRESHOLD) {
-            captureState = CaptureState::Capturing;
-            capturePosition = 0;
+        if (maxLevel > AUDIO_THRESHOLD && capture.beginTake()) {
+            beginCapture();
             state = CaptureState::Capturing;
         }
     }
 
     if (state == CaptureState::Capturing) {
-        // Capture audio
-        int spaceLeft = captureBuffer.getNumSamples() - capturePosition;
-        int toCopy = std::min(numSamples, spaceLeft);
-
-        for (int ch = 0; ch < std::min(numChannels, captureBuffer.getNumChannels()); ++ch)
-            captureBuffer.copyFrom(ch, capturePosition, buffer, ch, 0, toCopy);
-
-        capturePosition += toCopy;
-
-        // Auto-stop after 30 seconds or buffer full
-        int autoStopSamples = static_cast<int>(hostSampleRate * 30);
-        if (capturePosition >= autoStopSamples || capturePosition >= captureBuffer.getNumSamples())
+        capture.push(buffer, numSamples);
+        capturedSamples += numSamples;
+        silentSamples = maxLevel > AUDIO_THRESHOLD ? 0 : silentSamples + numSamples;
+
+        // Stop with the host transport, or after a stretch of silence when
+        // the host does not report one
+        bool stop = stopRequested.exchange(false);
+        if (posInfo.getIsPlaying())
+            transportSeenPlaying = true;
+        else if (transportSeenPlaying)
+            stop = true;
+        if (silentSamples >= static_cast<juce::int64>(hostSampleRate * SILENCE_STOP_SECONDS))
+            stop = true;
+
+        if (stop)
             finishCapture();
     }
 
     // Passthrough during capture
 }
 
+void PitchEditorAudioProcessor::beginCapture() {
+    capturedSamples = 0;
+    silentSamples = 0;
+    transportSeenPlaying = false;
+    stopRequested = false;
+    captureState = CaptureState::Capturing;
+}
+
 void PitchEditorAudioProcessor::finishCapture() {
-    if (capturePosition < static_cast<int>(hostSampleRate * 0.5))
-        return; // Too short
+    // Too short to analyse: drop it and wait for the next take
+    if (capturedSamples - silentSamples < static_cast<juce::int64>(hostSampleRate * MIN_CAPTURE_SECONDS)) {
+        capture.endTake(false);
+        captureState = CaptureState::WaitingForAudio;
+        return;
+    }
 
+    // The drain thread publishes the final snapshot for analysis
+    capture.endTake(true);
     captureState = CaptureState::Complete;
-
-    // Trim buffer
-    juce::AudioBuffer<float> trimmed;
-    trimmed.setSize(captureBuffer.getNumChannels(), capturePosition);
-    for (int ch = 0; ch < captureBuffer.getNumChannels(); ++ch)
-        trimmed.copyFrom(ch, 0, captureBuffer, ch, 0, capturePosition);
-
-    // Send to MainComponent for analysis
-    double sr = hostSampleRate;
-    juce::MessageManager::callAsync([this, trimmed, sr]() {
-        if (mainComponent) {
-            mainComponent->getToolbar().setStatusMessage(TR("progress.analyzing"));
-            mainComponent->setHostAudio(trimmed, sr);
-        }
-    });
 }
 
 void PitchEditorAudioProcessor::startCapture() {
-    captureBuffer.clear();
-    capturePosition = 0;
-    captureState = CaptureState::Capturing;
+    if (capture.beginTake())
+        beginCapture();
 }
 
 void PitchEditorAudioProcessor::stopCapture() {
     if (captureState == CaptureState::Capturing)
-        finishCapture();
+        stopRequested = true;
 }
 
 void PitchEditorAudioProcessor::setMainComponent(MainComponent* mc) {
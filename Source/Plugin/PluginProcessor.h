@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../Audio/RealtimePitchProcessor.h"
+#include "../Audio/StreamingCapture.h"
 #include "../JuceHeader.h"
 #include "HostCompatibility.h"
 #include <atomic>
@@ -75,18 +76,24 @@ private:
 
     void processNonARAMode(juce::AudioBuffer<float>& buffer,
                            const juce::AudioPlayHead::PositionInfo& posInfo);
+    void beginCapture();
     void finishCapture();
 
     RealtimePitchProcessor realtimeProcessor;
     MainComponent* mainComponent = nullptr;
     double hostSampleRate = 44100.0;
 
-    // Non-ARA capture
+    // Non-ARA capture. There is no length limit: a take ends when the host
+    // transport stops, after a stretch of silence, or on stopCapture().
     std::atomic<CaptureState> captureState{CaptureState::Idle};
-    juce::AudioBuffer<float> captureBuffer;
-    int capturePosition = 0;
-    static constexpr int MAX_CAPTURE_SECONDS = 300; // 5 minutes max
+    StreamingCapture capture;
+    juce::int64 capturedSamples = 0;  // Audio thread only
+    juce::int64 silentSamples = 0;
+    bool transportSeenPlaying = false;
+    std::atomic<bool> stopRequested{false};
     static constexpr float AUDIO_THRESHOLD = 0.001f; // -60dB
+    static constexpr double MIN_CAPTURE_SECONDS = 0.5;
+    static constexpr double SILENCE_STOP_SECONDS = 5.0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PitchEditorAudioProcessor)
 };
@@ -1,4 +1,5 @@
 #include "SettingsManager.h"
+#include "../../Models/ScratchStorage.h"
 #include "../../Utils/AppLogger.h"
 
 SettingsManager::SettingsManager() {
@@ -29,6 +30,12 @@ void SettingsManager::loadSettings() {
             juce::String pitchDetectorStr = xml->getStringAttribute("pitchDetector", "RMVPE");
             pitchDetectorType = stringToPitchDetectorType(pitchDetectorStr);
             LOG("SettingsManager: Loaded pitchDetector = " + pitchDetectorStr);
+
+            // Buffers this large are kept in memory-mapped scratch files (0 = never)
+            const int thresholdMB = xml->getIntAttribute("outOfCoreThresholdMB", 128);
+            ScratchStorage::setThreshold(static_cast<size_t>(juce::jmax(0, thresholdMB)) << 20);
+
+            preRenderBudget = juce::jlimit(0, 100, xml->getIntAttribute("preRenderBudget", 25));
         }
     } else {
         LOG("SettingsManager: Settings file not found, using defaults (RMVPE)");
@@ -62,6 +69,10 @@ void SettingsManager::loadConfig() {
                 if (lastFile.isNotEmpty())
                     lastFilePath = juce::File(lastFile);
 
+                auto journaled = configObj->getProperty("journaledProject").toString();
+                if (journaled.isNotEmpty())
+                    journaledProject = juce::File(journaled);
+
                 if (configObj->hasProperty("windowWidth"))
                     windowWidth = static_cast<int>(configObj->getProperty("windowWidth"));
                 if (configObj->hasProperty("windowHeight"))
@@ -82,6 +93,8 @@ void SettingsManager::saveConfig() {
 
     if (lastFilePath.existsAsFile())
         config->setProperty("lastFile", lastFilePath.getFullPathName());
+    if (journaledProject.existsAsFile())
+        config->setProperty("journaledProject", journaledProject.getFullPathName());
 
     config->setProperty("windowWidth", windowWidth);
     config->setProperty("windowHeight", windowHeight);
@@ -22,12 +22,16 @@ public:
     juce::String getDevice() const { return device; }
     int getThreads() const { return threads; }
     PitchDetectorType getPitchDetectorType() const { return pitchDetectorType; }
+    int getPreRenderBudget() const { return preRenderBudget; }
 
     // Config (config.json - window state, last file)
     void loadConfig();
     void saveConfig();
     void setLastFilePath(const juce::File& file) { lastFilePath = file; }
     juce::File getLastFilePath() const { return lastFilePath; }
+    // Project whose edit journal was open last, checked for recovery on startup
+    void setJournaledProject(const juce::File& file) { journaledProject = file; }
+    juce::File getJournaledProject() const { return journaledProject; }
     void setWindowSize(int w, int h) { windowWidth = w; windowHeight = h; }
     int getWindowWidth() const { return windowWidth; }
     int getWindowHeight() const { return windowHeight; }
@@ -51,9 +55,11 @@ private:
     juce::String device = "CPU";
     int threads = 0;
     PitchDetectorType pitchDetectorType = PitchDetectorType::RMVPE;
+    int preRenderBudget = 25;  // Percent of the time spent pre-rendering likely edits, 0 = off
 
     // Config
     juce::File lastFilePath;
+    juce::File journaledProject;
     int windowWidth = 1200;
     int windowHeight = 800;
     bool showDeltaPitch = true;
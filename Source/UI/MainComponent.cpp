@@ -9,6 +9,7 @@
 #include "../Utils/PitchCurveProcessor.h"
 #include "../Utils/PlatformPaths.h"
 #include <atomic>
+#include <chrono>
 #include <iostream>
 #include <climits>
 
@@ -27,12 +28,18 @@ MainComponent::MainComponent(bool enableAudioDevice)
   fcpePitchDetector = std::make_unique<FCPEPitchDetector>();
   rmvpePitchDetector = std::make_unique<RMVPEPitchDetector>();
   vocoder = std::make_unique<Vocoder>();
-  undoManager = std::make_unique<PitchUndoManager>(100);
+  undoManager = std::make_unique<PitchUndoManager>();
+  editJournal = std::make_unique<EditJournal>();
+  undoManager->onActionApplied = [this](const UndoableAction &action) {
+    const auto [startFrame, endFrame] = action.getAffectedFrames();
+    editJournal->recordEdit(startFrame, endFrame);
+  };
 
   // Initialize new modular components
   fileManager = std::make_unique<AudioFileManager>();
   audioAnalyzer = std::make_unique<AudioAnalyzer>();
   incrementalSynth = std::make_unique<IncrementalSynthesizer>();
+  speculativeRenderer = std::make_unique<SpeculativeRenderer>(*incrementalSynth);
   playbackController = std::make_unique<PlaybackController>();
   menuHandler = std::make_unique<MenuHandler>();
   settingsManager = std::make_unique<SettingsManager>();
@@ -116,6 +123,37 @@ MainComponent::MainComponent(bool enableAudioDevice)
   audioAnalyzer->setPitchDetectorType(settingsManager->getPitchDetectorType());
 
   incrementalSynth->setVocoder(vocoder.get());
+  speculativeRenderer->setVocoder(vocoder.get());
+  speculativeRenderer->setBudgetPercent(settingsManager->getPreRenderBudget());
+
+  // The likely next edit of a selection is a semitone nudge either way
+  speculativeRenderer->setVariantsFunction([this](int marginFrames) {
+    std::vector<SpeculativeRenderer::Variant> variants;
+    // Pending edits would be rendered along with the nudge; nothing to predict
+    if (!project || project->hasDirtyNotes() || project->hasF0DirtyRange())
+      return variants;
+
+    const auto selected = project->getSelectedNotes();
+    if (selected.empty())
+      return variants;
+
+    // Only the frames around the selection are copied
+    int startFrame = selected.front()->getStartFrame();
+    int endFrame = selected.front()->getEndFrame();
+    for (const auto *note : selected) {
+      startFrame = std::min(startFrame, note->getStartFrame());
+      endFrame = std::max(endFrame, note->getEndFrame());
+    }
+    const int projectFrames = project->getAudioData().getNumFrames();
+    startFrame = std::max(0, startFrame - marginFrames);
+    endFrame = std::min(projectFrames, endFrame + marginFrames);
+
+    for (float semitones : {1.0f, -1.0f})
+      variants.push_back({PitchEditor::previewNudge(*project, semitones,
+                                                    startFrame, endFrame),
+                          startFrame, projectFrames});
+    return variants;
+  });
   playbackController->setAudioEngine(audioEngine.get());
   menuHandler->setUndoManager(undoManager.get());
   menuHandler->setPluginMode(isPluginMode());
@@ -209,6 +247,7 @@ MainComponent::MainComponent(bool enableAudioDevice)
   // Setup piano roll callbacks
   pianoRoll.onSeek = [this](double time) { seek(time); };
   pianoRoll.onNoteSelected = [this](Note *note) { onNoteSelected(note); };
+  pianoRoll.onSelectionChanged = [this]() { speculativeRenderer->schedule(); };
   pianoRoll.onPitchEdited = [this]() { onPitchEdited(); };
   pianoRoll.onPitchEditFinished = [this]() {
     resynthesizeIncremental();
@@ -219,7 +258,10 @@ MainComponent::MainComponent(bool enableAudioDevice)
   pianoRoll.onZoomChanged = [this](float pps) { onZoomChanged(pps); };
 
   // Setup parameter panel callbacks
-  parameterPanel.onParameterChanged = [this]() { onPitchEdited(); };
+  parameterPanel.onParameterChanged = [this]() {
+    pianoRoll.invalidateRenderCache();
+    onPitchEdited();
+  };
   parameterPanel.onParameterEditFinished = [this]() {
     resynthesizeIncremental();
     // Melodyne-style: trigger real-time processor update in plugin mode
@@ -227,6 +269,7 @@ MainComponent::MainComponent(bool enableAudioDevice)
       onPitchEditFinished();
   };
   parameterPanel.onGlobalPitchChanged = [this]() {
+    pianoRoll.invalidateRenderCache();
     pianoRoll.repaint(); // Update display
   };
   parameterPanel.onVolumeChanged = [this](float dB) {
@@ -259,9 +302,22 @@ MainComponent::MainComponent(bool enableAudioDevice)
   setWantsKeyboardFocus(true);
 
   // Load config
-  if (enableAudioDeviceFlag)
+  if (enableAudioDeviceFlag) {
     settingsManager->loadConfig();
 
+    // The last session left edits it never saved: reopen that project, which
+    // offers to replay them
+    const auto journaled = settingsManager->getJournaledProject();
+    if (journaled.existsAsFile() &&
+        EditJournal::hasRecoverableEdits(journaled)) {
+      juce::Component::SafePointer<MainComponent> safeThis(this);
+      juce::MessageManager::callAsync([safeThis, journaled]() {
+        if (safeThis != nullptr)
+          safeThis->loadAudioFile(journaled);
+      });
+    }
+  }
+
   LOG("MainComponent: starting timer...");
   // Start timer for UI updates
   startTimerHz(30);
@@ -282,6 +338,9 @@ MainComponent::~MainComponent() {
   if (loaderThread.joinable())
     loaderThread.join();
 
+  if (editJournal)
+    editJournal->close();
+
   if (audioEngine) {
     audioEngine->clearCallbacks();
     audioEngine->shutdownAudio();
@@ -411,6 +470,14 @@ bool MainComponent::keyPressed(const juce::KeyPress &key,
     return true;
   }
 
+  // Up/Down: nudge the selected notes a semitone; without a selection the
+  // keys are left to whoever else wants them
+  if ((key == juce::KeyPress::upKey || key == juce::KeyPress::downKey) &&
+      project && project->hasSelectedNotes()) {
+    pianoRoll.nudgeSelectedNotes(key == juce::KeyPress::upKey ? 1.0f : -1.0f);
+    return true;
+  }
+
   // Space bar: toggle play/pause
   if (key == juce::KeyPress::spaceKey) {
     if (isPlaying)
@@ -479,8 +546,10 @@ void MainComponent::saveProject() {
       toolbar.setProgress(-1.0f);
 
       const bool ok = ProjectSerializer::saveToFile(*project, file);
-      if (ok)
+      if (ok) {
         project->setProjectFilePath(file);
+        openEditJournal(file);
+      }
 
       toolbar.hideProgress();
     });
@@ -492,14 +561,64 @@ void MainComponent::saveProject() {
   toolbar.setProgress(-1.0f);
 
   const bool ok = ProjectSerializer::saveToFile(*project, target);
-  juce::ignoreUnused(ok);
+  if (ok)
+    openEditJournal(target);
 
   toolbar.hideProgress();
 }
 
+void MainComponent::openEditJournal(const juce::File &projectFile) {
+  if (!editJournal->open(project.get(), projectFile))
+    return;
+
+  // Checked on the next start, in case this session does not end cleanly
+  if (!isPluginMode()) {
+    settingsManager->setJournaledProject(projectFile);
+    settingsManager->saveConfig();
+  }
+}
+
+void MainComponent::resumeEditJournal(const juce::File &projectFile) {
+  if (!EditJournal::hasRecoverableEdits(projectFile)) {
+    openEditJournal(projectFile);
+    return;
+  }
+
+  // Opening the journal starts it over, so the user decides first
+  juce::Component::SafePointer<MainComponent> safeThis(this);
+  juce::AlertWindow::showOkCancelBox(
+      juce::MessageBoxIconType::QuestionIcon, TR("dialog.recover_edits"),
+      TR("dialog.recover_edits_message") + "\n" +
+          projectFile.getFullPathName(),
+      TR("dialog.recover"), TR("dialog.discard"), this,
+      juce::ModalCallbackFunction::create([safeThis, projectFile](int result) {
+        if (safeThis == nullptr || !safeThis->project)
+          return;
+
+        if (result != 0 &&
+            EditJournal::recover(*safeThis->project, projectFile) >= 0) {
+          safeThis->pianoRoll.setProject(safeThis->project.get());
+          safeThis->parameterPanel.setProject(safeThis->project.get());
+          safeThis->project->setF0DirtyRange(
+              0, safeThis->project->getAudioData().getNumFrames());
+          safeThis->resynthesizeIncremental();
+
+          // The project file still lacks these edits; the fresh journal
+          // starts with all of them
+          safeThis->openEditJournal(projectFile);
+          safeThis->editJournal->recordEdit(-1, -1);
+          safeThis->editJournal->flush();
+          return;
+        }
+
+        safeThis->openEditJournal(projectFile);
+      }));
+}
+
 void MainComponent::openFile() {
   fileChooser = std::make_unique<juce::FileChooser>(
-      TR("dialog.select_audio"), juce::File{}, "*.wav;*.mp3;*.flac;*.aiff");
+      TR("dialog.select_audio"), juce::File{},
+      "*.wav;*.mp3;*.flac;*.aiff;*.htpx");
 
   auto chooserFlags = juce::FileBrowserComponent::openMode |
                       juce::FileBrowserComponent::canSelectFiles;
@@ -540,41 +659,74 @@ void MainComponent::loadAudioFile(const juce::File &file) {
 
     updateProgress(0.05, TR("progress.loading_audio"));
 
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
-
-    std::unique_ptr<juce::AudioFormatReader> reader(
-        formatManager.createReaderFor(file));
-    if (reader == nullptr || cancelLoading.load()) {
-      juce::MessageManager::callAsync([safeThis]() {
-        if (safeThis != nullptr)
-          safeThis->isLoadingAudio = false;
-      });
-      return;
+    // A project file names its audio and brings its own notes and curves
+    const bool isProjectFile = file.hasFileExtension("htpx");
+    auto newProject = std::make_shared<Project>();
+    juce::File audioFile = file;
+    if (isProjectFile) {
+      if (!ProjectSerializer::loadFromFile(*newProject, file, false) ||
+          !newProject->getFilePath().existsAsFile()) {
+        juce::MessageManager::callAsync([safeThis]() {
+          if (safeThis != nullptr)
+            safeThis->isLoadingAudio = false;
+        });
+        return;
+      }
+      audioFile = newProject->getFilePath();
     }
 
-    // Read audio data
-    const int numSamples = static_cast<int>(reader->lengthInSamples);
-    const int srcSampleRate = static_cast<int>(reader->sampleRate);
-
-    juce::AudioBuffer<float> buffer(1, numSamples);
-
-    updateProgress(0.10, "Reading audio...");
-    if (reader->numChannels == 1) {
-      reader->read(&buffer, 0, numSamples, 0, true, false);
-    } else {
-      juce::AudioBuffer<float> stereoBuffer(2, numSamples);
-      reader->read(&stereoBuffer, 0, numSamples, 0, true, true);
+    // Decode in chunks. The mel spectrogram only looks a few hops ahead, so a
+    // second thread computes each frame as soon as its samples have arrived
+    // and the analysis below starts with it already done.
+    std::shared_ptr<juce::AudioBuffer<float>> buffer;
+    std::atomic<int> samplesReady{0};
+    std::atomic<bool> decodeFinished{false};
+    MelFrames mel;
+    std::thread melThread;
+
+    auto runMel = [&buffer, &samplesReady, &decodeFinished, &mel, this]() {
+      MelSpectrogram melComputer(SAMPLE_RATE, N_FFT, HOP_SIZE, NUM_MELS, FMIN,
+                                 FMAX);
+      const int totalSamples = buffer->getNumSamples();
+      const float *samples = buffer->getReadPointer(0);
+      mel = MelFrames(
+          static_cast<size_t>(melComputer.getNumFrames(totalSamples)),
+          NUM_MELS);
+
+      int nextFrame = 0;
+      while (nextFrame < static_cast<int>(mel.size()) && !cancelLoading.load()) {
+        const bool finished = decodeFinished.load(std::memory_order_acquire);
+        const int ready = melComputer.getNumFramesReady(
+            samplesReady.load(std::memory_order_acquire), totalSamples);
+        if (ready > nextFrame) {
+          melComputer.computeFrames(samples, totalSamples, nextFrame, ready,
+                                    mel);
+          nextFrame = ready;
+        } else if (finished) {
+          break; // decode stopped early
+        } else {
+          std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+      }
+      if (nextFrame < static_cast<int>(mel.size()))
+        mel = MelFrames();
+    };
 
-      const float *left = stereoBuffer.getReadPointer(0);
-      const float *right = stereoBuffer.getReadPointer(1);
-      float *mono = buffer.getWritePointer(0);
+    const bool decoded = AudioFileManager::decodeStreaming(
+        audioFile, SAMPLE_RATE, buffer,
+        [&](int ready, double fraction) {
+          samplesReady.store(ready, std::memory_order_release);
+          if (!melThread.joinable())
+            melThread = std::thread(runMel);
+          updateProgress(0.05 + 0.17 * fraction, "Reading audio...");
+        },
+        cancelLoading);
 
-      for (int i = 0; i < numSamples; ++i)
-        mono[i] = (left[i] + right[i]) * 0.5f;
-    }
+    decodeFinished.store(true, std::memory_order_release);
+    if (melThread.joinable())
+      melThread.join();
 
-    if (cancelLoading.load()) {
+    if (!decoded || cancelLoading.load()) {
       juce::MessageManager::callAsync([safeThis]() {
         if (safeThis != nullptr)
           safeThis->isLoadingAudio = false;
@@ -582,36 +734,12 @@ void MainComponent::loadAudioFile(const juce::File &file) {
       return;
     }
 
-    // Resample if needed
-    if (srcSampleRate != SAMPLE_RATE) {
-      updateProgress(0.18, "Resampling...");
-      const double ratio = static_cast<double>(srcSampleRate) / SAMPLE_RATE;
-      const int newNumSamples = static_cast<int>(numSamples / ratio);
-
-      juce::AudioBuffer<float> resampledBuffer(1, newNumSamples);
-      const float *src = buffer.getReadPointer(0);
-      float *dst = resampledBuffer.getWritePointer(0);
-
-      for (int i = 0; i < newNumSamples; ++i) {
-        const double srcPos = i * ratio;
-        const int srcIndex = static_cast<int>(srcPos);
-        const double frac = srcPos - srcIndex;
-
-        if (srcIndex + 1 < numSamples)
-          dst[i] = static_cast<float>(src[srcIndex] * (1.0 - frac) +
-                                      src[srcIndex + 1] * frac);
-        else
-          dst[i] = src[srcIndex];
-      }
-
-      buffer = std::move(resampledBuffer);
-    }
-
     updateProgress(0.22, "Preparing project...");
-    auto newProject = std::make_shared<Project>();
-    newProject->setFilePath(file);
+    newProject->setFilePath(audioFile);
     auto &audioData = newProject->getAudioData();
-    audioData.waveform = std::move(buffer);
+    audioData.waveform =
+        CopyOnWrite<juce::AudioBuffer<float>>(std::move(buffer));
+    audioData.melSpectrogram = std::move(mel);
     audioData.sampleRate = SAMPLE_RATE;
 
     if (cancelLoading.load()) {
@@ -622,8 +750,10 @@ void MainComponent::loadAudioFile(const juce::File &file) {
       return;
     }
 
-    updateProgress(0.25, TR("progress.analyzing_audio"));
-    analyzeAudio(*newProject, updateProgress);
+    if (!isProjectFile) {
+      updateProgress(0.25, TR("progress.analyzing_audio"));
+      analyzeAudio(*newProject, updateProgress);
+    }
 
     if (cancelLoading.load()) {
       juce::MessageManager::callAsync([safeThis]() {
@@ -635,11 +765,15 @@ void MainComponent::loadAudioFile(const juce::File &file) {
 
     updateProgress(0.95, "Finalizing...");
 
-    juce::MessageManager::callAsync([safeThis, newProject]() mutable {
+    juce::MessageManager::callAsync([safeThis, newProject, file,
+                                     isProjectFile]() mutable {
       if (safeThis == nullptr)
         return;
 
+      safeThis->editJournal->close();
       safeThis->project = std::make_unique<Project>(std::move(*newProject));
+      if (isProjectFile)
+        safeThis->project->setProjectFilePath(file);
 
       // Update UI
       safeThis->pianoRoll.setProject(safeThis->project.get());
@@ -647,6 +781,12 @@ void MainComponent::loadAudioFile(const juce::File &file) {
       safeThis->toolbar.setTotalTime(
           safeThis->project->getAudioData().getDuration());
 
+      // The fresh waveform sounds at the analysed pitch; a project's edits
+      // are rendered below instead
+      safeThis->incrementalSynth->setProject(safeThis->project.get());
+      if (!isProjectFile)
+        safeThis->incrementalSynth->captureRenderedPitch();
+
       // Get audio data reference (used in multiple places below)
       auto &audioData = safeThis->project->getAudioData();
 
@@ -667,7 +807,7 @@ void MainComponent::loadAudioFile(const juce::File &file) {
                 << juce::String::toHexString(
                        reinterpret_cast<uintptr_t>(engine)));
             try {
-              engine->loadWaveform(audioData.waveform, audioData.sampleRate);
+              engine->loadWaveform(*audioData.waveform, audioData.sampleRate);
             } catch (...) {
               DBG("MainComponent::loadAudioFile - EXCEPTION in loadWaveform!");
             }
@@ -680,8 +820,7 @@ void MainComponent::loadAudioFile(const juce::File &file) {
         }
       }
 
-      // Save original waveform for incremental synthesis
-      safeThis->originalWaveform.makeCopyOf(audioData.waveform);
+      safeThis->originalNumChannels = audioData.waveform->getNumChannels();
       safeThis->hasOriginalWaveform = true;
 
       // Center view on detected pitch range
@@ -720,6 +859,14 @@ void MainComponent::loadAudioFile(const juce::File &file) {
         }
       }
 
+      if (isProjectFile) {
+        // The audio file does not have the project's edits until they are
+        // rendered
+        safeThis->project->setF0DirtyRange(0, audioData.getNumFrames());
+        safeThis->resynthesizeIncremental();
+        safeThis->resumeEditJournal(file);
+      }
+
       safeThis->repaint();
       safeThis->isLoadingAudio = false;
 
@@ -741,12 +888,14 @@ void MainComponent::analyzeAudio() {
   if (loaderThread.joinable())
     loaderThread.join();
 
-  loaderThread = std::thread([safeThis]() {
-    if (safeThis == nullptr || !safeThis->project)
-      return;
+  // Snapshot on the message thread; waveform and mel are shared, not copied
+  auto projectCopy = std::make_shared<Project>(*project);
+  // Re-analysis recomputes the mel from the current waveform
+  projectCopy->getAudioData().melSpectrogram = MelFrames();
 
-    // Create a copy for thread safety
-    auto projectCopy = std::make_shared<Project>(*safeThis->project);
+  loaderThread = std::thread([safeThis, projectCopy]() {
+    if (safeThis == nullptr)
+      return;
 
     // Perform analysis in background thread (all model inference here)
     safeThis->analyzeAudio(*projectCopy, [](double, const juce::String &) {});
@@ -756,16 +905,18 @@ void MainComponent::analyzeAudio() {
       if (safeThis == nullptr)
         return;
 
-      // Copy analyzed data back
-      safeThis->project->getAudioData().melSpectrogram =
-          projectCopy->getAudioData().melSpectrogram;
-      safeThis->project->getAudioData().f0 = projectCopy->getAudioData().f0;
-      safeThis->project->getAudioData().voicedMask =
-          projectCopy->getAudioData().voicedMask;
-      safeThis->project->getAudioData().basePitch =
-          projectCopy->getAudioData().basePitch;
-      safeThis->project->getAudioData().deltaPitch =
-          projectCopy->getAudioData().deltaPitch;
+      // Commit analyzed data back in one step
+      auto &audioData = safeThis->project->getAudioData();
+      auto &analyzed = projectCopy->getAudioData();
+      audioData.melSpectrogram = analyzed.melSpectrogram;
+      audioData.f0 = std::move(analyzed.f0);
+      audioData.voicedMask = std::move(analyzed.voicedMask);
+      audioData.basePitch = std::move(analyzed.basePitch);
+      audioData.deltaPitch = std::move(analyzed.deltaPitch);
+
+      // Re-analysed from the current waveform, so the two match again
+      safeThis->incrementalSynth->setProject(safeThis->project.get());
+      safeThis->incrementalSynth->captureRenderedPitch();
 
       // Update UI
       safeThis->pianoRoll.setProject(safeThis->project.get());
@@ -788,22 +939,29 @@ void MainComponent::analyzeAudio(
   // here.
 
   auto &audioData = targetProject.getAudioData();
-  if (audioData.waveform.getNumSamples() == 0)
+  if (audioData.waveform->getNumSamples() == 0)
     return;
 
   // Extract F0
-  const float *samples = audioData.waveform.getReadPointer(0);
-  int numSamples = audioData.waveform.getNumSamples();
+  const float *samples = audioData.waveform->getReadPointer(0);
+  int numSamples = audioData.waveform->getNumSamples();
 
-  onProgress(0.35, "Computing mel spectrogram...");
-  // Compute mel spectrogram first (to know target frame count)
+  // Compute mel spectrogram first (to know target frame count), unless the
+  // streaming import already produced it while decoding
   // This is computationally intensive and runs in background thread
   MelSpectrogram melComputer(SAMPLE_RATE, N_FFT, HOP_SIZE, NUM_MELS, FMIN,
                              FMAX);
-  audioData.melSpectrogram = melComputer.compute(samples, numSamples);
+  if (static_cast<int>(audioData.melSpectrogram.size()) !=
+      melComputer.getNumFrames(numSamples)) {
+    onProgress(0.35, "Computing mel spectrogram...");
+    audioData.melSpectrogram = melComputer.compute(samples, numSamples);
+  }
 
   int targetFrames = static_cast<int>(audioData.melSpectrogram.size());
 
+  // Waveform drawing summary, so the first paint does not build it
+  audioData.getPeaks();
+
   onProgress(0.55, "Extracting pitch (F0)...");
 
   // Get pitch detector type from settings
@@ -922,6 +1080,7 @@ void MainComponent::analyzeAudio(
   auto modelPath =
       PlatformPaths::getModelsDirectory().getChildFile("pc_nsf_hifigan.onnx");
 
+  std::unique_lock<std::mutex> vocoderLock(vocoderLoadLock);
   if (modelPath.existsAsFile() && !vocoder->isLoaded()) {
     if (vocoder->loadModel(modelPath)) {
       DBG("Vocoder model loaded successfully: " + modelPath.getFullPathName());
@@ -930,6 +1089,8 @@ void MainComponent::analyzeAudio(
     }
   }
 
+  vocoderLock.unlock();
+
   onProgress(0.90, "Segmenting notes...");
   // Segment into notes (SOME model inference runs in background thread)
   segmentIntoNotes(targetProject);
@@ -1013,7 +1174,7 @@ void MainComponent::exportFile() {
 
       // Write audio data
       bool writeSuccess = writer->writeFromAudioSampleBuffer(
-          audioData.waveform, 0, audioData.waveform.getNumSamples());
+          *audioData.waveform, 0, audioData.waveform->getNumSamples());
 
       toolbar.setProgress(0.9f);
 
@@ -1223,6 +1384,9 @@ void MainComponent::resynthesizeIncremental() {
   DBG("  Proceeding with synthesis: dirty frames " + juce::String(dirtyStart) +
       " to " + juce::String(dirtyEnd));
 
+  // Real work first; pre-rendering resumes once this is done
+  speculativeRenderer->cancel();
+
   // Setup incrementalSynth
   incrementalSynth->setProject(project.get());
   incrementalSynth->setVocoder(vocoder.get());
@@ -1243,6 +1407,32 @@ void MainComponent::resynthesizeIncremental() {
     audioEnginePtr = audioEngine.get();
   }
 
+  // Hand rewritten samples to playback and redraw what they cover; the
+  // vocoder's result fades in over the preview if it is being heard
+  auto showReplacedSamples = [safeThis, audioEnginePtr]() {
+    if (safeThis == nullptr) return;
+
+    const auto replaced = safeThis->incrementalSynth->getLastReplacedRange();
+
+    // Only the rewritten region goes to the audio engine (standalone mode only)
+    if (audioEnginePtr && !safeThis->isPluginMode()) {
+      if (safeThis->audioEngine && safeThis->audioEngine.get() == audioEnginePtr) {
+        const auto& waveform = *safeThis->project->getAudioData().waveform;
+        if (replaced.first < replaced.second && replaced.second <= waveform.getNumSamples())
+          audioEnginePtr->replaceRegion(replaced.first, waveform.getReadPointer(0, replaced.first),
+                                        replaced.second - replaced.first, 0.05);
+      }
+    }
+
+    // Repaint piano roll to show updated waveform; only what covers the
+    // rewritten samples is redrawn
+    safeThis->pianoRoll.invalidateSampleRange(replaced.first, replaced.second);
+
+    // Notify plugin mode that project data changed
+    if (safeThis->isPluginMode() && safeThis->onProjectDataChanged)
+      safeThis->onProjectDataChanged();
+  };
+
   // Run synthesis (expands to silence boundaries, no padding, no crossfade)
   incrementalSynth->synthesizeRegion(
       // Progress callback
@@ -1251,7 +1441,7 @@ void MainComponent::resynthesizeIncremental() {
         safeThis->toolbar.showProgress(message);
       },
       // Complete callback
-      [safeThis, audioEnginePtr](bool success) {
+      [safeThis, showReplacedSamples, audioEnginePtr](bool success) {
         if (safeThis == nullptr) return;
 
         safeThis->toolbar.setEnabled(true);
@@ -1259,27 +1449,24 @@ void MainComponent::resynthesizeIncremental() {
 
         if (!success) {
           DBG("resynthesizeIncremental: Synthesis failed or was cancelled");
+          // Back to the project's audio, unless a newer job's preview is playing
+          if (audioEnginePtr && safeThis->audioEngine.get() == audioEnginePtr &&
+              !safeThis->incrementalSynth->isSynthesizing())
+            audioEnginePtr->clearPreview(0.05);
           return;
         }
 
-        // Reload waveform in audio engine (standalone mode only)
-        if (audioEnginePtr && !safeThis->isPluginMode()) {
-          if (safeThis->audioEngine && safeThis->audioEngine.get() == audioEnginePtr) {
-            auto& audioData = safeThis->project->getAudioData();
-            try {
-              audioEnginePtr->loadWaveform(audioData.waveform, audioData.sampleRate, true);
-            } catch (...) {
-              DBG("resynthesizeIncremental: EXCEPTION in loadWaveform!");
-            }
-          }
-        }
-
-        // Repaint piano roll to show updated waveform
-        safeThis->pianoRoll.repaint();
+        showReplacedSamples();
 
-        // Notify plugin mode that project data changed
-        if (safeThis->isPluginMode() && safeThis->onProjectDataChanged)
-          safeThis->onProjectDataChanged();
+        // The selection is likely to be nudged again
+        safeThis->speculativeRenderer->schedule();
+      },
+      // Preview callback: played only, the project's waveform is untouched
+      [safeThis, audioEnginePtr](int startSample, const std::vector<float>& samples) {
+        if (safeThis == nullptr || audioEnginePtr == nullptr ||
+            safeThis->audioEngine.get() != audioEnginePtr)
+          return;
+        audioEnginePtr->setPreview(startSample, samples, 0.05);
       });
 }
 
@@ -1288,8 +1475,9 @@ void MainComponent::onNoteSelected(Note *note) {
 }
 
 void MainComponent::onPitchEdited() {
-  pianoRoll.repaint();
+  // The piano roll repaints what the edit changed itself
   parameterPanel.updateFromNote();
+  speculativeRenderer->cancel();
 }
 
 void MainComponent::onZoomChanged(float pixelsPerSecond) {
@@ -1306,9 +1494,13 @@ void MainComponent::onZoomChanged(float pixelsPerSecond) {
 }
 
 void MainComponent::undo() {
+  if (hostEditingLocked)
+    return;
+
   if (undoManager && undoManager->canUndo()) {
+    // The action reports what it changed through the project (or its
+    // callback), so the piano roll redraws only those frames and pitches
     undoManager->undo();
-    pianoRoll.repaint();
 
     if (project) {
       // Don't mark all notes as dirty - let undo action callbacks handle
@@ -1320,9 +1512,11 @@ void MainComponent::undo() {
 }
 
 void MainComponent::redo() {
+  if (hostEditingLocked)
+    return;
+
   if (undoManager && undoManager->canRedo()) {
     undoManager->redo();
-    pianoRoll.repaint();
 
     if (project) {
       // Don't mark all notes as dirty - let redo action callbacks handle
@@ -1349,12 +1543,12 @@ void MainComponent::segmentIntoNotes() {
   if (loaderThread.joinable())
     loaderThread.join();
 
-  loaderThread = std::thread([safeThis]() {
-    if (safeThis == nullptr || !safeThis->project)
-      return;
+  // Snapshot on the message thread; waveform and mel are shared, not copied
+  auto projectCopy = std::make_shared<Project>(*project);
 
-    // Create a copy for thread safety
-    auto projectCopy = std::make_shared<Project>(*safeThis->project);
+  loaderThread = std::thread([safeThis, projectCopy]() {
+    if (safeThis == nullptr)
+      return;
 
     // Perform segmentation in background thread (SOME model inference here)
     safeThis->segmentIntoNotes(*projectCopy);
@@ -1364,8 +1558,8 @@ void MainComponent::segmentIntoNotes() {
       if (safeThis == nullptr)
         return;
 
-      // Copy notes back
-      safeThis->project->getNotes() = projectCopy->getNotes();
+      // Move notes back
+      safeThis->project->setNotes(projectCopy->getNotes());
 
       // Update UI
       safeThis->pianoRoll.invalidateBasePitchCache();
@@ -1379,8 +1573,8 @@ void MainComponent::segmentIntoNotes(Project &targetProject) {
   // It should ONLY be called from background threads to avoid blocking UI.
 
   auto &audioData = targetProject.getAudioData();
-  auto &notes = targetProject.getNotes();
-  notes.clear();
+  std::vector<Note> notes;
+  targetProject.clearNotes();
 
   if (audioData.f0.empty())
     return;
@@ -1388,10 +1582,10 @@ void MainComponent::segmentIntoNotes(Project &targetProject) {
   // Try to use SOME model for segmentation if available
   // SOME model inference runs in background thread
   if (someDetector && someDetector->isLoaded() &&
-      audioData.waveform.getNumSamples() > 0) {
+      audioData.waveform->getNumSamples() > 0) {
 
-    const float *samples = audioData.waveform.getReadPointer(0);
-    int numSamples = audioData.waveform.getNumSamples();
+    const float *samples = audioData.waveform->getReadPointer(0);
+    int numSamples = audioData.waveform->getNumSamples();
 
     // audioData.f0 uses vocoder frame rate: 44100Hz / 512 hop = 86.13 fps
     // SOME uses 44100Hz / 512 hop = 86.13 fps (same!)
@@ -1419,11 +1613,7 @@ void MainComponent::segmentIntoNotes(Project &targetProject) {
 
             // Use SOME's predicted MIDI value directly for note position
             // Delta pitch (from RMVPE/FCPE F0) will capture the pitch curve details
-            Note note(f0Start, f0End, someNote.midiNote);
-            std::vector<float> f0Values(audioData.f0.begin() + f0Start,
-                                        audioData.f0.begin() + f0End);
-            note.setF0Values(std::move(f0Values));
-            notes.push_back(note);
+            notes.emplace_back(f0Start, f0End, someNote.midiNote);
           }
 
           // Update UI on main thread
@@ -1441,6 +1631,7 @@ void MainComponent::segmentIntoNotes(Project &targetProject) {
 
     DBG("SOME segmented into " << notes.size() << " notes");
 
+    targetProject.setNotes(std::move(notes));
     if (!audioData.f0.empty())
       PitchCurveProcessor::rebuildCurvesFromSource(targetProject, audioData.f0);
 
@@ -1470,11 +1661,7 @@ void MainComponent::segmentIntoNotes(Project &targetProject) {
 
     float midi = midiSum / midiCount;
 
-    Note note(start, end, midi);
-    std::vector<float> f0Values(audioData.f0.begin() + start,
-                                audioData.f0.begin() + end);
-    note.setF0Values(std::move(f0Values));
-    notes.push_back(note);
+    notes.emplace_back(start, end, midi);
   };
 
   // Segment F0 into notes, splitting on pitch changes > 0.5 semitones
@@ -1547,6 +1734,7 @@ void MainComponent::segmentIntoNotes(Project &targetProject) {
   }
 
   // Update dense pitch curves after segmentation
+  targetProject.setNotes(std::move(notes));
   if (!audioData.f0.empty())
     PitchCurveProcessor::rebuildCurvesFromSource(targetProject, audioData.f0);
 }
@@ -1565,6 +1753,9 @@ void MainComponent::showSettings() {
     settingsDialog->getSettingsComponent()->onPitchDetectorChanged = [this](PitchDetectorType type) {
       audioAnalyzer->setPitchDetectorType(type);
     };
+    settingsDialog->getSettingsComponent()->onPreRenderBudgetChanged = [this](int percent) {
+      speculativeRenderer->setBudgetPercent(percent);
+    };
   }
 
   settingsDialog->setVisible(true);
@@ -1575,7 +1766,8 @@ bool MainComponent::isInterestedInFileDrag(const juce::StringArray &files) {
   for (const auto &file : files) {
     if (file.endsWithIgnoreCase(".wav") || file.endsWithIgnoreCase(".mp3") ||
         file.endsWithIgnoreCase(".flac") || file.endsWithIgnoreCase(".aiff") ||
-        file.endsWithIgnoreCase(".ogg") || file.endsWithIgnoreCase(".m4a"))
+        file.endsWithIgnoreCase(".ogg") || file.endsWithIgnoreCase(".m4a") ||
+        file.endsWithIgnoreCase(".htpx"))
       return true;
   }
   return false;
@@ -1596,6 +1788,28 @@ void MainComponent::setHostAudio(const juce::AudioBuffer<float> &buffer,
   if (!isPluginMode())
     return;
 
+  setHostAudio(ScratchStorage::copyAudioBuffer(buffer), sampleRate);
+}
+
+void MainComponent::setHostAudio(
+    std::shared_ptr<juce::AudioBuffer<float>> buffer, double sampleRate,
+    bool takeInProgress) {
+  if (!isPluginMode() || buffer == nullptr)
+    return;
+
+  hostTakeInProgress = takeInProgress;
+
+  // A streaming capture hands over a growing recording; only the newest one
+  // matters, so replace whatever is still waiting
+  if (hostAnalysisRunning) {
+    pendingHostAudio = std::move(buffer);
+    pendingHostSampleRate = sampleRate;
+    updateHostEditingLock();
+    return;
+  }
+  hostAnalysisRunning = true;
+  updateHostEditingLock();
+
   DBG("MainComponent::setHostAudio called - starting async analysis");
 
   // Use SafePointer to prevent accessing destroyed component
@@ -1607,10 +1821,11 @@ void MainComponent::setHostAudio(const juce::AudioBuffer<float> &buffer,
 
   // Store sample rate and waveform (on message thread)
   project->getAudioData().sampleRate = static_cast<int>(sampleRate);
-  project->getAudioData().waveform = buffer;
+  const bool hadAnalysis = !project->getAudioData().f0.empty();
+  project->getAudioData().waveform =
+      CopyOnWrite<juce::AudioBuffer<float>>(std::move(buffer));
 
-  // Store original waveform for synthesis
-  originalWaveform = buffer;
+  originalNumChannels = project->getAudioData().waveform->getNumChannels();
   hasOriginalWaveform = true;
 
   // Show analyzing progress
@@ -1621,21 +1836,16 @@ void MainComponent::setHostAudio(const juce::AudioBuffer<float> &buffer,
   if (loaderThread.joinable())
     loaderThread.join();
 
-  loaderThread = std::thread([safeThis]() {
+  // Project data for analysis, captured on the message thread (the waveform
+  // is shared with the current project, not copied)
+  auto projectCopy = std::make_shared<Project>();
+  projectCopy->getAudioData().waveform = project->getAudioData().waveform;
+  projectCopy->getAudioData().sampleRate = project->getAudioData().sampleRate;
+
+  loaderThread = std::thread([safeThis, projectCopy, hadAnalysis]() {
     if (safeThis == nullptr)
       return;
 
-    // Create a copy of project data for analysis
-    // This ensures thread safety
-    auto projectCopy = std::make_shared<Project>();
-    {
-      // Copy project data (safe to read from background thread)
-      projectCopy->getAudioData().waveform =
-          safeThis->project->getAudioData().waveform;
-      projectCopy->getAudioData().sampleRate =
-          safeThis->project->getAudioData().sampleRate;
-    }
-
     DBG("MainComponent::setHostAudio - analysis thread started");
 
     // Use shared analyzeAudio function (same as loadAudioFile)
@@ -1658,71 +1868,128 @@ void MainComponent::setHostAudio(const juce::AudioBuffer<float> &buffer,
 
     // Analysis complete - update main project on message thread
     // Use same UI update logic as loadAudioFile for consistency
-    juce::MessageManager::callAsync([safeThis, projectCopy]() mutable {
+    juce::MessageManager::callAsync([safeThis, projectCopy,
+                                     hadAnalysis]() mutable {
       if (safeThis == nullptr)
         return;
 
-      safeThis->project = std::make_unique<Project>(std::move(*projectCopy));
+      // Later passes over a growing capture keep the user's view
+      safeThis->showHostProject(
+          std::make_unique<Project>(std::move(*projectCopy)), !hadAnalysis);
+
+      safeThis->hostAnalysisRunning = false;
+      if (auto pending = std::move(safeThis->pendingHostAudio))
+        safeThis->setHostAudio(std::move(pending),
+                               safeThis->pendingHostSampleRate,
+                               safeThis->hostTakeInProgress);
+      else
+        safeThis->updateHostEditingLock();
+    });
+  });
+}
 
-      // Update UI components (shared logic)
-      safeThis->pianoRoll.setProject(safeThis->project.get());
-      safeThis->parameterPanel.setProject(safeThis->project.get());
-      safeThis->toolbar.setTotalTime(
-          safeThis->project->getAudioData().getDuration());
+void MainComponent::setHostTakeInProgress(bool inProgress) {
+  if (!isPluginMode())
+    return;
 
-      // Center view on detected pitch range (shared logic)
-      const auto &f0 = safeThis->project->getAudioData().f0;
-      if (!f0.empty()) {
-        float minF0 = 10000.0f, maxF0 = 0.0f;
-        for (float freq : f0) {
-          if (freq > 50.0f) {
-            minF0 = std::min(minF0, freq);
-            maxF0 = std::max(maxF0, freq);
-          }
-        }
-        if (maxF0 > minF0) {
-          float minMidi = freqToMidi(minF0) - 2.0f;
-          float maxMidi = freqToMidi(maxF0) + 2.0f;
-          safeThis->pianoRoll.centerOnPitchRange(minMidi, maxMidi);
-        }
+  hostTakeInProgress = inProgress;
+  updateHostEditingLock();
+}
+
+void MainComponent::updateHostEditingLock() {
+  // Edits made before the last analysis pass is shown would be thrown away
+  // with the project it replaces, so they are not accepted at all
+  const bool locked = hostTakeInProgress || hostAnalysisRunning;
+  if (locked == hostEditingLocked)
+    return;
+
+  hostEditingLocked = locked;
+  pianoRoll.setEditingEnabled(!locked);
+  parameterPanel.setEnabled(!locked);
+  toolbar.setStatusMessage(locked ? TR("progress.editing_paused_host")
+                                  : juce::String());
+}
+
+void MainComponent::setHostProject(const Project &analysed) {
+  if (!isPluginMode())
+    return;
+
+  auto copy = std::make_unique<Project>(analysed);
+
+  originalNumChannels = copy->getAudioData().waveform->getNumChannels();
+  hasOriginalWaveform = true;
+
+  showHostProject(std::move(copy), true);
+}
+
+void MainComponent::showHostProject(std::unique_ptr<Project> analysed,
+                                    bool recenter) {
+  editJournal->close();
+  project = std::move(analysed);
+
+  // Update UI components (shared logic)
+  pianoRoll.setProject(project.get());
+  parameterPanel.setProject(project.get());
+  toolbar.setTotalTime(project->getAudioData().getDuration());
+
+  // The host's audio sounds at the analysed pitch
+  incrementalSynth->setProject(project.get());
+  incrementalSynth->captureRenderedPitch();
+
+  // Center view on detected pitch range (shared logic)
+  const auto &f0 = project->getAudioData().f0;
+  if (!f0.empty() && recenter) {
+    float minF0 = 10000.0f, maxF0 = 0.0f;
+    for (float freq : f0) {
+      if (freq > 50.0f) {
+        minF0 = std::min(minF0, freq);
+        maxF0 = std::max(maxF0, freq);
       }
+    }
+    if (maxF0 > minF0) {
+      float minMidi = freqToMidi(minF0) - 2.0f;
+      float maxMidi = freqToMidi(maxF0) + 2.0f;
+      pianoRoll.centerOnPitchRange(minMidi, maxMidi);
+    }
+  }
 
-      safeThis->repaint();
+  repaint();
 
-      // Load vocoder if not already loaded (required for real-time processing)
-      // This is done in analyzeAudio, but we ensure it's loaded here too
-      if (!safeThis->vocoder->isLoaded()) {
-        DBG("MainComponent::setHostAudio - loading vocoder model");
-        auto modelPath = PlatformPaths::getModelsDirectory().getChildFile(
-            "pc_nsf_hifigan.onnx");
-        if (modelPath.existsAsFile()) {
-          if (safeThis->vocoder->loadModel(modelPath)) {
-            DBG("MainComponent::setHostAudio - vocoder model loaded "
-                "successfully: "
-                << modelPath.getFullPathName());
-          } else {
-            DBG("MainComponent::setHostAudio - failed to load vocoder model: "
-                << modelPath.getFullPathName());
-          }
+  // Load vocoder if not already loaded (required for real-time processing)
+  // This is done in analyzeAudio, but we ensure it's loaded here too
+  {
+    const std::lock_guard<std::mutex> lock(vocoderLoadLock);
+    if (!vocoder->isLoaded()) {
+      DBG("MainComponent::showHostProject - loading vocoder model");
+      auto modelPath = PlatformPaths::getModelsDirectory().getChildFile(
+          "pc_nsf_hifigan.onnx");
+      if (modelPath.existsAsFile()) {
+        if (vocoder->loadModel(modelPath)) {
+          DBG("MainComponent::showHostProject - vocoder model loaded "
+              "successfully: "
+              << modelPath.getFullPathName());
         } else {
-          DBG("MainComponent::setHostAudio - vocoder model not found at: "
+          DBG("MainComponent::showHostProject - failed to load vocoder model: "
               << modelPath.getFullPathName());
         }
       } else {
-        DBG("MainComponent::setHostAudio - vocoder already loaded");
+        DBG("MainComponent::showHostProject - vocoder model not found at: "
+            << modelPath.getFullPathName());
       }
+    } else {
+      DBG("MainComponent::showHostProject - vocoder already loaded");
+    }
+  }
 
-      // Trigger real-time processor update (this will also set vocoder if
-      // needed)
-      if (safeThis->onProjectDataChanged)
-        safeThis->onProjectDataChanged();
+  // Trigger real-time processor update (this will also set vocoder if
+  // needed)
+  if (onProjectDataChanged)
+    onProjectDataChanged();
 
-      // Hide progress bar
-      safeThis->toolbar.hideProgress();
+  // Hide progress bar
+  toolbar.hideProgress();
 
-      DBG("MainComponent::setHostAudio - UI update complete");
-    });
-  });
+  DBG("MainComponent::showHostProject - UI update complete");
 }
 
 void MainComponent::updatePlaybackPosition(double timeSeconds) {
@@ -1745,7 +2012,7 @@ bool MainComponent::isARAModeActive() const {
   // If we have project data and it wasn't captured manually, it's likely from
   // ARA This is a heuristic - in a real implementation, we'd track this
   // explicitly
-  if (project && project->getAudioData().waveform.getNumSamples() > 0) {
+  if (project && project->getAudioData().waveform->getNumSamples() > 0) {
     // Check if we're not currently capturing (which would indicate non-ARA
     // mode) Note: This requires access to PluginProcessor, which we don't have
     // here A better approach would be to set a flag when ARA audio is received
@@ -1765,16 +2032,21 @@ void MainComponent::renderProcessedAudio() {
   // Use SafePointer to prevent accessing destroyed component
   juce::Component::SafePointer<MainComponent> safeThis(this);
 
+  // Capture the inputs on the message thread: the mel spectrogram is shared,
+  // the pitch curve is copied once
+  MelFrames melSpec = project->getAudioData().melSpectrogram;
+  std::vector<float> modifiedF0 = project->getAudioData().f0;
+  const auto voicedMask = project->getAudioData().voicedMask;
+  const float globalOffset = project->getGlobalPitchOffset();
+  const int numChannels = originalNumChannels;
+
   // Run synthesis in background thread
-  std::thread([safeThis]() {
+  std::thread([safeThis, melSpec, modifiedF0, voicedMask, globalOffset,
+               numChannels]() mutable {
     if (safeThis == nullptr)
       return;
 
-    // Resynthesize with current edits
-    auto &f0Array = safeThis->project->getAudioData().f0;
-    auto &voicedMask = safeThis->project->getAudioData().voicedMask;
-
-    if (f0Array.empty()) {
+    if (modifiedF0.empty()) {
       juce::MessageManager::callAsync([safeThis]() {
         if (safeThis != nullptr)
           safeThis->toolbar.hideProgress();
@@ -1783,15 +2055,11 @@ void MainComponent::renderProcessedAudio() {
     }
 
     // Apply global pitch offset
-    std::vector<float> modifiedF0 = f0Array;
-    float globalOffset = safeThis->project->getGlobalPitchOffset();
     for (size_t i = 0; i < modifiedF0.size(); ++i) {
       if (voicedMask[i] && modifiedF0[i] > 0)
         modifiedF0[i] *= std::pow(2.0f, globalOffset / 12.0f);
     }
 
-    // Get mel spectrogram
-    auto &melSpec = safeThis->project->getAudioData().melSpectrogram;
     if (melSpec.empty()) {
       juce::MessageManager::callAsync([safeThis]() {
         if (safeThis != nullptr)
@@ -1806,8 +2074,7 @@ void MainComponent::renderProcessedAudio() {
     if (!synthesized.empty()) {
       // Create output buffer
       juce::AudioBuffer<float> outputBuffer(
-          safeThis->originalWaveform.getNumChannels(),
-          static_cast<int>(synthesized.size()));
+          numChannels, static_cast<int>(synthesized.size()));
 
       // Copy to all channels
       for (int ch = 0; ch < outputBuffer.getNumChannels(); ++ch) {
@@ -9,9 +9,11 @@
 #include "../Audio/IO/AudioFileManager.h"
 #include "../Audio/Analysis/AudioAnalyzer.h"
 #include "../Audio/Synthesis/IncrementalSynthesizer.h"
+#include "../Audio/Synthesis/SpeculativeRenderer.h"
 #include "../Audio/Engine/PlaybackController.h"
 #include "../JuceHeader.h"
 #include "../Models/Project.h"
+#include "../Utils/EditJournal.h"
 #include "../Utils/UndoManager.h"
 #include "CustomMenuBarLookAndFeel.h"
 #include "CustomTitleBar.h"
@@ -24,6 +26,7 @@
 #include "Workspace/WorkspaceComponent.h"
 
 #include <atomic>
+#include <mutex>
 #include <thread>
 
 class MainComponent : public juce::Component,
@@ -63,6 +66,25 @@ public:
 
   // Plugin mode - host audio handling
   void setHostAudio(const juce::AudioBuffer<float> &buffer, double sampleRate);
+  // Adopts buffer without copying. While an analysis pass is running the
+  // newest buffer is queued and analysed once it finishes. takeInProgress
+  // marks a snapshot of a take that is still recording.
+  void setHostAudio(std::shared_ptr<juce::AudioBuffer<float>> buffer,
+                    double sampleRate, bool takeInProgress = false);
+  // Every analysis pass replaces the project, so editing is locked from the
+  // start of a host take until the finished take has been analysed and
+  // shown. Cleared without a final buffer when the take is discarded.
+  void setHostTakeInProgress(bool inProgress);
+  // Show a project that was already analysed elsewhere (the ARA analysis
+  // queue); the waveform is shared, not copied
+  void setHostProject(const Project &analysed);
+
+  // Full analysis of targetProject's waveform (mel, F0, notes, curves).
+  // Background threads only; safe to run for several projects at once.
+  void analyzeAudio(
+      Project &targetProject,
+      const std::function<void(double, const juce::String &)> &onProgress,
+      std::function<void()> onComplete = nullptr);
   void renderProcessedAudio();
 
   // Plugin mode callbacks
@@ -95,14 +117,16 @@ private:
 
   void loadAudioFile(const juce::File &file);
   void analyzeAudio();
-  void analyzeAudio(
-      Project &targetProject,
-      const std::function<void(double, const juce::String &)> &onProgress,
-      std::function<void()> onComplete = nullptr);
+  void showHostProject(std::unique_ptr<Project> analysed, bool recenter);
   void segmentIntoNotes();
   void segmentIntoNotes(Project &targetProject);
 
   void saveProject();
+  // Journal edits to projectFile, which holds the project as it is now
+  void openEditJournal(const juce::File &projectFile);
+  // After opening projectFile: offer to replay the edits a previous session
+  // journaled but never saved, then start a fresh journal
+  void resumeEditJournal(const juce::File &projectFile);
 
   void undo();
   void redo();
@@ -119,11 +143,13 @@ private:
       someDetector; // SOME note segmentation detector (legacy)
   std::unique_ptr<Vocoder> vocoder;
   std::unique_ptr<PitchUndoManager> undoManager;
+  std::unique_ptr<EditJournal> editJournal; // Incremental autosave of edits
 
   // New modular components
   std::unique_ptr<AudioFileManager> fileManager;
   std::unique_ptr<AudioAnalyzer> audioAnalyzer;
   std::unique_ptr<IncrementalSynthesizer> incrementalSynth;
+  std::unique_ptr<SpeculativeRenderer> speculativeRenderer;  // Fills incrementalSynth's cache
   std::unique_ptr<PlaybackController> playbackController;
   std::unique_ptr<MenuHandler> menuHandler;
   std::unique_ptr<SettingsManager> settingsManager;
@@ -141,8 +167,10 @@ private:
 
   std::unique_ptr<juce::FileChooser> fileChooser;
 
-  // Original waveform for incremental synthesis
-  juce::AudioBuffer<float> originalWaveform;
+  // Channel count of the original waveform, for rendering. The buffer itself
+  // is not kept, so the project's waveform is never shared and edits write
+  // into it in place.
+  int originalNumChannels = 0;
   bool hasOriginalWaveform = false;
 
   bool isPlaying = false;
@@ -159,6 +187,17 @@ private:
   juce::String loadingMessage;
   juce::String lastLoadingMessage;
 
+  // Serialises the lazy vocoder load in concurrent analyzeAudio() calls
+  std::mutex vocoderLoadLock;
+
+  // Host audio analysis (message thread only)
+  bool hostAnalysisRunning = false;
+  std::shared_ptr<juce::AudioBuffer<float>> pendingHostAudio;
+  double pendingHostSampleRate = 0.0;
+  bool hostTakeInProgress = false;
+  bool hostEditingLocked = false;
+  void updateHostEditingLock();
+
   // Cursor update throttling
   std::atomic<double> pendingCursorTime{0.0};
   std::atomic<bool> hasPendingCursorUpdate{false};
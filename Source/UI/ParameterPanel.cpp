@@ -133,8 +133,18 @@ void ParameterPanel::sliderValueChanged(juce::Slider* slider)
 
     if (slider == &pitchOffsetSlider && selectedNote)
     {
-        selectedNote->setPitchOffset(static_cast<float>(slider->getValue()));
-        selectedNote->markDirty();  // Mark as dirty for incremental synthesis
+        const float offset = static_cast<float>(slider->getValue());
+        // Mark as dirty for incremental synthesis
+        if (project)
+        {
+            project->setNotePitch(selectedNote, selectedNote->getMidiNote(), offset);
+            project->markNoteDirty(selectedNote);
+        }
+        else
+        {
+            selectedNote->setPitchOffset(offset);
+            selectedNote->markDirty();
+        }
 
         if (onParameterChanged)
             onParameterChanged();
@@ -144,8 +154,7 @@ void ParameterPanel::sliderValueChanged(juce::Slider* slider)
         project->setGlobalPitchOffset(static_cast<float>(slider->getValue()));
 
         // Mark all notes as dirty for full resynthesis
-        for (auto& note : project->getNotes())
-            note.markDirty();
+        project->markAllNotesDirty();
 
         if (onGlobalPitchChanged)
             onGlobalPitchChanged();
@@ -31,19 +31,27 @@ std::vector<Note*> BoxSelector::getNotesInRect(Project* project, CoordinateMappe
 
     auto rect = getSelectionRect();
 
-    for (auto& note : project->getNotes()) {
-        if (note.isRest())
+    // Only notes within the rectangle's frame and pitch span can intersect
+    // it; a note's row reaches one semitone above its adjusted MIDI note
+    const float pixelsPerSecond = mapper->getPixelsPerSecond();
+    const int startFrame = secondsToFrames(rect.getX() / pixelsPerSecond) - 1;
+    const int endFrame = secondsToFrames(rect.getRight() / pixelsPerSecond) + 2;
+    const float lowMidi = mapper->yToMidi(rect.getBottom()) - 0.01f;
+    const float highMidi = mapper->yToMidi(rect.getY()) + 1.01f;
+
+    for (auto* note : project->getNotesInArea(startFrame, endFrame, lowMidi, highMidi)) {
+        if (note->isRest())
             continue;
 
-        float noteX = framesToSeconds(note.getStartFrame()) * mapper->getPixelsPerSecond();
-        float noteW = framesToSeconds(note.getDurationFrames()) * mapper->getPixelsPerSecond();
-        float noteY = mapper->midiToY(note.getAdjustedMidiNote());
+        float noteX = framesToSeconds(note->getStartFrame()) * pixelsPerSecond;
+        float noteW = framesToSeconds(note->getDurationFrames()) * pixelsPerSecond;
+        float noteY = mapper->midiToY(note->getAdjustedMidiNote());
         float noteH = mapper->getPixelsPerSemitone();
 
         juce::Rectangle<float> noteRect(noteX, noteY, noteW, noteH);
 
         if (rect.intersects(noteRect)) {
-            result.push_back(&note);
+            result.push_back(note);
         }
     }
 
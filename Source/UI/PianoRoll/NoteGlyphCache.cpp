@@ -0,0 +1,220 @@
+#include "NoteGlyphCache.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Catmull-Rom spline: smooth interpolation between p1 and p2
+    float catmullRom(float t, float p0, float p1, float p2, float p3) {
+        float t2 = t * t;
+        float t3 = t2 * t;
+        return 0.5f * ((2.0f * p1) + (-p0 + p2) * t +
+                       (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                       (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t3);
+    }
+
+    // Interpolated points between each pair of values
+    constexpr int curveSegments = 4;
+
+    // Top curve left to right (sign -1) or bottom curve right to left (sign 1)
+    void addCurve(juce::Path& path, const std::vector<float>& values, float sign) {
+        const size_t numPoints = values.size();
+        const float last = static_cast<float>(numPoints - 1);
+
+        if (sign < 0.0f) {
+            for (size_t i = 0; i + 1 < numPoints; ++i) {
+                float u1 = static_cast<float>(i) / last;
+                float u2 = static_cast<float>(i + 1) / last;
+
+                size_t idx0 = (i > 0) ? i - 1 : i;
+                size_t idx3 = (i + 2 < numPoints) ? i + 2 : i + 1;
+
+                for (int seg = 1; seg <= curveSegments; ++seg) {
+                    float t = static_cast<float>(seg) / static_cast<float>(curveSegments);
+                    float val = catmullRom(t, values[idx0], values[i], values[i + 1], values[idx3]);
+                    path.lineTo(u1 + (u2 - u1) * t, sign * val);
+                }
+            }
+        } else {
+            for (int i = static_cast<int>(numPoints) - 2; i >= 0; --i) {
+                const auto n = static_cast<size_t>(i);
+                float u1 = static_cast<float>(n + 1) / last;
+                float u2 = static_cast<float>(n) / last;
+
+                size_t idx0 = (n + 2 < numPoints) ? n + 2 : n + 1;
+                size_t idx3 = (n > 0) ? n - 1 : n;
+
+                for (int seg = 1; seg <= curveSegments; ++seg) {
+                    float t = static_cast<float>(seg) / static_cast<float>(curveSegments);
+                    float val = catmullRom(t, values[idx0], values[n + 1], values[n], values[idx3]);
+                    path.lineTo(u1 + (u2 - u1) * t, sign * val);
+                }
+            }
+        }
+    }
+}
+
+const NoteGlyphCache::Glyph* NoteGlyphCache::getGlyph(int startSample, int endSample, float width,
+                                                      const juce::AudioBuffer<float>& waveform,
+                                                      const WaveformPeaks& peaks,
+                                                      juce::uint32 dataVersion) {
+    if (width <= 0.0f || endSample <= startSample)
+        return nullptr;
+
+    applyInvalidations(dataVersion);
+
+    const int bucket = juce::roundToInt(std::log2(width) * BUCKETS_PER_OCTAVE);
+    const float bucketWidth = std::exp2(static_cast<float>(bucket) / BUCKETS_PER_OCTAVE);
+
+    // Samples older than an applied invalidation may predate the rewrite it was for
+    if (dataVersion < appliedVersion) {
+        build(scratch, startSample, endSample, bucketWidth, waveform, peaks);
+        return scratch.shaped ? &scratch.glyph : nullptr;
+    }
+
+    const Key key{startSample, endSample, bucket};
+    auto found = glyphs.find(key);
+    if (found == glyphs.end()) {
+        evictOverBudget();
+        found = glyphs.emplace(key, Entry()).first;
+        build(found->second, startSample, endSample, bucketWidth, waveform, peaks);
+        cachedValues += found->second.numValues;
+    }
+
+    found->second.lastUsed = ++useCounter;
+    return found->second.shaped ? &found->second.glyph : nullptr;
+}
+
+juce::AffineTransform NoteGlyphCache::getTransform(float x, float centreY, float width, float waveHeight) {
+    return juce::AffineTransform::scale(width, waveHeight * 0.5f).translated(x, centreY);
+}
+
+void NoteGlyphCache::invalidateSampleRange(int startSample, int endSample) {
+    std::lock_guard<std::mutex> lock(pendingLock);
+    if (pending.size() >= MAX_PENDING) {
+        pending.clear();
+        resetVersion = ++version;
+        return;
+    }
+    pending.push_back({startSample, endSample, ++version});
+}
+
+void NoteGlyphCache::invalidateAll() {
+    std::lock_guard<std::mutex> lock(pendingLock);
+    pending.clear();
+    resetVersion = ++version;
+}
+
+juce::uint32 NoteGlyphCache::getVersion() const {
+    std::lock_guard<std::mutex> lock(pendingLock);
+    return version;
+}
+
+void NoteGlyphCache::applyInvalidations(juce::uint32 dataVersion) {
+    std::vector<Invalidation> due;
+    juce::uint32 reset = 0;
+    {
+        std::lock_guard<std::mutex> lock(pendingLock);
+        std::swap(reset, resetVersion);
+        auto firstLater = std::stable_partition(pending.begin(), pending.end(),
+                                                [dataVersion](const Invalidation& inv) {
+                                                    return inv.version <= dataVersion;
+                                                });
+        due.assign(pending.begin(), firstLater);
+        pending.erase(pending.begin(), firstLater);
+    }
+
+    if (reset != 0) {
+        glyphs.clear();
+        cachedValues = 0;
+        appliedVersion = std::max(appliedVersion, reset);
+    }
+
+    for (const auto& inv : due) {
+        for (auto it = glyphs.begin(); it != glyphs.end() && std::get<0>(it->first) < inv.endSample;) {
+            if (std::get<1>(it->first) > inv.startSample) {
+                cachedValues -= it->second.numValues;
+                it = glyphs.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        appliedVersion = std::max(appliedVersion, inv.version);
+    }
+}
+
+void NoteGlyphCache::build(Entry& entry, int startSample, int endSample, float width,
+                           const juce::AudioBuffer<float>& waveform, const WaveformPeaks& peaks) const {
+    entry.glyph.fill.clear();
+    entry.glyph.outline.clear();
+    entry.numValues = 0;
+    entry.shaped = false;
+
+    const int totalSamples = waveform.getNumSamples();
+    startSample = std::max(0, std::min(startSample, totalSamples - 1));
+    endSample = std::max(startSample + 1, std::min(endSample, totalSamples));
+    if (totalSamples <= 0)
+        return;
+
+    int numNoteSamples = endSample - startSample;
+    int samplesPerPixel = std::max(1, static_cast<int>(numNoteSamples / width));
+
+    // Increased resolution for smoother curves (up to about 2000 points)
+    std::vector<float> waveValues;
+    float step = std::max(0.5f, width / 1024.0f);
+
+    for (float px = 0; px <= width; px += step) {
+        int sampleIdx = startSample + static_cast<int>((px / width) * numNoteSamples);
+        int sampleEnd = std::min(sampleIdx + samplesPerPixel, endSample);
+
+        waveValues.push_back(peaks.getPeak(waveform, sampleIdx, sampleEnd).getMagnitude());
+    }
+
+    // Simple 3-point moving average to reduce aliasing artifacts
+    if (waveValues.size() > 2) {
+        std::vector<float> smoothed(waveValues.size());
+        smoothed[0] = waveValues[0];
+        for (size_t i = 1; i + 1 < waveValues.size(); ++i)
+            smoothed[i] = (waveValues[i - 1] * 0.25f + waveValues[i] * 0.5f + waveValues[i + 1] * 0.25f);
+        smoothed[waveValues.size() - 1] = waveValues[waveValues.size() - 1];
+        waveValues = std::move(smoothed);
+    }
+
+    entry.numValues = waveValues.size();
+    if (waveValues.size() < 2)
+        return;
+
+    auto& fill = entry.glyph.fill;
+    fill.startNewSubPath(0.0f, -waveValues.front());
+    addCurve(fill, waveValues, -1.0f);
+    fill.lineTo(1.0f, waveValues.back());
+    addCurve(fill, waveValues, 1.0f);
+    fill.closeSubPath();
+
+    auto& outline = entry.glyph.outline;
+    outline.startNewSubPath(0.0f, -waveValues.front());
+    addCurve(outline, waveValues, -1.0f);
+    addCurve(outline, waveValues, 1.0f);
+    outline.closeSubPath();
+
+    entry.shaped = true;
+}
+
+void NoteGlyphCache::evictOverBudget() {
+    if (cachedValues <= MAX_CACHED_VALUES)
+        return;
+
+    // Least recently used out until a quarter of the budget is free
+    std::vector<std::pair<juce::uint32, Key>> byUse;
+    byUse.reserve(glyphs.size());
+    for (const auto& [key, entry] : glyphs)
+        byUse.emplace_back(entry.lastUsed, key);
+    std::sort(byUse.begin(), byUse.end());
+
+    for (const auto& [lastUsed, key] : byUse) {
+        if (cachedValues <= MAX_CACHED_VALUES * 3 / 4)
+            break;
+        auto it = glyphs.find(key);
+        cachedValues -= it->second.numValues;
+        glyphs.erase(it);
+    }
+}
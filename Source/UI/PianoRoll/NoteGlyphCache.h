@@ -0,0 +1,102 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Models/WaveformPeaks.h"
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+/**
+ * Waveform shapes drawn inside notes, built once and reused across paints.
+ *
+ * A glyph is the smoothed Catmull-Rom outline of a note's sample range,
+ * mirrored about its centre line. It is stored as paths normalised to the
+ * note (x from 0 to 1, y in peak magnitude), so drawing one is a fill and a
+ * stroke through getTransform() with no resampling. Glyphs are built for
+ * widths rounded to BUCKETS_PER_OCTAVE steps per doubling, which keeps the
+ * point density right while a zoom or resize reuses them.
+ *
+ * Entries are found by sample range and width bucket and stay valid until
+ * invalidateSampleRange() covers their samples, i.e. until synthesis rewrites
+ * that part of the waveform. Selection, pitch offsets and vertical zoom
+ * only change how a glyph is placed, never its shape.
+ *
+ * Like PitchCurveCache, invalidations may come from any thread and are
+ * numbered; getGlyph() takes the number current when its waveform was
+ * copied and does not keep glyphs built from samples older than an
+ * invalidation it has already applied. getGlyph() itself must be called from
+ * one thread at a time.
+ */
+class NoteGlyphCache {
+public:
+    struct Glyph {
+        juce::Path fill;     // Top curve, then the mirrored bottom curve, closed
+        juce::Path outline;  // The same curves without the joining edge at the end
+    };
+
+    /**
+     * The glyph for samples [startSample, endSample) drawn width pixels wide,
+     * built if needed; nullptr if the range is too short to shape. The
+     * pointer is valid until the next call. dataVersion is getVersion() from
+     * when waveform and peaks were taken.
+     */
+    const Glyph* getGlyph(int startSample, int endSample, float width,
+                          const juce::AudioBuffer<float>& waveform, const WaveformPeaks& peaks,
+                          juce::uint32 dataVersion);
+
+    /** Places a glyph over a note at x, width wide, centred on centreY. */
+    static juce::AffineTransform getTransform(float x, float centreY, float width, float waveHeight);
+
+    /** Drop the glyphs of every range overlapping [startSample, endSample). */
+    void invalidateSampleRange(int startSample, int endSample);
+
+    /** Drop everything, e.g. when a different waveform is loaded. */
+    void invalidateAll();
+
+    /** Number of the latest invalidation. */
+    juce::uint32 getVersion() const;
+
+    static constexpr int BUCKETS_PER_OCTAVE = 8;
+
+private:
+    // (start sample, end sample, width bucket)
+    using Key = std::tuple<int, int, int>;
+
+    struct Entry {
+        Glyph glyph;
+        size_t numValues = 0;  // Cost: path points scale with this
+        juce::uint32 lastUsed = 0;
+        bool shaped = false;
+    };
+
+    struct Invalidation {
+        int startSample = 0;
+        int endSample = 0;
+        juce::uint32 version = 0;
+    };
+
+    void applyInvalidations(juce::uint32 dataVersion);
+    void build(Entry& entry, int startSample, int endSample, float width,
+               const juce::AudioBuffer<float>& waveform, const WaveformPeaks& peaks) const;
+    void evictOverBudget();
+
+    // Drawing thread only
+    std::map<Key, Entry> glyphs;
+    Entry scratch;  // Glyph from samples older than the cache
+    size_t cachedValues = 0;
+    juce::uint32 useCounter = 0;
+    juce::uint32 appliedVersion = 0;
+
+    // Any thread, under pendingLock
+    mutable std::mutex pendingLock;
+    std::vector<Invalidation> pending;
+    juce::uint32 resetVersion = 0;  // Drop everything, whatever the data version
+    juce::uint32 version = 0;
+
+    // Past this, pending ranges collapse into one reset
+    static constexpr size_t MAX_PENDING = 1024;
+
+    // Smoothed peak values across all glyphs; about 200 bytes of path each
+    static constexpr size_t MAX_CACHED_VALUES = 256 * 1024;
+};
@@ -8,17 +8,21 @@ Note* NoteSplitter::findNoteAt(float x, float y) {
     float pixelsPerSecond = coordMapper->getPixelsPerSecond();
     float pixelsPerSemitone = coordMapper->getPixelsPerSemitone();
 
-    for (auto& note : project->getNotes()) {
-        if (note.isRest())
+    // Only notes around the cursor's frame and pitch can contain it; the
+    // slack covers the rounding in secondsToFrames and yToMidi
+    const int frame = secondsToFrames(x / pixelsPerSecond);
+    const float midi = coordMapper->yToMidi(y);
+    for (auto* note : project->getNotesInArea(frame - 1, frame + 2, midi - 0.01f, midi + 1.01f)) {
+        if (note->isRest())
             continue;
 
-        float noteX = framesToSeconds(note.getStartFrame()) * pixelsPerSecond;
-        float noteW = framesToSeconds(note.getDurationFrames()) * pixelsPerSecond;
-        float noteY = coordMapper->midiToY(note.getAdjustedMidiNote());
+        float noteX = framesToSeconds(note->getStartFrame()) * pixelsPerSecond;
+        float noteW = framesToSeconds(note->getDurationFrames()) * pixelsPerSecond;
+        float noteY = coordMapper->midiToY(note->getAdjustedMidiNote());
         float noteH = pixelsPerSemitone;
 
         if (x >= noteX && x < noteX + noteW && y >= noteY && y < noteY + noteH) {
-            return &note;
+            return note;
         }
     }
 
@@ -48,7 +52,7 @@ bool NoteSplitter::splitNoteAtFrame(Note* note, int splitFrame) {
     secondNote.setPitchOffset(0.0f);
 
     // Modify the first note (left part)
-    note->setEndFrame(splitFrame);
+    project->setNoteRange(note, startFrame, splitFrame);
 
     // Add the second note to project
     project->addNote(secondNote);
@@ -57,15 +61,15 @@ bool NoteSplitter::splitNoteAtFrame(Note* note, int splitFrame) {
     if (undoManager) {
         auto action = std::make_unique<NoteSplitAction>(
             project, originalNote, *note, secondNote,
-            [this]() {
+            [this, startFrame, endFrame]() {
                 if (onNoteSplit)
-                    onNoteSplit();
+                    onNoteSplit(startFrame, endFrame);
             });
         undoManager->addAction(std::move(action));
     }
 
     if (onNoteSplit)
-        onNoteSplit();
+        onNoteSplit(startFrame, endFrame);
 
     return true;
 }
@@ -35,8 +35,8 @@ public:
      */
     bool splitNoteAtX(Note* note, float x);
 
-    // Callbacks
-    std::function<void()> onNoteSplit;
+    // Callbacks; the frames of the note that was split (or rejoined on undo)
+    std::function<void(int startFrame, int endFrame)> onNoteSplit;
 
 private:
     Project* project = nullptr;
@@ -1,4 +1,5 @@
 #include "PianoRollRenderer.h"
+#include <utility>
 
 PianoRollRenderer::PianoRollRenderer() = default;
 
@@ -13,22 +14,15 @@ void PianoRollRenderer::invalidateBasePitchCache() {
     cacheInvalidated = true;
     cachedNoteCount = 0;
     cachedBasePitch.clear();
-}
-
-float PianoRollRenderer::catmullRom(float t, float p0, float p1, float p2, float p3) {
-    float t2 = t * t;
-    float t3 = t2 * t;
-    return 0.5f * ((2.0f * p1) + (-p0 + p2) * t +
-                   (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
-                   (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t3);
+    pitchCurves.invalidateAll();
 }
 
 void PianoRollRenderer::drawBackgroundWaveform(juce::Graphics& g, const juce::Rectangle<int>& area) {
     if (!project || !coordMapper)
         return;
 
-    const auto& audioData = project->getAudioData();
-    if (audioData.waveform.getNumSamples() == 0)
+    auto& audioData = project->getAudioData();
+    if (audioData.waveform->getNumSamples() == 0)
         return;
 
     double scrollX = coordMapper->getScrollX();
@@ -50,8 +44,9 @@ void PianoRollRenderer::drawBackgroundWaveform(juce::Graphics& g, const juce::Re
     waveformCache = juce::Image(juce::Image::ARGB, area.getWidth(), area.getHeight(), true);
     juce::Graphics cacheGraphics(waveformCache);
 
-    const float* samples = audioData.waveform.getReadPointer(0);
-    int numSamples = audioData.waveform.getNumSamples();
+    const auto& waveform = *audioData.waveform;
+    const auto& peaks = audioData.getPeaks();
+    int numSamples = waveform.getNumSamples();
 
     float visibleHeight = static_cast<float>(area.getHeight());
     float centerY = visibleHeight * 0.5f;
@@ -60,9 +55,8 @@ void PianoRollRenderer::drawBackgroundWaveform(juce::Graphics& g, const juce::Re
     juce::Path waveformPath;
     int visibleWidth = area.getWidth();
 
-    waveformPath.startNewSubPath(0.0f, centerY);
-
-    // Top half
+    // Peak per visible column, from the peak pyramid
+    std::vector<float> columnPeaks(static_cast<size_t>(visibleWidth));
     for (int px = 0; px < visibleWidth; ++px) {
         double time = (scrollX + px) / pixelsPerSecond;
         int startSample = static_cast<int>(time * SAMPLE_RATE);
@@ -71,28 +65,20 @@ void PianoRollRenderer::drawBackgroundWaveform(juce::Graphics& g, const juce::Re
         startSample = std::max(0, std::min(startSample, numSamples - 1));
         endSample = std::max(startSample + 1, std::min(endSample, numSamples));
 
-        float maxVal = 0.0f;
-        for (int i = startSample; i < endSample; ++i)
-            maxVal = std::max(maxVal, std::abs(samples[i]));
+        columnPeaks[static_cast<size_t>(px)] = peaks.getPeak(waveform, startSample, endSample).getMagnitude();
+    }
 
-        float y = centerY - maxVal * waveformHeight * 0.5f;
+    waveformPath.startNewSubPath(0.0f, centerY);
+
+    // Top half
+    for (int px = 0; px < visibleWidth; ++px) {
+        float y = centerY - columnPeaks[static_cast<size_t>(px)] * waveformHeight * 0.5f;
         waveformPath.lineTo(static_cast<float>(px), y);
     }
 
     // Bottom half (reverse)
     for (int px = visibleWidth - 1; px >= 0; --px) {
-        double time = (scrollX + px) / pixelsPerSecond;
-        int startSample = static_cast<int>(time * SAMPLE_RATE);
-        int endSample = static_cast<int>((time + 1.0 / pixelsPerSecond) * SAMPLE_RATE);
-
-        startSample = std::max(0, std::min(startSample, numSamples - 1));
-        endSample = std::max(startSample + 1, std::min(endSample, numSamples));
-
-        float maxVal = 0.0f;
-        for (int i = startSample; i < endSample; ++i)
-            maxVal = std::max(maxVal, std::abs(samples[i]));
-
-        float y = centerY + maxVal * waveformHeight * 0.5f;
+        float y = centerY + columnPeaks[static_cast<size_t>(px)] * waveformHeight * 0.5f;
         waveformPath.lineTo(static_cast<float>(px), y);
     }
 
@@ -218,13 +204,16 @@ void PianoRollRenderer::drawNotes(juce::Graphics& g, double visibleStartTime, do
     if (!project || !coordMapper)
         return;
 
-    const auto& audioData = project->getAudioData();
-    const float* samples = audioData.waveform.getNumSamples() > 0
-                               ? audioData.waveform.getReadPointer(0)
-                               : nullptr;
-    int totalSamples = audioData.waveform.getNumSamples();
+    auto& audioData = project->getAudioData();
+    const auto& waveform = *audioData.waveform;
+    const WaveformPeaks* peaks = waveform.getNumSamples() > 0 ? &audioData.getPeaks() : nullptr;
+
+    // Candidate notes from the note index, with a frame of slack either side
+    const int visibleStartFrame = secondsToFrames(static_cast<float>(visibleStartTime)) - 1;
+    const int visibleEndFrame = secondsToFrames(static_cast<float>(visibleEndTime)) + 2;
 
-    for (auto& note : project->getNotes()) {
+    for (auto* visibleNote : project->getNotesInRange(visibleStartFrame, visibleEndFrame)) {
+        auto& note = *visibleNote;
         if (note.isRest())
             continue;
 
@@ -245,8 +234,8 @@ void PianoRollRenderer::drawNotes(juce::Graphics& g, double visibleStartTime, do
                                      ? juce::Colour(COLOR_NOTE_SELECTED)
                                      : juce::Colour(COLOR_NOTE_NORMAL);
 
-        if (samples && totalSamples > 0 && w > 2.0f) {
-            drawNoteWaveform(g, note, x, y, w, h, samples, totalSamples, audioData.sampleRate);
+        if (peaks && w > 2.0f) {
+            drawNoteWaveform(g, note, x, y, w, h, waveform, *peaks, audioData.sampleRate);
         } else {
             g.setColour(noteColor.withAlpha(0.85f));
             g.fillRoundedRectangle(x, y, std::max(w, 4.0f), h, 2.0f);
@@ -255,107 +244,34 @@ void PianoRollRenderer::drawNotes(juce::Graphics& g, double visibleStartTime, do
 }
 
 void PianoRollRenderer::drawNoteWaveform(juce::Graphics& g, const Note& note, float x, float y, float w, float h,
-                                         const float* samples, int totalSamples, int sampleRate) {
+                                         const juce::AudioBuffer<float>& waveform, const WaveformPeaks& peaks,
+                                         int sampleRate) {
     juce::Colour noteColor = note.isSelected()
                                  ? juce::Colour(COLOR_NOTE_SELECTED)
                                  : juce::Colour(COLOR_NOTE_NORMAL);
 
     int startSample = static_cast<int>(framesToSeconds(note.getStartFrame()) * sampleRate);
     int endSample = static_cast<int>(framesToSeconds(note.getEndFrame()) * sampleRate);
-    startSample = std::max(0, std::min(startSample, totalSamples - 1));
-    endSample = std::max(startSample + 1, std::min(endSample, totalSamples));
-
-    int numNoteSamples = endSample - startSample;
-    int samplesPerPixel = std::max(1, static_cast<int>(numNoteSamples / w));
-
-    float centerY = y + h * 0.5f;
-    float waveHeight = h * 3.0f;
 
-    std::vector<float> waveValues;
-    float step = std::max(0.5f, w / 1024.0f);
-
-    for (float px = 0; px <= w; px += step) {
-        int sampleIdx = startSample + static_cast<int>((px / w) * numNoteSamples);
-        int sampleEnd = std::min(sampleIdx + samplesPerPixel, endSample);
-
-        float maxVal = 0.0f;
-        for (int i = sampleIdx; i < sampleEnd; ++i)
-            maxVal = std::max(maxVal, std::abs(samples[i]));
-
-        waveValues.push_back(maxVal);
-    }
-
-    // Smooth waveform
-    if (waveValues.size() > 2) {
-        std::vector<float> smoothed(waveValues.size());
-        smoothed[0] = waveValues[0];
-        for (size_t i = 1; i + 1 < waveValues.size(); ++i) {
-            smoothed[i] = (waveValues[i - 1] * 0.25f + waveValues[i] * 0.5f + waveValues[i + 1] * 0.25f);
-        }
-        smoothed[waveValues.size() - 1] = waveValues[waveValues.size() - 1];
-        waveValues = std::move(smoothed);
-    }
-
-    size_t numPoints = waveValues.size();
-    if (numPoints < 2) {
+    const auto* glyph = noteGlyphs.getGlyph(startSample, endSample, w, waveform, peaks,
+                                            noteGlyphs.getVersion());
+    if (!glyph) {
         g.setColour(noteColor.withAlpha(0.85f));
         g.fillRoundedRectangle(x, y, std::max(w, 4.0f), h, 2.0f);
         return;
     }
 
+    const auto transform = NoteGlyphCache::getTransform(x, y + h * 0.5f, w, h * 3.0f);
+
     // Draw filled waveform
     g.setColour(noteColor.withAlpha(0.85f));
-    juce::Path waveformPath;
-
-    waveformPath.startNewSubPath(x, centerY - waveValues[0] * waveHeight * 0.5f);
-
-    const int curveSegments = 4;
-    for (size_t i = 0; i + 1 < numPoints; ++i) {
-        float px1 = (static_cast<float>(i) / static_cast<float>(numPoints - 1)) * w;
-        float px2 = (static_cast<float>(i + 1) / static_cast<float>(numPoints - 1)) * w;
-
-        size_t idx0 = (i > 0) ? i - 1 : i;
-        size_t idx1 = i;
-        size_t idx2 = i + 1;
-        size_t idx3 = (i + 2 < numPoints) ? i + 2 : i + 1;
-
-        for (int seg = 1; seg <= curveSegments; ++seg) {
-            float t = static_cast<float>(seg) / static_cast<float>(curveSegments);
-            float px = px1 + (px2 - px1) * t;
-            float val = catmullRom(t, waveValues[idx0], waveValues[idx1], waveValues[idx2], waveValues[idx3]);
-            float yPos = centerY - val * waveHeight * 0.5f;
-            waveformPath.lineTo(x + px, yPos);
-        }
-    }
-
-    // Bottom curve
-    waveformPath.lineTo(x + w, centerY + waveValues[numPoints - 1] * waveHeight * 0.5f);
-
-    for (int i = static_cast<int>(numPoints) - 2; i >= 0; --i) {
-        float px1 = (static_cast<float>(i + 1) / static_cast<float>(numPoints - 1)) * w;
-        float px2 = (static_cast<float>(i) / static_cast<float>(numPoints - 1)) * w;
-
-        size_t idx0 = (i + 2 < numPoints) ? i + 2 : i + 1;
-        size_t idx1 = i + 1;
-        size_t idx2 = i;
-        size_t idx3 = (i > 0) ? i - 1 : i;
-
-        for (int seg = 1; seg <= curveSegments; ++seg) {
-            float t = static_cast<float>(seg) / static_cast<float>(curveSegments);
-            float px = px1 + (px2 - px1) * t;
-            float val = catmullRom(t, waveValues[idx0], waveValues[idx1], waveValues[idx2], waveValues[idx3]);
-            float yPos = centerY + val * waveHeight * 0.5f;
-            waveformPath.lineTo(x + px, yPos);
-        }
-    }
-
-    waveformPath.closeSubPath();
-    g.fillPath(waveformPath);
+    g.fillPath(glyph->fill, transform);
 
     // Draw outline
     g.setColour(noteColor.brighter(0.2f));
-    g.strokePath(waveformPath, juce::PathStrokeType(1.2f, juce::PathStrokeType::curved,
-                                                     juce::PathStrokeType::rounded));
+    g.strokePath(glyph->fill, juce::PathStrokeType(1.2f, juce::PathStrokeType::curved,
+                                                    juce::PathStrokeType::rounded),
+                 transform);
 }
 
 void PianoRollRenderer::drawPitchCurves(juce::Graphics& g, float globalPitchOffset) {
@@ -368,45 +284,43 @@ void PianoRollRenderer::drawPitchCurves(juce::Graphics& g, float globalPitchOffs
 
     g.setColour(juce::Colour(COLOR_PITCH_CURVE));
 
-    for (const auto& note : project->getNotes()) {
+    // Only notes under the region being painted, with slack for stroke width
+    const float pixelsPerSecond = coordMapper->getPixelsPerSecond();
+    const auto clip = g.getClipBounds();
+    const float startX = static_cast<float>(clip.getX() - 4);
+    const float endX = static_cast<float>(clip.getRight() + 4);
+
+    const int f0Size = static_cast<int>(audioData.f0.size());
+    auto pitchAt = [&audioData, f0Size](int i) {
+        float baseMidi = (i < static_cast<int>(audioData.basePitch.size()))
+            ? audioData.basePitch[static_cast<size_t>(i)]
+            : ((i < f0Size && audioData.f0[static_cast<size_t>(i)] > 0.0f)
+                ? freqToMidi(audioData.f0[static_cast<size_t>(i)])
+                : 0.0f);
+
+        float deltaMidi = (i < static_cast<int>(audioData.deltaPitch.size()))
+            ? audioData.deltaPitch[static_cast<size_t>(i)]
+            : 0.0f;
+
+        return baseMidi + deltaMidi;
+    };
+
+    for (auto* visibleNote : project->getNotesInRange(secondsToFrames(startX / pixelsPerSecond) - 1,
+                                                      secondsToFrames(endX / pixelsPerSecond) + 2)) {
+        const auto& note = *visibleNote;
         if (note.isRest())
             continue;
 
-        juce::Path path;
-        bool pathStarted = false;
-
-        int startFrame = note.getStartFrame();
-        int endFrame = std::min(note.getEndFrame(), static_cast<int>(audioData.f0.size()));
-
-        for (int i = startFrame; i < endFrame; ++i) {
-            float baseMidi = (i < static_cast<int>(audioData.basePitch.size()))
-                ? audioData.basePitch[static_cast<size_t>(i)] + note.getPitchOffset()
-                : ((i < static_cast<int>(audioData.f0.size()) && audioData.f0[static_cast<size_t>(i)] > 0.0f)
-                    ? freqToMidi(audioData.f0[static_cast<size_t>(i)]) + note.getPitchOffset()
-                    : 0.0f);
-
-            float deltaMidi = (i < static_cast<int>(audioData.deltaPitch.size()))
-                ? audioData.deltaPitch[static_cast<size_t>(i)]
-                : 0.0f;
-
-            float finalMidi = baseMidi + deltaMidi + globalPitchOffset;
+        const float offset = note.getPitchOffset() + globalPitchOffset;
+        auto curveY = [this, offset](float midi) {
+            return coordMapper->midiToY(midi + offset) + coordMapper->getPixelsPerSemitone() * 0.5f;
+        };
 
-            if (finalMidi > 0.0f) {
-                float x = framesToSeconds(i) * coordMapper->getPixelsPerSecond();
-                float y = coordMapper->midiToY(finalMidi) + coordMapper->getPixelsPerSemitone() * 0.5f;
-
-                if (!pathStarted) {
-                    path.startNewSubPath(x, y);
-                    pathStarted = true;
-                } else {
-                    path.lineTo(x, y);
-                }
-            }
-        }
-
-        if (pathStarted) {
+        juce::Path path;
+        pitchCurves.addToPath(path, note, pixelsPerSecond, startX, endX, pitchAt, curveY,
+                              pitchCurves.getVersion());
+        if (!path.isEmpty())
             g.strokePath(path, juce::PathStrokeType(2.0f));
-        }
     }
 }
 
@@ -471,7 +385,7 @@ void PianoRollRenderer::updateBasePitchCacheIfNeeded() {
         return;
     }
 
-    const auto& notes = project->getNotes();
+    const auto& notes = std::as_const(*project).getNotes();
     const auto& audioData = project->getAudioData();
     int totalFrames = static_cast<int>(audioData.f0.size());
 
@@ -5,6 +5,8 @@
 #include "../../Utils/Constants.h"
 #include "../../Utils/BasePitchCurve.h"
 #include "CoordinateMapper.h"
+#include "NoteGlyphCache.h"
+#include "PitchCurveCache.h"
 #include <vector>
 
 /**
@@ -17,7 +19,7 @@ public:
     ~PianoRollRenderer() = default;
 
     void setCoordinateMapper(CoordinateMapper* mapper) { coordMapper = mapper; }
-    void setProject(Project* proj) { project = proj; }
+    void setProject(Project* proj) { project = proj; noteGlyphs.invalidateAll(); }
 
     // Main drawing methods
     void drawBackgroundWaveform(juce::Graphics& g, const juce::Rectangle<int>& area);
@@ -32,17 +34,17 @@ public:
     void invalidateWaveformCache();
     void invalidateBasePitchCache();
     void updateBasePitchCacheIfNeeded();
+    void invalidatePitchCurves(int startFrame, int endFrame) { pitchCurves.invalidateFrameRange(startFrame, endFrame); }
+    void invalidateNoteGlyphs(int startSample, int endSample) { noteGlyphs.invalidateSampleRange(startSample, endSample); }
 
     // Debug option
     static constexpr bool ENABLE_BASE_PITCH_DEBUG = true;
 
 private:
-    // Helper for Catmull-Rom spline interpolation
-    static float catmullRom(float t, float p0, float p1, float p2, float p3);
-
-    // Draw note waveform with smooth curves
+    // Draw note waveform with smooth curves; waveform must be the one peaks was built for
     void drawNoteWaveform(juce::Graphics& g, const Note& note, float x, float y, float w, float h,
-                         const float* samples, int totalSamples, int sampleRate);
+                         const juce::AudioBuffer<float>& waveform, const WaveformPeaks& peaks,
+                         int sampleRate);
 
     CoordinateMapper* coordMapper = nullptr;
     Project* project = nullptr;
@@ -60,5 +62,11 @@ private:
     int cachedTotalFrames = 0;
     bool cacheInvalidated = true;
 
+    // Decimated pitch curve geometry per note
+    PitchCurveCache pitchCurves;
+
+    // Waveform shapes inside notes, kept until their samples are rewritten
+    NoteGlyphCache noteGlyphs;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PianoRollRenderer)
 };
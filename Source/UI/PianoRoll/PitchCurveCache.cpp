@@ -0,0 +1,165 @@
+#include "PitchCurveCache.h"
+#include "../../Utils/Constants.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    struct Sample {
+        int frame = 0;
+        float x = 0.0f;
+        float midi = 0.0f;
+    };
+}
+
+void PitchCurveCache::addToPath(juce::Path& path, const Note& note, float pps,
+                                float startX, float endX, const PitchFunction& pitchAt,
+                                const YFunction& midiToY, juce::uint32 dataVersion) {
+    applyInvalidations(dataVersion);
+
+    if (pps != pixelsPerSecond) {
+        notes.clear();
+        pixelsPerSecond = pps;
+    }
+
+    // Data older than an applied invalidation may predate the edit it was for
+    const auto& points = getGeometry(note, pitchAt, dataVersion >= appliedVersion).points;
+    if (points.empty())
+        return;
+
+    auto begin = std::lower_bound(points.begin(), points.end(), startX,
+                                  [](const juce::Point<float>& p, float x) { return p.x < x; });
+    auto end = std::upper_bound(points.begin(), points.end(), endX,
+                                [](float x, const juce::Point<float>& p) { return x < p.x; });
+    if (begin != points.begin())
+        --begin;
+    if (end != points.end())
+        ++end;
+    if (begin >= end)
+        return;
+
+    path.startNewSubPath(begin->x, midiToY(begin->y));
+    for (auto p = begin + 1; p != end; ++p)
+        path.lineTo(p->x, midiToY(p->y));
+}
+
+void PitchCurveCache::invalidateFrameRange(int startFrame, int endFrame) {
+    std::lock_guard<std::mutex> lock(pendingLock);
+    if (pending.size() >= MAX_PENDING) {
+        pending.clear();
+        resetVersion = ++version;
+        return;
+    }
+    pending.push_back({startFrame, endFrame, ++version});
+}
+
+void PitchCurveCache::invalidateAll() {
+    std::lock_guard<std::mutex> lock(pendingLock);
+    pending.clear();
+    resetVersion = ++version;
+}
+
+juce::uint32 PitchCurveCache::getVersion() const {
+    std::lock_guard<std::mutex> lock(pendingLock);
+    return version;
+}
+
+void PitchCurveCache::applyInvalidations(juce::uint32 dataVersion) {
+    std::vector<Invalidation> due;
+    juce::uint32 reset = 0;
+    {
+        std::lock_guard<std::mutex> lock(pendingLock);
+        std::swap(reset, resetVersion);
+        auto firstLater = std::stable_partition(pending.begin(), pending.end(),
+                                                [dataVersion](const Invalidation& inv) {
+                                                    return inv.version <= dataVersion;
+                                                });
+        due.assign(pending.begin(), firstLater);
+        pending.erase(pending.begin(), firstLater);
+    }
+
+    // A reset is applied at once, even for older data; what that data builds
+    // is then not kept
+    if (reset != 0) {
+        notes.clear();
+        appliedVersion = std::max(appliedVersion, reset);
+    }
+
+    for (const auto& inv : due) {
+        for (auto it = notes.begin(); it != notes.end() && it->first < inv.endFrame;) {
+            if (it->second.endFrame > inv.startFrame)
+                it = notes.erase(it);
+            else
+                ++it;
+        }
+        appliedVersion = std::max(appliedVersion, inv.version);
+    }
+}
+
+const PitchCurveCache::Geometry& PitchCurveCache::getGeometry(const Note& note,
+                                                              const PitchFunction& pitchAt,
+                                                              bool keep) {
+    if (!keep) {
+        build(scratch, note, pitchAt);
+        return scratch;
+    }
+
+    auto found = notes.find(note.getStartFrame());
+    if (found != notes.end() && found->second.endFrame == note.getEndFrame())
+        return found->second;
+
+    auto& geometry = notes[note.getStartFrame()];
+    build(geometry, note, pitchAt);
+    return geometry;
+}
+
+void PitchCurveCache::build(Geometry& geometry, const Note& note,
+                            const PitchFunction& pitchAt) const {
+    geometry.endFrame = note.getEndFrame();
+    geometry.points.clear();
+
+    // Voiced frames seen so far in the current pixel column
+    Sample first, lowest, highest, last;
+    int column = 0;
+    bool columnOpen = false;
+
+    auto flushColumn = [&]() {
+        if (!columnOpen)
+            return;
+
+        Sample ordered[] = {first, lowest, highest, last};
+        std::sort(std::begin(ordered), std::end(ordered),
+                  [](const Sample& a, const Sample& b) { return a.frame < b.frame; });
+
+        int previousFrame = -1;
+        for (const auto& sample : ordered) {
+            if (sample.frame != previousFrame)
+                geometry.points.emplace_back(sample.x, sample.midi);
+            previousFrame = sample.frame;
+        }
+        columnOpen = false;
+    };
+
+    // Unvoiced frames are skipped; the curve bridges them as it always has
+    for (int i = note.getStartFrame(); i < note.getEndFrame(); ++i) {
+        const float midi = pitchAt(i);
+        if (midi <= 0.0f)
+            continue;
+
+        const Sample sample{i, framesToSeconds(i) * pixelsPerSecond, midi};
+        const int sampleColumn = static_cast<int>(std::floor(sample.x));
+
+        if (columnOpen && sampleColumn == column) {
+            if (midi < lowest.midi)
+                lowest = sample;
+            if (midi > highest.midi)
+                highest = sample;
+            last = sample;
+        } else {
+            flushColumn();
+            first = lowest = highest = last = sample;
+            column = sampleColumn;
+            columnOpen = true;
+        }
+    }
+    flushColumn();
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include "../../Models/Note.h"
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/**
+ * Per-note pitch curve geometry for drawing, decimated to the zoom.
+ *
+ * A note's curve is built once per zoom as points in world x (pixels before
+ * scrolling) and MIDI pitch. Where several frames fall into one pixel column
+ * only the first, lowest, highest and last are kept, so zoomed out a note
+ * costs a few points per pixel however many frames it spans. Pitch is stored
+ * before the note's drag offset and the global offset, and mapped to y while
+ * drawing, so dragging a note reuses its geometry.
+ *
+ * Geometry is kept until invalidateFrameRange() covers the note's frames or
+ * the zoom changes. Entries are found by the note's frame range.
+ *
+ * Drawing may run on a render worker from a copy of the project while the
+ * message thread keeps editing. Invalidations can come from any thread and
+ * are numbered; addToPath() takes the number current when its data was
+ * copied, applies the invalidations up to it, and does not keep geometry
+ * built from data older than an invalidation it has already applied.
+ * addToPath() itself must be called from one thread at a time.
+ */
+class PitchCurveCache {
+public:
+    /** Composed pitch (base + delta) in MIDI at a frame, <= 0 where unvoiced. */
+    using PitchFunction = std::function<float(int frame)>;
+
+    /** Maps a note's stored pitch to y, adding whatever offsets apply. */
+    using YFunction = std::function<float(float midi)>;
+
+    /**
+     * Append the part of note's curve over world x [startX, endX] to path as
+     * one sub-path, plus the nearest point on either side so pieces drawn for
+     * neighbouring areas join up. Builds the note's geometry if needed.
+     * dataVersion is getVersion() from when pitchAt's data was taken.
+     */
+    void addToPath(juce::Path& path, const Note& note, float pixelsPerSecond,
+                   float startX, float endX, const PitchFunction& pitchAt,
+                   const YFunction& midiToY, juce::uint32 dataVersion);
+
+    /** Drop the geometry of every note overlapping [startFrame, endFrame). */
+    void invalidateFrameRange(int startFrame, int endFrame);
+
+    /** Drop everything. */
+    void invalidateAll();
+
+    /** Number of the latest invalidation. */
+    juce::uint32 getVersion() const;
+
+private:
+    struct Geometry {
+        int endFrame = 0;
+        std::vector<juce::Point<float>> points;  // (world x, MIDI)
+    };
+
+    struct Invalidation {
+        int startFrame = 0;
+        int endFrame = 0;
+        juce::uint32 version = 0;
+    };
+
+    void applyInvalidations(juce::uint32 dataVersion);
+    const Geometry& getGeometry(const Note& note, const PitchFunction& pitchAt, bool keep);
+    void build(Geometry& geometry, const Note& note, const PitchFunction& pitchAt) const;
+
+    // Drawing thread only
+    std::map<int, Geometry> notes;  // By start frame
+    Geometry scratch;               // Geometry from data older than the cache
+    float pixelsPerSecond = 0.0f;
+    juce::uint32 appliedVersion = 0;
+
+    // Any thread, under pendingLock
+    mutable std::mutex pendingLock;
+    std::vector<Invalidation> pending;
+    juce::uint32 resetVersion = 0;  // Drop everything, whatever the data version
+    juce::uint32 version = 0;
+
+    // Past this, pending ranges collapse into one reset
+    static constexpr size_t MAX_PENDING = 1024;
+};
@@ -1,4 +1,18 @@
 #include "PitchEditor.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Frames [startFrame, endFrame) of a dense curve, clipped to its size
+template <typename T>
+std::vector<T> windowOf(const std::vector<T>& curve, int startFrame, int endFrame) {
+    const int size = static_cast<int>(curve.size());
+    return std::vector<T>(curve.begin() + std::min(startFrame, size),
+                          curve.begin() + std::min(endFrame, size));
+}
+
+} // namespace
 
 PitchEditor::PitchEditor() = default;
 
@@ -6,17 +20,21 @@ Note* PitchEditor::findNoteAt(float x, float y) {
     if (!project || !coordMapper)
         return nullptr;
 
-    for (auto& note : project->getNotes()) {
-        if (note.isRest())
+    // Only notes around the cursor's frame and pitch can contain it; the
+    // slack covers the rounding in secondsToFrames and yToMidi
+    const int frame = secondsToFrames(x / coordMapper->getPixelsPerSecond());
+    const float midi = coordMapper->yToMidi(y);
+    for (auto* note : project->getNotesInArea(frame - 1, frame + 2, midi - 0.01f, midi + 1.01f)) {
+        if (note->isRest())
             continue;
 
-        float noteX = framesToSeconds(note.getStartFrame()) * coordMapper->getPixelsPerSecond();
-        float noteW = framesToSeconds(note.getDurationFrames()) * coordMapper->getPixelsPerSecond();
-        float noteY = coordMapper->midiToY(note.getAdjustedMidiNote());
+        float noteX = framesToSeconds(note->getStartFrame()) * coordMapper->getPixelsPerSecond();
+        float noteW = framesToSeconds(note->getDurationFrames()) * coordMapper->getPixelsPerSecond();
+        float noteY = coordMapper->midiToY(note->getAdjustedMidiNote());
         float noteH = coordMapper->getPixelsPerSemitone();
 
         if (x >= noteX && x < noteX + noteW && y >= noteY && y < noteY + noteH) {
-            return &note;
+            return note;
         }
     }
 
@@ -27,25 +45,17 @@ void PitchEditor::startNoteDrag(Note* note, float y) {
     if (!note || !project)
         return;
 
-    // Capture delta slice from global dense deltaPitch
+    // Delta pitch stays in the dense curve; the drag only moves midiNote
     auto& audioData = project->getAudioData();
     int startFrame = note->getStartFrame();
     int endFrame = note->getEndFrame();
-    int numFrames = endFrame - startFrame;
-
-    std::vector<float> delta(numFrames, 0.0f);
-    for (int i = 0; i < numFrames; ++i) {
-        int globalFrame = startFrame + i;
-        if (globalFrame >= 0 && globalFrame < static_cast<int>(audioData.deltaPitch.size()))
-            delta[i] = audioData.deltaPitch[static_cast<size_t>(globalFrame)];
-    }
-    note->setDeltaPitch(std::move(delta));
 
     isDragging = true;
     draggedNote = note;
     dragStartY = y;
     originalPitchOffset = note->getPitchOffset();
     originalMidiNote = note->getMidiNote();
+    dragBounds = project->getNoteBounds(*note);
 
     // Save boundary F0 values
     int f0Size = static_cast<int>(audioData.f0.size());
@@ -55,23 +65,25 @@ void PitchEditor::startNoteDrag(Note* note, float y) {
     boundaryF0End = (endFrame < f0Size) ? audioData.f0[endFrame] : 0.0f;
 
     // Save original F0 values for undo
-    originalF0Values.clear();
-    for (int i = startFrame; i < endFrame && i < f0Size; ++i)
-        originalF0Values.push_back(audioData.f0[i]);
+    const auto f0View = note->viewOf(audioData.f0);
+    originalF0Values.assign(f0View.begin(), f0View.end());
 
     if (onNoteSelected)
         onNoteSelected(note);
 }
 
 void PitchEditor::updateNoteDrag(float y) {
-    if (!isDragging || !draggedNote || !coordMapper)
+    if (!isDragging || !draggedNote || !coordMapper || !project)
         return;
 
     float deltaY = dragStartY - y;
     float deltaSemitones = deltaY / coordMapper->getPixelsPerSemitone();
 
-    draggedNote->setPitchOffset(deltaSemitones);
-    draggedNote->markDirty();
+    // Old and new position of the note and its curve
+    project->notifyChanged(dragBounds.transposed(draggedNote->getPitchOffset() - originalPitchOffset));
+    project->setNotePitch(draggedNote, draggedNote->getMidiNote(), deltaSemitones);
+    project->markNoteDirty(draggedNote);
+    project->notifyChanged(dragBounds.transposed(deltaSemitones - originalPitchOffset));
 }
 
 void PitchEditor::endNoteDrag() {
@@ -89,29 +101,18 @@ void PitchEditor::endNoteDrag() {
         int f0Size = static_cast<int>(audioData.f0.size());
 
         // Bake pitchOffset into midiNote
-        draggedNote->setMidiNote(originalMidiNote + newOffset);
-        draggedNote->setPitchOffset(0.0f);
+        project->setNotePitch(draggedNote, originalMidiNote + newOffset, 0.0f);
 
         // Find adjacent notes to expand dirty range
-        const auto& notes = project->getNotes();
-        int expandedStart = startFrame;
-        int expandedEnd = endFrame;
-        for (const auto& note : notes) {
-            if (&note == draggedNote) continue;
-            if (note.getEndFrame() > startFrame - 30 && note.getEndFrame() <= startFrame) {
-                expandedStart = std::min(expandedStart, note.getStartFrame());
-            }
-            if (note.getStartFrame() < endFrame + 30 && note.getStartFrame() >= endFrame) {
-                expandedEnd = std::max(expandedEnd, note.getEndFrame());
-            }
-        }
+        const auto [expandedStart, expandedEnd] =
+            PitchCurveProcessor::expandToAdjacentNotes(*project, startFrame, endFrame);
 
-        // Rebuild pitch curves
-        PitchCurveProcessor::rebuildBaseFromNotes(*project);
-        PitchCurveProcessor::composeF0InPlace(*project, false);
+        // Rebuild pitch curves around the dragged note only
+        const auto rebuilt = PitchCurveProcessor::rebuildBaseForRange(*project, startFrame, endFrame);
+        project->notifyFramesChanged(std::min(rebuilt.first, startFrame), std::max(rebuilt.second, endFrame));
 
-        if (onBasePitchCacheInvalidated)
-            onBasePitchCacheInvalidated();
+        if (onBasePitchChanged)
+            onBasePitchChanged({{startFrame, endFrame}});
 
         // Mark dirty range
         int smoothStart = std::max(0, expandedStart - 60);
@@ -136,18 +137,22 @@ void PitchEditor::endNoteDrag() {
             int capturedExpandedEnd = expandedEnd;
             int capturedF0Size = f0Size;
             auto action = std::make_unique<NotePitchDragAction>(
-                draggedNote, &audioData.f0, originalMidiNote,
+                project, draggedNote, &audioData.f0, originalMidiNote,
                 originalMidiNote + newOffset, std::move(f0Edits),
                 [this, capturedExpandedStart, capturedExpandedEnd, capturedF0Size](Note* n) {
                     if (project) {
-                        PitchCurveProcessor::rebuildBaseFromNotes(*project);
-                        PitchCurveProcessor::composeF0InPlace(*project, false);
-                        if (onBasePitchCacheInvalidated)
-                            onBasePitchCacheInvalidated();
+                        if (n) {
+                            const auto rebuilt = PitchCurveProcessor::rebuildBaseForRange(
+                                *project, n->getStartFrame(), n->getEndFrame());
+                            project->notifyFramesChanged(std::min(rebuilt.first, n->getStartFrame()),
+                                                         std::max(rebuilt.second, n->getEndFrame()));
+                            if (onBasePitchChanged)
+                                onBasePitchChanged({{n->getStartFrame(), n->getEndFrame()}});
+                        }
                         int smoothStart = std::max(0, capturedExpandedStart - 60);
                         int smoothEnd = std::min(capturedF0Size, capturedExpandedEnd + 60);
                         project->setF0DirtyRange(smoothStart, smoothEnd);
-                        if (n) n->clearDirty();
+                        if (n) project->clearNoteDirty(n);
                     }
                 });
             undoManager->addAction(std::move(action));
@@ -158,7 +163,9 @@ void PitchEditor::endNoteDrag() {
         if (onPitchEditFinished)
             onPitchEditFinished();
     } else {
-        draggedNote->setPitchOffset(0.0f);
+        project->notifyChanged(dragBounds.transposed(draggedNote->getPitchOffset() - originalPitchOffset));
+        project->setNotePitch(draggedNote, draggedNote->getMidiNote(), 0.0f);
+        project->notifyChanged(dragBounds.transposed(-originalPitchOffset));
     }
 
     isDragging = false;
@@ -210,18 +217,8 @@ void PitchEditor::endDrawing() {
         maxFrame = std::max(maxFrame, e.idx);
     }
 
-    // Clear deltaPitch for notes in edited range
-    if (project && minFrame <= maxFrame) {
-        auto& notes = project->getNotes();
-        for (auto& note : notes) {
-            if (note.getEndFrame() > minFrame && note.getStartFrame() < maxFrame) {
-                if (note.hasDeltaPitch()) {
-                    note.setDeltaPitch(std::vector<float>());
-                }
-            }
-        }
+    if (project && minFrame <= maxFrame)
         project->setF0DirtyRange(minFrame, maxFrame);
-    }
 
     // Create undo action
     if (undoManager && project) {
@@ -230,6 +227,7 @@ void PitchEditor::endDrawing() {
             &audioData.f0, &audioData.deltaPitch, &audioData.voicedMask, drawingEdits,
             [this](int minFrame, int maxFrame) {
                 if (project) {
+                    project->notifyFramesChanged(minFrame, maxFrame + 1);
                     project->setF0DirtyRange(minFrame, maxFrame);
                     if (onPitchEditFinished)
                         onPitchEditFinished();
@@ -267,10 +265,16 @@ void PitchEditor::applyPitchPoint(int frameIndex, int midiCents) {
     if (frameIndex < 0 || frameIndex >= f0Size)
         return;
 
+    int firstChanged = f0Size;
+    int lastChanged = -1;
+
     auto applyFrame = [&](int idx, int cents) {
         if (idx < 0 || idx >= f0Size)
             return;
 
+        firstChanged = std::min(firstChanged, idx);
+        lastChanged = std::max(lastChanged, idx);
+
         const float newFreq = midiToFreq(static_cast<float>(cents) / 100.0f);
         const float oldF0 = audioData.f0[idx];
         const float oldDelta = (idx < static_cast<int>(audioData.deltaPitch.size()))
@@ -290,15 +294,6 @@ void PitchEditor::applyPitchPoint(int frameIndex, int midiCents) {
         if (it == drawingEditIndexByFrame.end()) {
             drawingEditIndexByFrame.emplace(idx, drawingEdits.size());
             drawingEdits.push_back(F0FrameEdit{idx, oldF0, newFreq, oldDelta, newDelta, oldVoiced, true});
-
-            // Clear deltaPitch for notes containing this frame
-            auto& notes = project->getNotes();
-            for (auto& note : notes) {
-                if (note.getStartFrame() <= idx && note.getEndFrame() > idx && note.hasDeltaPitch()) {
-                    note.setDeltaPitch(std::vector<float>());
-                    break;
-                }
-            }
         } else {
             auto& e = drawingEdits[it->second];
             e.newF0 = newFreq;
@@ -317,6 +312,7 @@ void PitchEditor::applyPitchPoint(int frameIndex, int midiCents) {
     if (!activeDrawCurve || frameIndex < activeDrawCurve->localStart()) {
         startNewPitchCurve(frameIndex, midiCents);
         applyFrame(frameIndex, midiCents);
+        project->notifyFramesChanged(frameIndex, frameIndex + 1);
         return;
     }
 
@@ -345,6 +341,9 @@ void PitchEditor::applyPitchPoint(int frameIndex, int midiCents) {
 
     lastDrawFrame = frameIndex;
     lastDrawValueCents = midiCents;
+
+    if (firstChanged <= lastChanged)
+        project->notifyFramesChanged(firstChanged, lastChanged + 1);
 }
 
 void PitchEditor::startNewPitchCurve(int frameIndex, int midiCents) {
@@ -364,12 +363,14 @@ void PitchEditor::snapNoteToSemitone(Note* note) {
 
     if (std::abs(snappedOffset - currentOffset) > 0.001f) {
         if (undoManager) {
-            auto action = std::make_unique<PitchOffsetAction>(note, currentOffset, snappedOffset);
+            auto action = std::make_unique<PitchOffsetAction>(project, note, currentOffset, snappedOffset);
             undoManager->addAction(std::move(action));
         }
 
-        note->setPitchOffset(snappedOffset);
-        note->markDirty();
+        project->notifyNoteChanged(*note);
+        project->setNotePitch(note, note->getMidiNote(), snappedOffset);
+        project->markNoteDirty(note);
+        project->notifyNoteChanged(*note);
 
         if (onPitchEdited)
             onPitchEdited();
@@ -385,47 +386,38 @@ void PitchEditor::startMultiNoteDrag(const std::vector<Note*>& notes, float y) {
     draggedNotes = notes;
     originalMidiNotes.clear();
     originalF0ValuesMulti.clear();
+    dragBoundsMulti.clear();
     dragStartY = y;
 
     auto& audioData = project->getAudioData();
-    int f0Size = static_cast<int>(audioData.f0.size());
 
     for (auto* note : draggedNotes) {
         originalMidiNotes.push_back(note->getMidiNote());
-
-        // Capture delta slice for each note
-        int startFrame = note->getStartFrame();
-        int endFrame = note->getEndFrame();
-        int numFrames = endFrame - startFrame;
-
-        std::vector<float> delta(numFrames, 0.0f);
-        for (int i = 0; i < numFrames; ++i) {
-            int globalFrame = startFrame + i;
-            if (globalFrame >= 0 && globalFrame < static_cast<int>(audioData.deltaPitch.size()))
-                delta[i] = audioData.deltaPitch[static_cast<size_t>(globalFrame)];
-        }
-        note->setDeltaPitch(std::move(delta));
+        dragBoundsMulti.push_back(project->getNoteBounds(*note).transposed(-note->getPitchOffset()));
 
         // Save original F0 values
-        std::vector<float> f0Values;
-        for (int i = startFrame; i < endFrame && i < f0Size; ++i)
-            f0Values.push_back(audioData.f0[i]);
-        originalF0ValuesMulti.push_back(std::move(f0Values));
+        const auto f0View = note->viewOf(audioData.f0);
+        originalF0ValuesMulti.emplace_back(f0View.begin(), f0View.end());
     }
 
     isMultiDragging = true;
 }
 
 void PitchEditor::updateMultiNoteDrag(float y) {
-    if (!isMultiDragging || draggedNotes.empty() || !coordMapper)
+    if (!isMultiDragging || draggedNotes.empty() || !coordMapper || !project)
         return;
 
     float deltaY = dragStartY - y;
-    float deltaSemitones = deltaY / coordMapper->getPixelsPerSemitone();
+    setMultiDragOffset(deltaY / coordMapper->getPixelsPerSemitone());
+}
 
-    for (auto* note : draggedNotes) {
-        note->setPitchOffset(deltaSemitones);
-        note->markDirty();
+void PitchEditor::setMultiDragOffset(float deltaSemitones) {
+    for (size_t i = 0; i < draggedNotes.size(); ++i) {
+        auto* note = draggedNotes[i];
+        project->notifyChanged(dragBoundsMulti[i].transposed(note->getPitchOffset()));
+        project->setNotePitch(note, note->getMidiNote(), deltaSemitones);
+        project->markNoteDirty(note);
+        project->notifyChanged(dragBoundsMulti[i].transposed(deltaSemitones));
     }
 }
 
@@ -435,6 +427,7 @@ void PitchEditor::endMultiNoteDrag() {
         draggedNotes.clear();
         originalMidiNotes.clear();
         originalF0ValuesMulti.clear();
+        dragBoundsMulti.clear();
         return;
     }
 
@@ -446,34 +439,31 @@ void PitchEditor::endMultiNoteDrag() {
         auto& audioData = project->getAudioData();
         int f0Size = static_cast<int>(audioData.f0.size());
 
-        int expandedStart = std::numeric_limits<int>::max();
-        int expandedEnd = std::numeric_limits<int>::min();
+        int selectionStart = std::numeric_limits<int>::max();
+        int selectionEnd = std::numeric_limits<int>::min();
+        std::vector<std::pair<int, int>> noteRanges;
+        noteRanges.reserve(draggedNotes.size());
 
         // Bake pitchOffset into midiNote for all notes
         for (size_t i = 0; i < draggedNotes.size(); ++i) {
             auto* note = draggedNotes[i];
-            note->setMidiNote(originalMidiNotes[i] + newOffset);
-            note->setPitchOffset(0.0f);
+            project->setNotePitch(note, originalMidiNotes[i] + newOffset, 0.0f);
 
-            expandedStart = std::min(expandedStart, note->getStartFrame());
-            expandedEnd = std::max(expandedEnd, note->getEndFrame());
+            selectionStart = std::min(selectionStart, note->getStartFrame());
+            selectionEnd = std::max(selectionEnd, note->getEndFrame());
+            noteRanges.emplace_back(note->getStartFrame(), note->getEndFrame());
         }
 
         // Find adjacent notes to expand dirty range
-        const auto& allNotes = project->getNotes();
-        for (const auto& note : allNotes) {
-            if (note.getEndFrame() > expandedStart - 30 && note.getEndFrame() <= expandedStart)
-                expandedStart = std::min(expandedStart, note.getStartFrame());
-            if (note.getStartFrame() < expandedEnd + 30 && note.getStartFrame() >= expandedEnd)
-                expandedEnd = std::max(expandedEnd, note.getEndFrame());
-        }
+        const auto [expandedStart, expandedEnd] =
+            PitchCurveProcessor::expandToAdjacentNotes(*project, selectionStart, selectionEnd);
 
-        // Rebuild pitch curves
-        PitchCurveProcessor::rebuildBaseFromNotes(*project);
-        PitchCurveProcessor::composeF0InPlace(*project, false);
+        // Rebuild pitch curves around the dragged notes only, all in one pass
+        for (const auto& rebuilt : PitchCurveProcessor::rebuildBaseForRanges(*project, noteRanges))
+            project->notifyFramesChanged(rebuilt.first, rebuilt.second);
 
-        if (onBasePitchCacheInvalidated)
-            onBasePitchCacheInvalidated();
+        if (onBasePitchChanged)
+            onBasePitchChanged(noteRanges);
 
         // Mark dirty range
         int smoothStart = std::max(0, expandedStart - 60);
@@ -507,14 +497,19 @@ void PitchEditor::endMultiNoteDrag() {
             float capturedNewOffset = newOffset;
 
             auto action = std::make_unique<MultiNotePitchDragAction>(
-                capturedNotes, &audioData.f0, capturedOriginalMidi, capturedNewOffset,
+                project, capturedNotes, &audioData.f0, capturedOriginalMidi, capturedNewOffset,
                 std::move(f0Edits),
-                [this, capturedExpandedStart, capturedExpandedEnd, capturedF0Size](const std::vector<Note*>&) {
+                [this, capturedExpandedStart, capturedExpandedEnd, capturedF0Size](const std::vector<Note*>& changedNotes) {
                     if (project) {
-                        PitchCurveProcessor::rebuildBaseFromNotes(*project);
-                        PitchCurveProcessor::composeF0InPlace(*project, false);
-                        if (onBasePitchCacheInvalidated)
-                            onBasePitchCacheInvalidated();
+                        std::vector<std::pair<int, int>> changedRanges;
+                        for (auto* n : changedNotes) {
+                            if (n)
+                                changedRanges.emplace_back(n->getStartFrame(), n->getEndFrame());
+                        }
+                        for (const auto& rebuilt : PitchCurveProcessor::rebuildBaseForRanges(*project, changedRanges))
+                            project->notifyFramesChanged(rebuilt.first, rebuilt.second);
+                        if (onBasePitchChanged)
+                            onBasePitchChanged(changedRanges);
                         int smoothStart = std::max(0, capturedExpandedStart - 60);
                         int smoothEnd = std::min(capturedF0Size, capturedExpandedEnd + 60);
                         project->setF0DirtyRange(smoothStart, smoothEnd);
@@ -529,12 +524,58 @@ void PitchEditor::endMultiNoteDrag() {
             onPitchEditFinished();
     } else {
         // No meaningful change: reset pitchOffset
-        for (auto* note : draggedNotes)
-            note->setPitchOffset(0.0f);
+        for (size_t i = 0; i < draggedNotes.size(); ++i) {
+            project->notifyChanged(dragBoundsMulti[i].transposed(draggedNotes[i]->getPitchOffset()));
+            project->setNotePitch(draggedNotes[i], draggedNotes[i]->getMidiNote(), 0.0f);
+            project->notifyChanged(dragBoundsMulti[i]);
+        }
     }
 
     isMultiDragging = false;
     draggedNotes.clear();
     originalMidiNotes.clear();
     originalF0ValuesMulti.clear();
+    dragBoundsMulti.clear();
+}
+
+void PitchEditor::nudgeNotes(const std::vector<Note*>& notes, float semitones) {
+    if (notes.empty() || !project || isDragging || isMultiDragging)
+        return;
+
+    startMultiNoteDrag(notes, 0.0f);
+    setMultiDragOffset(semitones);
+    endMultiNoteDrag();
+}
+
+std::unique_ptr<Project> PitchEditor::previewNudge(const Project& project, float semitones,
+                                                   int startFrame, int endFrame) {
+    const auto& source = project.getAudioData();
+    startFrame = std::clamp(startFrame, 0, source.getNumFrames());
+    endFrame = std::clamp(endFrame, startFrame, source.getNumFrames());
+
+    auto copy = std::make_unique<Project>();
+    copy->setGlobalPitchOffset(project.getGlobalPitchOffset());
+
+    // Notes cut by the window keep only their frames inside it
+    for (const Note* note : project.getNotesInRange(startFrame, endFrame)) {
+        Note part = *note;
+        part.setStartFrame(std::max(note->getStartFrame(), startFrame) - startFrame);
+        part.setEndFrame(std::min(note->getEndFrame(), endFrame) - startFrame);
+        copy->addNote(std::move(part));
+    }
+
+    auto& target = copy->getAudioData();
+    target.sampleRate = source.sampleRate;
+    target.melSpectrogram = source.melSpectrogram.slice(static_cast<size_t>(startFrame),
+                                                        static_cast<size_t>(endFrame));
+    target.f0 = windowOf(source.f0, startFrame, endFrame);
+    target.baseF0 = windowOf(source.baseF0, startFrame, endFrame);
+    target.basePitch = windowOf(source.basePitch, startFrame, endFrame);
+    target.deltaPitch = windowOf(source.deltaPitch, startFrame, endFrame);
+    target.voicedMask = windowOf(source.voicedMask, startFrame, endFrame);
+
+    PitchEditor editor;
+    editor.setProject(copy.get());
+    editor.nudgeNotes(copy->getSelectedNotes(), semitones);
+    return copy;
 }
@@ -13,6 +13,8 @@
 
 /**
  * Handles pitch editing operations including note dragging and pitch drawing.
+ * Every edit reports what it touched through Project::notifyChanged(): a
+ * dragged note at its old and new offset, drawn frames over every pitch.
  */
 class PitchEditor {
 public:
@@ -47,15 +49,29 @@ public:
     // Snap note to semitone
     void snapNoteToSemitone(Note* note);
 
+    // Move notes by whole semitones, as a multi-note drag by that much would
+    void nudgeNotes(const std::vector<Note*>& notes, float semitones);
+
+    /**
+     * A copy of frames [startFrame, endFrame) of project, sharing its mel
+     * frames, with the selected notes nudged by semitones and marked dirty;
+     * what nudgeNotes() would leave there. The copy's frames start at 0, and
+     * only what resynthesis reads is copied.
+     */
+    static std::unique_ptr<Project> previewNudge(const Project& project, float semitones,
+                                                 int startFrame, int endFrame);
+
     // Callbacks
     std::function<void(Note*)> onNoteSelected;
     std::function<void()> onPitchEdited;
     std::function<void()> onPitchEditFinished;
-    std::function<void()> onBasePitchCacheInvalidated;
+    // Base pitch was regenerated around notes with these frame ranges
+    std::function<void(const std::vector<std::pair<int, int>>& noteRanges)> onBasePitchChanged;
 
 private:
     void applyPitchPoint(int frameIndex, int midiCents);
     void startNewPitchCurve(int frameIndex, int midiCents);
+    void setMultiDragOffset(float semitones);
 
     Project* project = nullptr;
     PitchUndoManager* undoManager = nullptr;
@@ -70,12 +86,14 @@ private:
     float boundaryF0Start = 0.0f;
     float boundaryF0End = 0.0f;
     std::vector<float> originalF0Values;
+    ProjectChange dragBounds;  // Dragged note at originalPitchOffset
 
     // Multi-note drag state
     bool isMultiDragging = false;
     std::vector<Note*> draggedNotes;
     std::vector<float> originalMidiNotes;
     std::vector<std::vector<float>> originalF0ValuesMulti;
+    std::vector<ProjectChange> dragBoundsMulti;  // At offset 0
 
     // Draw state
     bool isDrawing = false;
@@ -0,0 +1,352 @@
+#include "TileCache.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Tile index of a world coordinate, rounding towards negative infinity
+    int tileIndex(int worldPos) {
+        return worldPos >= 0 ? worldPos / TileCache::TILE_SIZE
+                             : -((-worldPos + TileCache::TILE_SIZE - 1) / TileCache::TILE_SIZE);
+    }
+
+    size_t imageBytes(const juce::Image& image) {
+        return static_cast<size_t>(image.getWidth()) * static_cast<size_t>(image.getHeight()) * 4;
+    }
+}
+
+TileCache::TileCache(RenderFunction renderFunction) : render(std::move(renderFunction)) {}
+
+TileCache::TileCache(SnapshotFunction snapshotFunction, ReadyFunction tilesReady)
+    : snapshot(std::move(snapshotFunction)), onTilesReady(std::move(tilesReady)) {
+    running = true;
+    worker = std::thread([this]() { run(); });
+}
+
+TileCache::~TileCache() {
+    // Tiles finished after this are dropped by finishTile's token check
+    aliveToken.reset();
+
+    if (worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(queueLock);
+            running = false;
+            queue.clear();
+        }
+        queueChanged.notify_all();
+        worker.join();
+    }
+}
+
+void TileCache::draw(juce::Graphics& g, const juce::Rectangle<int>& visible,
+                     float pixelsPerSecond, float verticalKey) {
+    // Only the tiles under the region being repainted
+    const auto area = visible.getIntersection(g.getClipBounds());
+    if (area.isEmpty() || (!render && !snapshot))
+        return;
+
+    const float physicalScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    auto& level = getLevel(pixelsPerSecond, verticalKey, physicalScale);
+    const juce::uint32 firstUseThisDraw = useCounter + 1;
+
+    // Work queued for another zoom would only finish off screen
+    if (snapshot)
+        cancelJobsNotOnLevel(level.id);
+
+    juce::Graphics::ScopedSaveState saveState(g);
+    g.reduceClipRegion(area);
+    g.setImageResamplingQuality(juce::Graphics::lowResamplingQuality);
+
+    const int firstColumn = tileIndex(area.getX());
+    const int lastColumn = tileIndex(area.getRight() - 1);
+    const int firstRow = tileIndex(area.getY());
+    const int lastRow = tileIndex(area.getBottom() - 1);
+
+    const juce::Rectangle<int> tileSpan(firstColumn * TILE_SIZE, firstRow * TILE_SIZE,
+                                        (lastColumn - firstColumn + 1) * TILE_SIZE,
+                                        (lastRow - firstRow + 1) * TILE_SIZE);
+    std::shared_ptr<const RenderFunction> snapshotRender;
+
+    for (int columnIndex = firstColumn; columnIndex <= lastColumn; ++columnIndex) {
+        auto& column = level.columns[columnIndex];
+        for (int row = firstRow; row <= lastRow; ++row) {
+            auto& tile = column.rows[row];
+            tile.lastUsed = ++useCounter;
+
+            const int x = columnIndex * TILE_SIZE;
+            const int y = row * TILE_SIZE;
+
+            if (isOutOfDate(column, tile)) {
+                if (render) {
+                    cachedBytes -= imageBytes(tile.image);
+                    tile.image = renderTile(render, columnIndex, row, physicalScale);
+                    tile.renderedAt = generation;
+                    cachedBytes += imageBytes(tile.image);
+                } else if (tile.requestedAt == 0 || tile.requestedAt < requiredGeneration(column)) {
+                    // One snapshot for everything this draw queues
+                    if (snapshotRender == nullptr)
+                        snapshotRender = std::make_shared<const RenderFunction>(snapshot(tileSpan));
+                    tile.requestedAt = generation;
+                    queueJob({level.id, columnIndex, row, tile.requestedAt, physicalScale, snapshotRender});
+                }
+            }
+
+            if (!tile.image.isValid()) {
+                drawScaledFallback(g, level, {x, y, TILE_SIZE, TILE_SIZE});
+                continue;
+            }
+
+            if (physicalScale == 1.0f)
+                g.drawImageAt(tile.image, x, y);
+            else
+                g.drawImageTransformed(tile.image,
+                                       juce::AffineTransform::scale(1.0f / physicalScale)
+                                           .translated(static_cast<float>(x), static_cast<float>(y)));
+        }
+    }
+
+    evictOverBudget(firstUseThisDraw);
+}
+
+void TileCache::invalidateAll() {
+    allInvalidatedAt = ++generation;
+}
+
+void TileCache::invalidateTimeRange(double startSeconds, double endSeconds, float marginPixels) {
+    const juce::uint32 invalidatedAt = ++generation;
+
+    for (auto& level : levels) {
+        const double x0 = startSeconds * level.pixelsPerSecond - marginPixels;
+        const double x1 = endSeconds * level.pixelsPerSecond + marginPixels;
+        const int firstColumn = tileIndex(static_cast<int>(std::floor(x0)));
+        const int lastColumn = tileIndex(static_cast<int>(std::ceil(x1)));
+
+        for (auto column = level.columns.lower_bound(firstColumn);
+             column != level.columns.end() && column->first <= lastColumn; ++column)
+            column->second.invalidatedAt = invalidatedAt;
+    }
+}
+
+juce::uint32 TileCache::requiredGeneration(const Column& column) const {
+    return std::max(allInvalidatedAt, column.invalidatedAt);
+}
+
+bool TileCache::isOutOfDate(const Column& column, const Tile& tile) const {
+    return !tile.image.isValid() || tile.renderedAt < requiredGeneration(column);
+}
+
+void TileCache::drawScaledFallback(juce::Graphics& g, const Level& level,
+                                   const juce::Rectangle<int>& tileArea) {
+    // The most recent other zoom at this display scale, stretched to fit
+    for (const auto& other : levels) {
+        if (&other == &level || other.physicalScale != level.physicalScale || other.columns.empty())
+            continue;
+
+        const float scaleX = level.pixelsPerSecond / other.pixelsPerSecond;
+        const float scaleY = (level.verticalKey > 0.0f && other.verticalKey > 0.0f)
+                                 ? level.verticalKey / other.verticalKey
+                                 : 1.0f;
+        if (!std::isfinite(scaleX) || scaleX <= 0.0f)
+            continue;
+
+        juce::Graphics::ScopedSaveState saveState(g);
+        g.reduceClipRegion(tileArea);
+
+        const int firstColumn = tileIndex(static_cast<int>(std::floor(tileArea.getX() / scaleX)));
+        const int lastColumn = tileIndex(static_cast<int>(std::ceil(tileArea.getRight() / scaleX)));
+        const int firstRow = tileIndex(static_cast<int>(std::floor(tileArea.getY() / scaleY)));
+        const int lastRow = tileIndex(static_cast<int>(std::ceil(tileArea.getBottom() / scaleY)));
+
+        for (auto column = other.columns.lower_bound(firstColumn);
+             column != other.columns.end() && column->first <= lastColumn; ++column) {
+            for (auto row = column->second.rows.lower_bound(firstRow);
+                 row != column->second.rows.end() && row->first <= lastRow; ++row) {
+                if (!row->second.image.isValid())
+                    continue;
+
+                g.drawImageTransformed(row->second.image,
+                                       juce::AffineTransform::scale(1.0f / other.physicalScale)
+                                           .translated(static_cast<float>(column->first * TILE_SIZE),
+                                                       static_cast<float>(row->first * TILE_SIZE))
+                                           .scaled(scaleX, scaleY));
+            }
+        }
+        return;
+    }
+}
+
+void TileCache::evictOverBudget(juce::uint32 firstUseThisDraw) {
+    // Never evict what is on screen, even over budget
+    while (cachedBytes > MAX_CACHE_BYTES) {
+        Level* oldestLevel = nullptr;
+        std::map<int, Column>::iterator oldestColumn;
+        std::map<int, Tile>::iterator oldestTile;
+        juce::uint32 oldestUse = firstUseThisDraw;
+
+        for (auto& candidateLevel : levels) {
+            for (auto column = candidateLevel.columns.begin(); column != candidateLevel.columns.end(); ++column) {
+                for (auto tile = column->second.rows.begin(); tile != column->second.rows.end(); ++tile) {
+                    if (tile->second.image.isValid() && tile->second.lastUsed < oldestUse) {
+                        oldestUse = tile->second.lastUsed;
+                        oldestLevel = &candidateLevel;
+                        oldestColumn = column;
+                        oldestTile = tile;
+                    }
+                }
+            }
+        }
+
+        if (oldestLevel == nullptr)
+            break;
+
+        cachedBytes -= imageBytes(oldestTile->second.image);
+        oldestColumn->second.rows.erase(oldestTile);
+        if (oldestColumn->second.rows.empty())
+            oldestLevel->columns.erase(oldestColumn);
+    }
+}
+
+TileCache::Level& TileCache::getLevel(float pixelsPerSecond, float verticalKey, float physicalScale) {
+    for (size_t i = 0; i < levels.size(); ++i) {
+        const auto& level = levels[i];
+        if (level.pixelsPerSecond == pixelsPerSecond && level.verticalKey == verticalKey
+            && level.physicalScale == physicalScale) {
+            if (i > 0)
+                std::rotate(levels.begin(), levels.begin() + static_cast<std::ptrdiff_t>(i),
+                            levels.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+            return levels.front();
+        }
+    }
+
+    Level level;
+    level.id = ++levelCounter;
+    level.pixelsPerSecond = pixelsPerSecond;
+    level.verticalKey = verticalKey;
+    level.physicalScale = physicalScale;
+    levels.insert(levels.begin(), std::move(level));
+
+    while (levels.size() > MAX_LEVELS)
+        dropLevel(levels.size() - 1);
+
+    return levels.front();
+}
+
+TileCache::Level* TileCache::findLevel(juce::uint32 id) {
+    for (auto& level : levels)
+        if (level.id == id)
+            return &level;
+    return nullptr;
+}
+
+void TileCache::dropLevel(size_t index) {
+    for (const auto& column : levels[index].columns)
+        for (const auto& row : column.second.rows)
+            cachedBytes -= imageBytes(row.second.image);
+    levels.erase(levels.begin() + static_cast<std::ptrdiff_t>(index));
+}
+
+void TileCache::queueJob(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+
+        // A newer request replaces one for the same tile that has not started
+        queue.erase(std::remove_if(queue.begin(), queue.end(),
+                                   [&job](const Job& queued) {
+                                       return queued.levelId == job.levelId && queued.column == job.column
+                                              && queued.row == job.row;
+                                   }),
+                    queue.end());
+        queue.push_back(std::move(job));
+    }
+    queueChanged.notify_one();
+}
+
+void TileCache::cancelJobsNotOnLevel(juce::uint32 levelId) {
+    std::vector<Job> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+        auto firstCancelled = std::stable_partition(queue.begin(), queue.end(),
+                                                    [levelId](const Job& job) { return job.levelId == levelId; });
+        cancelled.assign(std::make_move_iterator(firstCancelled), std::make_move_iterator(queue.end()));
+        queue.erase(firstCancelled, queue.end());
+    }
+
+    // Let those tiles be requested again when their zoom comes back
+    for (const auto& job : cancelled) {
+        if (auto* level = findLevel(job.levelId)) {
+            auto column = level->columns.find(job.column);
+            if (column == level->columns.end())
+                continue;
+            auto tile = column->second.rows.find(job.row);
+            if (tile != column->second.rows.end() && tile->second.requestedAt == job.generation)
+                tile->second.requestedAt = 0;
+        }
+    }
+}
+
+void TileCache::run() {
+    std::weak_ptr<TileCache*> weakToken = aliveToken;
+
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(queueLock);
+            queueChanged.wait(lock, [this]() { return !running || !queue.empty(); });
+            if (!running)
+                return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        Result result;
+        result.levelId = job.levelId;
+        result.column = job.column;
+        result.row = job.row;
+        result.generation = job.generation;
+        result.image = renderTile(*job.render, job.column, job.row, job.physicalScale);
+
+        juce::MessageManager::callAsync([weakToken, result]() {
+            auto token = weakToken.lock();
+            if (token != nullptr)
+                (*token)->finishTile(result);
+        });
+    }
+}
+
+void TileCache::finishTile(Result result) {
+    auto* level = findLevel(result.levelId);
+    if (level == nullptr)
+        return;
+
+    auto& tile = level->columns[result.column].rows[result.row];
+    if (tile.image.isValid() && tile.renderedAt >= result.generation)
+        return;
+
+    cachedBytes -= imageBytes(tile.image);
+    tile.image = result.image;
+    tile.renderedAt = result.generation;
+    cachedBytes += imageBytes(tile.image);
+
+    if (onTilesReady) {
+        // Only the current level is drawn at world scale
+        if (level == &levels.front())
+            onTilesReady({result.column * TILE_SIZE, result.row * TILE_SIZE, TILE_SIZE, TILE_SIZE});
+        else
+            onTilesReady({});
+    }
+}
+
+juce::Image TileCache::renderTile(const RenderFunction& render, int column, int row, float physicalScale) {
+    const int size = juce::roundToInt(TILE_SIZE * physicalScale);
+
+    // Software image: the worker must not touch a native or GPU context
+    juce::Image image(juce::Image::ARGB, size, size, true, juce::SoftwareImageType());
+
+    const juce::Rectangle<int> area(column * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE);
+    juce::Graphics g(image);
+    g.addTransform(juce::AffineTransform::scale(physicalScale));
+    g.setOrigin(-area.getX(), -area.getY());
+    g.reduceClipRegion(area);
+    render(g, area);
+
+    return image;
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "../../JuceHeader.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Image cache for one static piano roll layer, cut into fixed-size tiles in
+ * world space (pixels before scrolling).
+ *
+ * draw() blits the tiles under the visible area and renders only the ones
+ * that are missing, so scrolling copies images and paints just the strip
+ * that came into view. Tiles belong to a zoom level; a few recent levels are
+ * kept so zooming back and forth does not start over. Edits mark only the
+ * tile columns over the time range they touched, on every level. Tiles that
+ * scrolled away stay cached up to MAX_CACHE_BYTES, least recently used out
+ * first.
+ *
+ * A cache built with a SnapshotFunction renders on its own worker thread
+ * instead. draw() then never renders: it queues what is missing or out of
+ * date against a snapshot of the layer's data and blits whatever images it
+ * has, an out-of-date tile until its replacement arrives and, after a zoom,
+ * the previous level scaled. onTilesReady is called on the message thread
+ * as finished tiles come in, with the world rectangle each one covers, or
+ * an empty one when the tile only shows scaled after a zoom.
+ */
+class TileCache {
+public:
+    /** Paints the world rectangle area into g, whose origin is world (0, 0). */
+    using RenderFunction = std::function<void(juce::Graphics& g, const juce::Rectangle<int>& area)>;
+
+    /**
+     * Called on the message thread; returns a RenderFunction that reads only
+     * data it owns, so it can run on the worker. It is only asked to paint
+     * inside area, the world rectangle of the tiles being queued, so the
+     * snapshot need only cover that.
+     */
+    using SnapshotFunction = std::function<RenderFunction(const juce::Rectangle<int>& area)>;
+
+    /** Called with the world rectangle whose image changed; empty means anywhere. */
+    using ReadyFunction = std::function<void(const juce::Rectangle<int>& area)>;
+
+    static constexpr int TILE_SIZE = 256;
+
+    /** Renders on the message thread, inside draw(). */
+    explicit TileCache(RenderFunction renderFunction);
+
+    /** Renders on a worker thread. */
+    TileCache(SnapshotFunction snapshotFunction, ReadyFunction onTilesReady);
+
+    ~TileCache();
+
+    /**
+     * Blit the layer over visible (world rectangle) at the given zoom.
+     * verticalKey is whatever else the layer's geometry depends on, e.g. the
+     * semitone height or the layer height. g's origin must be world (0, 0).
+     */
+    void draw(juce::Graphics& g, const juce::Rectangle<int>& visible,
+              float pixelsPerSecond, float verticalKey);
+
+    /** Mark every tile out of date. */
+    void invalidateAll();
+
+    /** Mark the tiles over [startSeconds, endSeconds), widened by marginPixels, out of date. */
+    void invalidateTimeRange(double startSeconds, double endSeconds, float marginPixels);
+
+private:
+    struct Tile {
+        juce::Image image;
+        juce::uint32 lastUsed = 0;
+        juce::uint32 renderedAt = 0;   // Generation the image was rendered at
+        juce::uint32 requestedAt = 0;  // Generation last queued for the worker, 0 if none
+    };
+
+    struct Column {
+        juce::uint32 invalidatedAt = 0;
+        std::map<int, Tile> rows;
+    };
+
+    struct Level {
+        juce::uint32 id = 0;
+        float pixelsPerSecond = 0.0f;
+        float verticalKey = 0.0f;
+        float physicalScale = 1.0f;
+        std::map<int, Column> columns;
+    };
+
+    struct Job {
+        juce::uint32 levelId = 0;
+        int column = 0;
+        int row = 0;
+        juce::uint32 generation = 0;
+        float physicalScale = 1.0f;
+        std::shared_ptr<const RenderFunction> render;
+    };
+
+    struct Result {
+        juce::uint32 levelId = 0;
+        int column = 0;
+        int row = 0;
+        juce::uint32 generation = 0;
+        juce::Image image;
+    };
+
+    Level& getLevel(float pixelsPerSecond, float verticalKey, float physicalScale);
+    Level* findLevel(juce::uint32 id);
+    juce::uint32 requiredGeneration(const Column& column) const;
+    bool isOutOfDate(const Column& column, const Tile& tile) const;
+    void drawScaledFallback(juce::Graphics& g, const Level& level, const juce::Rectangle<int>& tileArea);
+    void evictOverBudget(juce::uint32 firstUseThisDraw);
+    void dropLevel(size_t index);
+
+    // Worker
+    void queueJob(Job job);
+    void cancelJobsNotOnLevel(juce::uint32 levelId);
+    void run();
+    void finishTile(Result result);
+
+    static juce::Image renderTile(const RenderFunction& render, int column, int row, float physicalScale);
+
+    RenderFunction render;
+    SnapshotFunction snapshot;
+    ReadyFunction onTilesReady;
+
+    std::vector<Level> levels;  // Most recently used first
+    juce::uint32 useCounter = 0;
+    juce::uint32 levelCounter = 0;
+    juce::uint32 generation = 1;  // Bumped by every invalidation
+    juce::uint32 allInvalidatedAt = 0;
+    size_t cachedBytes = 0;
+
+    std::thread worker;
+    std::mutex queueLock;
+    std::condition_variable queueChanged;
+    std::deque<Job> queue;
+    bool running = false;
+
+    std::shared_ptr<TileCache*> aliveToken = std::make_shared<TileCache*>(this);
+
+    static constexpr size_t MAX_LEVELS = 3;
+    static constexpr size_t MAX_CACHE_BYTES = 64 * 1024 * 1024;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TileCache)
+};
@@ -2,8 +2,11 @@
 #include "../Utils/BasePitchCurve.h"
 #include "../Utils/Constants.h"
 #include "../Utils/PitchCurveProcessor.h"
+#include "../Utils/PitchMath.h"
+#include <algorithm>
 #include <cmath>
 #include <limits>
+#include <utility>
 
 PianoRollComponent::PianoRollComponent() {
   // Initialize modular components
@@ -20,6 +23,37 @@ PianoRollComponent::PianoRollComponent() {
   pitchEditor->setCoordinateMapper(coordMapper.get());
   noteSplitter->setCoordinateMapper(coordMapper.get());
 
+  // Tile caches for the static layers. The heavy ones render on workers
+  // from a snapshot, so paint only blits and input never waits on them.
+  waveformTiles = std::make_unique<TileCache>(
+      [this](const juce::Rectangle<int> &span) -> TileCache::RenderFunction {
+        auto snapshot = makeLayerSnapshot(span, false);
+        return [snapshot](juce::Graphics &g, const juce::Rectangle<int> &area) {
+          snapshot->drawBackgroundWaveform(g, area);
+        };
+      },
+      [this](const juce::Rectangle<int> &area) {
+        repaintTile(area, 0); // Scrolls horizontally only
+      });
+  contentTiles = std::make_unique<TileCache>(
+      [this](const juce::Rectangle<int> &span) -> TileCache::RenderFunction {
+        auto snapshot = makeLayerSnapshot(span, true);
+        return [snapshot](juce::Graphics &g, const juce::Rectangle<int> &area) {
+          snapshot->drawContent(g, area);
+        };
+      },
+      [this](const juce::Rectangle<int> &area) {
+        repaintTile(area, static_cast<int>(scrollY));
+      });
+  timelineTiles = std::make_unique<TileCache>(
+      [this](juce::Graphics &g, const juce::Rectangle<int> &area) {
+        drawTimeline(g, area);
+      });
+  pianoKeyTiles = std::make_unique<TileCache>(
+      [this](juce::Graphics &g, const juce::Rectangle<int> &area) {
+        drawPianoKeys(g, area);
+      });
+
   // Setup scrollZoomController callbacks
   scrollZoomController->onRepaintNeeded = [this]() { repaint(); };
   scrollZoomController->onZoomChanged = [this](float pps) {
@@ -34,20 +68,22 @@ PianoRollComponent::PianoRollComponent() {
     if (onNoteSelected) onNoteSelected(note);
   };
   pitchEditor->onPitchEdited = [this]() {
-    repaint();
+    repaintDamage();
     if (onPitchEdited) onPitchEdited();
   };
   pitchEditor->onPitchEditFinished = [this]() {
     if (onPitchEditFinished) onPitchEditFinished();
   };
-  pitchEditor->onBasePitchCacheInvalidated = [this]() {
-    invalidateBasePitchCache();
-  };
+  pitchEditor->onBasePitchChanged =
+      [this](const std::vector<std::pair<int, int>> &noteRanges) {
+        updateBasePitchCacheRanges(noteRanges);
+      };
 
   // Setup noteSplitter callbacks
-  noteSplitter->onNoteSplit = [this]() {
-    invalidateBasePitchCache();
-    repaint();
+  noteSplitter->onNoteSplit = [this](int startFrame, int endFrame) {
+    // The notes themselves were reported by the project as they changed
+    updateBasePitchCacheRange(startFrame, endFrame, true);
+    invalidateFrameRange(startFrame, endFrame);
   };
 
   addAndMakeVisible(horizontalScrollBar);
@@ -93,37 +129,47 @@ void PianoRollComponent::paint(juce::Graphics &g) {
   // Background
   g.fillAll(juce::Colour(COLOR_BACKGROUND));
 
-  constexpr int scrollBarSize = 8;
-
   // Create clipping region for main area (below timeline)
-  auto mainArea = getLocalBounds()
-                      .withTrimmedLeft(pianoKeysWidth)
-                      .withTrimmedTop(timelineHeight)
-                      .withTrimmedBottom(scrollBarSize)
-                      .withTrimmedRight(scrollBarSize);
+  auto mainArea = getMainArea();
+
+  const int scrollXPixels = static_cast<int>(scrollX);
+  const int scrollYPixels = static_cast<int>(scrollY);
 
   // Draw background waveform (only horizontal scroll, fills visible height)
   {
     juce::Graphics::ScopedSaveState saveState(g);
     g.reduceClipRegion(mainArea);
-    drawBackgroundWaveform(g, mainArea);
+    g.setOrigin(pianoKeysWidth - scrollXPixels, timelineHeight);
+    waveformTiles->draw(g,
+                        {scrollXPixels, 0, mainArea.getWidth(),
+                         mainArea.getHeight()},
+                        pixelsPerSecond,
+                        static_cast<float>(mainArea.getHeight()));
   }
 
-  // Draw scrolled content (grid, notes, pitch curves)
+  // Draw scrolled content (grid, notes, pitch curves), then the overlays
   {
     juce::Graphics::ScopedSaveState saveState(g);
     g.reduceClipRegion(mainArea);
-    g.setOrigin(pianoKeysWidth - static_cast<int>(scrollX),
-                timelineHeight - static_cast<int>(scrollY));
+    g.setOrigin(pianoKeysWidth - scrollXPixels, timelineHeight - scrollYPixels);
 
-    drawGrid(g);
-    drawNotes(g);
-    drawPitchCurves(g);
+    contentTiles->draw(g,
+                       {scrollXPixels, scrollYPixels, mainArea.getWidth(),
+                        mainArea.getHeight()},
+                       pixelsPerSecond, pixelsPerSemitone);
+    drawSplitGuide(g);
     drawSelectionRect(g);
   }
 
   // Draw timeline (above grid, scrolls horizontally)
-  drawTimeline(g);
+  {
+    juce::Graphics::ScopedSaveState saveState(g);
+    g.setOrigin(pianoKeysWidth - scrollXPixels, 0);
+    timelineTiles->draw(g,
+                        {scrollXPixels, 0, mainArea.getWidth(),
+                         timelineHeight},
+                        pixelsPerSecond, 0.0f);
+  }
 
   // Draw unified cursor line (spans from timeline through grid)
   {
@@ -137,8 +183,15 @@ void PianoRollComponent::paint(juce::Graphics &g) {
     g.fillRect(x - 0.5f, cursorTop, 1.0f, cursorBottom);
   }
 
-  // Draw piano keys
-  drawPianoKeys(g);
+  // Draw piano keys (scroll vertically)
+  {
+    juce::Graphics::ScopedSaveState saveState(g);
+    g.setOrigin(0, timelineHeight - scrollYPixels);
+    pianoKeyTiles->draw(g,
+                        {0, scrollYPixels, pianoKeysWidth,
+                         mainArea.getHeight()},
+                        0.0f, pixelsPerSemitone);
+  }
 }
 
 void PianoRollComponent::resized() {
@@ -153,51 +206,36 @@ void PianoRollComponent::resized() {
       bounds.getWidth() - scrollBarSize, timelineHeight, scrollBarSize,
       bounds.getHeight() - scrollBarSize - timelineHeight);
 
+  // The grid spans at least the component width
+  invalidateRenderCache();
   updateScrollBars();
 }
 
-void PianoRollComponent::drawBackgroundWaveform(
-    juce::Graphics &g, const juce::Rectangle<int> &visibleArea) {
+void PianoRollComponent::LayerSnapshot::drawBackgroundWaveform(
+    juce::Graphics &g, const juce::Rectangle<int> &area) {
   if (!project)
     return;
 
-  const auto &audioData = project->getAudioData();
-  if (audioData.waveform.getNumSamples() == 0)
+  auto &audioData = project->getAudioData();
+  if (audioData.waveform->getNumSamples() == 0)
     return;
 
-  // Check if we can use cached waveform
-  bool cacheValid = waveformCache.isValid() &&
-                    std::abs(cachedScrollX - scrollX) < 1.0 &&
-                    std::abs(cachedPixelsPerSecond - pixelsPerSecond) < 0.01f &&
-                    cachedWidth == visibleArea.getWidth() &&
-                    cachedHeight == visibleArea.getHeight();
-
-  if (cacheValid) {
-    g.drawImageAt(waveformCache, visibleArea.getX(), visibleArea.getY());
-    return;
-  }
-
-  // Render waveform to cache
-  waveformCache = juce::Image(juce::Image::ARGB, visibleArea.getWidth(),
-                              visibleArea.getHeight(), true);
-  juce::Graphics cacheGraphics(waveformCache);
-
-  const float *samples = audioData.waveform.getReadPointer(0);
-  int numSamples = audioData.waveform.getNumSamples();
+  const auto &waveform = *audioData.waveform;
+  const auto &peaks = audioData.getPeaks();
+  int numSamples = waveform.getNumSamples();
 
   // Draw waveform filling the visible area height
-  float visibleHeight = static_cast<float>(visibleArea.getHeight());
+  float visibleHeight = waveformAreaHeight;
   float centerY = visibleHeight * 0.5f;
   float waveformHeight = visibleHeight * 0.8f;
 
-  juce::Path waveformPath;
-  int visibleWidth = visibleArea.getWidth();
-
-  waveformPath.startNewSubPath(0.0f, centerY);
-
-  // Draw only the visible portion
-  for (int px = 0; px < visibleWidth; ++px) {
-    double time = (scrollX + px) / pixelsPerSecond;
+  // Peak per column, from the peak pyramid; one extra column either side so
+  // neighbouring tiles join up
+  const int firstPx = area.getX() - 1;
+  const int numColumns = area.getWidth() + 2;
+  std::vector<float> columnPeaks(static_cast<size_t>(numColumns));
+  for (int i = 0; i < numColumns; ++i) {
+    double time = (firstPx + i) / pixelsPerSecond;
     int startSample = static_cast<int>(time * SAMPLE_RATE);
     int endSample =
         static_cast<int>((time + 1.0 / pixelsPerSecond) * SAMPLE_RATE);
@@ -205,67 +243,67 @@ void PianoRollComponent::drawBackgroundWaveform(
     startSample = std::max(0, std::min(startSample, numSamples - 1));
     endSample = std::max(startSample + 1, std::min(endSample, numSamples));
 
-    float maxVal = 0.0f;
-    for (int i = startSample; i < endSample; ++i)
-      maxVal = std::max(maxVal, std::abs(samples[i]));
-
-    float y = centerY - maxVal * waveformHeight * 0.5f;
-    waveformPath.lineTo(static_cast<float>(px), y);
+    columnPeaks[static_cast<size_t>(i)] =
+        peaks.getPeak(waveform, startSample, endSample).getMagnitude();
   }
 
-  // Bottom half (reverse)
-  for (int px = visibleWidth - 1; px >= 0; --px) {
-    double time = (scrollX + px) / pixelsPerSecond;
-    int startSample = static_cast<int>(time * SAMPLE_RATE);
-    int endSample =
-        static_cast<int>((time + 1.0 / pixelsPerSecond) * SAMPLE_RATE);
-
-    startSample = std::max(0, std::min(startSample, numSamples - 1));
-    endSample = std::max(startSample + 1, std::min(endSample, numSamples));
+  juce::Path waveformPath;
+  waveformPath.startNewSubPath(static_cast<float>(firstPx), centerY);
 
-    float maxVal = 0.0f;
-    for (int i = startSample; i < endSample; ++i)
-      maxVal = std::max(maxVal, std::abs(samples[i]));
+  for (int i = 0; i < numColumns; ++i) {
+    float y = centerY - columnPeaks[static_cast<size_t>(i)] *
+                            waveformHeight * 0.5f;
+    waveformPath.lineTo(static_cast<float>(firstPx + i), y);
+  }
 
-    float y = centerY + maxVal * waveformHeight * 0.5f;
-    waveformPath.lineTo(static_cast<float>(px), y);
+  // Bottom half (reverse)
+  for (int i = numColumns - 1; i >= 0; --i) {
+    float y = centerY + columnPeaks[static_cast<size_t>(i)] *
+                            waveformHeight * 0.5f;
+    waveformPath.lineTo(static_cast<float>(firstPx + i), y);
   }
 
   waveformPath.closeSubPath();
 
-  cacheGraphics.setColour(juce::Colour(COLOR_WAVEFORM));
-  cacheGraphics.fillPath(waveformPath);
-
-  // Update cache metadata
-  cachedScrollX = scrollX;
-  cachedPixelsPerSecond = pixelsPerSecond;
-  cachedWidth = visibleArea.getWidth();
-  cachedHeight = visibleArea.getHeight();
+  g.setColour(juce::Colour(COLOR_WAVEFORM));
+  g.fillPath(waveformPath);
+}
 
-  // Draw cached image
-  g.drawImageAt(waveformCache, visibleArea.getX(), visibleArea.getY());
+void PianoRollComponent::LayerSnapshot::drawContent(
+    juce::Graphics &g, const juce::Rectangle<int> &area) {
+  drawGrid(g, area);
+  drawNotes(g, area);
+  drawPitchCurves(g, area);
 }
 
-void PianoRollComponent::drawGrid(juce::Graphics &g) {
+void PianoRollComponent::LayerSnapshot::drawGrid(
+    juce::Graphics &g, const juce::Rectangle<int> &area) {
   float duration = project ? project->getAudioData().getDuration() : 60.0f;
   float width =
-      std::max(duration * pixelsPerSecond, static_cast<float>(getWidth()));
+      std::max(duration * pixelsPerSecond, static_cast<float>(minWidth));
   float height = (MAX_MIDI_NOTE - MIN_MIDI_NOTE) * pixelsPerSemitone;
 
+  const float left = static_cast<float>(area.getX());
+  const float right = std::min(static_cast<float>(area.getRight()), width);
+
   // Horizontal lines (pitch)
   g.setColour(juce::Colour(COLOR_GRID));
 
-  for (int midi = MIN_MIDI_NOTE; midi <= MAX_MIDI_NOTE; ++midi) {
+  for (int midi = MIN_MIDI_NOTE; midi <= MAX_MIDI_NOTE && left < right;
+       ++midi) {
     float y = midiToY(static_cast<float>(midi));
+    if (y < area.getY() - 1 || y > area.getBottom())
+      continue;
+
     int noteInOctave = midi % 12;
 
     if (noteInOctave == 0) // C
     {
       g.setColour(juce::Colour(COLOR_GRID_BAR));
-      g.drawHorizontalLine(static_cast<int>(y), 0, width);
+      g.drawHorizontalLine(static_cast<int>(y), left, right);
       g.setColour(juce::Colour(COLOR_GRID));
     } else {
-      g.drawHorizontalLine(static_cast<int>(y), 0, width);
+      g.drawHorizontalLine(static_cast<int>(y), left, right);
     }
   }
 
@@ -273,26 +311,26 @@ void PianoRollComponent::drawGrid(juce::Graphics &g) {
   float secondsPerBeat = 60.0f / 120.0f; // Assuming 120 BPM
   float pixelsPerBeat = secondsPerBeat * pixelsPerSecond;
 
-  for (float x = 0; x < width; x += pixelsPerBeat) {
-    g.setColour(juce::Colour(COLOR_GRID));
+  g.setColour(juce::Colour(COLOR_GRID));
+  for (int beat = std::max(0, static_cast<int>(left / pixelsPerBeat));;
+       ++beat) {
+    float x = beat * pixelsPerBeat;
+    if (x >= width || x >= static_cast<float>(area.getRight()))
+      break;
     g.drawVerticalLine(static_cast<int>(x), 0, height);
   }
 }
 
-void PianoRollComponent::drawTimeline(juce::Graphics &g) {
-  constexpr int scrollBarSize = 8;
-  auto timelineArea = juce::Rectangle<int>(
-      pianoKeysWidth, 0, getWidth() - pianoKeysWidth - scrollBarSize,
-      timelineHeight);
-
+void PianoRollComponent::drawTimeline(juce::Graphics &g,
+                                      const juce::Rectangle<int> &area) {
   // Background
   g.setColour(juce::Colour(0xFF1E1E28));
-  g.fillRect(timelineArea);
+  g.fillRect(area);
 
   // Bottom border
   g.setColour(juce::Colour(COLOR_GRID_BAR));
-  g.drawHorizontalLine(timelineHeight - 1, static_cast<float>(pianoKeysWidth),
-                       static_cast<float>(getWidth() - scrollBarSize));
+  g.drawHorizontalLine(timelineHeight - 1, static_cast<float>(area.getX()),
+                       static_cast<float>(area.getRight()));
 
   // Determine tick interval based on zoom level
   float secondsPerTick;
@@ -309,19 +347,21 @@ void PianoRollComponent::drawTimeline(juce::Graphics &g) {
 
   float duration = project ? project->getAudioData().getDuration() : 60.0f;
 
-  // Draw ticks and labels
+  // Draw ticks and labels; a label reaches 53px right of its tick
   g.setFont(11.0f);
 
-  for (float time = 0.0f; time <= duration + secondsPerTick;
-       time += secondsPerTick) {
-    float x =
-        pianoKeysWidth + time * pixelsPerSecond - static_cast<float>(scrollX);
+  const int firstTick = std::max(
+      0, static_cast<int>((area.getX() - 53) / pixelsPerSecond / secondsPerTick));
 
-    if (x < pianoKeysWidth - 50 || x > getWidth())
-      continue;
+  for (int tick = firstTick;; ++tick) {
+    float time = tick * secondsPerTick;
+    float x = time * pixelsPerSecond;
+
+    if (time > duration + secondsPerTick || x > area.getRight())
+      break;
 
     // Tick mark
-    bool isMajor = std::fmod(time, secondsPerTick * 2.0f) < 0.001f;
+    bool isMajor = tick % 2 == 0;
     int tickHeight = isMajor ? 8 : 4;
 
     g.setColour(juce::Colour(COLOR_GRID_BAR));
@@ -350,21 +390,31 @@ void PianoRollComponent::drawTimeline(juce::Graphics &g) {
   }
 }
 
-void PianoRollComponent::drawNotes(juce::Graphics &g) {
+void PianoRollComponent::LayerSnapshot::drawNotes(
+    juce::Graphics &g, const juce::Rectangle<int> &area) {
   if (!project)
     return;
 
-  const auto &audioData = project->getAudioData();
-  const float *samples = audioData.waveform.getNumSamples() > 0
-                             ? audioData.waveform.getReadPointer(0)
-                             : nullptr;
-  int totalSamples = audioData.waveform.getNumSamples();
+  auto &audioData = project->getAudioData();
+  const auto &waveform = *audioData.waveform;
+  int totalSamples = waveform.getNumSamples();
+  const WaveformPeaks *peaks =
+      totalSamples > 0 ? &audioData.getPeaks() : nullptr;
+
+  // Time range of the area for culling, widened by the outline stroke
+  double visibleStartTime = (area.getX() - 2) / pixelsPerSecond;
+  double visibleEndTime = (area.getRight() + 2) / pixelsPerSecond;
+
+  // Candidate notes from the note index, with a frame of slack either side
+  const int visibleStartFrame =
+      secondsToFrames(static_cast<float>(visibleStartTime)) - 1;
+  const int visibleEndFrame =
+      secondsToFrames(static_cast<float>(visibleEndTime)) + 2;
 
-  // Calculate visible time range for culling
-  double visibleStartTime = scrollX / pixelsPerSecond;
-  double visibleEndTime = (scrollX + getWidth()) / pixelsPerSecond;
+  for (auto *visibleNote :
+       project->getNotesInRange(visibleStartFrame, visibleEndFrame)) {
+    auto &note = *visibleNote;
 
-  for (auto &note : project->getNotes()) {
     // Skip rest notes (they have no pitch)
     if (note.isRest())
       continue;
@@ -386,245 +436,51 @@ void PianoRollComponent::drawNotes(juce::Graphics &g) {
     float pitchOffsetPixels = -note.getPitchOffset() * pixelsPerSemitone;
     float y = baseGridCenterY + pitchOffsetPixels - h * 0.5f;
 
+    // The waveform spans 1.5 semitones either side of the note centre
+    if (y + h * 2.0f + 2.0f < area.getY() ||
+        y - h - 2.0f > area.getBottom())
+      continue;
+
     // Note color based on pitch
     juce::Colour noteColor = note.isSelected()
                                  ? juce::Colour(COLOR_NOTE_SELECTED)
                                  : juce::Colour(COLOR_NOTE_NORMAL);
 
-    if (samples && totalSamples > 0 && w > 2.0f) {
-      // Draw waveform slice inside note
+    const NoteGlyphCache::Glyph *glyph = nullptr;
+    if (peaks && w > 2.0f) {
+      // Waveform slice inside the note, shaped once per sample range and zoom
       int startSample = static_cast<int>(framesToSeconds(note.getStartFrame()) *
                                          audioData.sampleRate);
       int endSample = static_cast<int>(framesToSeconds(note.getEndFrame()) *
                                        audioData.sampleRate);
-      startSample = std::max(0, std::min(startSample, totalSamples - 1));
-      endSample = std::max(startSample + 1, std::min(endSample, totalSamples));
-
-      int numNoteSamples = endSample - startSample;
-      int samplesPerPixel = std::max(1, static_cast<int>(numNoteSamples / w));
-
-      float centerY = y + h * 0.5f;
-      float waveHeight = h * 3.0f;
-
-      // Build waveform data with increased resolution for smoother curves
-      std::vector<float> waveValues;
-      // Increase point density for smoother curves (up to 800 points)
-      float step = std::max(0.5f, w / 1024.0f);
-
-      for (float px = 0; px <= w; px += step) {
-        int sampleIdx =
-            startSample + static_cast<int>((px / w) * numNoteSamples);
-        int sampleEnd = std::min(sampleIdx + samplesPerPixel, endSample);
-
-        float maxVal = 0.0f;
-        for (int i = sampleIdx; i < sampleEnd; ++i)
-          maxVal = std::max(maxVal, std::abs(samples[i]));
-
-        waveValues.push_back(maxVal);
-      }
-
-      // Apply smoothing filter to reduce aliasing artifacts
-      if (waveValues.size() > 2) {
-        std::vector<float> smoothed(waveValues.size());
-        smoothed[0] = waveValues[0];
-        for (size_t i = 1; i + 1 < waveValues.size(); ++i) {
-          // Simple 3-point moving average for gentle smoothing
-          smoothed[i] = (waveValues[i - 1] * 0.25f + waveValues[i] * 0.5f +
-                         waveValues[i + 1] * 0.25f);
-        }
-        smoothed[waveValues.size() - 1] = waveValues[waveValues.size() - 1];
-        waveValues = std::move(smoothed);
-      }
-
-      size_t numPoints = waveValues.size();
-      if (numPoints < 2) {
-        // Fallback for very short notes
-        g.setColour(noteColor.withAlpha(0.85f));
-        g.fillRoundedRectangle(x, y, std::max(w, 4.0f), h, 2.0f);
-      } else {
-        // Helper function for Catmull-Rom spline interpolation
-        auto catmullRom = [](float t, float p0, float p1, float p2,
-                             float p3) -> float {
-          // Catmull-Rom spline: smooth interpolation between p1 and p2
-          float t2 = t * t;
-          float t3 = t2 * t;
-          return 0.5f * ((2.0f * p1) + (-p0 + p2) * t +
-                         (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
-                         (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t3);
-        };
-
-        // Draw filled waveform using smooth curves
-        g.setColour(noteColor.withAlpha(0.85f));
-        juce::Path waveformPath;
-
-        // Build top curve with Catmull-Rom spline
-        waveformPath.startNewSubPath(x, centerY -
-                                            waveValues[0] * waveHeight * 0.5f);
-
-        // Use cubic curves for smooth interpolation
-        const int curveSegments = 4; // Interpolate 4 points between each pair
-        for (size_t i = 0; i + 1 < numPoints; ++i) {
-          float px1 =
-              (static_cast<float>(i) / static_cast<float>(numPoints - 1)) * w;
-          float px2 =
-              (static_cast<float>(i + 1) / static_cast<float>(numPoints - 1)) *
-              w;
-
-          // Get control points for spline
-          size_t idx0 = (i > 0) ? i - 1 : i;
-          size_t idx1 = i;
-          size_t idx2 = i + 1;
-          size_t idx3 = (i + 2 < numPoints) ? i + 2 : i + 1;
-
-          float val0 = waveValues[idx0];
-          float val1 = waveValues[idx1];
-          float val2 = waveValues[idx2];
-          float val3 = waveValues[idx3];
-
-          // Draw smooth curve segment
-          for (int seg = 1; seg <= curveSegments; ++seg) {
-            float t =
-                static_cast<float>(seg) / static_cast<float>(curveSegments);
-            float px = px1 + (px2 - px1) * t;
-            float val = catmullRom(t, val0, val1, val2, val3);
-            float yPos = centerY - val * waveHeight * 0.5f;
-            waveformPath.lineTo(x + px, yPos);
-          }
-        }
-
-        // Build bottom curve (mirror of top)
-        waveformPath.lineTo(x + w, centerY + waveValues[numPoints - 1] *
-                                                 waveHeight * 0.5f);
-
-        for (int i = static_cast<int>(numPoints) - 2; i >= 0; --i) {
-          float px1 =
-              (static_cast<float>(i + 1) / static_cast<float>(numPoints - 1)) *
-              w;
-          float px2 =
-              (static_cast<float>(i) / static_cast<float>(numPoints - 1)) * w;
-
-          size_t idx0 = (i + 2 < numPoints) ? i + 2 : i + 1;
-          size_t idx1 = i + 1;
-          size_t idx2 = i;
-          size_t idx3 = (i > 0) ? i - 1 : i;
-
-          float val0 = waveValues[idx0];
-          float val1 = waveValues[idx1];
-          float val2 = waveValues[idx2];
-          float val3 = waveValues[idx3];
-
-          for (int seg = 1; seg <= curveSegments; ++seg) {
-            float t =
-                static_cast<float>(seg) / static_cast<float>(curveSegments);
-            float px = px1 + (px2 - px1) * t;
-            float val = catmullRom(t, val0, val1, val2, val3);
-            float yPos = centerY + val * waveHeight * 0.5f;
-            waveformPath.lineTo(x + px, yPos);
-          }
-        }
-
-        waveformPath.closeSubPath();
-        g.fillPath(waveformPath);
-
-        // Draw smooth outline with anti-aliasing
-        juce::Path outline;
-        outline.startNewSubPath(x, centerY - waveValues[0] * waveHeight * 0.5f);
-
-        // Top curve
-        for (size_t i = 0; i + 1 < numPoints; ++i) {
-          float px1 =
-              (static_cast<float>(i) / static_cast<float>(numPoints - 1)) * w;
-          float px2 =
-              (static_cast<float>(i + 1) / static_cast<float>(numPoints - 1)) *
-              w;
-
-          size_t idx0 = (i > 0) ? i - 1 : i;
-          size_t idx1 = i;
-          size_t idx2 = i + 1;
-          size_t idx3 = (i + 2 < numPoints) ? i + 2 : i + 1;
-
-          float val0 = waveValues[idx0];
-          float val1 = waveValues[idx1];
-          float val2 = waveValues[idx2];
-          float val3 = waveValues[idx3];
-
-          for (int seg = 1; seg <= curveSegments; ++seg) {
-            float t =
-                static_cast<float>(seg) / static_cast<float>(curveSegments);
-            float px = px1 + (px2 - px1) * t;
-            float val = catmullRom(t, val0, val1, val2, val3);
-            float yPos = centerY - val * waveHeight * 0.5f;
-            outline.lineTo(x + px, yPos);
-          }
-        }
+      glyph = noteGlyphs->getGlyph(startSample, endSample, w, waveform, *peaks,
+                                   noteGlyphVersion);
+    }
 
-        // Bottom curve
-        for (int i = static_cast<int>(numPoints) - 2; i >= 0; --i) {
-          float px1 =
-              (static_cast<float>(i + 1) / static_cast<float>(numPoints - 1)) *
-              w;
-          float px2 =
-              (static_cast<float>(i) / static_cast<float>(numPoints - 1)) * w;
-
-          size_t idx0 = (i + 2 < numPoints) ? i + 2 : i + 1;
-          size_t idx1 = i + 1;
-          size_t idx2 = i;
-          size_t idx3 = (i > 0) ? i - 1 : i;
-
-          float val0 = waveValues[idx0];
-          float val1 = waveValues[idx1];
-          float val2 = waveValues[idx2];
-          float val3 = waveValues[idx3];
-
-          for (int seg = 1; seg <= curveSegments; ++seg) {
-            float t =
-                static_cast<float>(seg) / static_cast<float>(curveSegments);
-            float px = px1 + (px2 - px1) * t;
-            float val = catmullRom(t, val0, val1, val2, val3);
-            float yPos = centerY + val * waveHeight * 0.5f;
-            outline.lineTo(x + px, yPos);
-          }
-        }
+    if (glyph) {
+      const auto transform =
+          NoteGlyphCache::getTransform(x, y + h * 0.5f, w, h * 3.0f);
 
-        outline.closeSubPath();
-        g.setColour(noteColor.brighter(0.2f));
-        // Use slightly thicker stroke with anti-aliasing for smoother
-        // appearance
-        g.strokePath(outline,
-                     juce::PathStrokeType(1.2f, juce::PathStrokeType::curved,
-                                          juce::PathStrokeType::rounded));
-      }
+      g.setColour(noteColor.withAlpha(0.85f));
+      g.fillPath(glyph->fill, transform);
+
+      g.setColour(noteColor.brighter(0.2f));
+      // Use slightly thicker stroke with anti-aliasing for smoother
+      // appearance
+      g.strokePath(glyph->outline,
+                   juce::PathStrokeType(1.2f, juce::PathStrokeType::curved,
+                                        juce::PathStrokeType::rounded),
+                   transform);
     } else {
       // Fallback: simple rectangle for very short notes
       g.setColour(noteColor.withAlpha(0.85f));
       g.fillRoundedRectangle(x, y, std::max(w, 4.0f), h, 2.0f);
     }
   }
-
-  // Draw split guide line when in split mode and hovering over a note
-  if (editMode == EditMode::Split && splitGuideNote && splitGuideX >= 0) {
-    float noteStartTime = framesToSeconds(splitGuideNote->getStartFrame());
-    float noteEndTime = framesToSeconds(splitGuideNote->getEndFrame());
-    float noteStartX = static_cast<float>(noteStartTime * pixelsPerSecond);
-    float noteEndX = static_cast<float>(noteEndTime * pixelsPerSecond);
-
-    // Only draw if guide is within note bounds (with margin)
-    if (splitGuideX > noteStartX + 5 && splitGuideX < noteEndX - 5) {
-      float noteY = midiToY(splitGuideNote->getAdjustedMidiNote());
-      float noteH = pixelsPerSemitone;
-
-      // Draw dashed vertical line
-      g.setColour(juce::Colour(0xFFFF6B6B));  // Red-ish color for visibility
-      float dashLength = 4.0f;
-      for (float dy = 0; dy < noteH; dy += dashLength * 2) {
-        float segmentLength = std::min(dashLength, noteH - dy);
-        g.drawLine(splitGuideX, noteY + dy, splitGuideX, noteY + dy + segmentLength, 2.0f);
-      }
-    }
-  }
 }
 
-void PianoRollComponent::drawPitchCurves(juce::Graphics &g) {
+void PianoRollComponent::LayerSnapshot::drawPitchCurves(
+    juce::Graphics &g, const juce::Rectangle<int> &area) {
   if (!project)
     return;
 
@@ -635,115 +491,103 @@ void PianoRollComponent::drawPitchCurves(juce::Graphics &g) {
   // Get global pitch offset (applied to display only)
   float globalOffset = project->getGlobalPitchOffset();
 
+  // Frames that can reach into the area, with slack for stroke width
+  const float areaStartX = static_cast<float>(area.getX() - 4);
+  const float areaEndX = static_cast<float>(area.getRight() + 4);
+  const int areaStartFrame = secondsToFrames(areaStartX / pixelsPerSecond) - 1;
+  const int areaEndFrame = secondsToFrames(areaEndX / pixelsPerSecond) + 2;
+
   // Draw pitch curves per note with their pitch offsets applied (delta pitch)
   if (showDeltaPitch) {
     g.setColour(juce::Colour(COLOR_PITCH_CURVE));
 
-    for (const auto &note : project->getNotes()) {
+    // The curves are copied from frameOffset on
+    const int f0Size = static_cast<int>(audioData.f0.size());
+    auto pitchAt = [&audioData, f0Size, offset = frameOffset](int frame) {
+      const int i = frame - offset;
+      if (i < 0)
+        return 0.0f;
+      float baseMidi =
+          (i < static_cast<int>(audioData.basePitch.size()))
+              ? audioData.basePitch[static_cast<size_t>(i)]
+              : ((i < f0Size && audioData.f0[static_cast<size_t>(i)] > 0.0f)
+                     ? freqToMidi(audioData.f0[static_cast<size_t>(i)])
+                     : 0.0f);
+      float deltaMidi = (i < static_cast<int>(audioData.deltaPitch.size()))
+                            ? audioData.deltaPitch[static_cast<size_t>(i)]
+                            : 0.0f;
+      return baseMidi + deltaMidi;
+    };
+
+    for (auto *visibleNote :
+         project->getNotesInRange(areaStartFrame, areaEndFrame)) {
+      const auto &note = *visibleNote;
       if (note.isRest())
         continue;
 
-      juce::Path path;
-      bool pathStarted = false;
-
-      int startFrame = note.getStartFrame();
-      int endFrame =
-          std::min(note.getEndFrame(), static_cast<int>(audioData.f0.size()));
-
-      for (int i = startFrame; i < endFrame; ++i) {
-        // Base pitch: during drag, add pitchOffset to simulate the new base pitch
-        // This gives real-time preview of how the curve will look after drag completes
-        float baseMidi =
-            (i < static_cast<int>(audioData.basePitch.size()))
-                ? audioData.basePitch[static_cast<size_t>(i)] + note.getPitchOffset()
-                : ((i < static_cast<int>(audioData.f0.size()) &&
-                    audioData.f0[static_cast<size_t>(i)] > 0.0f)
-                       ? freqToMidi(audioData.f0[static_cast<size_t>(i)]) + note.getPitchOffset()
-                       : 0.0f);
-        float deltaMidi = (i < static_cast<int>(audioData.deltaPitch.size()))
-                              ? audioData.deltaPitch[static_cast<size_t>(i)]
-                              : 0.0f;
-        // Final = base (with drag offset) + delta + global offset only
-        float finalMidi = baseMidi + deltaMidi + globalOffset;
-
-        if (finalMidi > 0.0f) {
-          float x = framesToSeconds(i) * pixelsPerSecond;
-          float y = midiToY(finalMidi) + pixelsPerSemitone * 0.5f;
-
-          if (!pathStarted) {
-            path.startNewSubPath(x, y);
-            pathStarted = true;
-          } else {
-            path.lineTo(x, y);
-          }
-        }
-      }
+      // Base pitch: during drag, add pitchOffset to simulate the new base pitch
+      // This gives real-time preview of how the curve will look after drag completes
+      const float offset = note.getPitchOffset() + globalOffset;
+      auto curveY = [this, offset](float midi) {
+        return midiToY(midi + offset) + pixelsPerSemitone * 0.5f;
+      };
 
-      if (pathStarted) {
+      juce::Path path;
+      pitchCurves->addToPath(path, note, pixelsPerSecond, areaStartX, areaEndX,
+                             pitchAt, curveY, pitchCurveVersion);
+      if (!path.isEmpty())
         g.strokePath(path, juce::PathStrokeType(2.0f));
-      }
     }
   }
 
   // Draw base pitch curve as dashed line
   // Use cached base pitch to avoid expensive recalculation on every repaint
   if (showBasePitch) {
-    updateBasePitchCacheIfNeeded();
-
-    if (!cachedBasePitch.empty()) {
-      // Calculate visible frame range
-      double visibleStartTime = scrollX / pixelsPerSecond;
-      double visibleEndTime = (scrollX + getWidth()) / pixelsPerSecond;
-      int visStartFrame =
-          std::max(0, static_cast<int>(visibleStartTime * audioData.sampleRate /
-                                       HOP_SIZE));
+    if (!basePitch.empty()) {
+      int visStartFrame = std::max(frameOffset, areaStartFrame);
       int visEndFrame = std::min(
-          static_cast<int>(cachedBasePitch.size()),
-          static_cast<int>(visibleEndTime * audioData.sampleRate / HOP_SIZE) +
-              1);
+          frameOffset + static_cast<int>(basePitch.size()), areaEndFrame);
 
-      // Draw base pitch curve with dashed line
-      g.setColour(
-          juce::Colour(0xFF00FF00).withAlpha(0.6f)); // Green with transparency
+      // Dashes are laid out along world x rather than along the curve, so
+      // neighbouring tiles agree on where each dash starts and ends
+      constexpr float dashLength = 4.0f; // 4px dash, 4px gap
       juce::Path basePath;
-      bool basePathStarted = false;
-
-      for (int i = visStartFrame; i < visEndFrame; ++i) {
-        if (i >= 0 && i < static_cast<int>(cachedBasePitch.size())) {
-          float baseMidi = cachedBasePitch[static_cast<size_t>(i)];
-          if (baseMidi > 0.0f) {
-            float x = framesToSeconds(i) * pixelsPerSecond;
-            float y = midiToY(baseMidi) +
-                      pixelsPerSemitone * 0.5f; // Center in grid cell
-
-            if (!basePathStarted) {
-              basePath.startNewSubPath(x, y);
-              basePathStarted = true;
-            } else {
-              basePath.lineTo(x, y);
-            }
-          } else if (basePathStarted) {
-            // Break path at unvoiced regions - draw current segment before
-            // breaking
-            juce::Path dashedPath;
-            juce::PathStrokeType stroke(1.5f);
-            const float dashLengths[] = {4.0f, 4.0f}; // 4px dash, 4px gap
-            stroke.createDashedStroke(dashedPath, basePath, dashLengths, 2);
-            g.strokePath(dashedPath, juce::PathStrokeType(1.5f));
-            basePath.clear();
-            basePathStarted = false;
+      float penX = -1.0f;
+
+      for (int i = visStartFrame; i + 1 < visEndFrame; ++i) {
+        float midi0 = basePitch[static_cast<size_t>(i - frameOffset)];
+        float midi1 = basePitch[static_cast<size_t>(i + 1 - frameOffset)];
+        // Break path at unvoiced regions
+        if (midi0 <= 0.0f || midi1 <= 0.0f)
+          continue;
+
+        float x0 = framesToSeconds(i) * pixelsPerSecond;
+        float x1 = framesToSeconds(i + 1) * pixelsPerSecond;
+        float y0 = midiToY(midi0) + pixelsPerSemitone * 0.5f;
+        float y1 = midiToY(midi1) + pixelsPerSemitone * 0.5f;
+
+        // Split the segment at dash boundaries and keep the dashes
+        for (float xa = x0; xa < x1;) {
+          float dashIndex = std::floor(xa / dashLength);
+          float xb = std::min(x1, (dashIndex + 1.0f) * dashLength);
+          if (static_cast<int>(dashIndex) % 2 == 0) {
+            float ya = y0 + (y1 - y0) * (xa - x0) / (x1 - x0);
+            float yb = y0 + (y1 - y0) * (xb - x0) / (x1 - x0);
+            if (xa != penX)
+              basePath.startNewSubPath(xa, ya);
+            basePath.lineTo(xb, yb);
+            penX = xb;
           }
+          xa = xb;
         }
       }
 
-      if (basePathStarted) {
-        // Use dashed stroke for base pitch curve
-        juce::Path dashedPath;
-        juce::PathStrokeType stroke(1.5f);
-        const float dashLengths[] = {4.0f, 4.0f}; // 4px dash, 4px gap
-        stroke.createDashedStroke(dashedPath, basePath, dashLengths, 2);
-        g.strokePath(dashedPath, juce::PathStrokeType(1.5f));
-      }
+      // Outline the dashes and stroke the outline, as before
+      g.setColour(
+          juce::Colour(0xFF00FF00).withAlpha(0.6f)); // Green with transparency
+      juce::Path dashedPath;
+      juce::PathStrokeType(1.5f).createStrokedPath(dashedPath, basePath);
+      g.strokePath(dashedPath, juce::PathStrokeType(1.5f));
     }
   }
 }
@@ -756,24 +600,21 @@ void PianoRollComponent::drawCursor(juce::Graphics &g) {
   g.fillRect(x - 0.5f, 0.0f, 1.0f, height);
 }
 
-void PianoRollComponent::drawPianoKeys(juce::Graphics &g) {
-  constexpr int scrollBarSize = 8;
-  auto keyArea = getLocalBounds()
-                     .withWidth(pianoKeysWidth)
-                     .withTrimmedTop(timelineHeight)
-                     .withTrimmedBottom(scrollBarSize);
-
+void PianoRollComponent::drawPianoKeys(juce::Graphics &g,
+                                       const juce::Rectangle<int> &area) {
   // Background
   g.setColour(juce::Colour(0xFF1A1A24));
-  g.fillRect(keyArea);
+  g.fillRect(area);
 
   static const char *noteNames[] = {"C",  "C#", "D",  "D#", "E",  "F",
                                     "F#", "G",  "G#", "A",  "A#", "B"};
 
   // Draw each key
   for (int midi = MIN_MIDI_NOTE; midi <= MAX_MIDI_NOTE; ++midi) {
-    float y = midiToY(static_cast<float>(midi)) - static_cast<float>(scrollY) +
-              timelineHeight;
+    float y = midiToY(static_cast<float>(midi));
+    if (y + pixelsPerSemitone < area.getY() || y > area.getBottom())
+      continue;
+
     int noteInOctave = midi % 12;
 
     // Check if it's a black key
@@ -807,6 +648,10 @@ float PianoRollComponent::midiToY(float midiNote) const {
   return (MAX_MIDI_NOTE - midiNote) * pixelsPerSemitone;
 }
 
+float PianoRollComponent::LayerSnapshot::midiToY(float midiNote) const {
+  return (MAX_MIDI_NOTE - midiNote) * pixelsPerSemitone;
+}
+
 float PianoRollComponent::yToMidi(float y) const {
   return MAX_MIDI_NOTE - y / pixelsPerSemitone;
 }
@@ -842,6 +687,9 @@ void PianoRollComponent::mouseDown(const juce::MouseEvent &e) {
   if (e.y < timelineHeight || e.x < pianoKeysWidth)
     return;
 
+  if (!editingEnabled)
+    return;
+
   if (editMode == EditMode::Draw) {
     // Start drawing
     isDrawing = true;
@@ -856,8 +704,6 @@ void PianoRollComponent::mouseDown(const juce::MouseEvent &e) {
 
     if (onPitchEdited)
       onPitchEdited();
-
-    repaint();
     return;
   }
 
@@ -882,27 +728,19 @@ void PianoRollComponent::mouseDown(const juce::MouseEvent &e) {
       // Start multi-note drag
       pitchEditor->startMultiNoteDrag(selectedNotes, adjustedY);
     } else {
-      // Single note selection and drag
+      // Single note selection and drag; the project reports what to redraw
       project->deselectAllNotes();
-      note->setSelected(true);
+      project->setNoteSelected(note, true);
 
       if (onNoteSelected)
         onNoteSelected(note);
+      if (onSelectionChanged)
+        onSelectionChanged();
 
-      // Capture delta slice from global dense deltaPitch for this note
+      // Delta pitch stays in the dense curve; the drag only moves midiNote
       auto &audioData = project->getAudioData();
       int startFrame = note->getStartFrame();
       int endFrame = note->getEndFrame();
-      int numFrames = endFrame - startFrame;
-
-      std::vector<float> delta(numFrames, 0.0f);
-      for (int i = 0; i < numFrames; ++i) {
-        int globalFrame = startFrame + i;
-        if (globalFrame >= 0 &&
-            globalFrame < static_cast<int>(audioData.deltaPitch.size()))
-          delta[i] = audioData.deltaPitch[static_cast<size_t>(globalFrame)];
-      }
-      note->setDeltaPitch(std::move(delta));
 
       // Start single note dragging
       isDragging = true;
@@ -910,6 +748,7 @@ void PianoRollComponent::mouseDown(const juce::MouseEvent &e) {
       dragStartY = adjustedY;
       originalPitchOffset = note->getPitchOffset();
       originalMidiNote = note->getMidiNote();
+      dragBounds = project->getNoteBounds(*note);
 
       // Save boundary F0 values and original F0 for undo
       int f0Size = static_cast<int>(audioData.f0.size());
@@ -920,17 +759,13 @@ void PianoRollComponent::mouseDown(const juce::MouseEvent &e) {
       boundaryF0End = (endFrame < f0Size) ? audioData.f0[endFrame] : 0.0f;
 
       // Save original F0 values for undo
-      originalF0Values.clear();
-      for (int i = startFrame; i < endFrame && i < f0Size; ++i)
-        originalF0Values.push_back(audioData.f0[i]);
+      const auto f0View = note->viewOf(audioData.f0);
+      originalF0Values.assign(f0View.begin(), f0View.end());
     }
-
-    repaint();
   } else {
     // Clicked on empty area - start box selection
     project->deselectAllNotes();
     boxSelector->startSelection(adjustedX, adjustedY);
-    repaint();
   }
 }
 
@@ -942,6 +777,9 @@ void PianoRollComponent::mouseDrag(const juce::MouseEvent &e) {
   float adjustedX = e.x - pianoKeysWidth + static_cast<float>(scrollX);
   float adjustedY = e.y - timelineHeight + static_cast<float>(scrollY);
 
+  // Damage from this step is repainted with the next throttled repaint
+  const juce::ScopedValueSetter<bool> gatherDamage(deferRepaints, true);
+
   if (editMode == EditMode::Draw && isDrawing) {
     applyPitchDrawing(adjustedX, adjustedY);
 
@@ -949,7 +787,7 @@ void PianoRollComponent::mouseDrag(const juce::MouseEvent &e) {
       onPitchEdited();
 
     if (shouldRepaint) {
-      repaint();
+      repaintDamage();
       lastDragRepaintTime = now;
     }
     return;
@@ -957,9 +795,11 @@ void PianoRollComponent::mouseDrag(const juce::MouseEvent &e) {
 
   // Handle box selection
   if (boxSelector->isSelecting()) {
+    addDamage(worldToScreen(boxSelector->getSelectionRect()));
     boxSelector->updateSelection(adjustedX, adjustedY);
+    addDamage(worldToScreen(boxSelector->getSelectionRect()));
     if (shouldRepaint) {
-      repaint();
+      repaintDamage();
       lastDragRepaintTime = now;
     }
     return;
@@ -969,22 +809,28 @@ void PianoRollComponent::mouseDrag(const juce::MouseEvent &e) {
   if (pitchEditor->isDraggingMultiNotes()) {
     pitchEditor->updateMultiNoteDrag(adjustedY);
     if (shouldRepaint) {
-      repaint();
+      repaintDamage();
       lastDragRepaintTime = now;
     }
     return;
   }
 
   // Handle single note drag
-  if (isDragging && draggedNote) {
+  if (isDragging && draggedNote && project) {
     float deltaY = dragStartY - adjustedY;
     float deltaSemitones = deltaY / pixelsPerSemitone;
 
-    draggedNote->setPitchOffset(deltaSemitones);
-    draggedNote->markDirty();
+    // Old and new position of the note and its curve
+    project->notifyChanged(dragBounds.transposed(
+        draggedNote->getPitchOffset() - originalPitchOffset));
+    project->setNotePitch(draggedNote, draggedNote->getMidiNote(),
+                          deltaSemitones);
+    project->markNoteDirty(draggedNote);
+    project->notifyChanged(
+        dragBounds.transposed(deltaSemitones - originalPitchOffset));
 
     if (shouldRepaint) {
-      repaint();
+      repaintDamage();
       lastDragRepaintTime = now;
     }
   }
@@ -993,10 +839,12 @@ void PianoRollComponent::mouseDrag(const juce::MouseEvent &e) {
 void PianoRollComponent::mouseUp(const juce::MouseEvent &e) {
   juce::ignoreUnused(e);
 
+  // Whatever the last throttled drag step left
+  repaintDamage();
+
   if (editMode == EditMode::Draw && isDrawing) {
     isDrawing = false;
     commitPitchDrawing();
-    repaint();
     return;
   }
 
@@ -1004,17 +852,18 @@ void PianoRollComponent::mouseUp(const juce::MouseEvent &e) {
   if (boxSelector->isSelecting()) {
     auto notesInRect = boxSelector->getNotesInRect(project, coordMapper.get());
     for (auto* note : notesInRect) {
-      note->setSelected(true);
+      project->setNoteSelected(note, true);
     }
+    addDamage(worldToScreen(boxSelector->getSelectionRect()));
     boxSelector->endSelection();
-    repaint();
+    if (onSelectionChanged)
+      onSelectionChanged();
     return;
   }
 
   // Handle multi-note drag end
   if (pitchEditor->isDraggingMultiNotes()) {
     pitchEditor->endMultiNoteDrag();
-    repaint();
     return;
   }
 
@@ -1034,31 +883,22 @@ void PianoRollComponent::mouseUp(const juce::MouseEvent &e) {
 
       // Update note's midiNote with final offset (bake pitchOffset into
       // midiNote)
-      draggedNote->setMidiNote(originalMidiNote + newOffset);
-      draggedNote->setPitchOffset(
-          0.0f); // Reset offset since it's baked into midiNote
+      project->setNotePitch(draggedNote, originalMidiNote + newOffset,
+                            0.0f); // Reset offset since it's baked into midiNote
 
       // Find adjacent notes to expand dirty range (basePitch smoothing affects neighbors)
-      const auto& notes = project->getNotes();
-      int expandedStart = startFrame;
-      int expandedEnd = endFrame;
-      for (const auto& note : notes) {
-        if (&note == draggedNote) continue;
-        // If note is adjacent (within smoothing window ~20 frames), include it
-        if (note.getEndFrame() > startFrame - 30 && note.getEndFrame() <= startFrame) {
-          expandedStart = std::min(expandedStart, note.getStartFrame());
-        }
-        if (note.getStartFrame() < endFrame + 30 && note.getStartFrame() >= endFrame) {
-          expandedEnd = std::max(expandedEnd, note.getEndFrame());
-        }
-      }
+      const auto [expandedStart, expandedEnd] =
+          PitchCurveProcessor::expandToAdjacentNotes(*project, startFrame,
+                                                     endFrame);
 
-      // Rebuild base pitch curve and F0 with final note position
-      PitchCurveProcessor::rebuildBaseFromNotes(*project);
-      PitchCurveProcessor::composeF0InPlace(*project, /*applyUvMask=*/false);
+      // Rebuild base pitch curve and F0 around the dragged note
+      const auto rebuilt =
+          PitchCurveProcessor::rebuildBaseForRange(*project, startFrame, endFrame);
+      invalidateFrameRange(std::min(rebuilt.first, startFrame),
+                           std::max(rebuilt.second, endFrame));
 
-      // Invalidate base pitch cache so it gets regenerated on next paint
-      invalidateBasePitchCache();
+      // Refresh the displayed base pitch around the edited note
+      updateBasePitchCacheRange(startFrame, endFrame);
 
       // Mark dirty range for synthesis (use expanded range)
       int smoothStart = std::max(0, expandedStart - 60);
@@ -1083,15 +923,21 @@ void PianoRollComponent::mouseUp(const juce::MouseEvent &e) {
         int capturedExpandedEnd = expandedEnd;
         int capturedF0Size = f0Size;
         auto action = std::make_unique<NotePitchDragAction>(
-            draggedNote, &audioData.f0, originalMidiNote,
+            project, draggedNote, &audioData.f0, originalMidiNote,
             originalMidiNote + newOffset, std::move(f0Edits),
             [this, capturedExpandedStart, capturedExpandedEnd, capturedF0Size](Note *n) {
               if (project) {
-                PitchCurveProcessor::rebuildBaseFromNotes(*project);
-                PitchCurveProcessor::composeF0InPlace(*project,
-                                                      /*applyUvMask=*/false);
-                // Invalidate base pitch cache
-                invalidateBasePitchCache();
+                if (n) {
+                  const auto rebuilt = PitchCurveProcessor::rebuildBaseForRange(
+                      *project, n->getStartFrame(), n->getEndFrame());
+                  invalidateFrameRange(
+                      std::min(rebuilt.first, n->getStartFrame()),
+                      std::max(rebuilt.second, n->getEndFrame()));
+                }
+                // Refresh the displayed base pitch around the note
+                if (n)
+                  updateBasePitchCacheRange(n->getStartFrame(),
+                                            n->getEndFrame());
                 // Set dirty range for synthesis (use expanded range)
                 int smoothStart = std::max(0, capturedExpandedStart - 60);
                 int smoothEnd = std::min(capturedF0Size, capturedExpandedEnd + 60);
@@ -1100,7 +946,7 @@ void PianoRollComponent::mouseUp(const juce::MouseEvent &e) {
                 // instead This prevents getDirtyFrameRange() from expanding the
                 // range unnecessarily
                 if (n) {
-                  n->clearDirty();
+                  project->clearNoteDirty(n);
                 }
               }
             });
@@ -1109,13 +955,14 @@ void PianoRollComponent::mouseUp(const juce::MouseEvent &e) {
 
       if (onPitchEdited)
         onPitchEdited();
-      repaint();
       if (onPitchEditFinished)
         onPitchEditFinished();
     } else {
-      // No meaningful change: just reset pitchOffset and repaint
-      draggedNote->setPitchOffset(0.0f);
-      repaint();
+      // No meaningful change: put the note back where it started
+      project->notifyChanged(dragBounds.transposed(
+          draggedNote->getPitchOffset() - originalPitchOffset));
+      project->setNotePitch(draggedNote, draggedNote->getMidiNote(), 0.0f);
+      project->notifyChanged(dragBounds.transposed(-originalPitchOffset));
     }
   }
 
@@ -1129,6 +976,16 @@ void PianoRollComponent::mouseMove(const juce::MouseEvent &e) {
     float adjustedX = e.x - pianoKeysWidth + static_cast<float>(scrollX);
     float adjustedY = e.y - timelineHeight + static_cast<float>(scrollY);
 
+    // The guide is a short line on the note's row; redraw the old and new one
+    auto guideArea = [this]() {
+      if (splitGuideNote == nullptr || splitGuideX < 0)
+        return juce::Rectangle<int>();
+      const float noteY = midiToY(splitGuideNote->getAdjustedMidiNote());
+      return worldToScreen(
+          {splitGuideX - 2.0f, noteY - 1.0f, 4.0f, pixelsPerSemitone + 2.0f});
+    };
+
+    addDamage(guideArea());
     Note *note = noteSplitter->findNoteAt(adjustedX, adjustedY);
     if (note) {
       splitGuideX = adjustedX;
@@ -1137,7 +994,7 @@ void PianoRollComponent::mouseMove(const juce::MouseEvent &e) {
       splitGuideX = -1.0f;
       splitGuideNote = nullptr;
     }
-    repaint();
+    addDamage(guideArea());
   } else if (splitGuideX >= 0) {
     // Clear guide when leaving split mode
     splitGuideX = -1.0f;
@@ -1154,6 +1011,9 @@ void PianoRollComponent::mouseDoubleClick(const juce::MouseEvent &e) {
   if (e.y < timelineHeight || e.x < pianoKeysWidth)
     return;
 
+  if (!editingEnabled)
+    return;
+
   float adjustedX = e.x - pianoKeysWidth + static_cast<float>(scrollX);
   float adjustedY = e.y - timelineHeight + static_cast<float>(scrollY);
 
@@ -1173,34 +1033,36 @@ void PianoRollComponent::mouseDoubleClick(const juce::MouseEvent &e) {
       // Create undo action with callback to rebuild pitch curves
       if (undoManager) {
         auto action = std::make_unique<NoteSnapToSemitoneAction>(
-            note, oldMidi, oldOffset, snappedMidi,
+            project, note, oldMidi, oldOffset, snappedMidi,
             [this](Note* n) {
               // Rebuild pitch curves after undo/redo
-              PitchCurveProcessor::rebuildBaseFromNotes(*project);
-              PitchCurveProcessor::composeF0InPlace(*project, false);
+              const auto rebuilt = PitchCurveProcessor::rebuildBaseForRange(
+                  *project, n->getStartFrame(), n->getEndFrame());
+              invalidateFrameRange(std::min(rebuilt.first, n->getStartFrame()),
+                                   std::max(rebuilt.second, n->getEndFrame()));
+              updateBasePitchCacheRange(n->getStartFrame(), n->getEndFrame());
               if (onPitchEdited) onPitchEdited();
               if (onPitchEditFinished) onPitchEditFinished();
-              repaint();
             });
         undoManager->addAction(std::move(action));
       }
 
       // Apply snap: set midiNote to rounded value, clear offset
-      note->setMidiNote(snappedMidi);
-      note->setPitchOffset(0.0f);
-      note->markDirty();
+      project->setNotePitch(note, snappedMidi, 0.0f);
+      project->markNoteDirty(note);
 
-      // Rebuild pitch curves to reflect the change
-      PitchCurveProcessor::rebuildBaseFromNotes(*project);
-      PitchCurveProcessor::composeF0InPlace(*project, false);
+      // Rebuild pitch curves around the snapped note
+      const auto rebuilt = PitchCurveProcessor::rebuildBaseForRange(
+          *project, note->getStartFrame(), note->getEndFrame());
+      invalidateFrameRange(std::min(rebuilt.first, note->getStartFrame()),
+                           std::max(rebuilt.second, note->getEndFrame()));
+      updateBasePitchCacheRange(note->getStartFrame(), note->getEndFrame());
 
       if (onPitchEdited)
         onPitchEdited();
 
       if (onPitchEditFinished)
         onPitchEditFinished();
-
-      repaint();
     }
   }
 }
@@ -1375,17 +1237,249 @@ void PianoRollComponent::scrollBarMoved(juce::ScrollBar *scrollBar,
 void PianoRollComponent::setProject(Project *proj) {
   project = proj;
 
+  // Redraw just what each edit touched. A project dropped without being
+  // detached may still call in; it is not the one shown, so it is ignored.
+  if (project) {
+    juce::Component::SafePointer<PianoRollComponent> safeThis(this);
+    project->setChangeCallback([safeThis, proj](const ProjectChange &change) {
+      if (safeThis != nullptr && safeThis->project == proj)
+        safeThis->onProjectChanged(change);
+    });
+  }
+
   // Update modular components
   renderer->setProject(proj);
   scrollZoomController->setProject(proj);
   pitchEditor->setProject(proj);
   noteSplitter->setProject(proj);
 
+  noteGlyphs.invalidateAll(); // Glyphs outlive everything but a new waveform
   invalidateBasePitchCache(); // Clear cache when project changes
   updateScrollBars();
   repaint();
 }
 
+std::shared_ptr<PianoRollComponent::LayerSnapshot>
+PianoRollComponent::makeLayerSnapshot(const juce::Rectangle<int> &area,
+                                      bool withNotes) {
+  constexpr int scrollBarSize = 8;
+
+  auto snapshot = std::make_shared<LayerSnapshot>();
+  snapshot->pixelsPerSecond = pixelsPerSecond;
+  snapshot->pixelsPerSemitone = pixelsPerSemitone;
+  snapshot->waveformAreaHeight =
+      static_cast<float>(getHeight() - timelineHeight - scrollBarSize);
+  snapshot->minWidth = getWidth();
+  snapshot->showDeltaPitch = showDeltaPitch;
+  snapshot->showBasePitch = showBasePitch;
+  snapshot->pitchCurves = &pitchCurves;
+  snapshot->pitchCurveVersion = pitchCurves.getVersion();
+  snapshot->noteGlyphs = &noteGlyphs;
+  snapshot->noteGlyphVersion = noteGlyphs.getVersion();
+
+  if (!project)
+    return snapshot;
+
+  // Copy only what the layers draw; waveform and peaks are shared handles
+  snapshot->project = std::make_unique<Project>();
+  const auto &source = std::as_const(*project).getAudioData();
+  auto &target = snapshot->project->getAudioData();
+  target.waveform = source.waveform;
+  target.peaks = source.peaks;
+  target.sampleRate = source.sampleRate;
+
+  if (withNotes) {
+    // Frames the area can reach, with the slack the draw functions cull with
+    const int areaStartFrame = std::max(
+        0, secondsToFrames((area.getX() - 4) / pixelsPerSecond) - 1);
+    const int areaEndFrame =
+        secondsToFrames((area.getRight() + 4) / pixelsPerSecond) + 2;
+
+    // Only the notes there, and the curves under the whole of each, since a
+    // note's curve geometry is built in one go
+    std::vector<Note> notes;
+    int startFrame = areaStartFrame;
+    int endFrame = areaEndFrame;
+    for (const auto *note : std::as_const(*project).getNotesInRange(
+             areaStartFrame, areaEndFrame)) {
+      notes.push_back(*note);
+      startFrame = std::min(startFrame, note->getStartFrame());
+      endFrame = std::max(endFrame, note->getEndFrame());
+    }
+    startFrame = std::max(0, startFrame);
+
+    auto slice = [startFrame, endFrame](const std::vector<float> &curve) {
+      const auto size = static_cast<int>(curve.size());
+      const int first = std::min(startFrame, size);
+      const int last = std::clamp(endFrame, first, size);
+      return std::vector<float>(curve.begin() + first, curve.begin() + last);
+    };
+
+    snapshot->frameOffset = startFrame;
+    snapshot->project->setGlobalPitchOffset(project->getGlobalPitchOffset());
+    snapshot->project->setNotes(std::move(notes));
+    target.f0 = slice(source.f0);
+    target.basePitch = slice(source.basePitch);
+    target.deltaPitch = slice(source.deltaPitch);
+
+    if (showBasePitch) {
+      updateBasePitchCacheIfNeeded();
+      snapshot->basePitch = slice(cachedBasePitch);
+    }
+  }
+
+  return snapshot;
+}
+
+void PianoRollComponent::invalidateRenderCache() {
+  waveformTiles->invalidateAll();
+  contentTiles->invalidateAll();
+  timelineTiles->invalidateAll();
+  pianoKeyTiles->invalidateAll();
+  pitchCurves.invalidateAll();
+
+  // Nothing on screen is known to be current
+  damagedArea.clear();
+  repaint();
+}
+
+void PianoRollComponent::invalidateFrameRange(int startFrame, int endFrame) {
+  // Only the content layer depends on notes and curves
+  contentTiles->invalidateTimeRange(framesToSeconds(startFrame),
+                                    framesToSeconds(endFrame),
+                                    tileInvalidationMargin);
+  pitchCurves.invalidateFrameRange(startFrame, endFrame);
+  addDamage(getChangeArea({startFrame, endFrame, 1.0f, 0.0f}));
+}
+
+void PianoRollComponent::invalidateSampleRange(int startSample,
+                                               int endSample) {
+  const int sampleRate =
+      project ? project->getAudioData().sampleRate : SAMPLE_RATE;
+  const double startSeconds = static_cast<double>(startSample) / sampleRate;
+  const double endSeconds = static_cast<double>(endSample) / sampleRate;
+
+  // The background waveform and the glyphs of notes over these samples
+  waveformTiles->invalidateTimeRange(startSeconds, endSeconds,
+                                     tileInvalidationMargin);
+  contentTiles->invalidateTimeRange(startSeconds, endSeconds,
+                                    tileInvalidationMargin);
+  noteGlyphs.invalidateSampleRange(startSample, endSample);
+
+  // Every pitch over the samples, timeline excluded
+  auto area = getMainArea();
+  const int left = static_cast<int>(
+      std::floor(std::max(static_cast<double>(area.getX()),
+                          pianoKeysWidth - scrollX +
+                              startSeconds * pixelsPerSecond -
+                              tileInvalidationMargin)));
+  const int right = static_cast<int>(
+      std::ceil(std::min(static_cast<double>(area.getRight()),
+                         pianoKeysWidth - scrollX +
+                             endSeconds * pixelsPerSecond +
+                             tileInvalidationMargin)));
+  addDamage(area.withLeft(left).withRight(std::max(left, right)));
+}
+
+void PianoRollComponent::onProjectChanged(const ProjectChange &change) {
+  // A change over every pitch is a curve edit; one bounded in pitch is a note
+  // moving or changing its look, which reuses the note's curve geometry
+  if (change.coversAllPitches()) {
+    invalidateFrameRange(change.startFrame, change.endFrame);
+    return;
+  }
+
+  // Notes and curves live in the content layer only
+  contentTiles->invalidateTimeRange(framesToSeconds(change.startFrame),
+                                    framesToSeconds(change.endFrame),
+                                    tileInvalidationMargin);
+  addDamage(getChangeArea(change));
+}
+
+void PianoRollComponent::addDamage(const juce::Rectangle<int> &area) {
+  if (area.isEmpty())
+    return;
+
+  damagedArea.add(area);
+  if (!deferRepaints)
+    repaintDamage();
+}
+
+void PianoRollComponent::repaintDamage() {
+  for (const auto &area : damagedArea)
+    repaint(area);
+  damagedArea.clear();
+}
+
+void PianoRollComponent::repaintTile(const juce::Rectangle<int> &worldArea,
+                                     int layerScrollY) {
+  // Empty: a tile that only shows scaled, wherever that is
+  if (worldArea.isEmpty()) {
+    repaint();
+    return;
+  }
+
+  addDamage(worldArea
+                .translated(pianoKeysWidth - static_cast<int>(scrollX),
+                            timelineHeight - layerScrollY)
+                .getIntersection(getMainArea()));
+}
+
+juce::Rectangle<int> PianoRollComponent::getMainArea() const {
+  constexpr int scrollBarSize = 8;
+  return getLocalBounds()
+      .withTrimmedLeft(pianoKeysWidth)
+      .withTrimmedTop(timelineHeight)
+      .withTrimmedBottom(scrollBarSize)
+      .withTrimmedRight(scrollBarSize);
+}
+
+juce::Rectangle<int>
+PianoRollComponent::getChangeArea(const ProjectChange &change) const {
+  const double margin = tileInvalidationMargin;
+  const double left = framesToSeconds(change.startFrame) *
+                          static_cast<double>(pixelsPerSecond) -
+                      margin;
+  const double right = framesToSeconds(change.endFrame) *
+                           static_cast<double>(pixelsPerSecond) +
+                       margin;
+
+  const auto mainArea = getMainArea();
+  double top = scrollY - 1.0;
+  double bottom = scrollY + mainArea.getHeight() + 1.0;
+  if (!change.coversAllPitches()) {
+    // Note waveforms reach 1.5 semitones either side of the row centre
+    top = midiToY(change.highMidi) - pixelsPerSemitone - margin;
+    bottom = midiToY(change.lowMidi) + pixelsPerSemitone * 2.0f + margin;
+  }
+
+  // Clamped in world space first: a change may run to the end of time
+  top = std::max(top, scrollY - 1.0);
+  bottom = std::min(bottom, scrollY + mainArea.getHeight() + 1.0);
+  const double clampedLeft = std::max(left, scrollX - 1.0);
+  const double clampedRight =
+      std::min(right, scrollX + mainArea.getWidth() + 1.0);
+  if (clampedLeft >= clampedRight || top >= bottom)
+    return {};
+
+  return worldToScreen({static_cast<float>(clampedLeft),
+                        static_cast<float>(top),
+                        static_cast<float>(clampedRight - clampedLeft),
+                        static_cast<float>(bottom - top)});
+}
+
+juce::Rectangle<int> PianoRollComponent::worldToScreen(
+    const juce::Rectangle<float> &worldArea) const {
+  // Content layer: scrolls both ways; one pixel either side for antialiasing
+  const int originX = pianoKeysWidth - static_cast<int>(scrollX);
+  const int originY = timelineHeight - static_cast<int>(scrollY);
+  return worldArea
+      .translated(static_cast<float>(originX), static_cast<float>(originY))
+      .getSmallestIntegerContainer()
+      .expanded(1)
+      .getIntersection(getMainArea());
+}
+
 void PianoRollComponent::setUndoManager(PitchUndoManager *manager) {
   undoManager = manager;
   pitchEditor->setUndoManager(manager);
@@ -1527,22 +1621,37 @@ void PianoRollComponent::setEditMode(EditMode mode) {
   repaint();
 }
 
+void PianoRollComponent::nudgeSelectedNotes(float semitones) {
+  if (!project || !editingEnabled || isDragging || isDrawing ||
+      boxSelector->isSelecting())
+    return;
+
+  // Same edit as dragging the selection by that much, so it is undone and
+  // resynthesized the same way
+  pitchEditor->nudgeNotes(project->getSelectedNotes(), semitones);
+}
+
 Note *PianoRollComponent::findNoteAt(float x, float y) {
   if (!project)
     return nullptr;
 
-  for (auto &note : project->getNotes()) {
+  // Only notes around the cursor's frame and pitch can contain it; the
+  // slack covers the rounding in secondsToFrames and yToMidi
+  const int frame = secondsToFrames(static_cast<float>(x / pixelsPerSecond));
+  const float midi = yToMidi(y);
+  for (auto *note : project->getNotesInArea(frame - 1, frame + 2, midi - 0.01f,
+                                            midi + 1.01f)) {
     // Skip rest notes
-    if (note.isRest())
+    if (note->isRest())
       continue;
 
-    float noteX = framesToSeconds(note.getStartFrame()) * pixelsPerSecond;
-    float noteW = framesToSeconds(note.getDurationFrames()) * pixelsPerSecond;
-    float noteY = midiToY(note.getAdjustedMidiNote());
+    float noteX = framesToSeconds(note->getStartFrame()) * pixelsPerSecond;
+    float noteW = framesToSeconds(note->getDurationFrames()) * pixelsPerSecond;
+    float noteY = midiToY(note->getAdjustedMidiNote());
     float noteH = pixelsPerSemitone;
 
     if (x >= noteX && x < noteX + noteW && y >= noteY && y < noteY + noteH) {
-      return &note;
+      return note;
     }
   }
 
@@ -1565,6 +1674,53 @@ void PianoRollComponent::updateScrollBars() {
   }
 }
 
+void PianoRollComponent::updateBasePitchCacheRange(int startFrame, int endFrame,
+                                                   bool noteCountChanged) {
+  updateBasePitchCacheRanges({{startFrame, endFrame}}, noteCountChanged);
+}
+
+void PianoRollComponent::updateBasePitchCacheRanges(
+    const std::vector<std::pair<int, int>> &noteRanges,
+    bool noteCountChanged) {
+  // Nothing cached (base pitch hidden): the next draw builds it from scratch
+  if (!project || cachedBasePitch.empty()) {
+    cacheInvalidated = true;
+    return;
+  }
+
+  if (cacheInvalidated ||
+      cachedTotalFrames != static_cast<int>(cachedBasePitch.size())) {
+    invalidateBasePitchCache();
+    return;
+  }
+
+  const size_t noteCount = project->getPitchedNoteCount();
+  if (noteCountChanged)
+    cachedNoteCount = noteCount;
+  else if (noteCount != cachedNoteCount) {
+    invalidateBasePitchCache();
+    return;
+  }
+
+  // The last note sets the curve's length
+  const Note *lastNote = project->getLastNoteStartingBefore(
+      std::numeric_limits<int>::max());
+  while (lastNote != nullptr && lastNote->isRest())
+    lastNote = project->getPreviousNoteByStart(lastNote);
+  if (lastNote == nullptr) {
+    invalidateBasePitchCache();
+    return;
+  }
+
+  // Only the notes around the ranges, from the note index; the display
+  // curve leaves the drag offsets out
+  const auto noteSegments = PitchCurveProcessor::collectSegmentsAround(
+      *project, noteRanges, cachedTotalFrames, false);
+  for (const auto &updated : BasePitchCurve::updateRanges(
+           noteSegments, cachedBasePitch, noteRanges, lastNote->getEndFrame()))
+    invalidateFrameRange(updated.first, updated.second);
+}
+
 void PianoRollComponent::updateBasePitchCacheIfNeeded() {
   if (!project) {
     cachedBasePitch.clear();
@@ -1573,17 +1729,12 @@ void PianoRollComponent::updateBasePitchCacheIfNeeded() {
     return;
   }
 
-  const auto &notes = project->getNotes();
+  const auto &notes = std::as_const(*project).getNotes();
   const auto &audioData = project->getAudioData();
   int totalFrames = static_cast<int>(audioData.f0.size());
 
   // Check if cache is valid
-  size_t currentNoteCount = 0;
-  for (const auto &note : notes) {
-    if (!note.isRest()) {
-      currentNoteCount++;
-    }
-  }
+  const size_t currentNoteCount = project->getPitchedNoteCount();
 
   // Invalidate cache if notes changed or total frames changed or explicitly
   // invalidated For performance, we only check note count and total frames A
@@ -1635,8 +1786,20 @@ void PianoRollComponent::reapplyBasePitchForNote(Note *note) {
   int endFrame = note->getEndFrame();
   int f0Size = static_cast<int>(audioData.f0.size());
 
-  // Reapply base + delta from dense curves
-  for (int i = startFrame; i < endFrame && i < f0Size; ++i) {
+  // Reapply base + delta from dense curves (batch over the frames that have
+  // both curves, per-frame for any short tail)
+  const int begin = std::max(0, startFrame);
+  const int end = std::min(endFrame, f0Size);
+  const int batchEnd =
+      std::max(begin, std::min({end, static_cast<int>(audioData.basePitch.size()),
+                                static_cast<int>(audioData.deltaPitch.size())}));
+  if (batchEnd > begin)
+    PitchMath::composeToFreq(audioData.basePitch.data() + begin,
+                             audioData.deltaPitch.data() + begin, 0.0f, nullptr,
+                             audioData.f0.data() + begin,
+                             static_cast<size_t>(batchEnd - begin));
+
+  for (int i = batchEnd; i < end; ++i) {
     float base = (i < static_cast<int>(audioData.basePitch.size()))
                      ? audioData.basePitch[static_cast<size_t>(i)]
                      : 0.0f;
@@ -1653,6 +1816,7 @@ void PianoRollComponent::reapplyBasePitchForNote(Note *note) {
   project->setF0DirtyRange(smoothStart, smoothEnd);
 
   // Trigger repaint
+  invalidateFrameRange(startFrame, endFrame);
   repaint();
 }
 
@@ -1670,7 +1834,12 @@ void PianoRollComponent::applyPitchDrawing(float x, float y) {
   float midi = yToMidi(y - pixelsPerSemitone * 0.5f);
   int frameIndex = static_cast<int>(secondsToFrames(static_cast<float>(time)));
   int midiCents = static_cast<int>(std::round(midi * 100.0f));
+  const int previousFrame = lastDrawFrame < 0 ? frameIndex : lastDrawFrame;
   applyPitchPoint(frameIndex, midiCents);
+
+  // Frames between the previous point and this one were filled in
+  invalidateFrameRange(std::min(previousFrame, frameIndex),
+                       std::max(previousFrame, frameIndex) + 1);
 }
 
 void PianoRollComponent::commitPitchDrawing() {
@@ -1685,22 +1854,6 @@ void PianoRollComponent::commitPitchDrawing() {
     maxFrame = std::max(maxFrame, e.idx);
   }
 
-  // Clear deltaPitch for notes in the edited range so they use the drawn F0
-  // values
-  if (project && minFrame <= maxFrame) {
-    auto &notes = project->getNotes();
-    for (auto &note : notes) {
-      // Check if note overlaps with edited range
-      if (note.getEndFrame() > minFrame && note.getStartFrame() < maxFrame) {
-        // Clear deltaPitch so the note will use audioData.f0 instead of
-        // computed values
-        if (note.hasDeltaPitch()) {
-          note.setDeltaPitch(std::vector<float>());
-        }
-      }
-    }
-  }
-
   // Set F0 dirty range in project for incremental synthesis
   if (project && minFrame <= maxFrame) {
     project->setF0DirtyRange(minFrame, maxFrame);
@@ -1712,8 +1865,9 @@ void PianoRollComponent::commitPitchDrawing() {
     auto action = std::make_unique<F0EditAction>(
         &audioData.f0, &audioData.deltaPitch, &audioData.voicedMask, drawingEdits,
         [this](int minFrame, int maxFrame) {
-          // Callback to trigger resynthesis after undo/redo
+          // Redraw and resynthesize the restored frames after undo/redo
           if (project) {
+            invalidateFrameRange(minFrame, maxFrame + 1);
             project->setF0DirtyRange(minFrame, maxFrame);
             if (onPitchEditFinished)
               onPitchEditFinished();
@@ -1775,16 +1929,6 @@ void PianoRollComponent::applyPitchPoint(int frameIndex, int midiCents) {
         drawingEditIndexByFrame.emplace(idx, drawingEdits.size());
         drawingEdits.push_back(
             F0FrameEdit{idx, oldF0, newFreq, oldDelta, newDelta, oldVoiced, true});
-        // Clear deltaPitch for any note containing this frame so changes are
-        // visible immediately
-        auto &notes = project->getNotes();
-        for (auto &note : notes) {
-          if (note.getStartFrame() <= idx && note.getEndFrame() > idx &&
-              note.hasDeltaPitch()) {
-            note.setDeltaPitch(std::vector<float>());
-            break;
-          }
-        }
       } else {
         auto &e = drawingEdits[it->second];
         e.newF0 = newFreq;
@@ -1826,17 +1970,6 @@ void PianoRollComponent::applyPitchPoint(int frameIndex, int midiCents) {
     if (it == drawingEditIndexByFrame.end()) {
       drawingEditIndexByFrame.emplace(idx, drawingEdits.size());
       drawingEdits.push_back(F0FrameEdit{idx, oldF0, newFreq, oldDelta, newDelta, oldVoiced, true});
-
-      // Clear deltaPitch for any note containing this frame so changes are
-      // visible immediately
-      auto &notes = project->getNotes();
-      for (auto &note : notes) {
-        if (note.getStartFrame() <= idx && note.getEndFrame() > idx &&
-            note.hasDeltaPitch()) {
-          note.setDeltaPitch(std::vector<float>());
-          break;
-        }
-      }
     } else {
       auto &e = drawingEdits[it->second];
       e.newF0 = newFreq;
@@ -1927,3 +2060,27 @@ void PianoRollComponent::drawSelectionRect(juce::Graphics &g) {
   g.setColour(juce::Colour::fromRGBA(0x30, 0x80, 0xFF, 0xC0));
   g.drawRect(rect, 1.0f);
 }
+
+void PianoRollComponent::drawSplitGuide(juce::Graphics &g) {
+  // Draw split guide line when in split mode and hovering over a note
+  if (editMode == EditMode::Split && splitGuideNote && splitGuideX >= 0) {
+    float noteStartTime = framesToSeconds(splitGuideNote->getStartFrame());
+    float noteEndTime = framesToSeconds(splitGuideNote->getEndFrame());
+    float noteStartX = static_cast<float>(noteStartTime * pixelsPerSecond);
+    float noteEndX = static_cast<float>(noteEndTime * pixelsPerSecond);
+
+    // Only draw if guide is within note bounds (with margin)
+    if (splitGuideX > noteStartX + 5 && splitGuideX < noteEndX - 5) {
+      float noteY = midiToY(splitGuideNote->getAdjustedMidiNote());
+      float noteH = pixelsPerSemitone;
+
+      // Draw dashed vertical line
+      g.setColour(juce::Colour(0xFFFF6B6B));  // Red-ish color for visibility
+      float dashLength = 4.0f;
+      for (float dy = 0; dy < noteH; dy += dashLength * 2) {
+        float segmentLength = std::min(dashLength, noteH - dy);
+        g.drawLine(splitGuideX, noteY + dy, splitGuideX, noteY + dy + segmentLength, 2.0f);
+      }
+    }
+  }
+}
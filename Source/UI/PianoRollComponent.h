@@ -11,6 +11,9 @@
 #include "PianoRoll/PitchEditor.h"
 #include "PianoRoll/BoxSelector.h"
 #include "PianoRoll/NoteSplitter.h"
+#include "PianoRoll/NoteGlyphCache.h"
+#include "PianoRoll/PitchCurveCache.h"
+#include "PianoRoll/TileCache.h"
 
 #include <deque>
 #include <memory>
@@ -78,32 +81,92 @@ public:
     void setEditMode(EditMode mode);
     EditMode getEditMode() const { return editMode; }
 
+    // Move the selected notes by whole semitones, e.g. from the arrow keys
+    void nudgeSelectedNotes(float semitones);
+
+    // While disabled the view still scrolls, zooms and seeks, but notes and
+    // pitch cannot be edited (e.g. a host take that will replace the project)
+    void setEditingEnabled(bool enabled) { editingEnabled = enabled; }
+    bool isEditingEnabled() const { return editingEnabled; }
+
     // View settings
-    void setShowDeltaPitch(bool show) { showDeltaPitch = show; repaint(); }
-    void setShowBasePitch(bool show) { showBasePitch = show; repaint(); }
+    void setShowDeltaPitch(bool show) { showDeltaPitch = show; invalidateRenderCache(); repaint(); }
+    void setShowBasePitch(bool show) { showBasePitch = show; invalidateRenderCache(); repaint(); }
     bool getShowDeltaPitch() const { return showDeltaPitch; }
     bool getShowBasePitch() const { return showBasePitch; }
     
     // Callbacks
     std::function<void(Note*)> onNoteSelected;
+    std::function<void()> onSelectionChanged;  // By click or box selection
     std::function<void()> onPitchEdited;
     std::function<void()> onPitchEditFinished;  // Called when dragging ends
     std::function<void(double)> onSeek;
     std::function<void(float)> onZoomChanged;
     std::function<void(double)> onScrollChanged;
     std::function<void(int, int)> onReinterpolateUV;  // Called to re-infer UV regions (startFrame, endFrame)
+
+    // Render cache. Anything that changes notes, curves or the waveform
+    // without going through this component must invalidate before repainting.
+    // Waveform glyphs inside notes are dropped only by invalidateSampleRange()
+    // (and a new project), never by the other two.
+    void invalidateRenderCache();
+    void invalidateFrameRange(int startFrame, int endFrame);
+    void invalidateSampleRange(int startSample, int endSample);
     
 private:
-    void drawBackgroundWaveform(juce::Graphics& g, const juce::Rectangle<int>& visibleArea);
-    void drawGrid(juce::Graphics& g);
-    void drawTimeline(juce::Graphics& g);
-    void drawNotes(juce::Graphics& g);
-    void drawPitchCurves(juce::Graphics& g);
+    // What the layers rendered on a worker draw from: copied on the message
+    // thread by makeLayerSnapshot(), then read by that layer's worker only.
+    // Each draw function paints the world rectangle area, which must lie
+    // inside the one the snapshot was made for.
+    struct LayerSnapshot {
+        std::unique_ptr<Project> project;  // Partial copy; audio is shared copy-on-write
+        int frameOffset = 0;               // Frame at index 0 of the copied curves
+        float pixelsPerSecond = DEFAULT_PIXELS_PER_SECOND;
+        float pixelsPerSemitone = DEFAULT_PIXELS_PER_SEMITONE;
+        float waveformAreaHeight = 0.0f;
+        int minWidth = 0;  // The grid spans at least this
+        bool showDeltaPitch = true;
+        bool showBasePitch = false;
+        std::vector<float> basePitch;            // Dashed display curve, from frameOffset
+        PitchCurveCache* pitchCurves = nullptr;  // The component's, used by the content worker only
+        juce::uint32 pitchCurveVersion = 0;
+        NoteGlyphCache* noteGlyphs = nullptr;  // Likewise
+        juce::uint32 noteGlyphVersion = 0;
+
+        void drawBackgroundWaveform(juce::Graphics& g, const juce::Rectangle<int>& area);
+        void drawContent(juce::Graphics& g, const juce::Rectangle<int>& area);  // Grid, notes, pitch curves
+        void drawGrid(juce::Graphics& g, const juce::Rectangle<int>& area);
+        void drawNotes(juce::Graphics& g, const juce::Rectangle<int>& area);
+        void drawPitchCurves(juce::Graphics& g, const juce::Rectangle<int>& area);
+        float midiToY(float midiNote) const;
+    };
+
+    // Notes and curves are copied only for the frames area (world) reaches
+    std::shared_ptr<LayerSnapshot> makeLayerSnapshot(const juce::Rectangle<int>& area,
+                                                     bool withNotes);
+
+    // Static layers drawn on the message thread; cheap, and also cached in tiles
+    void drawTimeline(juce::Graphics& g, const juce::Rectangle<int>& area);
+    void drawPianoKeys(juce::Graphics& g, const juce::Rectangle<int>& area);
+
+    // Overlays, drawn over the tiles on every paint
     void drawCursor(juce::Graphics& g);
-    void drawPianoKeys(juce::Graphics& g);
     void drawDrawingCursor(juce::Graphics& g);  // Draw mode indicator
+    void drawSplitGuide(juce::Graphics& g);     // Split mode guide line
     void drawSelectionRect(juce::Graphics& g);  // Box selection rectangle
 
+    // Damage: screen areas whose content changed, repainted on their own
+    // rather than the whole component. Project change notifications, the
+    // component's own invalidations and finished tiles add to it; it is
+    // repainted at once except while a throttled drag gathers it.
+    void onProjectChanged(const ProjectChange& change);
+    void addDamage(const juce::Rectangle<int>& area);
+    void repaintDamage();
+    void repaintTile(const juce::Rectangle<int>& worldArea, int layerScrollY);
+    juce::Rectangle<int> getMainArea() const;
+    juce::Rectangle<int> getChangeArea(const ProjectChange& change) const;
+    juce::Rectangle<int> worldToScreen(const juce::Rectangle<float>& worldArea) const;
+
     float midiToY(float midiNote) const;
     float yToMidi(float y) const;
     float timeToX(double time) const;
@@ -145,6 +208,7 @@ private:
     
     // Edit mode
     EditMode editMode = EditMode::Select;
+    bool editingEnabled = true;
 
     // View settings
     bool showDeltaPitch = true;
@@ -177,12 +241,22 @@ private:
     juce::ScrollBar horizontalScrollBar { false };
     juce::ScrollBar verticalScrollBar { true };
 
-    // Waveform cache for performance
-    juce::Image waveformCache;
-    double cachedScrollX = -1.0;
-    float cachedPixelsPerSecond = -1.0f;
-    int cachedWidth = 0;
-    int cachedHeight = 0;
+    // Decimated per-note pitch curve geometry, reused by every tile a note
+    // crosses. Declared before the tile caches so their workers stop first.
+    PitchCurveCache pitchCurves;
+
+    // Waveform shapes inside notes, kept until synthesis rewrites their samples
+    NoteGlyphCache noteGlyphs;
+
+    // Static layers cached as world-space tiles, so scrolling only renders
+    // what comes into view. Waveform and content render on worker threads.
+    std::unique_ptr<TileCache> waveformTiles;
+    std::unique_ptr<TileCache> contentTiles;
+    std::unique_ptr<TileCache> timelineTiles;
+    std::unique_ptr<TileCache> pianoKeyTiles;
+
+    // Strokes and spline overshoot reach this far past their frames
+    static constexpr float tileInvalidationMargin = 4.0f;
 
     // Base pitch curve cache for performance
     // Only recalculates when notes change, not on every repaint
@@ -192,7 +266,13 @@ private:
     bool cacheInvalidated = true;  // Start invalidated, force first calculation
 
 public:
-    void invalidateBasePitchCache() { cacheInvalidated = true; cachedNoteCount = 0; cachedBasePitch.clear(); }
+    void invalidateBasePitchCache() { cacheInvalidated = true; cachedNoteCount = 0; cachedBasePitch.clear(); invalidateRenderCache(); }
+    // Regenerate the cached base pitch only around notes in [startFrame, endFrame);
+    // noteCountChanged when notes were added or removed there (a split)
+    void updateBasePitchCacheRange(int startFrame, int endFrame, bool noteCountChanged = false);
+    // The same for several ranges at once, e.g. the notes of a multi-note drag
+    void updateBasePitchCacheRanges(const std::vector<std::pair<int, int>>& noteRanges,
+                                    bool noteCountChanged = false);
 
 private:
     // Optional: disable base pitch rendering for performance testing
@@ -201,6 +281,10 @@ private:
     // Mouse drag throttling
     juce::int64 lastDragRepaintTime = 0;
     static constexpr juce::int64 minDragRepaintInterval = 16;  // ~60fps max
+
+    juce::RectangleList<int> damagedArea;
+    bool deferRepaints = false;  // Set while a drag step gathers damage
+    ProjectChange dragBounds;    // Single-dragged note at originalPitchOffset
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PianoRollComponent)
 };
@@ -71,6 +71,19 @@ SettingsComponent::SettingsComponent(juce::AudioDeviceManager* audioDeviceManage
     pitchDetectorComboBox.addListener(this);
     addAndMakeVisible(pitchDetectorComboBox);
 
+    // Pre-rendering of likely edits (CPU budget)
+    preRenderLabel.setText(TR("settings.pre_render"), juce::dontSendNotification);
+    preRenderLabel.setColour(juce::Label::textColourId, juce::Colours::white);
+    addAndMakeVisible(preRenderLabel);
+
+    preRenderComboBox.addItem(TR("settings.pre_render_off"), 1);
+    preRenderComboBox.addItem("25%", 2);
+    preRenderComboBox.addItem("50%", 3);
+    preRenderComboBox.addItem("100%", 4);
+    preRenderComboBox.setSelectedId(2, juce::dontSendNotification);
+    preRenderComboBox.addListener(this);
+    addAndMakeVisible(preRenderComboBox);
+
     // Info label
     infoLabel.setColour(juce::Label::textColourId, juce::Colour(0xFF888888));
     infoLabel.setFont(juce::Font(12.0f));
@@ -130,9 +143,9 @@ SettingsComponent::SettingsComponent(juce::AudioDeviceManager* audioDeviceManage
 
     // Set size based on mode
     if (pluginMode)
-        setSize(400, 260);
+        setSize(400, 300);
     else
-        setSize(400, 560);
+        setSize(400, 600);
 }
 
 SettingsComponent::~SettingsComponent()
@@ -178,6 +191,12 @@ void SettingsComponent::resized()
     pitchDetectorComboBox.setBounds(pitchDetectorRow.reduced(0, 2));
     bounds.removeFromTop(10);
 
+    // Pre-render row
+    auto preRenderRow = bounds.removeFromTop(30);
+    preRenderLabel.setBounds(preRenderRow.removeFromLeft(120));
+    preRenderComboBox.setBounds(preRenderRow.reduced(0, 2));
+    bounds.removeFromTop(10);
+
     bounds.removeFromTop(5);
 
     // Info label
@@ -302,6 +321,18 @@ void SettingsComponent::comboBoxChanged(juce::ComboBox* comboBox)
         if (onPitchDetectorChanged)
             onPitchDetectorChanged(pitchDetectorType);
     }
+    else if (comboBox == &preRenderComboBox)
+    {
+        static constexpr int budgets[] = { 0, 25, 50, 100 };
+        int selectedId = preRenderComboBox.getSelectedId();
+        if (selectedId >= 1 && selectedId <= 4)
+            preRenderBudget = budgets[selectedId - 1];
+
+        saveSettings();
+
+        if (onPreRenderBudgetChanged)
+            onPreRenderBudgetChanged(preRenderBudget);
+    }
     else if (comboBox == &audioDeviceTypeComboBox)
     {
         auto& types = deviceManager->getAvailableDeviceTypes();
@@ -636,6 +667,9 @@ void SettingsComponent::loadSettings()
             juce::String pitchDetectorStr = xml->getStringAttribute("pitchDetector", "RMVPE");
             pitchDetectorType = stringToPitchDetectorType(pitchDetectorStr);
 
+            outOfCoreThresholdMB = xml->getIntAttribute("outOfCoreThresholdMB", outOfCoreThresholdMB);
+            preRenderBudget = xml->getIntAttribute("preRenderBudget", preRenderBudget);
+
             // Load language
             juce::String langCode = xml->getStringAttribute("language", "auto");
             if (langCode == "auto")
@@ -693,6 +727,16 @@ void SettingsComponent::loadSettings()
         pitchDetectorComboBox.setSelectedId(1, juce::dontSendNotification);
     else if (pitchDetectorType == PitchDetectorType::FCPE)
         pitchDetectorComboBox.setSelectedId(2, juce::dontSendNotification);
+
+    // Update pre-render combo box to the nearest budget offered
+    if (preRenderBudget <= 0)
+        preRenderComboBox.setSelectedId(1, juce::dontSendNotification);
+    else if (preRenderBudget <= 25)
+        preRenderComboBox.setSelectedId(2, juce::dontSendNotification);
+    else if (preRenderBudget <= 50)
+        preRenderComboBox.setSelectedId(3, juce::dontSendNotification);
+    else
+        preRenderComboBox.setSelectedId(4, juce::dontSendNotification);
 }
 
 void SettingsComponent::saveSettings()
@@ -711,6 +755,8 @@ void SettingsComponent::saveSettings()
     xml.setAttribute("device", currentDevice);
     xml.setAttribute("gpuDeviceId", gpuDeviceId);
     xml.setAttribute("pitchDetector", pitchDetectorTypeToString(pitchDetectorType));
+    xml.setAttribute("outOfCoreThresholdMB", outOfCoreThresholdMB);
+    xml.setAttribute("preRenderBudget", preRenderBudget);
 
     // Save language code
     int langId = languageComboBox.getSelectedId();
@@ -877,9 +923,9 @@ SettingsDialog::SettingsDialog(juce::AudioDeviceManager* audioDeviceManager)
     setResizable(false, false);
 
     if (audioDeviceManager != nullptr)
-        centreWithSize(400, 560);
+        centreWithSize(400, 600);
     else
-        centreWithSize(400, 260);
+        centreWithSize(400, 300);
 }
 
 void SettingsDialog::closeButtonPressed()
@@ -29,6 +29,7 @@ public:
     juce::String getSelectedDevice() const { return currentDevice; }
     int getGPUDeviceId() const { return gpuDeviceId; }
     PitchDetectorType getPitchDetectorType() const { return pitchDetectorType; }
+    int getPreRenderBudget() const { return preRenderBudget; }
 
     // Plugin mode (disables audio device settings)
     bool isPluginMode() const { return pluginMode; }
@@ -37,6 +38,7 @@ public:
     std::function<void()> onSettingsChanged;
     std::function<void()> onLanguageChanged;
     std::function<void(PitchDetectorType)> onPitchDetectorChanged;
+    std::function<void(int)> onPreRenderBudgetChanged;  // Percent, 0 = off
 
     // Load/save settings
     void loadSettings();
@@ -70,6 +72,9 @@ private:
     juce::Label pitchDetectorLabel;
     StyledComboBox pitchDetectorComboBox;
 
+    juce::Label preRenderLabel;
+    StyledComboBox preRenderComboBox;
+
     juce::Label infoLabel;
 
     // Audio device settings (standalone mode only)
@@ -88,6 +93,8 @@ private:
     juce::String currentDevice = "CPU";
     int gpuDeviceId = 0;
     PitchDetectorType pitchDetectorType = PitchDetectorType::RMVPE;
+    int outOfCoreThresholdMB = 128;  // No UI; kept so saving does not drop it
+    int preRenderBudget = 25;        // Percent of the time spent pre-rendering likely edits
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SettingsComponent)
 };
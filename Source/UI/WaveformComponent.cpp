@@ -35,15 +35,16 @@ void WaveformComponent::drawWaveform(juce::Graphics& g)
 {
     if (!project) return;
     
-    const auto& audioData = project->getAudioData();
-    if (audioData.waveform.getNumSamples() == 0) return;
+    auto& audioData = project->getAudioData();
+    if (audioData.waveform->getNumSamples() == 0) return;
     
     auto bounds = getLocalBounds().withTrimmedBottom(14);
     float centerY = static_cast<float>(bounds.getCentreY());
     float amplitude = bounds.getHeight() * 0.4f;
     
-    const float* samples = audioData.waveform.getReadPointer(0);
-    int numSamples = audioData.waveform.getNumSamples();
+    const auto& waveform = *audioData.waveform;
+    const auto& peaks = audioData.getPeaks();
+    int numSamples = waveform.getNumSamples();
     
     // Calculate visible range
     double startTime = xToTime(static_cast<float>(scrollX));
@@ -70,14 +71,10 @@ void WaveformComponent::drawWaveform(juce::Graphics& g)
         
         if (sampleStart >= numSamples || sampleEnd < 0) continue;
         
-        // Find min/max in this range
-        float minVal = 0.0f, maxVal = 0.0f;
-        for (int i = sampleStart; i <= sampleEnd; ++i)
-        {
-            float s = samples[i];
-            if (s < minVal) minVal = s;
-            if (s > maxVal) maxVal = s;
-        }
+        // Min/max in this range, from the peak pyramid
+        const auto peak = peaks.getPeak(waveform, sampleStart, sampleEnd + 1);
+        float minVal = juce::jmin(0.0f, peak.min);
+        float maxVal = juce::jmax(0.0f, peak.max);
         
         float yMin = centerY - maxVal * amplitude;
         float yMax = centerY - minVal * amplitude;
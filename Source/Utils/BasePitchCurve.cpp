@@ -1,21 +1,11 @@
 #include "BasePitchCurve.h"
+#include "PitchMath.h"
 #include <algorithm>
 
 // Local constants (to avoid JUCE dependency from Constants.h)
 namespace {
     constexpr int SAMPLE_RATE = 44100;
     constexpr int HOP_SIZE = 512;
-    constexpr int MIDI_A4 = 69;
-    constexpr float FREQ_A4 = 440.0f;
-
-    inline float midiToFreq(float midi) {
-        return FREQ_A4 * std::pow(2.0f, (midi - MIDI_A4) / 12.0f);
-    }
-
-    inline float freqToMidi(float freq) {
-        if (freq <= 0.0f) return 0.0f;
-        return 12.0f * std::log2(freq / FREQ_A4) + MIDI_A4;
-    }
 }
 
 std::vector<double> BasePitchCurve::createCosineKernel()
@@ -43,111 +33,269 @@ std::vector<float> BasePitchCurve::generateForNote(int startFrame, int endFrame,
     return generateForNotes(notes, totalFrames);
 }
 
-std::vector<float> BasePitchCurve::generateForNotes(const std::vector<NoteSegment>& notes, int totalFrames)
+const std::vector<double>& BasePitchCurve::getCosineKernel()
 {
-    if (notes.empty() || totalFrames <= 0)
-        return {};
-
-    // Convert frames to milliseconds (at ~86 fps, each frame is ~11.6ms)
-    // We'll work at 1ms resolution for smoothing, then resample
-    double msPerFrame = 1000.0 * HOP_SIZE / SAMPLE_RATE;  // ~11.6ms
+    static const std::vector<double> kernel = createCosineKernel();
+    return kernel;
+}
 
-    // Calculate total duration in seconds, add padding for convolution kernel
-    double lastNoteEndSec = notes.back().endFrame * msPerFrame / 1000.0;
-    int totalMs = static_cast<int>(std::round(1000.0 * (lastNoteEndSec + SMOOTH_WINDOW))) + 1;
+std::vector<BasePitchCurve::NoteInSeconds> BasePitchCurve::toSeconds(const std::vector<NoteSegment>& notes)
+{
+    const double msPerFrame = 1000.0 * HOP_SIZE / SAMPLE_RATE;
 
-    // Create initial step function values at 1ms resolution
-    // This matches ds-editor-lite's BasePitchCurve::Convolve algorithm
-    std::vector<double> initValues(totalMs, 0.0);
-    
     // Convert note segments from frames to seconds for step function
-    struct NoteInSeconds {
-        double start;
-        double end;
-        float midiNote;
-    };
     std::vector<NoteInSeconds> noteArray;
+    noteArray.reserve(notes.size());
     for (const auto& note : notes)
     {
         double startSec = note.startFrame * msPerFrame / 1000.0;
         double endSec = note.endFrame * msPerFrame / 1000.0;
         noteArray.push_back({startSec, endSec, note.midiNote});
     }
-    
-    if (noteArray.empty())
-        return {};
-    
+    return noteArray;
+}
+
+int BasePitchCurve::getTotalMs(int lastEndFrame)
+{
+    // Calculate total duration in seconds, add padding for convolution kernel
+    const double msPerFrame = 1000.0 * HOP_SIZE / SAMPLE_RATE;
+    double lastNoteEndSec = lastEndFrame * msPerFrame / 1000.0;
+    return static_cast<int>(std::round(1000.0 * (lastNoteEndSec + SMOOTH_WINDOW))) + 1;
+}
+
+std::vector<double> BasePitchCurve::smoothRange(const std::vector<NoteInSeconds>& noteArray,
+                                                int totalMs, int msBegin, int msEnd)
+{
+    const int halfKernel = KERNEL_SIZE / 2;
+    const int stepBegin = std::max(0, msBegin - halfKernel);
+    const int stepEnd = std::min(totalMs, msEnd + halfKernel);
+    const int numNotes = static_cast<int>(noteArray.size());
+
     // Create step function: each millisecond gets the semitone value of its note
-    // At note boundaries, switch at the midpoint (matching ds-editor-lite)
+    // At note boundaries, switch at the midpoint (matching ds-editor-lite).
+    // The note index at stepBegin is the number of midpoints already passed,
+    // which is what a scan from 0 would reach (the index advances at most
+    // once per millisecond, and midpoints are at least a frame apart).
+    auto midpoint = [&](int k) { return 0.5 * (noteArray[k].end + noteArray[k + 1].start); };
+
     int noteIndex = 0;
-    for (int i = 0; i < totalMs; ++i)
+    if (stepBegin > 0)
+    {
+        const double prevTime = 0.001 * (stepBegin - 1);
+        int lo = 0;
+        int hi = numNotes - 1;
+        while (lo < hi)
+        {
+            int mid = (lo + hi) / 2;
+            if (prevTime > midpoint(mid))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        noteIndex = lo;
+    }
+
+    std::vector<double> initValues(static_cast<size_t>(stepEnd - stepBegin), 0.0);
+    for (int i = stepBegin; i < stepEnd; ++i)
     {
         const double time = 0.001 * i;  // Time in seconds
-        
+
         // Assign current note's semitone value
-        initValues[i] = noteArray[noteIndex].midiNote;
-        
+        initValues[static_cast<size_t>(i - stepBegin)] = noteArray[noteIndex].midiNote;
+
         // Check if we should advance to next note at midpoint
         // Switch at: 0.5 * (current_note_end + next_note_start)
-        if (noteIndex < static_cast<int>(noteArray.size()) - 1 &&
-            time > 0.5 * (noteArray[noteIndex].end + noteArray[noteIndex + 1].start))
-        {
+        if (noteIndex < numNotes - 1 && time > midpoint(noteIndex))
             noteIndex++;
-        }
     }
 
-    // Apply cosine kernel convolution
-    auto kernel = createCosineKernel();
-    std::vector<double> smoothedMs(totalMs, 0.0);
+    // Apply cosine kernel convolution; edges clamp to the full curve's ends
+    const auto& kernel = getCosineKernel();
+    std::vector<double> smoothedMs(static_cast<size_t>(msEnd - msBegin), 0.0);
 
-    for (int i = 0; i < totalMs; ++i)
+    for (int i = msBegin; i < msEnd; ++i)
     {
+        double& out = smoothedMs[static_cast<size_t>(i - msBegin)];
         for (int j = 0; j < KERNEL_SIZE; ++j)
         {
-            int srcIdx = std::clamp(i - KERNEL_SIZE / 2 + j, 0, totalMs - 1);
-            smoothedMs[i] += initValues[srcIdx] * kernel[j];
+            int srcIdx = std::clamp(i - halfKernel + j, 0, totalMs - 1);
+            out += initValues[static_cast<size_t>(srcIdx - stepBegin)] * kernel[j];
         }
     }
 
+    return smoothedMs;
+}
+
+void BasePitchCurve::resampleToFrames(const std::vector<double>& smoothedMs, int msOffset, int totalMs,
+                                      float* out, int frameBegin, int frameEnd)
+{
+    const double msPerFrame = 1000.0 * HOP_SIZE / SAMPLE_RATE;
+    const int msLimit = msOffset + static_cast<int>(smoothedMs.size());
+
     // Resample back to frame resolution
-    std::vector<float> result(totalFrames);
-    for (int frame = 0; frame < totalFrames; ++frame)
+    for (int frame = frameBegin; frame < frameEnd; ++frame)
     {
         double ms = frame * msPerFrame;
         int msIdx = static_cast<int>(ms);
         double frac = ms - msIdx;
 
+        float value;
         if (msIdx + 1 < totalMs)
-            result[frame] = static_cast<float>(smoothedMs[msIdx] * (1.0 - frac) + smoothedMs[msIdx + 1] * frac);
+            value = static_cast<float>(smoothedMs[msIdx - msOffset] * (1.0 - frac) + smoothedMs[msIdx + 1 - msOffset] * frac);
         else if (msIdx < totalMs)
-            result[frame] = static_cast<float>(smoothedMs[msIdx]);
+            value = static_cast<float>(smoothedMs[msIdx - msOffset]);
         else
-            result[frame] = static_cast<float>(smoothedMs.back());
+            value = static_cast<float>(smoothedMs[msLimit - 1 - msOffset]);
+
+        out[frame - frameBegin] = value;
     }
+}
+
+std::vector<float> BasePitchCurve::generateForNotes(const std::vector<NoteSegment>& notes, int totalFrames)
+{
+    if (notes.empty() || totalFrames <= 0)
+        return {};
+
+    // Convert frames to milliseconds (at ~86 fps, each frame is ~11.6ms)
+    // We'll work at 1ms resolution for smoothing, then resample.
+    // This matches ds-editor-lite's BasePitchCurve::Convolve algorithm
+    const int totalMs = getTotalMs(notes.back().endFrame);
+    const auto noteArray = toSeconds(notes);
+
+    auto smoothedMs = smoothRange(noteArray, totalMs, 0, totalMs);
 
+    std::vector<float> result(totalFrames);
+    resampleToFrames(smoothedMs, 0, totalMs, result.data(), 0, totalFrames);
     return result;
 }
 
+std::pair<int, int> BasePitchCurve::getAffectedFrames(const std::vector<NoteSegment>& notes, int totalFrames,
+                                                      int startFrame, int endFrame)
+{
+    // The step function only changes between the midpoints around the edited
+    // notes, which lie inside the gaps to the neighbouring notes. Notes are
+    // sorted by start, so the next note is found by binary search; walking
+    // back stops at the first earlier note that ends before the range, which
+    // may end earlier than another one further back and so errs wide.
+    auto next = std::lower_bound(notes.begin(), notes.end(), endFrame,
+                                 [](const NoteSegment& note, int frame) { return note.startFrame < frame; });
+    const int spanEnd = next != notes.end() ? next->startFrame : totalFrames;
+
+    int spanStart = 0;
+    auto previous = std::lower_bound(notes.begin(), notes.end(), startFrame,
+                                     [](const NoteSegment& note, int frame) { return note.startFrame < frame; });
+    while (previous != notes.begin())
+    {
+        --previous;
+        if (previous->endFrame <= startFrame)
+        {
+            spanStart = previous->endFrame;
+            break;
+        }
+    }
+
+    // Widen by the kernel half-width
+    const int marginFrames = getReachFrames();
+    const int frameBegin = std::clamp(std::min(spanStart, startFrame) - marginFrames, 0, totalFrames);
+    const int frameEnd = std::clamp(std::max(spanEnd, endFrame) + marginFrames, 0, totalFrames);
+    return {frameBegin, std::max(frameBegin, frameEnd)};
+}
+
+int BasePitchCurve::getReachFrames()
+{
+    const double msPerFrame = 1000.0 * HOP_SIZE / SAMPLE_RATE;
+    return static_cast<int>(std::ceil((KERNEL_SIZE / 2) / msPerFrame)) + 1;
+}
+
+std::pair<int, int> BasePitchCurve::updateRange(const std::vector<NoteSegment>& notes,
+                                                std::vector<float>& basePitch,
+                                                int startFrame, int endFrame)
+{
+    const int totalFrames = static_cast<int>(basePitch.size());
+    if (notes.empty() || totalFrames <= 0)
+        return {0, 0};
+
+    const auto rewritten = updateRanges(notes, basePitch, {{startFrame, endFrame}});
+    if (rewritten.empty())
+    {
+        const int frame = std::clamp(startFrame, 0, totalFrames);
+        return {frame, frame};
+    }
+    return {rewritten.front().first, rewritten.back().second};
+}
+
+std::vector<std::pair<int, int>> BasePitchCurve::updateRanges(const std::vector<NoteSegment>& notes,
+                                                              std::vector<float>& basePitch,
+                                                              std::vector<std::pair<int, int>> ranges)
+{
+    if (notes.empty())
+        return {};
+    return updateRanges(notes, basePitch, std::move(ranges), notes.back().endFrame);
+}
+
+std::vector<std::pair<int, int>> BasePitchCurve::updateRanges(const std::vector<NoteSegment>& notes,
+                                                              std::vector<float>& basePitch,
+                                                              std::vector<std::pair<int, int>> ranges,
+                                                              int lastEndFrame)
+{
+    const int totalFrames = static_cast<int>(basePitch.size());
+    if (notes.empty() || totalFrames <= 0)
+        return {};
+
+    // Frames to regenerate, merged where the widened ranges meet
+    std::vector<std::pair<int, int>> windows;
+    windows.reserve(ranges.size());
+    for (const auto& range : ranges)
+    {
+        const auto window = getAffectedFrames(notes, totalFrames, range.first, range.second);
+        if (window.first < window.second)
+            windows.push_back(window);
+    }
+    std::sort(windows.begin(), windows.end());
+
+    std::vector<std::pair<int, int>> merged;
+    for (const auto& window : windows)
+    {
+        if (!merged.empty() && window.first <= merged.back().second)
+            merged.back().second = std::max(merged.back().second, window.second);
+        else
+            merged.push_back(window);
+    }
+    if (merged.empty())
+        return {};
+
+    const double msPerFrame = 1000.0 * HOP_SIZE / SAMPLE_RATE;
+    const int totalMs = getTotalMs(lastEndFrame);
+    const auto noteArray = toSeconds(notes);
+
+    for (const auto& [frameBegin, frameEnd] : merged)
+    {
+        // 1ms samples needed to interpolate frames [frameBegin, frameEnd)
+        const int msBegin = std::min(static_cast<int>(frameBegin * msPerFrame), totalMs - 1);
+        const int msEnd = std::clamp(static_cast<int>((frameEnd - 1) * msPerFrame) + 2, msBegin + 1, totalMs);
+
+        auto smoothedMs = smoothRange(noteArray, totalMs, msBegin, msEnd);
+        resampleToFrames(smoothedMs, msBegin, totalMs, basePitch.data() + frameBegin, frameBegin, frameEnd);
+    }
+
+    return merged;
+}
+
 std::vector<float> BasePitchCurve::calculateDeltaPitch(const std::vector<float>& f0Values,
                                                         const std::vector<float>& basePitch,
                                                         int startFrame)
 {
     std::vector<float> deltaPitch(f0Values.size(), 0.0f);
 
-    for (size_t i = 0; i < f0Values.size(); ++i)
+    // Only frames that map inside basePitch get a delta; the rest stay 0
+    const int size = static_cast<int>(f0Values.size());
+    const int first = std::clamp(-startFrame, 0, size);
+    const int last = std::clamp(static_cast<int>(basePitch.size()) - startFrame, first, size);
+    if (first < last)
     {
-        int globalFrame = startFrame + static_cast<int>(i);
-        if (globalFrame < 0 || globalFrame >= static_cast<int>(basePitch.size()))
-            continue;
-
-        float f0 = f0Values[i];
-        if (f0 > 0.0f)
-        {
-            // Convert F0 to MIDI
-            float f0Midi = freqToMidi(f0);
-            // Delta = actual - base
-            deltaPitch[i] = f0Midi - basePitch[globalFrame];
-        }
+        // Delta = actual MIDI - base, 0 for unvoiced frames
+        PitchMath::freqToDelta(f0Values.data() + first, basePitch.data() + startFrame + first,
+                               deltaPitch.data() + first, static_cast<size_t>(last - first));
     }
 
     return deltaPitch;
@@ -159,13 +307,10 @@ std::vector<float> BasePitchCurve::applyBasePitchChange(const std::vector<float>
 {
     std::vector<float> newF0(numFrames, 0.0f);
 
-    for (int i = 0; i < numFrames && i < static_cast<int>(deltaPitch.size()); ++i)
-    {
-        // New MIDI = new base + delta
-        float newMidi = newBaseMidi + deltaPitch[i];
-        // Convert back to Hz
-        newF0[i] = midiToFreq(newMidi);
-    }
+    // New MIDI = new base + delta, converted back to Hz
+    const int count = std::min(numFrames, static_cast<int>(deltaPitch.size()));
+    if (count > 0)
+        PitchMath::midiToFreq(deltaPitch.data(), newF0.data(), static_cast<size_t>(count), newBaseMidi);
 
     return newF0;
 }
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cmath>
+#include <utility>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -35,6 +36,38 @@ public:
     // Generate smoothed base pitch for multiple notes
     static std::vector<float> generateForNotes(const std::vector<NoteSegment>& notes, int totalFrames);
 
+    // Regenerate basePitch in place after notes overlapping [startFrame, endFrame)
+    // changed. The span is widened to the neighbouring notes and the kernel
+    // half-width, so the cost follows the edited notes rather than the project.
+    // Notes must be sorted by start frame. Returns the frame range rewritten.
+    static std::pair<int, int> updateRange(const std::vector<NoteSegment>& notes,
+                                           std::vector<float>& basePitch,
+                                           int startFrame, int endFrame);
+
+    // updateRange for several edited ranges at once, e.g. every note of a
+    // multi-note drag. Widened ranges that overlap are regenerated together,
+    // so no frame is smoothed twice. Returns the frame ranges rewritten,
+    // sorted and disjoint.
+    static std::vector<std::pair<int, int>> updateRanges(const std::vector<NoteSegment>& notes,
+                                                         std::vector<float>& basePitch,
+                                                         std::vector<std::pair<int, int>> ranges);
+
+    // updateRanges reading only a run of the notes. notes must hold, in start
+    // order, every note from the last one ending before each range (or the
+    // first note) to the first one starting after it, plus the nearest note
+    // more than 2 * getReachFrames() beyond those on either side.
+    // lastEndFrame is the end of the last of all the notes, which sets the
+    // curve's length. For notes that do not overlap (which the midpoint search
+    // in the step function assumes anyway) the result matches a call with
+    // every note.
+    static std::vector<std::pair<int, int>> updateRanges(const std::vector<NoteSegment>& notes,
+                                                         std::vector<float>& basePitch,
+                                                         std::vector<std::pair<int, int>> ranges,
+                                                         int lastEndFrame);
+
+    // Frames the smoothing kernel reaches past a note boundary (half-width, rounded up)
+    static int getReachFrames();
+
     // Calculate delta pitch (actual F0 in MIDI - base pitch)
     static std::vector<float> calculateDeltaPitch(const std::vector<float>& f0Values,
                                                    const std::vector<float>& basePitch,
@@ -50,5 +83,27 @@ private:
     static constexpr int KERNEL_SIZE = 241;  // ±120ms at 1000Hz sampling
     static constexpr double SMOOTH_WINDOW = 0.24;  // 240ms total window for smoother transitions
 
+    struct NoteInSeconds {
+        double start;
+        double end;
+        float midiNote;
+    };
+
     static std::vector<double> createCosineKernel();
+    static const std::vector<double>& getCosineKernel();
+    static std::vector<NoteInSeconds> toSeconds(const std::vector<NoteSegment>& notes);
+    static int getTotalMs(int lastEndFrame);
+
+    // Frames whose base pitch depends on notes overlapping [startFrame, endFrame)
+    static std::pair<int, int> getAffectedFrames(const std::vector<NoteSegment>& notes, int totalFrames,
+                                                 int startFrame, int endFrame);
+
+    // Smoothed 1ms curve over [msBegin, msEnd), identical to the matching
+    // slice of a full-length convolution of totalMs samples
+    static std::vector<double> smoothRange(const std::vector<NoteInSeconds>& noteArray,
+                                           int totalMs, int msBegin, int msEnd);
+
+    // Resample frames [frameBegin, frameEnd) from a 1ms curve starting at msOffset
+    static void resampleToFrames(const std::vector<double>& smoothedMs, int msOffset, int totalMs,
+                                 float* out, int frameBegin, int frameEnd);
 };
@@ -0,0 +1,444 @@
+#include "EditJournal.h"
+#include "../Models/ProjectSerializer.h"
+#include "PitchMath.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+    constexpr char JOURNAL_MAGIC[4] = {'H', 'T', 'P', 'J'};
+    constexpr int JOURNAL_VERSION = 1;
+    constexpr int JOURNAL_HEADER_SIZE = 8;
+    constexpr int RECORD_MAGIC = 0x4345524A;  // "JREC"
+    constexpr int RECORD_HEADER_SIZE = 12;
+
+    constexpr int COMPACT_AFTER_RECORDS = 200;
+    constexpr juce::int64 COMPACT_AFTER_BYTES = 8 * 1024 * 1024;
+
+    uint32_t checksum(const void* data, size_t numBytes)
+    {
+        // FNV-1a: enough to reject a torn final record
+        uint32_t hash = 2166136261u;
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < numBytes; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    void writeFloatSpan(juce::OutputStream& out, const std::vector<float>& values, int start, int end)
+    {
+        const int count = std::max(0, std::min(end, static_cast<int>(values.size())) - start);
+        out.writeInt(count);
+        if (count > 0)
+            out.write(values.data() + start, static_cast<size_t>(count) * sizeof(float));
+    }
+
+    bool readFloatSpan(juce::InputStream& in, std::vector<float>& values, int start, bool resizeToFit)
+    {
+        const int count = in.readInt();
+        if (count < 0 || in.getNumBytesRemaining() < static_cast<juce::int64>(count) * 4)
+            return false;
+
+        std::vector<float> span(static_cast<size_t>(count));
+        if (count > 0)
+            in.read(span.data(), count * static_cast<int>(sizeof(float)));
+
+        if (resizeToFit)
+            values.resize(static_cast<size_t>(start + count), 0.0f);
+
+        const int n = std::min(count, static_cast<int>(values.size()) - start);
+        if (n > 0)
+            std::copy(span.begin(), span.begin() + n, values.begin() + start);
+        return true;
+    }
+}
+
+EditJournal::~EditJournal()
+{
+    close();
+    if (compactionThread.joinable())
+        compactionThread.join();
+}
+
+juce::File EditJournal::getJournalFile(const juce::File& projectFile)
+{
+    return projectFile.getSiblingFile(projectFile.getFileName() + ".journal");
+}
+
+juce::File EditJournal::getSnapshotFile(const juce::File& projectFile)
+{
+    return projectFile.getSiblingFile(projectFile.getFileName() + ".autosave");
+}
+
+bool EditJournal::open(Project* newProject, const juce::File& newProjectFile)
+{
+    close();
+    if (newProject == nullptr || newProjectFile == juce::File{})
+        return false;
+
+    project = newProject;
+    projectFile = newProjectFile;
+    journalFile = getJournalFile(projectFile);
+    recordsSinceSnapshot = 0;
+    wroteRecords = false;
+    project->setTrackingRewrittenFrames(true);
+
+    // The project file is the new baseline
+    getSnapshotFile(projectFile).deleteFile();
+    if (!openOutput(true))
+    {
+        project->setTrackingRewrittenFrames(false);
+        project = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void EditJournal::close()
+{
+    flush();
+    cancelPendingUpdate();
+    output.reset();
+    if (project != nullptr)
+    {
+        project->setTrackingRewrittenFrames(false);
+
+        // Nothing happened since the project was saved
+        if (!wroteRecords)
+            journalFile.deleteFile();
+    }
+    project = nullptr;
+}
+
+bool EditJournal::openOutput(bool truncate)
+{
+    output.reset();
+    if (truncate)
+        journalFile.deleteFile();
+
+    auto stream = std::make_unique<juce::FileOutputStream>(journalFile);
+    if (stream->failedToOpen())
+        return false;
+
+    if (stream->getPosition() == 0)
+    {
+        stream->write(JOURNAL_MAGIC, 4);
+        stream->writeInt(JOURNAL_VERSION);
+        stream->flush();
+    }
+
+    output = std::move(stream);
+    return true;
+}
+
+void EditJournal::recordEdit(int startFrame, int endFrame)
+{
+    if (!isOpen())
+        return;
+
+    pendingRanges.emplace_back(startFrame, endFrame);
+    triggerAsyncUpdate();
+}
+
+void EditJournal::handleAsyncUpdate()
+{
+    flush();
+    startCompactionIfNeeded();
+}
+
+void EditJournal::flush()
+{
+    if (!isOpen() || project == nullptr)
+    {
+        pendingRanges.clear();
+        return;
+    }
+
+    if (pendingRanges.empty())
+        return;
+
+    for (const auto& [start, end] : pendingRanges)
+        writeRecord(start, end);
+    pendingRanges.clear();
+
+    // Curves the edits rebuilt beyond their own frames, e.g. smoothed base
+    // pitch around moved notes
+    for (const auto& [start, end] : project->takeRewrittenFrames())
+        writeRecord(start, end);
+
+    output->flush();
+}
+
+void EditJournal::writeRecord(int startFrame, int endFrame)
+{
+    const auto& audioData = project->getAudioData();
+    const int totalFrames = static_cast<int>(audioData.f0.size());
+
+    const bool wholeProject = startFrame < 0;
+    if (wholeProject)
+    {
+        startFrame = 0;
+        endFrame = totalFrames;
+    }
+    else
+    {
+        startFrame = std::max(0, startFrame);
+        endFrame = std::max(startFrame, std::min(totalFrames, endFrame));
+    }
+
+    juce::MemoryOutputStream payload;
+    payload.writeBool(wholeProject);
+    payload.writeInt(startFrame);
+    payload.writeInt(endFrame);
+
+    writeFloatSpan(payload, audioData.f0, startFrame, endFrame);
+    writeFloatSpan(payload, audioData.basePitch, startFrame, endFrame);
+    writeFloatSpan(payload, audioData.deltaPitch, startFrame, endFrame);
+
+    const int voicedCount = std::max(0, std::min(endFrame, static_cast<int>(audioData.voicedMask.size())) - startFrame);
+    payload.writeInt(voicedCount);
+    if (voicedCount > 0)
+        payload.write(audioData.voicedMask.data() + startFrame, static_cast<size_t>(voicedCount));
+
+    // Full copies of every note the span touches
+    std::vector<Note> notes;
+    if (wholeProject)
+    {
+        notes = std::as_const(*project).getNotes();
+    }
+    else
+    {
+        for (auto* note : project->getNotesInRange(startFrame, endFrame))
+            notes.push_back(*note);
+    }
+
+    const auto notesData = ProjectSerializer::notesToBinary(notes);
+    payload.writeInt(static_cast<int>(notesData.getSize()));
+    payload.write(notesData.getData(), notesData.getSize());
+
+    output->writeInt(RECORD_MAGIC);
+    output->writeInt(static_cast<int>(payload.getDataSize()));
+    output->writeInt(static_cast<int>(checksum(payload.getData(), payload.getDataSize())));
+    output->write(payload.getData(), payload.getDataSize());
+
+    ++recordsSinceSnapshot;
+    wroteRecords = true;
+}
+
+void EditJournal::startCompactionIfNeeded()
+{
+    if (!isOpen() || project == nullptr || compacting.load())
+        return;
+
+    if (recordsSinceSnapshot < COMPACT_AFTER_RECORDS && output->getPosition() < COMPACT_AFTER_BYTES)
+        return;
+
+    if (compactionThread.joinable())
+        compactionThread.join();
+
+    compacting = true;
+    const juce::int64 journalOffset = output->getPosition();
+    const int coveredRecords = recordsSinceSnapshot;
+
+    // Copy only what the snapshot stores; waveform and mel stay behind
+    auto snapshot = std::make_shared<Project>();
+    snapshot->setName(project->getName());
+    snapshot->setFilePath(project->getFilePath());
+    snapshot->setGlobalPitchOffset(project->getGlobalPitchOffset());
+    snapshot->setFormantShift(project->getFormantShift());
+    snapshot->setVolume(project->getVolume());
+    snapshot->setNotes(project->getNotes());
+
+    const auto& source = project->getAudioData();
+    auto& target = snapshot->getAudioData();
+    target.sampleRate = source.sampleRate;
+    target.f0 = source.f0;
+    target.basePitch = source.basePitch;
+    target.deltaPitch = source.deltaPitch;
+    target.voicedMask = source.voicedMask;
+
+    const auto snapshotFile = getSnapshotFile(projectFile);
+    const auto journal = journalFile;
+    std::weak_ptr<EditJournal*> weakToken = aliveToken;
+
+    compactionThread = std::thread([snapshot, snapshotFile, journal, journalOffset, coveredRecords, weakToken]() {
+        ProjectSaveOptions options;
+        options.includeMelCache = false;
+        const bool ok = ProjectSerializer::saveToFile(*snapshot, snapshotFile, options);
+
+        juce::MessageManager::callAsync([weakToken, journal, journalOffset, coveredRecords, ok]() {
+            auto token = weakToken.lock();
+            if (token == nullptr)
+                return;
+
+            auto* self = *token;
+            if (self->journalFile == journal)
+                self->finishCompaction(journalOffset, coveredRecords, ok);
+            else
+                self->compacting = false;
+        });
+    });
+}
+
+void EditJournal::finishCompaction(juce::int64 journalOffset, int coveredRecords, bool snapshotWritten)
+{
+    compacting = false;
+    if (!snapshotWritten || !isOpen())
+        return;
+
+    // Records written while the snapshot was being saved stay in the journal
+    recordsSinceSnapshot = std::max(0, recordsSinceSnapshot - coveredRecords);
+
+    flush();
+    output.reset();
+
+    // Keep only the records written after the snapshot was taken
+    juce::MemoryBlock tail;
+    {
+        juce::FileInputStream in(journalFile);
+        if (in.openedOk() && in.setPosition(journalOffset))
+            in.readIntoMemoryBlock(tail);
+    }
+
+    juce::TemporaryFile temp(journalFile);
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (!out.failedToOpen())
+        {
+            out.write(JOURNAL_MAGIC, 4);
+            out.writeInt(JOURNAL_VERSION);
+            out.write(tail.getData(), tail.getSize());
+            out.flush();
+        }
+    }
+    temp.overwriteTargetFileWithTemporary();
+
+    if (!openOutput(false))
+        DBG("EditJournal: failed to reopen journal after compaction");
+}
+
+bool EditJournal::hasRecoverableEdits(const juce::File& projectFile)
+{
+    if (projectFile == juce::File{})
+        return false;
+
+    const auto snapshotFile = getSnapshotFile(projectFile);
+    if (snapshotFile.existsAsFile()
+        && snapshotFile.getLastModificationTime() >= projectFile.getLastModificationTime())
+        return true;
+
+    return getJournalFile(projectFile).getSize() > JOURNAL_HEADER_SIZE;
+}
+
+int EditJournal::recover(Project& project, const juce::File& projectFile)
+{
+    const auto snapshotFile = getSnapshotFile(projectFile);
+    const auto journal = getJournalFile(projectFile);
+    if (!snapshotFile.existsAsFile() && !journal.existsAsFile())
+        return -1;
+
+    if (snapshotFile.existsAsFile()
+        && snapshotFile.getLastModificationTime() >= projectFile.getLastModificationTime())
+        ProjectSerializer::loadFromFile(project, snapshotFile, false);
+
+    juce::FileInputStream in(journal);
+    if (!in.openedOk())
+        return 0;
+
+    char magic[4] = {};
+    if (in.read(magic, 4) != 4 || std::memcmp(magic, JOURNAL_MAGIC, 4) != 0
+        || in.readInt() != JOURNAL_VERSION)
+        return 0;
+
+    int replayed = 0;
+    while (in.getNumBytesRemaining() >= RECORD_HEADER_SIZE)
+    {
+        const int recordMagic = in.readInt();
+        const int size = in.readInt();
+        const auto expected = static_cast<uint32_t>(in.readInt());
+        if (recordMagic != RECORD_MAGIC || size < 0 || in.getNumBytesRemaining() < size)
+            break;
+
+        juce::MemoryBlock payload;
+        in.readIntoMemoryBlock(payload, size);
+
+        // A torn write at the end of the journal stops replay there
+        if (checksum(payload.getData(), payload.getSize()) != expected)
+            break;
+        if (!applyRecord(project, payload))
+            break;
+        ++replayed;
+    }
+
+    if (replayed > 0)
+        project.setModified(true);
+    return replayed;
+}
+
+bool EditJournal::applyRecord(Project& project, const juce::MemoryBlock& payload)
+{
+    juce::MemoryInputStream in(payload, false);
+    auto& audioData = project.getAudioData();
+
+    const bool wholeProject = in.readBool();
+    const int startFrame = in.readInt();
+    const int endFrame = in.readInt();
+    if (startFrame < 0 || endFrame < startFrame)
+        return false;
+
+    if (!readFloatSpan(in, audioData.f0, startFrame, wholeProject)
+        || !readFloatSpan(in, audioData.basePitch, startFrame, wholeProject)
+        || !readFloatSpan(in, audioData.deltaPitch, startFrame, wholeProject))
+        return false;
+
+    const int voicedCount = in.readInt();
+    if (voicedCount < 0 || in.getNumBytesRemaining() < voicedCount)
+        return false;
+    std::vector<uint8_t> voiced(static_cast<size_t>(voicedCount));
+    if (voicedCount > 0)
+        in.read(voiced.data(), voicedCount);
+    if (wholeProject)
+        audioData.voicedMask.resize(static_cast<size_t>(startFrame + voicedCount), 0);
+    const int voicedFit = std::min(voicedCount, static_cast<int>(audioData.voicedMask.size()) - startFrame);
+    if (voicedFit > 0)
+        std::copy(voiced.begin(), voiced.begin() + voicedFit, audioData.voicedMask.begin() + startFrame);
+
+    const int notesSize = in.readInt();
+    if (notesSize < 0 || in.getNumBytesRemaining() < notesSize)
+        return false;
+
+    juce::MemoryBlock notesData;
+    in.readIntoMemoryBlock(notesData, notesSize);
+    std::vector<Note> notes;
+    if (!ProjectSerializer::notesFromBinary(notesData, notes))
+        return false;
+
+    // Replace the notes the span covered with the recorded ones. An action's
+    // span covers its notes both before and after it (pitch drags keep notes
+    // in place, a split stays inside the original note), so this also drops
+    // the versions the action replaced.
+    if (wholeProject)
+    {
+        project.clearNotes();
+    }
+    else
+    {
+        project.removeNotesInRange(startFrame, endFrame);
+    }
+    for (auto& note : notes)
+        project.addNote(std::move(note));
+
+    // baseF0 caches base pitch in Hz
+    if (audioData.baseF0.size() != audioData.basePitch.size())
+        audioData.baseF0.resize(audioData.basePitch.size(), 0.0f);
+    const int baseEnd = std::min(endFrame, static_cast<int>(audioData.basePitch.size()));
+    if (baseEnd > startFrame)
+        PitchMath::midiToFreq(audioData.basePitch.data() + startFrame, audioData.baseF0.data() + startFrame,
+                              static_cast<size_t>(baseEnd - startFrame));
+
+    return true;
+}
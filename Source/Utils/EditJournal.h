@@ -0,0 +1,111 @@
+#pragma once
+
+#include "../JuceHeader.h"
+#include "../Models/Project.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Append-only edit journal kept next to a saved project file.
+ *
+ * Every applied undo/redo action queues a record holding the final state of
+ * the frames it touched: the dense curves over that span and the notes that
+ * overlap it. Curve frames rebuilt along with an edit, which the project
+ * collects from PitchCurveProcessor, get records of their own. Records are
+ * absolute rather than deltas, so replaying them in order over any older
+ * snapshot of the project reproduces the latest state, and replaying one
+ * twice is harmless.
+ *
+ * Records are written (and flushed) once the current message callback has
+ * finished, so the action's own follow-up work such as base pitch rebuilds
+ * is captured. Autosave cost follows the size of the edit, and a crash loses
+ * at most the action in flight.
+ *
+ * When the journal grows past a threshold, notes and curves are copied and
+ * written as a full snapshot on a background thread. The journal is then cut
+ * down to the records that arrived after the copy.
+ *
+ * Files, for a project "Song.htpx":
+ *   Song.htpx.journal   - the journal
+ *   Song.htpx.autosave  - last compacted snapshot (binary container)
+ *
+ * Message thread only, apart from the internal compaction worker.
+ */
+class EditJournal : private juce::AsyncUpdater
+{
+public:
+    EditJournal() = default;
+    ~EditJournal() override;
+
+    /**
+     * Start a fresh journal for projectFile, which must already hold the
+     * project's current state (i.e. it was just saved). Stale journal and
+     * autosave files are discarded.
+     */
+    bool open(Project* project, const juce::File& projectFile);
+
+    /**
+     * Flush pending records and stop journaling. A journal that never got a
+     * record is deleted; one holding edits is left for recover(), since the
+     * project file does not have them.
+     */
+    void close();
+
+    bool isOpen() const { return output != nullptr; }
+
+    /**
+     * Queue a record for frames [startFrame, endFrame). A negative start
+     * records the whole project.
+     */
+    void recordEdit(int startFrame, int endFrame);
+
+    /** Write queued records now instead of waiting for the async update. */
+    void flush();
+
+    /**
+     * True if a journal or autosave next to projectFile holds edits the
+     * project file does not have, i.e. the session that wrote them crashed or
+     * ended without saving.
+     */
+    static bool hasRecoverableEdits(const juce::File& projectFile);
+
+    /**
+     * Crash recovery: with project loaded from projectFile, apply the newer
+     * autosave snapshot (if any) and replay the journal on top.
+     * Returns the number of records replayed, or -1 if there was nothing to
+     * recover. The files are left alone; open() starts them over.
+     */
+    static int recover(Project& project, const juce::File& projectFile);
+
+    static juce::File getJournalFile(const juce::File& projectFile);
+    static juce::File getSnapshotFile(const juce::File& projectFile);
+
+private:
+    void handleAsyncUpdate() override;
+
+    void writeRecord(int startFrame, int endFrame);
+    void startCompactionIfNeeded();
+    void finishCompaction(juce::int64 journalOffset, int coveredRecords, bool snapshotWritten);
+    bool openOutput(bool truncate);
+
+    static bool applyRecord(Project& project, const juce::MemoryBlock& payload);
+
+    Project* project = nullptr;
+    juce::File projectFile;
+    juce::File journalFile;
+    std::unique_ptr<juce::FileOutputStream> output;
+
+    std::vector<std::pair<int, int>> pendingRanges;
+    int recordsSinceSnapshot = 0;
+    bool wroteRecords = false;
+
+    // Background compaction
+    std::thread compactionThread;
+    std::atomic<bool> compacting{false};
+    std::shared_ptr<EditJournal*> aliveToken = std::make_shared<EditJournal*>(this);
+
+    JUCE_DECLARE_NON_COPYABLE(EditJournal)
+};
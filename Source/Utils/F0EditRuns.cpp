@@ -0,0 +1,154 @@
+#include "F0EditRuns.h"
+#include <algorithm>
+#include <climits>
+
+F0EditRuns::F0EditRuns(std::vector<F0FrameEdit> edits, bool withDeltaVoiced)
+    : hasDeltaVoiced(withDeltaVoiced)
+{
+    edits.erase(std::remove_if(edits.begin(), edits.end(),
+                               [](const F0FrameEdit& e) { return e.idx < 0; }),
+                edits.end());
+    if (edits.empty())
+        return;
+
+    std::stable_sort(edits.begin(), edits.end(),
+                     [](const F0FrameEdit& a, const F0FrameEdit& b) { return a.idx < b.idx; });
+
+    // Merge repeated frames: the earliest old state, the latest new state
+    size_t unique = 0;
+    for (size_t i = 1; i < edits.size(); ++i)
+    {
+        auto& last = edits[unique];
+        const auto& e = edits[i];
+        if (e.idx == last.idx)
+        {
+            last.newF0 = e.newF0;
+            last.newDelta = e.newDelta;
+            last.newVoiced = e.newVoiced;
+        }
+        else
+        {
+            edits[++unique] = e;
+        }
+    }
+    edits.resize(unique + 1);
+
+    const size_t lanes = hasDeltaVoiced ? 4 : 2;
+    values.reserve(edits.size() * lanes);
+
+    size_t runBegin = 0;
+    while (runBegin < edits.size())
+    {
+        size_t runEnd = runBegin + 1;
+        while (runEnd < edits.size() && edits[runEnd].idx == edits[runEnd - 1].idx + 1)
+            ++runEnd;
+
+        Run run;
+        run.start = edits[runBegin].idx;
+        run.length = static_cast<int>(runEnd - runBegin);
+        run.valueOffset = static_cast<uint32_t>(values.size());
+
+        for (size_t i = runBegin; i < runEnd; ++i) values.push_back(edits[i].oldF0);
+        for (size_t i = runBegin; i < runEnd; ++i) values.push_back(edits[i].newF0);
+
+        if (hasDeltaVoiced)
+        {
+            for (size_t i = runBegin; i < runEnd; ++i) values.push_back(edits[i].oldDelta);
+            for (size_t i = runBegin; i < runEnd; ++i) values.push_back(edits[i].newDelta);
+
+            bool uniform = true;
+            for (size_t i = runBegin + 1; i < runEnd && uniform; ++i)
+                uniform = edits[i].oldVoiced == edits[runBegin].oldVoiced
+                       && edits[i].newVoiced == edits[runBegin].newVoiced;
+
+            if (uniform)
+            {
+                if (edits[runBegin].oldVoiced) run.flags |= OLD_VOICED;
+                if (edits[runBegin].newVoiced) run.flags |= NEW_VOICED;
+            }
+            else
+            {
+                run.flags |= MIXED_VOICED;
+                run.voicedOffset = static_cast<uint32_t>(voicedBits.size());
+                for (size_t i = runBegin; i < runEnd; ++i)
+                    voicedBits.push_back(static_cast<uint8_t>((edits[i].oldVoiced ? 1 : 0)
+                                                            | (edits[i].newVoiced ? 2 : 0)));
+            }
+        }
+
+        runs.push_back(run);
+        runBegin = runEnd;
+    }
+
+    runs.shrink_to_fit();
+    values.shrink_to_fit();
+    voicedBits.shrink_to_fit();
+}
+
+std::pair<int, int> F0EditRuns::getRange() const
+{
+    if (runs.empty())
+        return {-1, -1};
+    return {runs.front().start, runs.back().start + runs.back().length};
+}
+
+std::pair<int, int> F0EditRuns::apply(std::vector<float>* f0, std::vector<float>* delta,
+                                      std::vector<uint8_t>* voiced, bool useNew) const
+{
+    int minIdx = INT_MAX;
+    int maxIdx = INT_MIN;
+
+    for (const auto& run : runs)
+    {
+        const float* base = values.data() + run.valueOffset;
+        const float* f0Values = base + (useNew ? run.length : 0);
+
+        if (f0)
+        {
+            const int n = std::min(run.length, static_cast<int>(f0->size()) - run.start);
+            if (n > 0)
+            {
+                std::copy(f0Values, f0Values + n, f0->begin() + run.start);
+                minIdx = std::min(minIdx, run.start);
+                maxIdx = std::max(maxIdx, run.start + n - 1);
+            }
+        }
+
+        if (!hasDeltaVoiced)
+            continue;
+
+        if (delta)
+        {
+            const float* deltaValues = base + 2 * run.length + (useNew ? run.length : 0);
+            const int n = std::min(run.length, static_cast<int>(delta->size()) - run.start);
+            if (n > 0)
+                std::copy(deltaValues, deltaValues + n, delta->begin() + run.start);
+        }
+
+        if (voiced)
+        {
+            const int n = std::min(run.length, static_cast<int>(voiced->size()) - run.start);
+            if (run.flags & MIXED_VOICED)
+            {
+                const uint8_t mask = useNew ? 2 : 1;
+                for (int i = 0; i < n; ++i)
+                    (*voiced)[static_cast<size_t>(run.start + i)] = (voicedBits[run.voicedOffset + i] & mask) != 0 ? 1 : 0;
+            }
+            else
+            {
+                const uint8_t value = (run.flags & (useNew ? NEW_VOICED : OLD_VOICED)) != 0 ? 1 : 0;
+                if (n > 0)
+                    std::fill_n(voiced->begin() + run.start, n, value);
+            }
+        }
+    }
+
+    return {minIdx, maxIdx};
+}
+
+size_t F0EditRuns::getMemoryUsage() const
+{
+    return runs.capacity() * sizeof(Run)
+         + values.capacity() * sizeof(float)
+         + voicedBits.capacity();
+}
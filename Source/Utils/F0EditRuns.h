@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * One frame of a pitch curve edit, as collected while drawing or dragging.
+ */
+struct F0FrameEdit
+{
+    int idx = -1;
+    float oldF0 = 0.0f;
+    float newF0 = 0.0f;
+    float oldDelta = 0.0f;
+    float newDelta = 0.0f;
+    bool oldVoiced = false;
+    bool newVoiced = false;
+};
+
+/**
+ * Compact storage for a set of frame edits inside undo history.
+ *
+ * Edits are sorted and grouped into runs of consecutive frames. Each run
+ * keeps its values as plain arrays (old/new f0, then old/new delta when
+ * requested), so frame indices are stored once per run instead of per frame.
+ * The voiced flags of a run are usually constant and are then kept as two
+ * bits on the run; only mixed runs store one byte per frame.
+ *
+ * A stroke of N frames costs about 16 * N bytes (8 * N for f0-only edits)
+ * instead of sizeof(F0FrameEdit) * N.
+ */
+class F0EditRuns
+{
+public:
+    F0EditRuns() = default;
+
+    /**
+     * @param edits           Edits in any order. Negative indices are dropped;
+     *                        for repeated indices the first old value and the
+     *                        last new value are kept.
+     * @param withDeltaVoiced Also store delta pitch and voiced flags. Note drags
+     *                        only touch f0 and pass false.
+     */
+    F0EditRuns(std::vector<F0FrameEdit> edits, bool withDeltaVoiced);
+
+    bool empty() const { return runs.empty(); }
+
+    /** [first frame, last frame + 1), or {-1, -1} when empty. */
+    std::pair<int, int> getRange() const;
+
+    /**
+     * Write the old (useNew == false) or new values into the given arrays.
+     * Null arrays are skipped, frames past an array's end are ignored.
+     * Returns the inclusive min/max f0 frame written; min > max if none.
+     */
+    std::pair<int, int> apply(std::vector<float>* f0, std::vector<float>* delta,
+                              std::vector<uint8_t>* voiced, bool useNew) const;
+
+    /** Heap bytes held by this object. */
+    size_t getMemoryUsage() const;
+
+private:
+    enum RunFlags : uint8_t
+    {
+        OLD_VOICED = 1 << 0,
+        NEW_VOICED = 1 << 1,
+        MIXED_VOICED = 1 << 2  // per-frame bits in voicedBits
+    };
+
+    struct Run
+    {
+        int start = 0;
+        int length = 0;
+        uint32_t valueOffset = 0;   // first value in `values`
+        uint32_t voicedOffset = 0;  // first byte in `voicedBits` (mixed runs)
+        uint8_t flags = 0;
+    };
+
+    // Values per run: oldF0[len], newF0[len] and, with delta, oldDelta[len], newDelta[len]
+    std::vector<Run> runs;
+    std::vector<float> values;
+    std::vector<uint8_t> voicedBits;  // bit 0 = old, bit 1 = new
+    bool hasDeltaVoiced = false;
+};
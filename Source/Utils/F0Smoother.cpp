@@ -1,6 +1,67 @@
 #include "F0Smoother.h"
 #include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <set>
+
+namespace
+{
+    /**
+     * Running median over a multiset of values, kept as two ordered halves.
+     * Insert and erase are O(log w); the median matches sorting the window.
+     */
+    class SlidingMedian
+    {
+    public:
+        void insert(float value)
+        {
+            if (lower.empty() || value <= *lower.rbegin())
+                lower.insert(value);
+            else
+                upper.insert(value);
+            rebalance();
+        }
+
+        void erase(float value)
+        {
+            if (!lower.empty() && value <= *lower.rbegin())
+                lower.erase(lower.find(value));
+            else
+                upper.erase(upper.find(value));
+            rebalance();
+        }
+
+        bool empty() const { return lower.empty(); }
+
+        float median() const
+        {
+            if (lower.size() == upper.size())
+                return (*lower.rbegin() + *upper.begin()) / 2.0f;
+            return *lower.rbegin();
+        }
+
+    private:
+        // lower holds the smaller half and is never smaller than upper
+        void rebalance()
+        {
+            if (lower.size() > upper.size() + 1)
+            {
+                auto it = std::prev(lower.end());
+                upper.insert(*it);
+                lower.erase(it);
+            }
+            else if (upper.size() > lower.size())
+            {
+                auto it = upper.begin();
+                lower.insert(*it);
+                upper.erase(it);
+            }
+        }
+
+        std::multiset<float> lower;
+        std::multiset<float> upper;
+    };
+}
 
 std::vector<float> F0Smoother::medianFilter(const std::vector<float>& f0, int windowSize)
 {
@@ -11,52 +72,39 @@ std::vector<float> F0Smoother::medianFilter(const std::vector<float>& f0, int wi
     if (windowSize % 2 == 0)
         windowSize += 1;
     
-    int halfWindow = windowSize / 2;
+    const int halfWindow = windowSize / 2;
+    const int size = static_cast<int>(f0.size());
     std::vector<float> smoothed(f0.size());
     
-    for (size_t i = 0; i < f0.size(); ++i)
+    // Only voiced (positive) values take part in the median
+    SlidingMedian window;
+    for (int j = 0; j <= halfWindow && j < size; ++j)
     {
-        int start = static_cast<int>(i) - halfWindow;
-        int end = static_cast<int>(i) + halfWindow;
-        
-        // Collect valid F0 values in window (only voiced)
-        std::vector<float> windowValues;
-        windowValues.reserve(windowSize);
-        
-        for (int j = start; j <= end; ++j)
+        if (f0[j] > 0.0f)
+            window.insert(f0[j]);
+    }
+    
+    for (int i = 0; i < size; ++i)
+    {
+        if (i > 0)
         {
-            if (j >= 0 && j < static_cast<int>(f0.size()) && f0[j] > 0.0f)
-            {
-                windowValues.push_back(f0[j]);
-            }
+            int leaving = i - halfWindow - 1;
+            int entering = i + halfWindow;
+            if (leaving >= 0 && f0[leaving] > 0.0f)
+                window.erase(f0[leaving]);
+            if (entering < size && f0[entering] > 0.0f)
+                window.insert(f0[entering]);
         }
         
-        if (!windowValues.empty())
-        {
-            // Sort and get median
-            std::sort(windowValues.begin(), windowValues.end());
-            size_t mid = windowValues.size() / 2;
-            if (windowValues.size() % 2 == 0)
-            {
-                smoothed[i] = (windowValues[mid - 1] + windowValues[mid]) / 2.0f;
-            }
-            else
-            {
-                smoothed[i] = windowValues[mid];
-            }
-        }
-        else
-        {
-            // No voiced frames in window, keep original (or 0)
-            smoothed[i] = f0[i];
-        }
+        // No voiced frames in window, keep original (or 0)
+        smoothed[i] = window.empty() ? f0[i] : window.median();
     }
     
     return smoothed;
 }
 
 std::vector<float> F0Smoother::smoothTransitions(const std::vector<float>& f0,
-                                                  const std::vector<bool>& voicedMask,
+                                                  const std::vector<uint8_t>& voicedMask,
                                                   int windowSize)
 {
     if (f0.empty() || f0.size() != voicedMask.size())
@@ -107,7 +155,7 @@ std::vector<float> F0Smoother::smoothTransitions(const std::vector<float>& f0,
 }
 
 std::vector<float> F0Smoother::interpolateUnvoiced(const std::vector<float>& f0,
-                                                     const std::vector<bool>& voicedMask,
+                                                     const std::vector<uint8_t>& voicedMask,
                                                      int maxGapFrames)
 {
     if (f0.empty() || f0.size() != voicedMask.size())
@@ -211,7 +259,7 @@ std::vector<float> F0Smoother::removeOutliers(const std::vector<float>& f0,
 }
 
 std::vector<float> F0Smoother::smoothF0(const std::vector<float>& f0,
-                                         const std::vector<bool>& voicedMask)
+                                         const std::vector<uint8_t>& voicedMask)
 {
     if (f0.empty())
         return f0;
@@ -231,38 +279,6 @@ std::vector<float> F0Smoother::smoothF0(const std::vector<float>& f0,
     return step4;
 }
 
-float F0Smoother::getMedian(const std::vector<float>& values, int start, int end)
-{
-    if (start < 0) start = 0;
-    if (end >= static_cast<int>(values.size())) end = static_cast<int>(values.size()) - 1;
-    if (start > end) return 0.0f;
-    
-    std::vector<float> window;
-    window.reserve(end - start + 1);
-    
-    for (int i = start; i <= end; ++i)
-    {
-        if (values[i] > 0.0f)
-        {
-            window.push_back(values[i]);
-        }
-    }
-    
-    if (window.empty())
-        return 0.0f;
-    
-    std::sort(window.begin(), window.end());
-    size_t mid = window.size() / 2;
-    if (window.size() % 2 == 0)
-    {
-        return (window[mid - 1] + window[mid]) / 2.0f;
-    }
-    else
-    {
-        return window[mid];
-    }
-}
-
 bool F0Smoother::isReasonableJump(float f0Prev, float f0Curr, float maxRatio)
 {
     if (f0Prev <= 0.0f || f0Curr <= 0.0f)
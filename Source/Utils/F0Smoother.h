@@ -12,6 +12,7 @@ class F0Smoother
 public:
     /**
      * Apply median filter to F0 values to reduce jitter.
+     * Keeps a running median of the voiced frames in the window, O(n log w).
      * @param f0 Input F0 values
      * @param windowSize Median filter window size (should be odd, e.g., 5, 7, 9)
      * @return Smoothed F0 values
@@ -26,7 +27,7 @@ public:
      * @return Smoothed F0 values
      */
     static std::vector<float> smoothTransitions(const std::vector<float>& f0,
-                                                 const std::vector<bool>& voicedMask,
+                                                 const std::vector<uint8_t>& voicedMask,
                                                  int windowSize = 3);
     
     /**
@@ -38,7 +39,7 @@ public:
      * @return Interpolated F0 values
      */
     static std::vector<float> interpolateUnvoiced(const std::vector<float>& f0,
-                                                    const std::vector<bool>& voicedMask,
+                                                    const std::vector<uint8_t>& voicedMask,
                                                     int maxGapFrames = 5);
     
     /**
@@ -57,14 +58,9 @@ public:
      * @return Fully smoothed F0 values
      */
     static std::vector<float> smoothF0(const std::vector<float>& f0,
-                                        const std::vector<bool>& voicedMask);
+                                        const std::vector<uint8_t>& voicedMask);
     
 private:
-    /**
-     * Helper: Get median value from a window of F0 values.
-     */
-    static float getMedian(const std::vector<float>& values, int start, int end);
-    
     /**
      * Helper: Check if F0 jump is reasonable.
      */
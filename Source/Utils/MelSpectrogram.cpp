@@ -101,7 +101,14 @@ void MelSpectrogram::createMelFilterbank()
     }
 }
 
-std::vector<std::vector<float>> MelSpectrogram::compute(const float* audio, int numSamples)
+MelFrames MelSpectrogram::compute(const float* audio, int numSamples)
+{
+    MelFrames mel(static_cast<size_t>(getNumFrames(numSamples)), numMels);
+    computeFrames(audio, numSamples, 0, static_cast<int>(mel.size()), mel);
+    return mel;
+}
+
+int MelSpectrogram::getNumFrames(int numSamples) const
 {
     // Add center padding for better frame alignment (matches librosa default)
     // This ensures the first frame is centered at hopSize/2
@@ -111,17 +118,32 @@ std::vector<std::vector<float>> MelSpectrogram::compute(const float* audio, int
     // Calculate number of frames with proper padding
     int paddedLength = numSamples + padLeft + padRight;
     int numFrames = (paddedLength - nFft) / hopSize + 1;
-    if (numFrames < 1)
-    {
-        numFrames = 1;
-    }
+    return std::max(numFrames, 1);
+}
+
+int MelSpectrogram::getNumFramesReady(int samplesReady, int numSamples) const
+{
+    const int numFrames = getNumFrames(numSamples);
+    if (samplesReady >= numSamples)
+        return numFrames;
     
-    std::vector<std::vector<float>> mel(numFrames);
+    // Frame i reads samples up to i * hopSize + nFft / 2 - 1
+    const int available = samplesReady - nFft / 2;
+    if (available < 0)
+        return 0;
+    return std::min(available / hopSize + 1, numFrames);
+}
+
+void MelSpectrogram::computeFrames(const float* audio, int numSamples, int startFrame, int endFrame,
+                                   MelFrames& mel)
+{
+    int padLeft = nFft / 2;
     int numBins = nFft / 2 + 1;
     
     std::vector<float> frame(nFft * 2, 0.0f);  // Complex FFT buffer
+    std::vector<float> mag(numBins);
     
-    for (int i = 0; i < numFrames; ++i)
+    for (int i = startFrame; i < endFrame; ++i)
     {
         // Calculate sample position in original audio (accounting for padding)
         int centerSample = i * hopSize;
@@ -155,7 +177,6 @@ std::vector<std::vector<float>> MelSpectrogram::compute(const float* audio, int
         fft.performRealOnlyForwardTransform(frame.data());
         
         // Compute magnitude spectrum with small epsilon to avoid log(0)
-        std::vector<float> mag(numBins);
         for (int k = 0; k < numBins; ++k)
         {
             float real = frame[k * 2];
@@ -164,7 +185,7 @@ std::vector<std::vector<float>> MelSpectrogram::compute(const float* audio, int
         }
         
         // Apply mel filterbank
-        mel[i].resize(numMels);
+        float* melFrame = mel.getWritePointer(static_cast<size_t>(i));
         for (int m = 0; m < numMels; ++m)
         {
             float sum = 0.0f;
@@ -175,9 +196,7 @@ std::vector<std::vector<float>> MelSpectrogram::compute(const float* audio, int
             
             // Log scale (natural log for vocoder compatibility)
             // Use slightly larger epsilon to match common vocoder implementations
-            mel[i][m] = std::log(std::max(sum, 1e-10f));
+            melFrame[m] = std::log(std::max(sum, 1e-10f));
         }
     }
-    
-    return mel;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../JuceHeader.h"
+#include "../Models/MelFrames.h"
 #include <vector>
 
 /**
@@ -19,7 +20,26 @@ public:
      * @param numSamples Number of samples
      * @return Mel spectrogram [T, numMels] in log scale
      */
-    std::vector<std::vector<float>> compute(const float* audio, int numSamples);
+    MelFrames compute(const float* audio, int numSamples);
+    
+    /** Number of frames compute() returns for numSamples samples. */
+    int getNumFrames(int numSamples) const;
+    
+    /**
+     * Number of leading frames whose samples are all known once the first
+     * samplesReady of numSamples samples have been written. Frames reaching
+     * into the right padding need the whole signal.
+     */
+    int getNumFramesReady(int samplesReady, int numSamples) const;
+    
+    /**
+     * Compute frames [startFrame, endFrame) into mel, which must already hold
+     * getNumFrames(numSamples) frames of numMels values. Only reads samples
+     * those frames cover, so it can run while audio is still being written
+     * further on.
+     */
+    void computeFrames(const float* audio, int numSamples, int startFrame, int endFrame,
+                       MelFrames& mel);
     
 private:
     void createMelFilterbank();
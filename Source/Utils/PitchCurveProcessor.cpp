@@ -1,23 +1,14 @@
 #include "PitchCurveProcessor.h"
 #include "BasePitchCurve.h"
+#include "PitchMath.h"
 #include "../Utils/Constants.h"
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <utility>
 
 namespace
 {
-    inline float safeMidiToFreq(float midi)
-    {
-        return midiToFreq(midi);
-    }
-
-    inline float safeFreqToMidi(float freq)
-    {
-        if (freq <= 0.0f)
-            return 0.0f;
-        return freqToMidi(freq);
-    }
-
     void ensureSizes(AudioData& audioData, int totalFrames)
     {
         if (totalFrames <= 0)
@@ -47,17 +38,91 @@ namespace
             segments.push_back(seg);
         }
 
-        // Ensure segments are sorted by start frame for stable generation
-        std::sort(segments.begin(), segments.end(),
-                  [](const auto& a, const auto& b) { return a.startFrame < b.startFrame; });
+        // Sorted by start frame, equal starts in vector order as in the note
+        // index, so full and incremental rebuilds see the same order
+        std::stable_sort(segments.begin(), segments.end(),
+                         [](const auto& a, const auto& b) { return a.startFrame < b.startFrame; });
         return segments;
     }
+
+    const Note* skipRestsForward(const Project& project, const Note* note)
+    {
+        while (note != nullptr && note->isRest())
+            note = project.getNextNoteByStart(note);
+        return note;
+    }
+
+    const Note* skipRestsBack(const Project& project, const Note* note)
+    {
+        while (note != nullptr && note->isRest())
+            note = project.getPreviousNoteByStart(note);
+        return note;
+    }
 } // namespace
 
 namespace PitchCurveProcessor
 {
+    // Around each range, from the last note ending before it to the first
+    // one starting after it, plus one note beyond the smoothing reach each
+    // way. Runs that meet are collected once.
+    std::vector<BasePitchCurve::NoteSegment> collectSegmentsAround(const Project& project,
+                                                                   const std::vector<std::pair<int, int>>& ranges,
+                                                                   int totalFrames,
+                                                                   bool withPitchOffset)
+    {
+        constexpr int first = std::numeric_limits<int>::min();
+        constexpr int last = std::numeric_limits<int>::max();
+        const int reach = 2 * BasePitchCurve::getReachFrames() + 1;
+
+        // Start frames [begin, end) of each run
+        std::vector<std::pair<int, int>> runs;
+        runs.reserve(ranges.size());
+        for (const auto& [startFrame, endFrame] : ranges)
+        {
+            const Note* next = skipRestsForward(project, project.getFirstNoteStartingFrom(endFrame));
+            const int spanEnd = next != nullptr ? next->getStartFrame() : totalFrames;
+
+            const Note* previous = project.getLastNoteStartingBefore(startFrame);
+            while (previous != nullptr && (previous->isRest() || previous->getEndFrame() > startFrame))
+                previous = project.getPreviousNoteByStart(previous);
+            const int spanStart = previous != nullptr ? previous->getEndFrame() : 0;
+
+            const Note* before = skipRestsBack(project,
+                project.getLastNoteStartingBefore(std::min(spanStart, startFrame) - reach));
+            const Note* after = skipRestsForward(project,
+                project.getFirstNoteStartingFrom(std::max(spanEnd, endFrame) + reach));
+
+            int runBegin = previous != nullptr ? previous->getStartFrame() : first;
+            if (before != nullptr)
+                runBegin = std::min(runBegin, before->getStartFrame());
+            else
+                runBegin = first;
+            const int runEnd = after != nullptr ? after->getStartFrame() + 1 : last;
+            runs.push_back({runBegin, runEnd});
+        }
+        std::sort(runs.begin(), runs.end());
+
+        std::vector<BasePitchCurve::NoteSegment> segments;
+        int collectedTo = first;
+        for (const auto& [runBegin, runEnd] : runs)
+        {
+            const int begin = std::max(runBegin, collectedTo);
+            if (begin >= runEnd)
+                continue;
+
+            for (const auto* note : project.getNotesStartingIn(begin, runEnd))
+            {
+                if (!note->isRest())
+                    segments.push_back({note->getStartFrame(), note->getEndFrame(),
+                                        note->getMidiNote() + (withPitchOffset ? note->getPitchOffset() : 0.0f)});
+            }
+            collectedTo = runEnd;
+        }
+        return segments;
+    }
+
     std::vector<float> interpolateWithUvMask(const std::vector<float>& pitchHz,
-                                             const std::vector<bool>& uvMask)
+                                             const std::vector<uint8_t>& uvMask)
     {
         if (pitchHz.empty())
             return {};
@@ -133,7 +198,7 @@ namespace PitchCurveProcessor
         const int totalFrames = static_cast<int>(sourcePitchHz.size());
         ensureSizes(audioData, totalFrames);
 
-        auto segments = collectNoteSegments(project.getNotes());
+        auto segments = collectNoteSegments(std::as_const(project).getNotes());
         if (!segments.empty())
         {
             audioData.basePitch = BasePitchCurve::generateForNotes(segments, totalFrames);
@@ -143,25 +208,21 @@ namespace PitchCurveProcessor
         {
             // Fallback: derive base from source pitch directly
             audioData.basePitch.assign(static_cast<size_t>(totalFrames), 0.0f);
-            for (int i = 0; i < totalFrames; ++i)
-                audioData.basePitch[static_cast<size_t>(i)] = safeFreqToMidi(sourcePitchHz[i]);
+            PitchMath::freqToMidi(sourcePitchHz.data(), audioData.basePitch.data(), static_cast<size_t>(totalFrames));
         }
 
-        // Dense delta: midi(source) - base
+        // Dense delta: midi(source) - base (unvoiced source frames become -base)
         audioData.deltaPitch.assign(static_cast<size_t>(totalFrames), 0.0f);
+        PitchMath::freqToMidi(sourcePitchHz.data(), audioData.deltaPitch.data(), static_cast<size_t>(totalFrames));
         for (int i = 0; i < totalFrames; ++i)
-        {
-            const float base = audioData.basePitch[static_cast<size_t>(i)];
-            const float midi = safeFreqToMidi(sourcePitchHz[i]);
-            audioData.deltaPitch[static_cast<size_t>(i)] = midi - base;
-        }
+            audioData.deltaPitch[static_cast<size_t>(i)] -= audioData.basePitch[static_cast<size_t>(i)];
 
         // Cache base F0 (Hz) for backwards compatibility
         audioData.baseF0.resize(static_cast<size_t>(totalFrames));
-        for (int i = 0; i < totalFrames; ++i)
-            audioData.baseF0[static_cast<size_t>(i)] = safeMidiToFreq(audioData.basePitch[static_cast<size_t>(i)]);
+        PitchMath::midiToFreq(audioData.basePitch.data(), audioData.baseF0.data(), static_cast<size_t>(totalFrames));
 
         composeF0InPlace(project, /*applyUvMask=*/false);
+        project.addRewrittenFrames(0, totalFrames);
     }
 
     void rebuildBaseFromNotes(Project& project)
@@ -170,7 +231,7 @@ namespace PitchCurveProcessor
         const int totalFrames = audioData.getNumFrames();
         ensureSizes(audioData, totalFrames);
 
-        auto segments = collectNoteSegments(project.getNotes());
+        auto segments = collectNoteSegments(std::as_const(project).getNotes());
         if (!segments.empty())
         {
             audioData.basePitch = BasePitchCurve::generateForNotes(segments, totalFrames);
@@ -186,10 +247,78 @@ namespace PitchCurveProcessor
 
         // Update cached baseF0
         audioData.baseF0.resize(static_cast<size_t>(totalFrames));
-        for (int i = 0; i < totalFrames; ++i)
-            audioData.baseF0[static_cast<size_t>(i)] = safeMidiToFreq(audioData.basePitch[static_cast<size_t>(i)]);
+        PitchMath::midiToFreq(audioData.basePitch.data(), audioData.baseF0.data(), static_cast<size_t>(totalFrames));
 
         composeF0InPlace(project, /*applyUvMask=*/false);
+        project.addRewrittenFrames(0, totalFrames);
+    }
+
+    std::pair<int, int> rebuildBaseForRange(Project& project, int startFrame, int endFrame)
+    {
+        const auto rewritten = rebuildBaseForRanges(project, {{startFrame, endFrame}});
+        if (rewritten.empty())
+        {
+            const int frame = std::clamp(startFrame, 0, std::max(0, project.getAudioData().getNumFrames()));
+            return {frame, frame};
+        }
+        return {rewritten.front().first, rewritten.back().second};
+    }
+
+    std::vector<std::pair<int, int>> rebuildBaseForRanges(Project& project,
+                                                          const std::vector<std::pair<int, int>>& ranges)
+    {
+        auto& audioData = project.getAudioData();
+        const int totalFrames = audioData.getNumFrames();
+        const size_t size = static_cast<size_t>(totalFrames);
+
+        // The last note sets the curve's length; without one there is nothing to update
+        const Note* lastNote = skipRestsBack(project, project.getLastNoteStartingBefore(std::numeric_limits<int>::max()));
+        if (totalFrames <= 0 || lastNote == nullptr || audioData.basePitch.size() != size ||
+            audioData.deltaPitch.size() != size || audioData.baseF0.size() != size ||
+            audioData.f0.size() != size)
+        {
+            rebuildBaseFromNotes(project);
+            return {{0, std::max(0, totalFrames)}};
+        }
+
+        const auto segments = collectSegmentsAround(project, ranges, totalFrames);
+        const auto rewritten = BasePitchCurve::updateRanges(segments, audioData.basePitch, ranges,
+                                                            lastNote->getEndFrame());
+
+        for (const auto& [begin, end] : rewritten)
+        {
+            const size_t first = static_cast<size_t>(begin);
+            const size_t count = static_cast<size_t>(end - begin);
+            PitchMath::midiToFreq(audioData.basePitch.data() + first, audioData.baseF0.data() + first, count);
+            PitchMath::composeToFreq(audioData.basePitch.data() + first, audioData.deltaPitch.data() + first,
+                                     0.0f, nullptr, audioData.f0.data() + first, count);
+            project.addRewrittenFrames(begin, end);
+        }
+
+        return rewritten;
+    }
+
+    std::pair<int, int> expandToAdjacentNotes(Project& project, int startFrame, int endFrame)
+    {
+        constexpr int reach = 30;
+        int expandedStart = startFrame;
+        int expandedEnd = endFrame;
+
+        // Notes ending in (startFrame - reach, startFrame]
+        for (const auto* note : project.getNotesInRange(startFrame - reach + 1, startFrame + 1))
+        {
+            if (note->getEndFrame() > startFrame - reach && note->getEndFrame() <= startFrame)
+                expandedStart = std::min(expandedStart, note->getStartFrame());
+        }
+
+        // Notes starting in [endFrame, endFrame + reach)
+        for (const auto* note : project.getNotesInRange(endFrame, endFrame + reach))
+        {
+            if (note->getStartFrame() < endFrame + reach && note->getStartFrame() >= endFrame)
+                expandedEnd = std::max(expandedEnd, note->getEndFrame());
+        }
+
+        return {expandedStart, expandedEnd};
     }
 
     std::vector<float> composeF0(const Project& project,
@@ -200,18 +329,27 @@ namespace PitchCurveProcessor
         const int totalFrames = static_cast<int>(audioData.basePitch.size());
         std::vector<float> result(static_cast<size_t>(totalFrames), 0.0f);
 
-        for (int i = 0; i < totalFrames; ++i)
-        {
-            bool isVoiced = (i < static_cast<int>(audioData.voicedMask.size())) ? audioData.voicedMask[i] : true;
-            if (applyUvMask && !isVoiced)
-                continue;
+        // The byte mask feeds straight into the kernel when it covers the curve
+        const uint8_t* voiced = applyUvMask && audioData.voicedMask.size() >= result.size()
+                                    ? audioData.voicedMask.data()
+                                    : nullptr;
 
-            const float base = audioData.basePitch[static_cast<size_t>(i)];
-            const float delta = (i < static_cast<int>(audioData.deltaPitch.size()))
-                                    ? audioData.deltaPitch[static_cast<size_t>(i)]
-                                    : 0.0f;
-            const float midi = base + delta + globalPitchOffset;
-            result[static_cast<size_t>(i)] = safeMidiToFreq(midi);
+        // base + delta + offset in one batch pass; frames past the delta curve use base only
+        const size_t withDelta = std::min(result.size(), audioData.deltaPitch.size());
+        PitchMath::composeToFreq(audioData.basePitch.data(), audioData.deltaPitch.data(), globalPitchOffset,
+                                 voiced, result.data(), withDelta);
+        PitchMath::composeToFreq(audioData.basePitch.data() + withDelta, nullptr, globalPitchOffset,
+                                 voiced != nullptr ? voiced + withDelta : nullptr,
+                                 result.data() + withDelta, result.size() - withDelta);
+
+        if (applyUvMask && voiced == nullptr)
+        {
+            const int maskSize = std::min(totalFrames, static_cast<int>(audioData.voicedMask.size()));
+            for (int i = 0; i < maskSize; ++i)
+            {
+                if (!audioData.voicedMask[static_cast<size_t>(i)])
+                    result[static_cast<size_t>(i)] = 0.0f;
+            }
         }
 
         return result;
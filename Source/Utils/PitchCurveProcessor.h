@@ -1,16 +1,20 @@
 #pragma once
 
 #include "../Models/Project.h"
+#include "BasePitchCurve.h"
 #include <vector>
 
 namespace PitchCurveProcessor
 {
+    // Every rebuild below reports the frames it rewrote through
+    // Project::addRewrittenFrames().
+
     /**
      * Linearly interpolate pitch through unvoiced regions using the uv mask.
      * Returns a dense pitch (Hz) array with the same length as the input.
      */
     std::vector<float> interpolateWithUvMask(const std::vector<float>& pitchHz,
-                                             const std::vector<bool>& uvMask);
+                                             const std::vector<uint8_t>& uvMask);
 
     /**
      * Rebuild base pitch (midi) from current notes and keep existing delta.
@@ -19,6 +23,44 @@ namespace PitchCurveProcessor
      */
     void rebuildBaseFromNotes(Project& project);
 
+    /**
+     * Incremental variant of rebuildBaseFromNotes for edits to notes that
+     * overlap [startFrame, endFrame). Base pitch, baseF0 and f0 are only
+     * recomputed over that span plus the smoothing reach, so the cost follows
+     * the edited notes instead of the project length. Falls back to a full
+     * rebuild when the dense curves are not aligned yet.
+     * Returns the frame range that was rewritten.
+     */
+    std::pair<int, int> rebuildBaseForRange(Project& project, int startFrame, int endFrame);
+
+    /**
+     * rebuildBaseForRange for several edited ranges in one pass, e.g. every
+     * note of a multi-note drag. Only the notes around the ranges are read,
+     * through the note index, and no frame is recomputed twice, so the cost
+     * follows the edited notes even when they are far apart. Returns the
+     * frame ranges that were rewritten, sorted.
+     */
+    std::vector<std::pair<int, int>> rebuildBaseForRanges(Project& project,
+                                                          const std::vector<std::pair<int, int>>& ranges);
+
+    /**
+     * The run of notes BasePitchCurve::updateRanges() reads for these ranges,
+     * found through the note index, in start order, rests left out. The
+     * pitch includes each note's offset unless withPitchOffset is false, as
+     * for a display curve that shows the offset separately.
+     */
+    std::vector<BasePitchCurve::NoteSegment> collectSegmentsAround(const Project& project,
+                                                                   const std::vector<std::pair<int, int>>& ranges,
+                                                                   int totalFrames,
+                                                                   bool withPitchOffset = true);
+
+    /**
+     * [startFrame, endFrame) widened to the notes that end or start within
+     * 30 frames of it, whose resynthesis an edit there can reach. Only notes
+     * near the two edges are looked at.
+     */
+    std::pair<int, int> expandToAdjacentNotes(Project& project, int startFrame, int endFrame);
+
     /**
      * Rebuild base and delta from a source pitch (Hz). This is used after
      * detection/segmentation or when we need to recompute delta from edited
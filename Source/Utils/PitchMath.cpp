@@ -0,0 +1,277 @@
+#include "PitchMath.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define PITCHMATH_USE_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+ #include <arm_neon.h>
+ #define PITCHMATH_USE_NEON 1
+#endif
+
+namespace
+{
+    constexpr float MIDI_A4 = 69.0f;
+    constexpr float FREQ_A4 = 440.0f;
+    constexpr float LN2 = 0.693147180559945309f;
+    constexpr float LOG2E = 1.442695040888963407f;
+    constexpr float SQRT2 = 1.41421356f;
+
+    // Taylor coefficients of e^y, highest order first
+    constexpr float EXP_C6 = 1.0f / 720.0f;
+    constexpr float EXP_C5 = 1.0f / 120.0f;
+    constexpr float EXP_C4 = 1.0f / 24.0f;
+    constexpr float EXP_C3 = 1.0f / 6.0f;
+    constexpr float EXP_C2 = 0.5f;
+
+    inline int32_t floatBits(float x)
+    {
+        int32_t i;
+        std::memcpy(&i, &x, sizeof(i));
+        return i;
+    }
+
+    inline float bitsToFloat(int32_t i)
+    {
+        float x;
+        std::memcpy(&x, &i, sizeof(x));
+        return x;
+    }
+
+    // 2^x for x in roughly [-126, 127]. Rounds to the nearest integer n and
+    // evaluates 2^f on f in [-0.5, 0.5] with a degree-6 Taylor series
+    // (truncation error < 1.2e-7), then adds n to the exponent bits.
+    inline float fastExp2(float x)
+    {
+        x = std::max(-126.0f, std::min(127.0f, x));
+        // Shifted so truncation acts as floor(x + 0.5)
+        const int32_t n = static_cast<int32_t>(x + 126.5f) - 126;
+        const float f = (x - static_cast<float>(n)) * LN2;
+
+        float p = EXP_C6;
+        p = p * f + EXP_C5;
+        p = p * f + EXP_C4;
+        p = p * f + EXP_C3;
+        p = p * f + EXP_C2;
+        p = p * f + 1.0f;
+        p = p * f + 1.0f;
+
+        return bitsToFloat(floatBits(p) + (n << 23));
+    }
+
+    // log2(x) for normal x > 0. Splits off the exponent, then uses the
+    // atanh series log(m) = 2(t + t^3/3 + ...) with t = (m-1)/(m+1) on
+    // m in [sqrt(0.5), sqrt(2)), |t| < 0.172 (truncation error < 1e-9).
+    inline float fastLog2(float x)
+    {
+        const int32_t bits = floatBits(x);
+        int32_t e = ((bits >> 23) & 0xff) - 127;
+        float m = bitsToFloat((bits & 0x007fffff) | 0x3f800000);
+
+        if (m > SQRT2)
+        {
+            m *= 0.5f;
+            e += 1;
+        }
+
+        const float t = (m - 1.0f) / (m + 1.0f);
+        const float t2 = t * t;
+        float s = 1.0f / 9.0f;
+        s = s * t2 + 1.0f / 7.0f;
+        s = s * t2 + 1.0f / 5.0f;
+        s = s * t2 + 1.0f / 3.0f;
+        s = s * t2 + 1.0f;
+
+        return static_cast<float>(e) + 2.0f * LOG2E * t * s;
+    }
+
+    inline float midiToFreqScalar(float midi)
+    {
+        return FREQ_A4 * fastExp2((midi - MIDI_A4) * (1.0f / 12.0f));
+    }
+
+    inline float freqToMidiScalar(float freq)
+    {
+        return 12.0f * fastLog2(freq * (1.0f / FREQ_A4)) + MIDI_A4;
+    }
+
+#if PITCHMATH_USE_SSE2 || PITCHMATH_USE_NEON
+    // Thin 4-lane wrappers so the kernels below read the same on SSE2 and NEON
+ #if PITCHMATH_USE_SSE2
+    using VF = __m128;
+    using VI = __m128i;
+    inline VF load(const float* p) { return _mm_loadu_ps(p); }
+    inline void store(float* p, VF v) { _mm_storeu_ps(p, v); }
+    inline VF set1(float x) { return _mm_set1_ps(x); }
+    inline VI set1i(int32_t x) { return _mm_set1_epi32(x); }
+    inline VF add(VF a, VF b) { return _mm_add_ps(a, b); }
+    inline VF sub(VF a, VF b) { return _mm_sub_ps(a, b); }
+    inline VF mul(VF a, VF b) { return _mm_mul_ps(a, b); }
+    inline VF div(VF a, VF b) { return _mm_div_ps(a, b); }
+    inline VF vmin(VF a, VF b) { return _mm_min_ps(a, b); }
+    inline VF vmax(VF a, VF b) { return _mm_max_ps(a, b); }
+    inline VI truncToInt(VF a) { return _mm_cvttps_epi32(a); }
+    inline VF toFloat(VI a) { return _mm_cvtepi32_ps(a); }
+    inline VI asInt(VF a) { return _mm_castps_si128(a); }
+    inline VF asFloat(VI a) { return _mm_castsi128_ps(a); }
+    inline VI addi(VI a, VI b) { return _mm_add_epi32(a, b); }
+    inline VI subi(VI a, VI b) { return _mm_sub_epi32(a, b); }
+    inline VI andi(VI a, VI b) { return _mm_and_si128(a, b); }
+    inline VI ori(VI a, VI b) { return _mm_or_si128(a, b); }
+    inline VI shl23(VI a) { return _mm_slli_epi32(a, 23); }
+    inline VI shr23(VI a) { return _mm_srli_epi32(a, 23); }
+    inline VF greaterThan(VF a, VF b) { return _mm_cmpgt_ps(a, b); }
+    inline VF select(VF mask, VF a, VF b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+ #else
+    using VF = float32x4_t;
+    using VI = int32x4_t;
+    inline VF load(const float* p) { return vld1q_f32(p); }
+    inline void store(float* p, VF v) { vst1q_f32(p, v); }
+    inline VF set1(float x) { return vdupq_n_f32(x); }
+    inline VI set1i(int32_t x) { return vdupq_n_s32(x); }
+    inline VF add(VF a, VF b) { return vaddq_f32(a, b); }
+    inline VF sub(VF a, VF b) { return vsubq_f32(a, b); }
+    inline VF mul(VF a, VF b) { return vmulq_f32(a, b); }
+    inline VF div(VF a, VF b) { return vdivq_f32(a, b); }
+    inline VF vmin(VF a, VF b) { return vminq_f32(a, b); }
+    inline VF vmax(VF a, VF b) { return vmaxq_f32(a, b); }
+    inline VI truncToInt(VF a) { return vcvtq_s32_f32(a); }
+    inline VF toFloat(VI a) { return vcvtq_f32_s32(a); }
+    inline VI asInt(VF a) { return vreinterpretq_s32_f32(a); }
+    inline VF asFloat(VI a) { return vreinterpretq_f32_s32(a); }
+    inline VI addi(VI a, VI b) { return vaddq_s32(a, b); }
+    inline VI subi(VI a, VI b) { return vsubq_s32(a, b); }
+    inline VI andi(VI a, VI b) { return vandq_s32(a, b); }
+    inline VI ori(VI a, VI b) { return vorrq_s32(a, b); }
+    inline VI shl23(VI a) { return vshlq_n_s32(a, 23); }
+    inline VI shr23(VI a) { return vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a), 23)); }
+    inline VF greaterThan(VF a, VF b) { return vreinterpretq_f32_u32(vcgtq_f32(a, b)); }
+    inline VF select(VF mask, VF a, VF b) { return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+ #endif
+
+    // Lane-wise versions of fastExp2 / fastLog2 with identical arithmetic
+    inline VF fastExp2(VF x)
+    {
+        x = vmax(set1(-126.0f), vmin(set1(127.0f), x));
+        const VI n = subi(truncToInt(add(x, set1(126.5f))), set1i(126));
+        const VF f = mul(sub(x, toFloat(n)), set1(LN2));
+
+        VF p = set1(EXP_C6);
+        p = add(mul(p, f), set1(EXP_C5));
+        p = add(mul(p, f), set1(EXP_C4));
+        p = add(mul(p, f), set1(EXP_C3));
+        p = add(mul(p, f), set1(EXP_C2));
+        p = add(mul(p, f), set1(1.0f));
+        p = add(mul(p, f), set1(1.0f));
+
+        return asFloat(addi(asInt(p), shl23(n)));
+    }
+
+    inline VF fastLog2(VF x)
+    {
+        const VI bits = asInt(x);
+        const VF exponent = toFloat(subi(andi(shr23(bits), set1i(0xff)), set1i(127)));
+        VF m = asFloat(ori(andi(bits, set1i(0x007fffff)), set1i(0x3f800000)));
+
+        const VF high = greaterThan(m, set1(SQRT2));
+        m = select(high, mul(m, set1(0.5f)), m);
+        const VF e = select(high, add(exponent, set1(1.0f)), exponent);
+
+        const VF one = set1(1.0f);
+        const VF t = div(sub(m, one), add(m, one));
+        const VF t2 = mul(t, t);
+        VF s = set1(1.0f / 9.0f);
+        s = add(mul(s, t2), set1(1.0f / 7.0f));
+        s = add(mul(s, t2), set1(1.0f / 5.0f));
+        s = add(mul(s, t2), set1(1.0f / 3.0f));
+        s = add(mul(s, t2), one);
+
+        return add(e, mul(set1(2.0f * LOG2E), mul(t, s)));
+    }
+
+    inline VF midiToFreqVec(VF midi)
+    {
+        return mul(set1(FREQ_A4), fastExp2(mul(sub(midi, set1(MIDI_A4)), set1(1.0f / 12.0f))));
+    }
+
+    // Returns MIDI for positive lanes and 0 elsewhere
+    inline VF freqToMidiVec(VF freq, VF& positive)
+    {
+        positive = greaterThan(freq, set1(0.0f));
+        const VF safe = select(positive, freq, set1(1.0f));
+        return add(mul(set1(12.0f), fastLog2(mul(safe, set1(1.0f / FREQ_A4)))), set1(MIDI_A4));
+    }
+
+    constexpr size_t LANES = 4;
+#endif
+} // namespace
+
+namespace PitchMath
+{
+    void midiToFreq(const float* midi, float* out, size_t count, float offset)
+    {
+        size_t i = 0;
+#if PITCHMATH_USE_SSE2 || PITCHMATH_USE_NEON
+        const VF vOffset = set1(offset);
+        for (; i + LANES <= count; i += LANES)
+            store(out + i, midiToFreqVec(add(load(midi + i), vOffset)));
+#endif
+        for (; i < count; ++i)
+            out[i] = midiToFreqScalar(midi[i] + offset);
+    }
+
+    void composeToFreq(const float* base, const float* delta, float offset,
+                       const uint8_t* voiced, float* out, size_t count)
+    {
+        size_t i = 0;
+#if PITCHMATH_USE_SSE2 || PITCHMATH_USE_NEON
+        const VF vOffset = set1(offset);
+        for (; i + LANES <= count; i += LANES)
+        {
+            VF midi = load(base + i);
+            if (delta)
+                midi = add(midi, load(delta + i));
+            store(out + i, midiToFreqVec(add(midi, vOffset)));
+        }
+#endif
+        for (; i < count; ++i)
+            out[i] = midiToFreqScalar(base[i] + (delta ? delta[i] : 0.0f) + offset);
+
+        if (voiced)
+        {
+            for (size_t j = 0; j < count; ++j)
+                out[j] = voiced[j] ? out[j] : 0.0f;
+        }
+    }
+
+    void freqToMidi(const float* freq, float* out, size_t count)
+    {
+        size_t i = 0;
+#if PITCHMATH_USE_SSE2 || PITCHMATH_USE_NEON
+        for (; i + LANES <= count; i += LANES)
+        {
+            VF positive;
+            const VF midi = freqToMidiVec(load(freq + i), positive);
+            store(out + i, select(positive, midi, set1(0.0f)));
+        }
+#endif
+        for (; i < count; ++i)
+            out[i] = freq[i] > 0.0f ? freqToMidiScalar(freq[i]) : 0.0f;
+    }
+
+    void freqToDelta(const float* freq, const float* base, float* out, size_t count)
+    {
+        size_t i = 0;
+#if PITCHMATH_USE_SSE2 || PITCHMATH_USE_NEON
+        for (; i + LANES <= count; i += LANES)
+        {
+            VF positive;
+            const VF midi = freqToMidiVec(load(freq + i), positive);
+            store(out + i, select(positive, sub(midi, load(base + i)), set1(0.0f)));
+        }
+#endif
+        for (; i < count; ++i)
+            out[i] = freq[i] > 0.0f ? freqToMidiScalar(freq[i]) - base[i] : 0.0f;
+    }
+} // namespace PitchMath
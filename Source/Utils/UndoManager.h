@@ -3,10 +3,13 @@
 #include "../JuceHeader.h"
 #include "../Models/Note.h"
 #include "../Models/Project.h"
+#include "F0EditRuns.h"
+#include <algorithm>
 #include <vector>
 #include <memory>
 #include <functional>
 #include <limits>
+#include <utility>
 
 /**
  * Base class for undoable actions.
@@ -18,6 +21,15 @@ public:
     virtual void undo() = 0;
     virtual void redo() = 0;
     virtual juce::String getName() const = 0;
+
+    /**
+     * Frame range [start, end) whose state this action changes, used by the
+     * edit journal. {-1, -1} means the whole project.
+     */
+    virtual std::pair<int, int> getAffectedFrames() const { return {-1, -1}; }
+
+    /** Approximate bytes held by this action, for the history budget. */
+    virtual size_t getMemoryUsage() const = 0;
 };
 
 /**
@@ -26,14 +38,30 @@ public:
 class PitchOffsetAction : public UndoableAction
 {
 public:
-    PitchOffsetAction(Note* note, float oldOffset, float newOffset)
-        : note(note), oldOffset(oldOffset), newOffset(newOffset) {}
+    PitchOffsetAction(Project* proj, Note* note, float oldOffset, float newOffset)
+        : project(proj), note(note), oldOffset(oldOffset), newOffset(newOffset) {}
     
-    void undo() override { if (note) note->setPitchOffset(oldOffset); }
-    void redo() override { if (note) note->setPitchOffset(newOffset); }
+    void undo() override { apply(oldOffset); }
+    void redo() override { apply(newOffset); }
     juce::String getName() const override { return "Change Pitch Offset"; }
+    std::pair<int, int> getAffectedFrames() const override
+    {
+        if (!note) return {-1, -1};
+        return {note->getStartFrame(), note->getEndFrame()};
+    }
+    size_t getMemoryUsage() const override { return sizeof(*this); }
     
 private:
+    void apply(float offset)
+    {
+        if (!note) return;
+        // Report where the note was drawn and where it is now
+        project->notifyNoteChanged(*note);
+        project->setNotePitch(note, note->getMidiNote(), offset);
+        project->notifyNoteChanged(*note);
+    }
+
+    Project* project;
     Note* note;
     float oldOffset;
     float newOffset;
@@ -42,77 +70,38 @@ private:
 /**
  * Action for changing multiple F0 values (hand-drawing).
  */
-struct F0FrameEdit
-{
-    int idx = -1;
-    float oldF0 = 0.0f;
-    float newF0 = 0.0f;
-    float oldDelta = 0.0f;
-    float newDelta = 0.0f;
-    bool oldVoiced = false;
-    bool newVoiced = false;
-};
-
 class F0EditAction : public UndoableAction
 {
 public:
     F0EditAction(std::vector<float>* f0Array,
                  std::vector<float>* deltaPitchArray,
-                 std::vector<bool>* voicedMask,
+                 std::vector<uint8_t>* voicedMask,
                  std::vector<F0FrameEdit> edits,
                  std::function<void(int, int)> onF0Changed = nullptr)
-        : f0Array(f0Array), deltaPitchArray(deltaPitchArray), voicedMask(voicedMask), edits(std::move(edits)), onF0Changed(onF0Changed) {}
+        : f0Array(f0Array), deltaPitchArray(deltaPitchArray), voicedMask(voicedMask),
+          edits(std::move(edits), true), onF0Changed(onF0Changed) {}
 
-    void undo() override
-    {
-        if (!f0Array) return;
-        int minIdx = std::numeric_limits<int>::max();
-        int maxIdx = std::numeric_limits<int>::min();
-        for (const auto& e : edits)
-        {
-            if (e.idx >= 0 && e.idx < static_cast<int>(f0Array->size())) {
-                (*f0Array)[e.idx] = e.oldF0;
-                minIdx = std::min(minIdx, e.idx);
-                maxIdx = std::max(maxIdx, e.idx);
-            }
-            if (deltaPitchArray && e.idx >= 0 && e.idx < static_cast<int>(deltaPitchArray->size()))
-                (*deltaPitchArray)[e.idx] = e.oldDelta;
-            if (voicedMask && e.idx >= 0 && e.idx < static_cast<int>(voicedMask->size()))
-                (*voicedMask)[e.idx] = e.oldVoiced;
-        }
-        if (onF0Changed && minIdx <= maxIdx)
-            onF0Changed(minIdx, maxIdx);
-    }
+    void undo() override { apply(false); }
+    void redo() override { apply(true); }
 
-    void redo() override
+    juce::String getName() const override { return "Edit Pitch Curve"; }
+    std::pair<int, int> getAffectedFrames() const override { return edits.getRange(); }
+    size_t getMemoryUsage() const override { return sizeof(*this) + edits.getMemoryUsage(); }
+
+private:
+    void apply(bool useNew)
     {
         if (!f0Array) return;
-        int minIdx = std::numeric_limits<int>::max();
-        int maxIdx = std::numeric_limits<int>::min();
-        for (const auto& e : edits)
-        {
-            if (e.idx >= 0 && e.idx < static_cast<int>(f0Array->size())) {
-                (*f0Array)[e.idx] = e.newF0;
-                minIdx = std::min(minIdx, e.idx);
-                maxIdx = std::max(maxIdx, e.idx);
-            }
-            if (deltaPitchArray && e.idx >= 0 && e.idx < static_cast<int>(deltaPitchArray->size()))
-                (*deltaPitchArray)[e.idx] = e.newDelta;
-            if (voicedMask && e.idx >= 0 && e.idx < static_cast<int>(voicedMask->size()))
-                (*voicedMask)[e.idx] = e.newVoiced;
-        }
+        const auto [minIdx, maxIdx] = edits.apply(f0Array, deltaPitchArray, voicedMask, useNew);
         if (onF0Changed && minIdx <= maxIdx)
             onF0Changed(minIdx, maxIdx);
     }
 
-    juce::String getName() const override { return "Edit Pitch Curve"; }
-
-private:
     std::vector<float>* f0Array;
     std::vector<float>* deltaPitchArray;
-    std::vector<bool>* voicedMask;
-    std::vector<F0FrameEdit> edits;
-    std::function<void(int, int)> onF0Changed;  // Callback with (minFrame, maxFrame) to trigger resynthesis
+    std::vector<uint8_t>* voicedMask;
+    F0EditRuns edits;
+    std::function<void(int, int)> onF0Changed;  // Callback with (minFrame, maxFrame) to redraw and resynthesize
 };
 
 /**
@@ -121,25 +110,20 @@ private:
 class NotePitchDragAction : public UndoableAction
 {
 public:
-    NotePitchDragAction(Note* note, std::vector<float>* f0Array,
+    NotePitchDragAction(Project* proj, Note* note, std::vector<float>* f0Array,
                         float oldMidi, float newMidi,
                         std::vector<F0FrameEdit> f0Edits,
                         std::function<void(Note*)> onNoteChanged = nullptr)
-        : note(note), f0Array(f0Array), oldMidi(oldMidi), newMidi(newMidi),
-          f0Edits(std::move(f0Edits)), onNoteChanged(onNoteChanged) {}
+        : project(proj), note(note), f0Array(f0Array), oldMidi(oldMidi), newMidi(newMidi),
+          f0Edits(std::move(f0Edits), false), onNoteChanged(onNoteChanged) {}
 
     void undo() override
     {
         if (note) {
-            note->setMidiNote(oldMidi);
-            note->markDirty();
-        }
-        if (f0Array) {
-            for (const auto& e : f0Edits) {
-                if (e.idx >= 0 && e.idx < static_cast<int>(f0Array->size()))
-                    (*f0Array)[e.idx] = e.oldF0;
-            }
+            project->setNotePitch(note, oldMidi, note->getPitchOffset());
+            project->markNoteDirty(note);
         }
+        f0Edits.apply(f0Array, nullptr, nullptr, false);
         // Notify that note changed, so base pitch can be recalculated
         if (onNoteChanged && note) {
             onNoteChanged(note);
@@ -149,15 +133,10 @@ public:
     void redo() override
     {
         if (note) {
-            note->setMidiNote(newMidi);
-            note->markDirty();
-        }
-        if (f0Array) {
-            for (const auto& e : f0Edits) {
-                if (e.idx >= 0 && e.idx < static_cast<int>(f0Array->size()))
-                    (*f0Array)[e.idx] = e.newF0;
-            }
+            project->setNotePitch(note, newMidi, note->getPitchOffset());
+            project->markNoteDirty(note);
         }
+        f0Edits.apply(f0Array, nullptr, nullptr, true);
         // Notify that note changed, so base pitch can be recalculated
         if (onNoteChanged && note) {
             onNoteChanged(note);
@@ -165,13 +144,20 @@ public:
     }
 
     juce::String getName() const override { return "Drag Note Pitch"; }
+    std::pair<int, int> getAffectedFrames() const override
+    {
+        if (!note) return {-1, -1};
+        return {note->getStartFrame(), note->getEndFrame()};
+    }
+    size_t getMemoryUsage() const override { return sizeof(*this) + f0Edits.getMemoryUsage(); }
 
 private:
+    Project* project;
     Note* note;
     std::vector<float>* f0Array;
     float oldMidi;
     float newMidi;
-    std::vector<F0FrameEdit> f0Edits;
+    F0EditRuns f0Edits;
     std::function<void(Note*)> onNoteChanged;  // Callback when note MIDI changes
 };
 
@@ -181,27 +167,22 @@ private:
 class MultiNotePitchDragAction : public UndoableAction
 {
 public:
-    MultiNotePitchDragAction(std::vector<Note*> notes, std::vector<float>* f0Array,
+    MultiNotePitchDragAction(Project* proj, std::vector<Note*> notes, std::vector<float>* f0Array,
                              std::vector<float> oldMidis, float pitchDelta,
                              std::vector<F0FrameEdit> f0Edits,
                              std::function<void(const std::vector<Note*>&)> onNotesChanged = nullptr)
-        : notes(std::move(notes)), f0Array(f0Array), oldMidis(std::move(oldMidis)),
-          pitchDelta(pitchDelta), f0Edits(std::move(f0Edits)), onNotesChanged(onNotesChanged) {}
+        : project(proj), notes(std::move(notes)), f0Array(f0Array), oldMidis(std::move(oldMidis)),
+          pitchDelta(pitchDelta), f0Edits(std::move(f0Edits), false), onNotesChanged(onNotesChanged) {}
 
     void undo() override
     {
         for (size_t i = 0; i < notes.size() && i < oldMidis.size(); ++i) {
             if (notes[i]) {
-                notes[i]->setMidiNote(oldMidis[i]);
-                notes[i]->markDirty();
-            }
-        }
-        if (f0Array) {
-            for (const auto& e : f0Edits) {
-                if (e.idx >= 0 && e.idx < static_cast<int>(f0Array->size()))
-                    (*f0Array)[e.idx] = e.oldF0;
+                project->setNotePitch(notes[i], oldMidis[i], notes[i]->getPitchOffset());
+                project->markNoteDirty(notes[i]);
             }
         }
+        f0Edits.apply(f0Array, nullptr, nullptr, false);
         if (onNotesChanged)
             onNotesChanged(notes);
     }
@@ -210,28 +191,41 @@ public:
     {
         for (size_t i = 0; i < notes.size() && i < oldMidis.size(); ++i) {
             if (notes[i]) {
-                notes[i]->setMidiNote(oldMidis[i] + pitchDelta);
-                notes[i]->markDirty();
-            }
-        }
-        if (f0Array) {
-            for (const auto& e : f0Edits) {
-                if (e.idx >= 0 && e.idx < static_cast<int>(f0Array->size()))
-                    (*f0Array)[e.idx] = e.newF0;
+                project->setNotePitch(notes[i], oldMidis[i] + pitchDelta, notes[i]->getPitchOffset());
+                project->markNoteDirty(notes[i]);
             }
         }
+        f0Edits.apply(f0Array, nullptr, nullptr, true);
         if (onNotesChanged)
             onNotesChanged(notes);
     }
 
     juce::String getName() const override { return "Drag Multiple Notes"; }
+    std::pair<int, int> getAffectedFrames() const override
+    {
+        int start = std::numeric_limits<int>::max();
+        int end = std::numeric_limits<int>::min();
+        for (const auto* n : notes) {
+            if (!n) continue;
+            start = std::min(start, n->getStartFrame());
+            end = std::max(end, n->getEndFrame());
+        }
+        if (start > end) return {-1, -1};
+        return {start, end};
+    }
+    size_t getMemoryUsage() const override
+    {
+        return sizeof(*this) + notes.capacity() * sizeof(Note*)
+             + oldMidis.capacity() * sizeof(float) + f0Edits.getMemoryUsage();
+    }
 
 private:
+    Project* project;
     std::vector<Note*> notes;
     std::vector<float>* f0Array;
     std::vector<float> oldMidis;
     float pitchDelta;
-    std::vector<F0FrameEdit> f0Edits;
+    F0EditRuns f0Edits;
     std::function<void(const std::vector<Note*>&)> onNotesChanged;
 };
 
@@ -242,19 +236,18 @@ private:
 class NoteSnapToSemitoneAction : public UndoableAction
 {
 public:
-    NoteSnapToSemitoneAction(Note* note,
+    NoteSnapToSemitoneAction(Project* proj, Note* note,
                              float oldMidi, float oldOffset,
                              float newMidi,
                              std::function<void(Note*)> onNoteChanged = nullptr)
-        : note(note), oldMidi(oldMidi), oldOffset(oldOffset),
+        : project(proj), note(note), oldMidi(oldMidi), oldOffset(oldOffset),
           newMidi(newMidi), onNoteChanged(onNoteChanged) {}
 
     void undo() override
     {
         if (note) {
-            note->setMidiNote(oldMidi);
-            note->setPitchOffset(oldOffset);
-            note->markDirty();
+            project->setNotePitch(note, oldMidi, oldOffset);
+            project->markNoteDirty(note);
         }
         if (onNoteChanged && note)
             onNoteChanged(note);
@@ -263,17 +256,23 @@ public:
     void redo() override
     {
         if (note) {
-            note->setMidiNote(newMidi);
-            note->setPitchOffset(0.0f);
-            note->markDirty();
+            project->setNotePitch(note, newMidi, 0.0f);
+            project->markNoteDirty(note);
         }
         if (onNoteChanged && note)
             onNoteChanged(note);
     }
 
     juce::String getName() const override { return "Snap to Semitone"; }
+    std::pair<int, int> getAffectedFrames() const override
+    {
+        if (!note) return {-1, -1};
+        return {note->getStartFrame(), note->getEndFrame()};
+    }
+    size_t getMemoryUsage() const override { return sizeof(*this); }
 
 private:
+    Project* project;
     Note* note;
     float oldMidi;
     float oldOffset;
@@ -298,12 +297,7 @@ public:
         // Remove the second note and restore original
         project->removeNoteByStartFrame(secondNote.getStartFrame());
         // Find and restore the first note to original state
-        for (auto& note : project->getNotes()) {
-            if (note.getStartFrame() == firstNote.getStartFrame()) {
-                note = originalNote;
-                break;
-            }
-        }
+        project->replaceNote(project->getNoteStartingAt(firstNote.getStartFrame()), originalNote);
         if (onChanged) onChanged();
     }
 
@@ -311,17 +305,17 @@ public:
     {
         if (!project) return;
         // Split again: modify first note and add second
-        for (auto& note : project->getNotes()) {
-            if (note.getStartFrame() == originalNote.getStartFrame()) {
-                note = firstNote;
-                break;
-            }
-        }
+        project->replaceNote(project->getNoteStartingAt(originalNote.getStartFrame()), firstNote);
         project->addNote(secondNote);
         if (onChanged) onChanged();
     }
 
     juce::String getName() const override { return "Split Note"; }
+    std::pair<int, int> getAffectedFrames() const override
+    {
+        return {originalNote.getStartFrame(), originalNote.getEndFrame()};
+    }
+    size_t getMemoryUsage() const override { return sizeof(*this); }
 
 private:
     Project* project;
@@ -331,25 +325,102 @@ private:
     std::function<void()> onChanged;
 };
 
+/**
+ * Undo history storage: a growable ring buffer so that dropping the oldest
+ * action is O(1) instead of shifting the whole stack.
+ */
+class UndoHistoryRing
+{
+public:
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    UndoableAction& back() { return *slots[slot(count - 1)]; }
+    const UndoableAction& back() const { return *slots[slot(count - 1)]; }
+    UndoableAction& front() { return *slots[head]; }
+
+    void push_back(std::unique_ptr<UndoableAction> action)
+    {
+        if (count == slots.size())
+            grow();
+        slots[slot(count)] = std::move(action);
+        ++count;
+    }
+
+    std::unique_ptr<UndoableAction> pop_back()
+    {
+        --count;
+        return std::move(slots[slot(count)]);
+    }
+
+    void pop_front()
+    {
+        slots[head].reset();
+        head = (head + 1) % slots.size();
+        --count;
+    }
+
+    void clear()
+    {
+        for (auto& s : slots) s.reset();
+        head = 0;
+        count = 0;
+    }
+
+private:
+    size_t slot(size_t i) const { return (head + i) % slots.size(); }
+
+    void grow()
+    {
+        std::vector<std::unique_ptr<UndoableAction>> larger(std::max<size_t>(16, slots.size() * 2));
+        for (size_t i = 0; i < count; ++i)
+            larger[i] = std::move(slots[slot(i)]);
+        slots = std::move(larger);
+        head = 0;
+    }
+
+    std::vector<std::unique_ptr<UndoableAction>> slots;
+    size_t head = 0;
+    size_t count = 0;
+};
+
 /**
  * Simple undo manager for the pitch editor.
+ *
+ * History is bounded by the memory its actions hold (undo and redo
+ * together) rather than by a fixed count, so many small edits can be kept
+ * while a few long draw strokes still stay within budget. The most recent
+ * action is always kept, however large.
  */
 class PitchUndoManager
 {
 public:
-    PitchUndoManager(size_t maxHistory = 100) : maxHistory(maxHistory) {}
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+    static constexpr size_t DEFAULT_MAX_ACTIONS = 10000;
+
+    PitchUndoManager(size_t memoryBudget = DEFAULT_MEMORY_BUDGET,
+                     size_t maxActions = DEFAULT_MAX_ACTIONS)
+        : memoryBudget(memoryBudget), maxActions(maxActions) {}
     
     void addAction(std::unique_ptr<UndoableAction> action)
     {
         // Clear redo stack when new action is added
+        for (const auto& redoAction : redoStack)
+            historyBytes -= redoAction->getMemoryUsage();
         redoStack.clear();
         
+        historyBytes += action->getMemoryUsage();
         undoStack.push_back(std::move(action));
         
-        // Limit history size
-        while (undoStack.size() > maxHistory)
+        if (onActionApplied)
+            onActionApplied(undoStack.back());
+        
+        // Drop the oldest actions until history fits the budget
+        while (undoStack.size() > 1
+               && (historyBytes > memoryBudget || undoStack.size() > maxActions))
         {
-            undoStack.erase(undoStack.begin());
+            historyBytes -= undoStack.front().getMemoryUsage();
+            undoStack.pop_front();
         }
         
         if (onHistoryChanged)
@@ -363,10 +434,11 @@ public:
     {
         if (undoStack.empty()) return;
         
-        auto action = std::move(undoStack.back());
-        undoStack.pop_back();
+        auto action = undoStack.pop_back();
         
         action->undo();
+        if (onActionApplied)
+            onActionApplied(*action);
         redoStack.push_back(std::move(action));
         
         if (onHistoryChanged)
@@ -381,6 +453,8 @@ public:
         redoStack.pop_back();
         
         action->redo();
+        if (onActionApplied)
+            onActionApplied(*action);
         undoStack.push_back(std::move(action));
         
         if (onHistoryChanged)
@@ -391,6 +465,7 @@ public:
     {
         undoStack.clear();
         redoStack.clear();
+        historyBytes = 0;
         
         if (onHistoryChanged)
             onHistoryChanged();
@@ -398,7 +473,7 @@ public:
     
     juce::String getUndoName() const
     {
-        return undoStack.empty() ? "" : undoStack.back()->getName();
+        return undoStack.empty() ? "" : undoStack.back().getName();
     }
     
     juce::String getRedoName() const
@@ -406,10 +481,16 @@ public:
         return redoStack.empty() ? "" : redoStack.back()->getName();
     }
     
+    /** Bytes currently held by undo and redo history. */
+    size_t getMemoryUsage() const { return historyBytes; }
+    
     std::function<void()> onHistoryChanged;
+    std::function<void(const UndoableAction&)> onActionApplied;  // After add / undo / redo
     
 private:
-    std::vector<std::unique_ptr<UndoableAction>> undoStack;
+    UndoHistoryRing undoStack;
     std::vector<std::unique_ptr<UndoableAction>> redoStack;
-    size_t maxHistory;
+    size_t memoryBudget;
+    size_t maxActions;
+    size_t historyBytes = 0;
 };
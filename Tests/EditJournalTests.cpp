@@ -0,0 +1,166 @@
+#include "../Source/Utils/EditJournal.h"
+#include "../Source/Models/ProjectSerializer.h"
+#include "../Source/Utils/Constants.h"
+#include "../Source/Utils/PitchCurveProcessor.h"
+#include "../Source/Utils/UndoManager.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr int NUM_FRAMES = 1000;
+
+    struct NoteSpec
+    {
+        int startFrame;
+        int endFrame;
+        float midiNote;
+    };
+
+    void makeBaseProject(Project& project)
+    {
+        // The mel spectrogram sets the frame count; its values do not matter here
+        auto& audioData = project.getAudioData();
+        audioData.melSpectrogram = MelFrames(static_cast<size_t>(NUM_FRAMES), NUM_MELS);
+        audioData.voicedMask.assign(NUM_FRAMES, 1);
+
+        std::vector<float> sourcePitch(NUM_FRAMES);
+        for (int i = 0; i < NUM_FRAMES; ++i)
+            sourcePitch[static_cast<size_t>(i)] = 220.0f * std::pow(2.0f, 0.2f * std::sin(0.05f * static_cast<float>(i)) / 12.0f);
+
+        std::vector<Note> notes;
+        for (const auto& spec : {NoteSpec{100, 200, 57.0f}, NoteSpec{300, 450, 60.0f}, NoteSpec{600, 700, 62.0f}})
+            notes.emplace_back(spec.startFrame, spec.endFrame, spec.midiNote);
+        project.setNotes(std::move(notes));
+
+        PitchCurveProcessor::rebuildCurvesFromSource(project, sourcePitch);
+    }
+
+    std::vector<Note> sortedNotes(const Project& project)
+    {
+        auto notes = project.getNotes();
+        std::sort(notes.begin(), notes.end(),
+                  [](const Note& a, const Note& b) { return a.getStartFrame() < b.getStartFrame(); });
+        return notes;
+    }
+}
+
+/**
+ * Replays journaled edits onto the project as it was last saved, the way
+ * crash recovery does, and checks the result matches the edited project.
+ */
+class EditJournalTests : public juce::UnitTest
+{
+public:
+    EditJournalTests() : juce::UnitTest("EditJournal", "Utils") {}
+
+    void runTest() override
+    {
+        const juce::TemporaryFile temp(".htpx");
+        const auto projectFile = temp.getFile();
+
+        Project live;
+        makeBaseProject(live);
+        ProjectSaveOptions options;
+        options.includeMelCache = false;
+        expect(ProjectSerializer::saveToFile(live, projectFile, options));
+
+        EditJournal journal;
+        expect(journal.open(&live, projectFile));
+        expect(!EditJournal::hasRecoverableEdits(projectFile));
+
+        PitchUndoManager undoManager;
+        undoManager.onActionApplied = [&journal](const UndoableAction& action) {
+            const auto [startFrame, endFrame] = action.getAffectedFrames();
+            journal.recordEdit(startFrame, endFrame);
+        };
+
+        beginTest("Pitch drag");
+        {
+            // As PitchEditor does it: bake the new pitch into the note,
+            // rebuild the curves around it, then record the F0 it changed
+            auto& audioData = live.getAudioData();
+            const std::vector<float> oldF0(audioData.f0.begin() + 300, audioData.f0.begin() + 450);
+
+            Note* dragged = live.getNoteStartingAt(300);
+            expect(dragged != nullptr);
+            live.setNotePitch(dragged, 62.0f, 0.0f);
+            PitchCurveProcessor::rebuildBaseForRange(live, 300, 450);
+
+            std::vector<F0FrameEdit> f0Edits;
+            for (int i = 300; i < 450; ++i)
+            {
+                F0FrameEdit edit;
+                edit.idx = i;
+                edit.oldF0 = oldF0[static_cast<size_t>(i - 300)];
+                edit.newF0 = audioData.f0[static_cast<size_t>(i)];
+                f0Edits.push_back(edit);
+            }
+            undoManager.addAction(std::make_unique<NotePitchDragAction>(
+                &live, dragged, &audioData.f0, 60.0f, 62.0f, std::move(f0Edits)));
+            journal.flush();
+
+            expectReplayMatches(live, projectFile);
+        }
+
+        beginTest("Split");
+        {
+            // As NoteSplitter does it
+            const Note original = *live.getNoteStartingAt(600);
+            live.setNoteRange(live.getNoteStartingAt(600), 600, 650);
+            const Note secondPart(650, 700, original.getMidiNote());
+            live.addNote(secondPart);
+
+            undoManager.addAction(std::make_unique<NoteSplitAction>(
+                &live, original, *live.getNoteStartingAt(600), secondPart));
+            journal.flush();
+
+            expectEquals(static_cast<int>(live.getNotes().size()), 4);
+            expectReplayMatches(live, projectFile);
+        }
+
+        beginTest("Undone split");
+        {
+            undoManager.undo();
+            journal.flush();
+
+            expectEquals(static_cast<int>(live.getNotes().size()), 3);
+            expectReplayMatches(live, projectFile);
+        }
+
+        // Left without closing, as after a crash; clean up here
+        journal.close();
+        EditJournal::getJournalFile(projectFile).deleteFile();
+        EditJournal::getSnapshotFile(projectFile).deleteFile();
+    }
+
+private:
+    void expectReplayMatches(const Project& expected, const juce::File& projectFile)
+    {
+        expect(EditJournal::hasRecoverableEdits(projectFile));
+
+        Project recovered;
+        expect(ProjectSerializer::loadFromFile(recovered, projectFile, false));
+        expectGreaterThan(EditJournal::recover(recovered, projectFile), 0);
+
+        const auto expectedNotes = sortedNotes(expected);
+        const auto recoveredNotes = sortedNotes(recovered);
+        expectEquals(static_cast<int>(recoveredNotes.size()), static_cast<int>(expectedNotes.size()));
+        for (size_t i = 0; i < std::min(expectedNotes.size(), recoveredNotes.size()); ++i)
+        {
+            expectEquals(recoveredNotes[i].getStartFrame(), expectedNotes[i].getStartFrame());
+            expectEquals(recoveredNotes[i].getEndFrame(), expectedNotes[i].getEndFrame());
+            expectEquals(recoveredNotes[i].getMidiNote(), expectedNotes[i].getMidiNote());
+            expectEquals(recoveredNotes[i].getPitchOffset(), expectedNotes[i].getPitchOffset());
+        }
+
+        const auto& a = expected.getAudioData();
+        const auto& b = recovered.getAudioData();
+        expect(b.f0 == a.f0, "f0 differs after replay");
+        expect(b.basePitch == a.basePitch, "base pitch differs after replay");
+        expect(b.deltaPitch == a.deltaPitch, "delta pitch differs after replay");
+        expect(b.voicedMask == a.voicedMask, "voiced mask differs after replay");
+    }
+};
+
+static EditJournalTests editJournalTests;
@@ -0,0 +1,18 @@
+#include "../Source/JuceHeader.h"
+
+int main()
+{
+    // Some classes under test post work through the message queue
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runAllTests();
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+    {
+        if (runner.getResult(i)->failures > 0)
+            return 1;
+    }
+    return 0;
+}